@@ -94,9 +94,11 @@ class EngineState : public NotCopyable {
     auto rel_map = table_store_->GetRelationMap();
     // Use an empty string for query result address, because the local execution mode should use
     // the Local GRPC result server to send results to.
-    return std::make_unique<planner::CompilerState>(std::move(rel_map), registry_info_.get(),
-                                                    time_now, /* result address */ "",
-                                                    /* ssl target name override*/ "");
+    auto compiler_state = std::make_unique<planner::CompilerState>(
+        std::move(rel_map), registry_info_.get(), time_now, /* result address */ "",
+        /* ssl target name override*/ "");
+    compiler_state->set_table_sizes(table_store_->GetTableSizes());
+    return compiler_state;
   }
 
   const udf::Registry* func_registry() const { return func_registry_.get(); }
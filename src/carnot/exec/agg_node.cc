@@ -20,9 +20,14 @@
 
 #include <arrow/array.h>
 #include <arrow/array/builder_base.h>
+#include <arrow/builder.h>
 #include <arrow/status.h>
 #include <algorithm>
+#include <chrono>
 #include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
 
 #include <magic_enum.hpp>
 
@@ -35,6 +40,10 @@
 #include "src/shared/types/type_utils.h"
 #include "src/shared/types/types.h"
 
+DEFINE_int64(windowed_agg_idle_input_timeout_ms, 10000,
+             "How long an input of a windowed aggregate can go without sending rows before it "
+             "stops holding back the windows that the other inputs have moved past.");
+
 namespace px {
 namespace carnot {
 namespace exec {
@@ -71,13 +80,50 @@ void ExtractToColumnWrapper(const std::vector<GroupArgs>& group_args,
   size_t num_rows = rb.num_rows();
   DCHECK(num_rows <= group_args.size());
   for (size_t row_idx = 0; row_idx < num_rows; ++row_idx) {
-    DCHECK(group_args[row_idx].av != nullptr);
+    // Late rows of windowed aggregates don't belong to any group.
+    if (group_args[row_idx].av == nullptr) {
+      continue;
+    }
     auto col_wrapper = group_args[row_idx].av->agg_cols[col_idx].get();
     auto arr = rb.ColumnAt(rb_col_idx).get();
     types::ExtractValueToColumnWrapper<DT>(col_wrapper, arr, row_idx);
   }
 }
 
+// Partial aggregates serialize the states of all of the UDAs of a group into a single string.
+// Each state is prefixed with its length as a little-endian uint32.
+constexpr size_t kSerializedStateLengthBytes = sizeof(uint32_t);
+
+void AppendSerializedState(std::string_view state, std::string* out) {
+  char len[kSerializedStateLengthBytes];
+  utils::IntToLEndianBytes(state.size(), len);
+  out->append(len, kSerializedStateLengthBytes);
+  out->append(state);
+}
+
+StatusOr<std::vector<std::string_view>> SplitSerializedStates(std::string_view serialized,
+                                                              size_t num_states) {
+  std::vector<std::string_view> states;
+  states.reserve(num_states);
+  while (!serialized.empty()) {
+    if (serialized.size() < kSerializedStateLengthBytes) {
+      return error::Internal("Serialized aggregate state is truncated");
+    }
+    auto len = utils::LEndianBytesToInt<uint32_t>(serialized);
+    serialized.remove_prefix(kSerializedStateLengthBytes);
+    if (serialized.size() < len) {
+      return error::Internal("Serialized aggregate state is truncated");
+    }
+    states.push_back(serialized.substr(0, len));
+    serialized.remove_prefix(len);
+  }
+  if (states.size() != num_states) {
+    return error::Internal("Expected $0 serialized aggregate states, got $1", num_states,
+                           states.size());
+  }
+  return states;
+}
+
 }  // namespace
 
 std::string AggNode::DebugStringImpl() {
@@ -106,11 +152,21 @@ Status AggNode::InitImpl(const plan::Operator& plan_node) {
     }
   }
 
-  size_t output_size = plan_node_->values().size() + plan_node_->groups().size();
+  size_t num_value_cols = SerializesPartials() ? 1 : plan_node_->values().size();
+  size_t output_size = num_value_cols + plan_node_->groups().size();
   if (output_size != output_descriptor_->size()) {
     return error::InvalidArgument("Output size mismatch in aggregate");
   }
 
+  if (MergesPartials()) {
+    if (input_descriptor_->size() == 0 ||
+        input_descriptor_->type(input_descriptor_->size() - 1) != types::STRING) {
+      return error::InvalidArgument(
+          "Finalize aggregate expects the serialized partial aggregates as its last input column");
+    }
+    serialized_col_idx_ = input_descriptor_->size() - 1;
+  }
+
   if (HasNoGroups()) {
     return Status::OK();
   }
@@ -128,13 +184,39 @@ Status AggNode::InitImpl(const plan::Operator& plan_node) {
     group_data_types_.emplace_back(input_descriptor_->type(group.idx));
   }
 
-  auto values_size = plan_node_->values().size();
-  for (size_t i = 0; i < values_size; ++i) {
+  if (plan_node_->windowed() && plan_node_->HasWindowGroup()) {
+    auto idx = plan_node_->window_group_idx();
+    if (idx < 0 || idx >= static_cast<int64_t>(groups_size)) {
+      return error::InvalidArgument("Window group $0 is out of range, the aggregate has $1 groups",
+                                    idx, groups_size);
+    }
+    if (group_data_types_[idx] != types::TIME64NS) {
+      return error::InvalidArgument("Window group '$0' must be of type TIME64NS, got $1",
+                                    plan_node_->groups()[idx].name,
+                                    types::ToString(group_data_types_[idx]));
+    }
+    if (plan_node_->allowed_lateness_ns() < 0) {
+      return error::InvalidArgument("Allowed lateness must not be negative, got $0",
+                                    plan_node_->allowed_lateness_ns());
+    }
+    window_group_idx_ = idx;
+    allowed_lateness_ns_ = plan_node_->allowed_lateness_ns();
+  }
+
+  for (size_t i = 0; i < num_value_cols; ++i) {
     auto values_idx = i + groups_size;
     DCHECK(values_idx < output_descriptor_->size());
     value_data_types_.emplace_back(output_descriptor_->type(values_idx));
   }
 
+  if (MergesPartials()) {
+    // The only column stored for each group are the serialized UDA states, which are merged into
+    // the UDAs of the group when the stored column is evaluated.
+    plan_cols_to_stored_map_[serialized_col_idx_] = 0;
+    stored_cols_to_plan_idx_.emplace_back(serialized_col_idx_);
+    stored_cols_data_types_.emplace_back(types::STRING);
+    return Status::OK();
+  }
   return CreateColumnMapping();
 }
 
@@ -144,6 +226,14 @@ Status AggNode::PrepareImpl(ExecState* exec_state) {
 }
 
 Status AggNode::OpenImpl(ExecState* exec_state) {
+  if (SerializesPartials() || MergesPartials()) {
+    for (const auto& value : plan_node_->values()) {
+      auto def = exec_state->GetUDADefinition(value->uda_id());
+      if (!def->supports_partial()) {
+        return error::InvalidArgument("UDA '$0' does not support partial aggregates", def->name());
+      }
+    }
+  }
   if (HasNoGroups()) {
     PL_RETURN_IF_ERROR(CreateUDAInfoValues(&udas_no_groups_, exec_state));
   }
@@ -158,6 +248,9 @@ Status AggNode::ConsumeNextImpl(ExecState* exec_state, const RowBatch& rb, size_
 }
 
 Status AggNode::CloseImpl(ExecState*) {
+  if (HasWindowColumn()) {
+    stats()->AddExtraInfo("late_rows_dropped", std::to_string(late_rows_dropped_));
+  }
   udas_no_groups_.clear();
   group_args_chunk_.clear();
   group_args_pool_.Clear();
@@ -181,21 +274,30 @@ Status AggNode::ClearAggState(ExecState* exec_state) {
 
 Status AggNode::AggregateGroupByNone(ExecState* exec_state, const RowBatch& rb) {
   auto values = plan_node_->values();
-  for (size_t i = 0; i < values.size(); ++i) {
-    PL_RETURN_IF_ERROR(
-        EvaluateSingleExpressionNoGroups(exec_state, udas_no_groups_[i], values[i].get(), rb));
+  if (MergesPartials()) {
+    auto serialized_col = rb.ColumnAt(serialized_col_idx_).get();
+    for (int64_t row_idx = 0; row_idx < serialized_col->length(); ++row_idx) {
+      PL_RETURN_IF_ERROR(MergeSerializedUDAs(
+          types::GetValueFromArrowArray<types::STRING>(serialized_col, row_idx), &udas_no_groups_));
+    }
+  } else {
+    for (size_t i = 0; i < values.size(); ++i) {
+      PL_RETURN_IF_ERROR(
+          EvaluateSingleExpressionNoGroups(exec_state, udas_no_groups_[i], values[i].get(), rb));
+    }
   }
 
   if (ReadyToEmitBatches(rb)) {
     RowBatch output_rb(*output_descriptor_, 1);
-    for (size_t i = 0; i < values.size(); ++i) {
-      const auto& uda_info = udas_no_groups_[i];
-      auto builder = types::MakeArrowBuilder(uda_info.def->finalize_return_type(),
-                                             exec_state->exec_mem_pool());
-      PL_RETURN_IF_ERROR(
-          uda_info.def->FinalizeArrow(uda_info.uda.get(), function_ctx_.get(), builder.get()));
+    std::vector<std::unique_ptr<arrow::ArrayBuilder>> value_builders;
+    for (size_t i = 0; i < output_descriptor_->size(); ++i) {
+      value_builders.push_back(
+          types::MakeArrowBuilder(output_descriptor_->type(i), exec_state->exec_mem_pool()));
+    }
+    PL_RETURN_IF_ERROR(AppendUDAValues(udas_no_groups_, value_builders));
+    for (const auto& value_builder : value_builders) {
       SharedArray out_col;
-      PL_RETURN_IF_ERROR(builder->Finish(&out_col));
+      PL_RETURN_IF_ERROR(value_builder->Finish(&out_col));
       PL_RETURN_IF_ERROR(output_rb.AddColumn(out_col));
     }
     output_rb.set_eow(rb.eow());
@@ -233,11 +335,28 @@ Status AggNode::ExtractRowTupleForBatch(const RowBatch& rb) {
 }
 
 Status AggNode::HashRowBatch(ExecState* exec_state, const RowBatch& rb) {
-  PL_UNUSED(exec_state);
+  InputWatermark* input_watermark = nullptr;
+  if (HasWindowColumn()) {
+    auto now = std::chrono::steady_clock::now();
+    auto it = input_watermarks_.try_emplace(exec_state->current_source(), now).first;
+    input_watermark = &it->second;
+    if (rb.num_rows() > 0) {
+      input_watermark->last_row_time = now;
+    }
+  }
   // Loop through all the row and basically store the values into column chunk based on which
   // group they belong to.
   for (auto row_idx = 0; row_idx < rb.num_rows(); ++row_idx) {
     auto& ga = group_args_chunk_[row_idx];
+    if (HasWindowColumn()) {
+      auto window_start = WindowStart(ga.rt);
+      if (window_start < closed_watermark_) {
+        // The window of this row was already emitted.
+        ++late_rows_dropped_;
+        continue;
+      }
+      input_watermark->window_start = std::max(input_watermark->window_start, window_start);
+    }
     AggHashValue* val = nullptr;
     // Check to see if in hash
     // TODO(zasgar): Change this to upsert.
@@ -277,7 +396,9 @@ Status AggNode::EvaluatePartialAggregates(ExecState* exec_state, size_t num_reco
   for (size_t i = 0; i < num_records; ++i) {
     DCHECK(i < group_args_chunk_.size());
     auto& ga = group_args_chunk_[i];
-    DCHECK(ga.av != nullptr);
+    if (ga.av == nullptr) {
+      continue;
+    }
     if (ga.av->agg_cols[0]->Size() > kAggCompactionThreshold) {
       PL_RETURN_IF_ERROR(EvaluateAggHashValue(exec_state, ga.av));
     }
@@ -300,7 +421,8 @@ Status AggNode::ResetGroupArgs() {
   return Status::OK();
 }
 
-Status AggNode::ConvertAggHashMapToRowBatch(ExecState* exec_state, RowBatch* output_rb) {
+Status AggNode::ConvertAggHashMapToRowBatch(ExecState* exec_state, const AggHashMap& agg_hash_map,
+                                            RowBatch* output_rb) {
   PL_UNUSED(exec_state);
   DCHECK(output_rb != nullptr);
   std::vector<std::unique_ptr<arrow::ArrayBuilder>> group_builders;
@@ -313,7 +435,7 @@ Status AggNode::ConvertAggHashMapToRowBatch(ExecState* exec_state, RowBatch* out
   }
 
   // Agg into agg values and emit!
-  for (const auto& kv : agg_hash_map_) {
+  for (const auto& kv : agg_hash_map) {
     auto* groups_rt = kv.first;
     auto* val = kv.second;
 
@@ -326,11 +448,7 @@ Status AggNode::ConvertAggHashMapToRowBatch(ExecState* exec_state, RowBatch* out
     }
     // Actually Finalize the UDA based on the column wrapper chunks.
     PL_RETURN_IF_ERROR(EvaluateAggHashValue(exec_state, val));
-    for (size_t i = 0; i < val->udas.size(); ++i) {
-      const auto& uda_info = val->udas[i];
-      PL_RETURN_IF_ERROR(uda_info.def->FinalizeArrow(uda_info.uda.get(), function_ctx_.get(),
-                                                     value_builders[i].get()));
-    }
+    PL_RETURN_IF_ERROR(AppendUDAValues(val->udas, value_builders));
   }
 
   for (const auto& group_builder : group_builders) {
@@ -365,11 +483,73 @@ Status AggNode::AggregateGroupByClause(ExecState* exec_state, const RowBatch& rb
   PL_RETURN_IF_ERROR(ResetGroupArgs());
   if (ReadyToEmitBatches(rb)) {
     RowBatch output_rb(*output_descriptor_, agg_hash_map_.size());
-    PL_RETURN_IF_ERROR(ConvertAggHashMapToRowBatch(exec_state, &output_rb));
+    PL_RETURN_IF_ERROR(ConvertAggHashMapToRowBatch(exec_state, agg_hash_map_, &output_rb));
     output_rb.set_eow(rb.eow());
     output_rb.set_eos(rb.eos());
     PL_RETURN_IF_ERROR(SendRowBatchToChildren(exec_state, output_rb));
     PL_RETURN_IF_ERROR(ClearAggState(exec_state));
+  } else if (HasWindowColumn()) {
+    PL_RETURN_IF_ERROR(EmitClosedWindows(exec_state));
+  }
+  return Status::OK();
+}
+
+void AggNode::SetInputSources(const std::vector<int64_t>& source_ids) {
+  auto now = std::chrono::steady_clock::now();
+  for (auto source_id : source_ids) {
+    input_watermarks_.try_emplace(source_id, now);
+  }
+}
+
+Status AggNode::EmitClosedWindows(ExecState* exec_state) {
+  auto now = std::chrono::steady_clock::now();
+  auto idle_timeout = std::chrono::milliseconds(FLAGS_windowed_agg_idle_input_timeout_ms);
+  auto min_watermark = std::numeric_limits<int64_t>::max();
+  bool has_active_input = false;
+  for (const auto& [source_id, input] : input_watermarks_) {
+    // The current source has just sent a batch, so it is never idle.
+    if (exec_state->SourceFinished(source_id) ||
+        (source_id != exec_state->current_source() && now - input.last_row_time > idle_timeout)) {
+      continue;
+    }
+    has_active_input = true;
+    min_watermark = std::min(min_watermark, input.window_start);
+  }
+  // Windows that start at or after min_watermark - allowed_lateness_ns_ may still get rows from
+  // the slowest active input. That includes every window when some active input hasn't sent any
+  // rows yet.
+  if (!has_active_input ||
+      min_watermark < std::numeric_limits<int64_t>::min() + allowed_lateness_ns_ + 1) {
+    return Status::OK();
+  }
+  auto closed_watermark = min_watermark - allowed_lateness_ns_;
+  if (closed_watermark <= closed_watermark_) {
+    return Status::OK();
+  }
+  closed_watermark_ = closed_watermark;
+
+  AggHashMap closed_windows;
+  for (auto it = agg_hash_map_.begin(); it != agg_hash_map_.end();) {
+    if (WindowStart(it->first) < closed_watermark_) {
+      closed_windows.insert(*it);
+      agg_hash_map_.erase(it++);
+    } else {
+      ++it;
+    }
+  }
+  if (closed_windows.empty()) {
+    return Status::OK();
+  }
+
+  RowBatch output_rb(*output_descriptor_, closed_windows.size());
+  PL_RETURN_IF_ERROR(ConvertAggHashMapToRowBatch(exec_state, closed_windows, &output_rb));
+  PL_RETURN_IF_ERROR(SendRowBatchToChildren(exec_state, output_rb));
+
+  // The hash values are owned by the pool, but the UDA states of the closed windows can be
+  // released right away.
+  for (const auto& kv : closed_windows) {
+    kv.second->udas.clear();
+    kv.second->agg_cols.clear();
   }
   return Status::OK();
 }
@@ -431,7 +611,54 @@ Status AggNode::EvaluateSingleExpressionNoGroups(ExecState* exec_state, const UD
   return Status::OK();
 }
 
+Status AggNode::AppendUDAValues(
+    const std::vector<UDAInfo>& udas,
+    const std::vector<std::unique_ptr<arrow::ArrayBuilder>>& value_builders) {
+  if (!SerializesPartials()) {
+    DCHECK_EQ(udas.size(), value_builders.size());
+    for (size_t i = 0; i < udas.size(); ++i) {
+      const auto& uda_info = udas[i];
+      PL_RETURN_IF_ERROR(uda_info.def->FinalizeArrow(uda_info.uda.get(), function_ctx_.get(),
+                                                     value_builders[i].get()));
+    }
+    return Status::OK();
+  }
+
+  DCHECK_EQ(value_builders.size(), 1ULL);
+  std::string serialized;
+  for (const auto& uda_info : udas) {
+    PL_ASSIGN_OR_RETURN(auto state,
+                        uda_info.def->Serialize(uda_info.uda.get(), function_ctx_.get()));
+    AppendSerializedState(state, &serialized);
+  }
+  PL_RETURN_IF_ERROR(
+      static_cast<arrow::StringBuilder*>(value_builders[0].get())->Append(serialized));
+  return Status::OK();
+}
+
+Status AggNode::MergeSerializedUDAs(std::string_view serialized, std::vector<UDAInfo>* udas) {
+  PL_ASSIGN_OR_RETURN(auto states, SplitSerializedStates(serialized, udas->size()));
+  for (size_t i = 0; i < udas->size(); ++i) {
+    auto& uda_info = (*udas)[i];
+    auto partial = uda_info.def->Make();
+    PL_RETURN_IF_ERROR(uda_info.def->Deserialize(partial.get(), function_ctx_.get(),
+                                                 std::string(states[i])));
+    PL_RETURN_IF_ERROR(
+        uda_info.def->Merge(uda_info.uda.get(), partial.get(), function_ctx_.get()));
+  }
+  return Status::OK();
+}
+
 Status AggNode::EvaluateAggHashValue(ExecState* exec_state, AggHashValue* val) {
+  if (MergesPartials()) {
+    auto* serialized_col = static_cast<types::StringValueColumnWrapper*>(val->agg_cols[0].get());
+    for (size_t row_idx = 0; row_idx < serialized_col->Size(); ++row_idx) {
+      PL_RETURN_IF_ERROR(MergeSerializedUDAs((*serialized_col)[row_idx], &val->udas));
+    }
+    serialized_col->Clear();
+    return Status::OK();
+  }
+
   size_t values_size = plan_node_->values().size();
   for (size_t i = 0; i < values_size; ++i) {
     const auto& uda_info = val->udas[i];
@@ -520,13 +747,14 @@ Status AggNode::CreateUDAInfoValues(std::vector<UDAInfo>* val, ExecState* exec_s
   CHECK_EQ(val->size(), 0ULL);
 
   for (const auto& value : plan_node_->values()) {
-    std::vector<types::DataType> types;
-    types.reserve(value->Deps().size());
-    for (auto* dep : value->Deps()) {
-      PL_ASSIGN_OR_RETURN(auto type, GetTypeOfDep(*dep));
-      types.push_back(type);
-    }
     auto def = exec_state->GetUDADefinition(value->uda_id());
+    // The args of a finalize aggregate refer to the input of the partial aggregates, so they
+    // can't be checked against this node's input.
+    if (!MergesPartials()) {
+      for (auto* dep : value->Deps()) {
+        PL_RETURN_IF_ERROR(GetTypeOfDep(*dep));
+      }
+    }
     val->emplace_back(def->Make(), def);
   }
   return Status::OK();
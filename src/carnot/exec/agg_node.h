@@ -17,13 +17,20 @@
  */
 
 #pragma once
+#include <arrow/array/builder_base.h>
+
+#include <chrono>
 #include <cstddef>
+#include <limits>
 #include <map>
 #include <memory>
 #include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 
+#include <absl/container/flat_hash_map.h>
+
 #include "src/carnot/exec/exec_node.h"
 #include "src/carnot/exec/exec_state.h"
 #include "src/carnot/exec/expression_evaluator.h"
@@ -40,6 +47,8 @@
 #include "src/shared/types/types.h"
 #include "src/table_store/table_store.h"
 
+DECLARE_int64(windowed_agg_idle_input_timeout_ms);
+
 namespace px {
 namespace carnot {
 namespace exec {
@@ -70,6 +79,11 @@ class AggNode : public ProcessingNode {
   AggNode() = default;
   virtual ~AggNode() = default;
 
+  // Sets the ids of the sources that feed this node. A windowed aggregate tracks a watermark for
+  // each of them, and only closes a window once all of them have moved past it, except for the
+  // sources that have finished or have been idle for --windowed_agg_idle_input_timeout_ms.
+  void SetInputSources(const std::vector<int64_t>& source_ids);
+
  protected:
   Status AggregateGroupByNone(ExecState* exec_state, const table_store::schema::RowBatch& rb);
   Status AggregateGroupByClause(ExecState* exec_state, const table_store::schema::RowBatch& rb);
@@ -85,6 +99,16 @@ class AggNode : public ProcessingNode {
  private:
   AggHashMap agg_hash_map_;
   bool HasNoGroups() const { return plan_node_->groups().empty(); }
+  // A partial aggregate (run on the PEMs) emits the serialized UDA states of each group in a single
+  // string column instead of finalizing them.
+  bool SerializesPartials() const {
+    return plan_node_->partial_agg() && !plan_node_->finalize_results();
+  }
+  // A finalize aggregate (run on Kelvin) merges the serialized UDA states produced by partial
+  // aggregates. The serialized states are always the last column of the input.
+  bool MergesPartials() const {
+    return plan_node_->finalize_results() && !plan_node_->partial_agg();
+  }
   // ReadyToEmitBatches returns true when the input stream has reached a point where output batches
   // can be emitted. In the windowed aggregate case, this happens whenever end of window (eow) is
   // reached. In the blocking aggregate case, this happens at eos only.
@@ -92,10 +116,31 @@ class AggNode : public ProcessingNode {
   // When we see a new window, we need to be able to clear the aggregate state.
   Status ClearAggState(ExecState* exec_state);
 
+  // Windowed aggregates whose plan sets a window group (the start of each window, e.g. the output
+  // of px.bin(time_, ...)) keep the state of each window separately. The watermark of each input
+  // source is the latest window start it has sent. Once the watermarks of all inputs are more than
+  // the allowed lateness past a window, that window is emitted and its state is released, without
+  // waiting for eow. Inputs that have sent eos, or no rows for a while (e.g. a PEM that has no
+  // rows for the table), don't hold back the others; rows they send for closed windows later on
+  // are dropped.
+  bool HasWindowColumn() const { return window_group_idx_ >= 0; }
+  int64_t WindowStart(const RowTuple* groups_rt) const {
+    return groups_rt->GetValue<types::Time64NSValue>(window_group_idx_).val;
+  }
+  // Emits the windows that start before closed_watermark_, after advancing it.
+  Status EmitClosedWindows(ExecState* exec_state);
+
   Status EvaluateSingleExpressionNoGroups(ExecState* exec_state, const UDAInfo& uda_info,
                                           plan::AggregateExpression* expr,
                                           const table_store::schema::RowBatch& rb);
   Status EvaluateAggHashValue(ExecState* exec_state, AggHashValue* val);
+  // Writes the finalized (or serialized, for partial aggregates) values of the UDAs into the
+  // value builders.
+  Status AppendUDAValues(const std::vector<UDAInfo>& udas,
+                         const std::vector<std::unique_ptr<arrow::ArrayBuilder>>& value_builders);
+  // Deserializes the UDA states that a partial aggregate serialized for one group, and merges them
+  // into the passed in UDAs.
+  Status MergeSerializedUDAs(std::string_view serialized, std::vector<UDAInfo>* udas);
   StatusOr<types::DataType> GetTypeOfDep(const plan::ScalarExpression& expr) const;
 
   // Store information about aggregate node from the query planner.
@@ -104,6 +149,27 @@ class AggNode : public ProcessingNode {
 
   std::unique_ptr<udf::FunctionContext> function_ctx_;
 
+  // The index of the group that holds the window start, or -1 if the aggregate isn't windowed by
+  // time.
+  int64_t window_group_idx_ = -1;
+  int64_t allowed_lateness_ns_ = 0;
+  struct InputWatermark {
+    explicit InputWatermark(std::chrono::steady_clock::time_point now) : last_row_time(now) {}
+    // Sources that haven't sent any rows yet are at the minimum value, which holds back every
+    // window until they are idle.
+    int64_t window_start = std::numeric_limits<int64_t>::min();
+    std::chrono::steady_clock::time_point last_row_time;
+  };
+  // The watermark of each input source.
+  absl::flat_hash_map<int64_t, InputWatermark> input_watermarks_;
+  // All windows that start before this have been emitted. Rows for those windows that arrive late
+  // are dropped.
+  int64_t closed_watermark_ = std::numeric_limits<int64_t>::min();
+  int64_t late_rows_dropped_ = 0;
+
+  // The index of the input column that holds the serialized UDA states when merging partials.
+  int64_t serialized_col_idx_ = -1;
+
   // Variables specific to GroupByNone Agg.
   std::vector<UDAInfo> udas_no_groups_;
   // END: Variables specific to GroupByNone Agg.
@@ -140,7 +206,7 @@ class AggNode : public ProcessingNode {
   Status HashRowBatch(ExecState* exec_state, const table_store::schema::RowBatch& rb);
   Status EvaluatePartialAggregates(ExecState* exec_state, size_t num_records);
   Status ResetGroupArgs();
-  Status ConvertAggHashMapToRowBatch(ExecState* exec_state,
+  Status ConvertAggHashMapToRowBatch(ExecState* exec_state, const AggHashMap& agg_hash_map,
                                      table_store::schema::RowBatch* output_rb);
 
   AggHashValue* CreateAggHashValue(ExecState* exec_state);
@@ -19,7 +19,9 @@
 #include "src/carnot/exec/agg_node.h"
 
 #include <algorithm>
+#include <string>
 
+#include <absl/strings/substitute.h>
 #include <google/protobuf/text_format.h>
 #include <gtest/gtest.h>
 #include <sole.hpp>
@@ -53,6 +55,19 @@ class MinSumUDA : public udf::UDA {
   types::Int64Value sum_ = 0;
 };
 
+// MinSumUDA with support for partial aggregates.
+class PartialMinSumUDA : public MinSumUDA {
+ public:
+  void Merge(udf::FunctionContext*, const PartialMinSumUDA& other) {
+    sum_ = sum_.val + other.sum_.val;
+  }
+  types::StringValue Serialize(udf::FunctionContext*) { return std::to_string(sum_.val); }
+  Status Deserialize(udf::FunctionContext*, const types::StringValue& data) {
+    sum_ = std::stoll(data);
+    return Status::OK();
+  }
+};
+
 constexpr char kBlockingNoGroupAgg[] = R"(
 op_type: AGGREGATE_OPERATOR
 agg_op {
@@ -183,6 +198,37 @@ agg_op {
   value_names: "value1"
 })";
 
+constexpr char kWindowedTimeGroupAgg[] = R"(
+op_type: AGGREGATE_OPERATOR
+agg_op {
+  windowed: true
+  window_group_idx {
+    value: 0
+  }
+  allowed_lateness_ns: $0
+  values {
+    name: "minsum"
+    args {
+      column {
+        node:0
+        index: 1
+      }
+    }
+    args {
+      column {
+        node:0
+        index: 1
+      }
+    }
+  }
+  groups {
+     node: 0
+     index: 0
+  }
+  group_names: "window"
+  value_names: "value1"
+})";
+
 constexpr char kSingleGroupNoValues[] = R"(
 op_type: AGGREGATE_OPERATOR
 agg_op {
@@ -193,6 +239,65 @@ agg_op {
   group_names: "g1"
 })";
 
+constexpr char kPartialAgg[] = R"(
+op_type: AGGREGATE_OPERATOR
+agg_op {
+  windowed: false
+  values {
+    name: "partial_minsum"
+    id: 1
+    args {
+      column {
+        node:0
+        index: 0
+      }
+    }
+    args {
+      column {
+        node:0
+        index: 1
+      }
+    }
+  }
+  $0
+  value_names: "value1"
+  partial_agg: true
+  finalize_results: false
+})";
+
+constexpr char kFinalizeAgg[] = R"(
+op_type: AGGREGATE_OPERATOR
+agg_op {
+  windowed: false
+  values {
+    name: "partial_minsum"
+    id: 1
+    args {
+      column {
+        node:0
+        index: 0
+      }
+    }
+    args {
+      column {
+        node:0
+        index: 1
+      }
+    }
+  }
+  $0
+  value_names: "value1"
+  partial_agg: false
+  finalize_results: true
+})";
+
+constexpr char kSingleGroup[] = R"(
+  groups {
+     node: 0
+     index: 0
+  }
+  group_names: "g1")";
+
 std::unique_ptr<ExecState> MakeTestExecState(udf::Registry* registry) {
   auto table_store = std::make_shared<table_store::TableStore>();
   return std::make_unique<ExecState>(registry, table_store, MockResultSinkStubGenerator,
@@ -210,10 +315,13 @@ class AggNodeTest : public ::testing::Test {
   AggNodeTest() {
     func_registry_ = std::make_unique<udf::Registry>("test");
     EXPECT_TRUE(func_registry_->Register<MinSumUDA>("minsum").ok());
+    EXPECT_TRUE(func_registry_->Register<PartialMinSumUDA>("partial_minsum").ok());
 
     exec_state_ = MakeTestExecState(func_registry_.get());
     EXPECT_OK(exec_state_->AddUDA(0, "minsum",
                                   std::vector<types::DataType>({types::INT64, types::INT64})));
+    EXPECT_OK(exec_state_->AddUDA(1, "partial_minsum",
+                                  std::vector<types::DataType>({types::INT64, types::INT64})));
   }
 
  protected:
@@ -450,6 +558,178 @@ TEST_F(AggNodeTest, single_group_windowed) {
       .Close();
 }
 
+TEST_F(AggNodeTest, windowed_emits_closed_windows) {
+  auto plan_node = PlanNodeFromPbtxt(absl::Substitute(kWindowedTimeGroupAgg, 0));
+  RowDescriptor input_rd({types::DataType::TIME64NS, types::DataType::INT64});
+
+  RowDescriptor output_rd({types::DataType::TIME64NS, types::DataType::INT64});
+
+  auto tester = exec::ExecNodeTester<AggNode, plan::AggregateOperator>(
+      *plan_node, output_rd, {input_rd}, exec_state_.get());
+
+  tester
+      // Window 10 closes window 0.
+      .ConsumeNext(RowBatchBuilder(input_rd, 3, /*eow*/ false, /*eos*/ false)
+                       .AddColumn<types::Time64NSValue>({0, 0, 10})
+                       .AddColumn<types::Int64Value>({1, 2, 3})
+                       .get(),
+                   0)
+      .ExpectRowBatch(RowBatchBuilder(output_rd, 1, false, false)
+                          .AddColumn<types::Time64NSValue>({0})
+                          .AddColumn<types::Int64Value>({3})
+                          .get(),
+                      false)
+      // The row for window 0 arrives after it was emitted and is dropped.
+      .ConsumeNext(RowBatchBuilder(input_rd, 3, /*eow*/ false, /*eos*/ false)
+                       .AddColumn<types::Time64NSValue>({0, 10, 20})
+                       .AddColumn<types::Int64Value>({5, 4, 6})
+                       .get(),
+                   0)
+      .ExpectRowBatch(RowBatchBuilder(output_rd, 1, false, false)
+                          .AddColumn<types::Time64NSValue>({10})
+                          .AddColumn<types::Int64Value>({7})
+                          .get(),
+                      false)
+      // The rest of the windows are emitted at eos.
+      .ConsumeNext(RowBatchBuilder(input_rd, 2, /*eow*/ true, /*eos*/ true)
+                       .AddColumn<types::Time64NSValue>({20, 30})
+                       .AddColumn<types::Int64Value>({1, 2})
+                       .get(),
+                   0)
+      .ExpectRowBatch(RowBatchBuilder(output_rd, 2, true, true)
+                          .AddColumn<types::Time64NSValue>({20, 30})
+                          .AddColumn<types::Int64Value>({7, 2})
+                          .get(),
+                      false)
+      .Close();
+}
+
+TEST_F(AggNodeTest, windowed_interleaved_out_of_order_inputs) {
+  auto plan_node = PlanNodeFromPbtxt(absl::Substitute(kWindowedTimeGroupAgg, 10));
+  RowDescriptor input_rd({types::DataType::TIME64NS, types::DataType::INT64});
+
+  RowDescriptor output_rd({types::DataType::TIME64NS, types::DataType::INT64});
+
+  auto tester = exec::ExecNodeTester<AggNode, plan::AggregateOperator>(
+      *plan_node, output_rd, {input_rd}, exec_state_.get());
+  tester.node()->SetInputSources({1, 2});
+
+  // Source 2 hasn't sent anything yet, so no window can close.
+  exec_state_->SetCurrentSource(1);
+  tester.ConsumeNext(RowBatchBuilder(input_rd, 3, /*eow*/ false, /*eos*/ false)
+                         .AddColumn<types::Time64NSValue>({0, 10, 20})
+                         .AddColumn<types::Int64Value>({1, 2, 3})
+                         .get(),
+                     0, 0);
+
+  // The slowest source is at window 10, which is within the allowed lateness of window 0.
+  exec_state_->SetCurrentSource(2);
+  tester.ConsumeNext(RowBatchBuilder(input_rd, 2, /*eow*/ false, /*eos*/ false)
+                         .AddColumn<types::Time64NSValue>({0, 10})
+                         .AddColumn<types::Int64Value>({4, 5})
+                         .get(),
+                     0, 0);
+
+  // The out of order row for window 0 is still accepted. Source 1 is now the slowest at window
+  // 20, which closes window 0.
+  tester
+      .ConsumeNext(RowBatchBuilder(input_rd, 2, /*eow*/ false, /*eos*/ false)
+                       .AddColumn<types::Time64NSValue>({30, 0})
+                       .AddColumn<types::Int64Value>({6, 7})
+                       .get(),
+                   0)
+      .ExpectRowBatch(RowBatchBuilder(output_rd, 1, false, false)
+                          .AddColumn<types::Time64NSValue>({0})
+                          .AddColumn<types::Int64Value>({12})
+                          .get(),
+                      false);
+
+  // The row for window 0 is too late now and is dropped. Source 2 is the slowest at window 30,
+  // which closes window 10.
+  exec_state_->SetCurrentSource(1);
+  tester
+      .ConsumeNext(RowBatchBuilder(input_rd, 3, /*eow*/ false, /*eos*/ false)
+                       .AddColumn<types::Time64NSValue>({10, 0, 40})
+                       .AddColumn<types::Int64Value>({8, 9, 10})
+                       .get(),
+                   0)
+      .ExpectRowBatch(RowBatchBuilder(output_rd, 1, false, false)
+                          .AddColumn<types::Time64NSValue>({10})
+                          .AddColumn<types::Int64Value>({15})
+                          .get(),
+                      false)
+      // The rest of the windows are emitted at eos.
+      .ConsumeNext(RowBatchBuilder(input_rd, 1, /*eow*/ true, /*eos*/ true)
+                       .AddColumn<types::Time64NSValue>({20})
+                       .AddColumn<types::Int64Value>({1})
+                       .get(),
+                   0)
+      .ExpectRowBatch(RowBatchBuilder(output_rd, 3, true, true)
+                          .AddColumn<types::Time64NSValue>({20, 30, 40})
+                          .AddColumn<types::Int64Value>({4, 6, 10})
+                          .get(),
+                      false)
+      .Close();
+}
+
+// Stirling pushes records out of order, e.g. records of connection trackers after newer ones. With
+// the lateness that the planner sets for streams (a delay of 10 plus the window width of 10), none
+// of the late rows are dropped.
+TEST_F(AggNodeTest, windowed_standing_agg_out_of_order_input) {
+  auto plan_node = PlanNodeFromPbtxt(absl::Substitute(kWindowedTimeGroupAgg, 20));
+  RowDescriptor input_rd({types::DataType::TIME64NS, types::DataType::INT64});
+  RowDescriptor output_rd({types::DataType::TIME64NS, types::DataType::INT64});
+
+  auto tester = exec::ExecNodeTester<AggNode, plan::AggregateOperator>(
+      *plan_node, output_rd, {input_rd}, exec_state_.get());
+  exec_state_->SetCurrentSource(1);
+  tester.node()->SetInputSources({1});
+
+  tester
+      .ConsumeNext(RowBatchBuilder(input_rd, 3, /*eow*/ false, /*eos*/ false)
+                       .AddColumn<types::Time64NSValue>({0, 0, 10})
+                       .AddColumn<types::Int64Value>({1, 2, 3})
+                       .get(),
+                   0, 0)
+      // The rows for windows 0 and 10 arrive after rows of the next windows.
+      .ConsumeNext(RowBatchBuilder(input_rd, 3, /*eow*/ false, /*eos*/ false)
+                       .AddColumn<types::Time64NSValue>({20, 0, 10})
+                       .AddColumn<types::Int64Value>({4, 5, 6})
+                       .get(),
+                   0, 0)
+      // Window 30 closes window 0, which includes its late row.
+      .ConsumeNext(RowBatchBuilder(input_rd, 3, /*eow*/ false, /*eos*/ false)
+                       .AddColumn<types::Time64NSValue>({30, 10, 20})
+                       .AddColumn<types::Int64Value>({7, 8, 9})
+                       .get(),
+                   0)
+      .ExpectRowBatch(RowBatchBuilder(output_rd, 1, false, false)
+                          .AddColumn<types::Time64NSValue>({0})
+                          .AddColumn<types::Int64Value>({8})
+                          .get(),
+                      false)
+      .ConsumeNext(RowBatchBuilder(input_rd, 1, /*eow*/ true, /*eos*/ true)
+                       .AddColumn<types::Time64NSValue>({30})
+                       .AddColumn<types::Int64Value>({10})
+                       .get(),
+                   0)
+      .ExpectRowBatch(RowBatchBuilder(output_rd, 3, true, true)
+                          .AddColumn<types::Time64NSValue>({10, 20, 30})
+                          .AddColumn<types::Int64Value>({17, 13, 17})
+                          .get(),
+                      false)
+      .Close();
+}
+
+TEST_F(AggNodeTest, windowed_window_group_must_be_time) {
+  auto plan_node = PlanNodeFromPbtxt(absl::Substitute(kWindowedTimeGroupAgg, 0));
+  RowDescriptor input_rd({types::DataType::INT64, types::DataType::INT64});
+  RowDescriptor output_rd({types::DataType::INT64, types::DataType::INT64});
+
+  AggNode node;
+  EXPECT_NOT_OK(node.Init(*plan_node, output_rd, {input_rd}));
+}
+
 TEST_F(AggNodeTest, no_aggregate_expressions) {
   auto plan_node = PlanNodeFromPbtxt(kSingleGroupNoValues);
   RowDescriptor input_rd({types::DataType::INT64, types::DataType::INT64});
@@ -476,6 +756,101 @@ TEST_F(AggNodeTest, no_aggregate_expressions) {
       .Close();
 }
 
+TEST_F(AggNodeTest, partial_and_finalize_no_groups) {
+  auto partial_plan_node = PlanNodeFromPbtxt(absl::Substitute(kPartialAgg, ""));
+  auto finalize_plan_node = PlanNodeFromPbtxt(absl::Substitute(kFinalizeAgg, ""));
+  RowDescriptor input_rd({types::DataType::INT64, types::DataType::INT64});
+  RowDescriptor partial_rd({types::DataType::STRING});
+  RowDescriptor output_rd({types::DataType::INT64});
+
+  // Run two partial aggregates, as if they ran on two different agents.
+  auto partial_tester1 = exec::ExecNodeTester<AggNode, plan::AggregateOperator>(
+      *partial_plan_node, partial_rd, {input_rd}, exec_state_.get());
+  partial_tester1.ConsumeNext(RowBatchBuilder(input_rd, 4, /*eow*/ true, /*eos*/ true)
+                                  .AddColumn<types::Int64Value>({1, 2, 3, 4})
+                                  .AddColumn<types::Int64Value>({2, 5, 6, 8})
+                                  .get(),
+                              0);
+  auto partial_rb1 = partial_tester1.PopRowBatch();
+  partial_rb1->set_eow(false);
+  partial_rb1->set_eos(false);
+
+  auto partial_tester2 = exec::ExecNodeTester<AggNode, plan::AggregateOperator>(
+      *partial_plan_node, partial_rd, {input_rd}, exec_state_.get());
+  partial_tester2.ConsumeNext(RowBatchBuilder(input_rd, 4, /*eow*/ true, /*eos*/ true)
+                                  .AddColumn<types::Int64Value>({5, 6, 3, 4})
+                                  .AddColumn<types::Int64Value>({1, 5, 3, 8})
+                                  .get(),
+                              0);
+  auto partial_rb2 = partial_tester2.PopRowBatch();
+
+  auto tester = exec::ExecNodeTester<AggNode, plan::AggregateOperator>(
+      *finalize_plan_node, output_rd, {partial_rd}, exec_state_.get());
+  tester.ConsumeNext(*partial_rb1, 0, 0)
+      .ConsumeNext(*partial_rb2, 0)
+      .ExpectRowBatch(RowBatchBuilder(output_rd, 1, true, true)
+                          .AddColumn<types::Int64Value>({Int64Value(23)})
+                          .get(),
+                      false)
+      .Close();
+}
+
+TEST_F(AggNodeTest, partial_and_finalize_single_group) {
+  auto partial_plan_node = PlanNodeFromPbtxt(absl::Substitute(kPartialAgg, kSingleGroup));
+  auto finalize_plan_node = PlanNodeFromPbtxt(absl::Substitute(kFinalizeAgg, kSingleGroup));
+  RowDescriptor input_rd({types::DataType::INT64, types::DataType::INT64});
+  RowDescriptor partial_rd({types::DataType::INT64, types::DataType::STRING});
+  RowDescriptor output_rd({types::DataType::INT64, types::DataType::INT64});
+
+  auto partial_tester1 = exec::ExecNodeTester<AggNode, plan::AggregateOperator>(
+      *partial_plan_node, partial_rd, {input_rd}, exec_state_.get());
+  partial_tester1.ConsumeNext(RowBatchBuilder(input_rd, 4, /*eow*/ true, /*eos*/ true)
+                                  .AddColumn<types::Int64Value>({1, 1, 2, 2})
+                                  .AddColumn<types::Int64Value>({2, 3, 3, 1})
+                                  .get(),
+                              0);
+  auto partial_rb1 = partial_tester1.PopRowBatch();
+  partial_rb1->set_eow(false);
+  partial_rb1->set_eos(false);
+
+  auto partial_tester2 = exec::ExecNodeTester<AggNode, plan::AggregateOperator>(
+      *partial_plan_node, partial_rd, {input_rd}, exec_state_.get());
+  partial_tester2.ConsumeNext(RowBatchBuilder(input_rd, 3, /*eow*/ true, /*eos*/ true)
+                                  .AddColumn<types::Int64Value>({1, 2, 3})
+                                  .AddColumn<types::Int64Value>({5, 1, 3})
+                                  .get(),
+                              0);
+  auto partial_rb2 = partial_tester2.PopRowBatch();
+
+  auto tester = exec::ExecNodeTester<AggNode, plan::AggregateOperator>(
+      *finalize_plan_node, output_rd, {partial_rd}, exec_state_.get());
+  tester.ConsumeNext(*partial_rb1, 0, 0)
+      .ConsumeNext(*partial_rb2, 0)
+      .ExpectRowBatch(RowBatchBuilder(output_rd, 3, true, true)
+                          .AddColumn<types::Int64Value>({1, 2, 3})
+                          .AddColumn<types::Int64Value>({3, 4, 3})
+                          .get(),
+                      false)
+      .Close();
+}
+
+TEST_F(AggNodeTest, partial_agg_requires_partial_uda) {
+  planpb::Operator op_pb;
+  ASSERT_TRUE(
+      google::protobuf::TextFormat::MergeFromString(absl::Substitute(kPartialAgg, ""), &op_pb));
+  // minsum doesn't implement Serialize/Deserialize.
+  op_pb.mutable_agg_op()->mutable_values(0)->set_name("minsum");
+  op_pb.mutable_agg_op()->mutable_values(0)->set_id(0);
+  auto plan_node = plan::AggregateOperator::FromProto(op_pb, 1);
+  RowDescriptor input_rd({types::DataType::INT64, types::DataType::INT64});
+  RowDescriptor partial_rd({types::DataType::STRING});
+
+  AggNode node;
+  EXPECT_OK(node.Init(*plan_node, partial_rd, {input_rd}));
+  EXPECT_OK(node.Prepare(exec_state_.get()));
+  EXPECT_NOT_OK(node.Open(exec_state_.get()));
+}
+
 }  // namespace exec
 }  // namespace carnot
 }  // namespace px
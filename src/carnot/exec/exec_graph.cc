@@ -61,7 +61,8 @@ Status ExecutionGraph::Init(std::shared_ptr<table_store::schema::Schema> schema,
 
   std::unordered_map<int64_t, ExecNode*> nodes;
   std::unordered_map<int64_t, RowDescriptor> descriptors;
-  return plan::PlanFragmentWalker()
+  std::vector<int64_t> agg_nodes;
+  auto s = plan::PlanFragmentWalker()
       .OnMap([&](auto& node) {
         return OnOperatorImpl<plan::MapOperator, MapNode>(node, &descriptors);
       })
@@ -70,6 +71,7 @@ Status ExecutionGraph::Init(std::shared_ptr<table_store::schema::Schema> schema,
         return OnOperatorImpl<plan::MemorySinkOperator, MemorySinkNode>(node, &descriptors);
       })
       .OnAggregate([&](auto& node) {
+        agg_nodes.push_back(node.id());
         return OnOperatorImpl<plan::AggregateOperator, AggNode>(node, &descriptors);
       })
       .OnMemorySource([&](auto& node) {
@@ -106,6 +108,33 @@ Status ExecutionGraph::Init(std::shared_ptr<table_store::schema::Schema> schema,
         return OnOperatorImpl<plan::EmptySourceOperator, EmptySourceNode>(node, &descriptors);
       })
       .Walk(pf_);
+  PL_RETURN_IF_ERROR(s);
+
+  // Windowed aggregates track a watermark for each source that feeds them.
+  for (auto agg_id : agg_nodes) {
+    static_cast<AggNode*>(nodes_[agg_id])->SetInputSources(UpstreamSources(agg_id));
+  }
+  return Status::OK();
+}
+
+std::vector<int64_t> ExecutionGraph::UpstreamSources(int64_t node_id) const {
+  std::vector<int64_t> upstream_sources;
+  absl::flat_hash_set<int64_t> visited;
+  std::vector<int64_t> to_visit{node_id};
+  while (!to_visit.empty()) {
+    auto id = to_visit.back();
+    to_visit.pop_back();
+    if (!visited.insert(id).second) {
+      continue;
+    }
+    auto parents = pf_->dag().ParentsOf(id);
+    if (parents.empty()) {
+      upstream_sources.push_back(id);
+    }
+    to_visit.insert(to_visit.end(), parents.begin(), parents.end());
+  }
+  std::sort(upstream_sources.begin(), upstream_sources.end());
+  return upstream_sources;
 }
 
 bool ExecutionGraph::YieldWithTimeout() {
@@ -198,6 +227,7 @@ Status ExecutionGraph::ExecuteSources() {
               "proceeding with the rest of the query. Message: $0",
               s.msg());
           PL_RETURN_IF_ERROR(source->SendEndOfStream(exec_state_));
+          exec_state_->MarkSourceFinished(source_to_id[source]);
           completed_sources_execute_loop.insert(source);
           continue;
         }
@@ -215,6 +245,7 @@ Status ExecutionGraph::ExecuteSources() {
       // keep_running will be set to false when a downstream limit for this particular
       // source (set in exec_state) has been reached.
       if (!source->HasBatchesRemaining() || !exec_state_->keep_running()) {
+        exec_state_->MarkSourceFinished(source_to_id[source]);
         completed_sources_execute_loop.insert(source);
         break;
       }
@@ -265,6 +296,7 @@ Status ExecutionGraph::ExecuteSources() {
                 "proceeding with the rest of the query. Message: $0",
                 s.msg());
             PL_RETURN_IF_ERROR(source->SendEndOfStream(exec_state_));
+            exec_state_->MarkSourceFinished(source_to_id[source]);
             completed_sources_wait_loop.insert(source);
             continue;
           }
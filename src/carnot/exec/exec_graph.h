@@ -210,6 +210,9 @@ class ExecutionGraph {
 
   Status ExecuteSources();
 
+  // Returns the ids of the sources that (transitively) feed the given node.
+  std::vector<int64_t> UpstreamSources(int64_t node_id) const;
+
   ExecState* exec_state_;
   ObjectPool pool_{"exec_graph_pool"};
   std::shared_ptr<table_store::schema::Schema> schema_;
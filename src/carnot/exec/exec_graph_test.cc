@@ -20,6 +20,7 @@
 
 #include <arrow/array.h>
 #include <arrow/memory_pool.h>
+#include <map>
 #include <memory>
 #include <string>
 #include <tuple>
@@ -29,6 +30,7 @@
 #include <gtest/gtest.h>
 #include <sole.hpp>
 
+#include "src/carnot/exec/agg_node.h"
 #include "src/carnot/exec/grpc_source_node.h"
 #include "src/carnot/exec/test_utils.h"
 #include "src/carnot/plan/plan_fragment.h"
@@ -66,6 +68,16 @@ class MultiplyUDF : public udf::ScalarUDF {
   }
 };
 
+class SumUDA : public udf::UDA {
+ public:
+  void Update(udf::FunctionContext*, types::Int64Value arg) { sum_ = sum_.val + arg.val; }
+  void Merge(udf::FunctionContext*, const SumUDA& other) { sum_ = sum_.val + other.sum_.val; }
+  types::Int64Value Finalize(udf::FunctionContext*) { return sum_; }
+
+ protected:
+  types::Int64Value sum_ = 0;
+};
+
 class BaseExecGraphTest : public ::testing::Test {
  protected:
   void SetUpExecState() {
@@ -718,6 +730,7 @@ class GRPCExecGraphTest : public ::testing::Test {
     func_registry_ = std::make_unique<udf::Registry>("test_registry");
     func_registry_->RegisterOrDie<AddUDF>("add");
     func_registry_->RegisterOrDie<MultiplyUDF>("multiply");
+    func_registry_->RegisterOrDie<SumUDA>("sum");
 
     auto table_store = std::make_shared<table_store::TableStore>();
     exec_state_ =
@@ -887,6 +900,270 @@ TEST_F(GRPCExecGraphTest, infinite_source_and_error_source) {
   EXPECT_NOT_OK(s);
 }
 
+// Two GRPC sources, like the results of two PEMs, are unioned into a windowed aggregate.
+constexpr char kWindowedAggTwoGRPCSourcesPlanFragment[] = R"(
+  id: 1,
+  dag {
+    nodes {
+      id: 1
+      sorted_children: 3
+    }
+    nodes {
+      id: 2
+      sorted_children: 3
+    }
+    nodes {
+      id: 3
+      sorted_children: 4
+      sorted_parents: 1
+      sorted_parents: 2
+    }
+    nodes {
+      id: 4
+      sorted_children: 5
+      sorted_parents: 3
+    }
+    nodes {
+      id: 5
+      sorted_parents: 4
+    }
+  }
+  nodes {
+    id: 1
+    op {
+      op_type: GRPC_SOURCE_OPERATOR
+      grpc_source_op {
+        column_types: TIME64NS
+        column_types: INT64
+        column_names: "window"
+        column_names: "value"
+      }
+    }
+  }
+  nodes {
+    id: 2
+    op {
+      op_type: GRPC_SOURCE_OPERATOR
+      grpc_source_op {
+        column_types: TIME64NS
+        column_types: INT64
+        column_names: "window"
+        column_names: "value"
+      }
+    }
+  }
+  nodes {
+    id: 3
+    op {
+      op_type: UNION_OPERATOR
+      union_op {
+        column_names: "window"
+        column_names: "value"
+        column_mappings {
+          column_indexes: 0
+          column_indexes: 1
+        }
+        column_mappings {
+          column_indexes: 0
+          column_indexes: 1
+        }
+      }
+    }
+  }
+  nodes {
+    id: 4
+    op {
+      op_type: AGGREGATE_OPERATOR
+      agg_op {
+        windowed: true
+        window_group_idx {
+          value: 0
+        }
+        values {
+          name: "sum"
+          args {
+            column {
+              node: 3
+              index: 1
+            }
+          }
+        }
+        groups {
+          node: 3
+          index: 0
+        }
+        group_names: "window"
+        value_names: "sum"
+      }
+    }
+  }
+  nodes {
+    id: 5
+    op {
+      op_type: MEMORY_SINK_OPERATOR
+      mem_sink_op {
+        name: "output"
+        column_types: TIME64NS
+        column_types: INT64
+        column_names: "window"
+        column_names: "sum"
+      }
+    }
+  }
+)";
+
+TEST_F(GRPCExecGraphTest, windowed_agg_two_grpc_sources) {
+  planpb::PlanFragment pf_pb;
+  ASSERT_TRUE(TextFormat::MergeFromString(kWindowedAggTwoGRPCSourcesPlanFragment, &pf_pb));
+  auto plan_fragment = std::make_shared<plan::PlanFragment>(1);
+  ASSERT_OK(plan_fragment->Init(pf_pb));
+  ASSERT_OK(exec_state_->AddUDA(0, "sum", std::vector<types::DataType>({types::INT64})));
+
+  ExecutionGraph e{std::chrono::milliseconds(0), std::chrono::milliseconds(0)};
+  ASSERT_OK(e.Init(schema_, plan_state_.get(), exec_state_.get(), plan_fragment.get(),
+                   /* collect_exec_node_stats */ false));
+
+  RowDescriptor input_rd({types::DataType::TIME64NS, types::DataType::INT64});
+  // The first source is ahead of the second one. None of the rows of the second source may be
+  // dropped, no matter how the execution interleaves the two sources.
+  std::vector<table_store::schema::RowBatch> src1_batches;
+  src1_batches.push_back(RowBatchBuilder(input_rd, 3, /*eow*/ false, /*eos*/ false)
+                             .AddColumn<types::Time64NSValue>({0, 0, 10})
+                             .AddColumn<types::Int64Value>({1, 2, 3})
+                             .get());
+  src1_batches.push_back(RowBatchBuilder(input_rd, 2, /*eow*/ false, /*eos*/ false)
+                             .AddColumn<types::Time64NSValue>({20, 30})
+                             .AddColumn<types::Int64Value>({4, 5})
+                             .get());
+  src1_batches.push_back(RowBatchBuilder(input_rd, 1, /*eow*/ true, /*eos*/ true)
+                             .AddColumn<types::Time64NSValue>({40})
+                             .AddColumn<types::Int64Value>({6})
+                             .get());
+  std::vector<table_store::schema::RowBatch> src2_batches;
+  src2_batches.push_back(RowBatchBuilder(input_rd, 1, /*eow*/ false, /*eos*/ false)
+                             .AddColumn<types::Time64NSValue>({0})
+                             .AddColumn<types::Int64Value>({10})
+                             .get());
+  src2_batches.push_back(RowBatchBuilder(input_rd, 2, /*eow*/ false, /*eos*/ false)
+                             .AddColumn<types::Time64NSValue>({10, 20})
+                             .AddColumn<types::Int64Value>({20, 30})
+                             .get());
+  src2_batches.push_back(RowBatchBuilder(input_rd, 1, /*eow*/ true, /*eos*/ true)
+                             .AddColumn<types::Time64NSValue>({30})
+                             .AddColumn<types::Int64Value>({40})
+                             .get());
+  auto enqueue = [&](int64_t src_id, const std::vector<table_store::schema::RowBatch>& batches) {
+    auto grpc_src = static_cast<GRPCSourceNode*>(e.node(src_id).ConsumeValueOrDie());
+    grpc_src->set_upstream_initiated_connection();
+    for (const auto& rb : batches) {
+      auto req = std::make_unique<carnotpb::TransferResultChunkRequest>();
+      EXPECT_OK(rb.ToProto(req->mutable_query_result()->mutable_row_batch()));
+      EXPECT_OK(grpc_src->EnqueueRowBatch(std::move(req)));
+    }
+    grpc_src->set_upstream_closed_connection();
+  };
+  enqueue(1, src1_batches);
+  enqueue(2, src2_batches);
+
+  ASSERT_OK(e.Execute());
+
+  auto output_table = exec_state_->table_store()->GetTable("output");
+  std::map<int64_t, int64_t> window_sums;
+  for (int64_t i = 0; i < output_table->NumBatches(); ++i) {
+    auto rb =
+        output_table->GetRowBatch(i, std::vector<int64_t>({0, 1}), arrow::default_memory_pool())
+            .ConsumeValueOrDie();
+    for (int64_t row = 0; row < rb->num_rows(); ++row) {
+      auto window = types::GetValueFromArrowArray<types::TIME64NS>(rb->ColumnAt(0).get(), row);
+      auto sum = types::GetValueFromArrowArray<types::INT64>(rb->ColumnAt(1).get(), row);
+      // Each window is emitted exactly once.
+      EXPECT_TRUE(window_sums.emplace(window, sum).second) << window;
+    }
+  }
+  EXPECT_EQ(window_sums,
+            (std::map<int64_t, int64_t>{{0, 13}, {10, 23}, {20, 34}, {30, 45}, {40, 6}}));
+}
+
+TEST_F(GRPCExecGraphTest, windowed_agg_grpc_source_without_rows) {
+  // The second source counts as idle right away.
+  const int64_t orig_idle_timeout_ms = FLAGS_windowed_agg_idle_input_timeout_ms;
+  FLAGS_windowed_agg_idle_input_timeout_ms = 0;
+
+  planpb::PlanFragment pf_pb;
+  ASSERT_TRUE(TextFormat::MergeFromString(kWindowedAggTwoGRPCSourcesPlanFragment, &pf_pb));
+  auto plan_fragment = std::make_shared<plan::PlanFragment>(1);
+  ASSERT_OK(plan_fragment->Init(pf_pb));
+  ASSERT_OK(exec_state_->AddUDA(0, "sum", std::vector<types::DataType>({types::INT64})));
+
+  ExecutionGraph e{std::chrono::milliseconds(0), std::chrono::milliseconds(0)};
+  ASSERT_OK(e.Init(schema_, plan_state_.get(), exec_state_.get(), plan_fragment.get(),
+                   /* collect_exec_node_stats */ false));
+
+  RowDescriptor input_rd({types::DataType::TIME64NS, types::DataType::INT64});
+  std::vector<table_store::schema::RowBatch> src1_batches;
+  src1_batches.push_back(RowBatchBuilder(input_rd, 3, /*eow*/ false, /*eos*/ false)
+                             .AddColumn<types::Time64NSValue>({0, 0, 10})
+                             .AddColumn<types::Int64Value>({1, 2, 3})
+                             .get());
+  src1_batches.push_back(RowBatchBuilder(input_rd, 2, /*eow*/ false, /*eos*/ false)
+                             .AddColumn<types::Time64NSValue>({20, 30})
+                             .AddColumn<types::Int64Value>({4, 5})
+                             .get());
+  src1_batches.push_back(RowBatchBuilder(input_rd, 1, /*eow*/ true, /*eos*/ true)
+                             .AddColumn<types::Time64NSValue>({40})
+                             .AddColumn<types::Int64Value>({6})
+                             .get());
+  // The second source, like a PEM without any rows for the table, only ends the stream. Whether
+  // that is executed before or after the batches of the first source, it must not hold back the
+  // windows of the first source.
+  std::vector<table_store::schema::RowBatch> src2_batches;
+  src2_batches.push_back(RowBatchBuilder(input_rd, 0, /*eow*/ true, /*eos*/ true)
+                             .AddColumn<types::Time64NSValue>({})
+                             .AddColumn<types::Int64Value>({})
+                             .get());
+  auto enqueue = [&](int64_t src_id, const std::vector<table_store::schema::RowBatch>& batches) {
+    auto grpc_src = static_cast<GRPCSourceNode*>(e.node(src_id).ConsumeValueOrDie());
+    grpc_src->set_upstream_initiated_connection();
+    for (const auto& rb : batches) {
+      auto req = std::make_unique<carnotpb::TransferResultChunkRequest>();
+      EXPECT_OK(rb.ToProto(req->mutable_query_result()->mutable_row_batch()));
+      EXPECT_OK(grpc_src->EnqueueRowBatch(std::move(req)));
+    }
+    grpc_src->set_upstream_closed_connection();
+  };
+  enqueue(1, src1_batches);
+  enqueue(2, src2_batches);
+
+  ASSERT_OK(e.Execute());
+  FLAGS_windowed_agg_idle_input_timeout_ms = orig_idle_timeout_ms;
+
+  auto output_table = exec_state_->table_store()->GetTable("output");
+  std::vector<std::map<int64_t, int64_t>> batch_window_sums;
+  for (int64_t i = 0; i < output_table->NumBatches(); ++i) {
+    auto rb =
+        output_table->GetRowBatch(i, std::vector<int64_t>({0, 1}), arrow::default_memory_pool())
+            .ConsumeValueOrDie();
+    if (rb->num_rows() == 0) {
+      continue;
+    }
+    auto& window_sums = batch_window_sums.emplace_back();
+    for (int64_t row = 0; row < rb->num_rows(); ++row) {
+      auto window = types::GetValueFromArrowArray<types::TIME64NS>(rb->ColumnAt(0).get(), row);
+      auto sum = types::GetValueFromArrowArray<types::INT64>(rb->ColumnAt(1).get(), row);
+      window_sums.emplace(window, sum);
+    }
+  }
+  // The windows are emitted as soon as the first source moves past them.
+  ASSERT_GE(batch_window_sums.size(), 3UL);
+  EXPECT_EQ(batch_window_sums[0], (std::map<int64_t, int64_t>{{0, 3}}));
+  EXPECT_EQ(batch_window_sums[1], (std::map<int64_t, int64_t>{{10, 3}, {20, 4}}));
+  std::map<int64_t, int64_t> rest;
+  for (size_t i = 2; i < batch_window_sums.size(); ++i) {
+    rest.insert(batch_window_sums[i].begin(), batch_window_sums[i].end());
+  }
+  EXPECT_EQ(rest, (std::map<int64_t, int64_t>{{30, 5}, {40, 6}}));
+}
+
 }  // namespace exec
 }  // namespace carnot
 }  // namespace px
@@ -26,6 +26,7 @@
 #include <utility>
 #include <vector>
 
+#include <absl/container/flat_hash_set.h>
 #include <sole.hpp>
 
 #include "src/carnot/carnotpb/carnot.pb.h"
@@ -138,6 +139,12 @@ class ExecState {
     return source_id_to_keep_running_map_[current_source_];
   }
 
+  // The source whose row batches are currently being pushed through the graph.
+  int64_t current_source() const {
+    DCHECK(current_source_set_);
+    return current_source_;
+  }
+
   void SetCurrentSource(int64_t source_id) {
     current_source_ = source_id;
     current_source_set_ = true;
@@ -147,6 +154,10 @@ class ExecState {
     }
   }
 
+  // Records that the source has sent eos, so nodes downstream of it no longer wait on it.
+  void MarkSourceFinished(int64_t source_id) { finished_sources_.insert(source_id); }
+  bool SourceFinished(int64_t source_id) const { return finished_sources_.contains(source_id); }
+
   void set_metadata_state(std::shared_ptr<const md::AgentMetadataState> metadata_state) {
     metadata_state_ = metadata_state;
   }
@@ -178,6 +189,7 @@ class ExecState {
   int64_t current_source_ = 0;
   bool current_source_set_ = false;
   std::map<int64_t, bool> source_id_to_keep_running_map_;
+  absl::flat_hash_set<int64_t> finished_sources_;
 
   std::vector<std::unique_ptr<carnotpb::ResultSinkService::StubInterface>> result_sink_stubs_pool_;
   // Mapping of remote address to stub that serves that address.
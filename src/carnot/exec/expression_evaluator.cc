@@ -144,6 +144,54 @@ Status ScalarExpressionEvaluator::Evaluate(ExecState* exec_state, const RowBatch
   }
   return Status::OK();
 }
+Status ScalarExpressionEvaluator::OpenUDFs(ExecState* exec_state) {
+  for (const auto& expression : expressions_) {
+    PL_RETURN_IF_ERROR(CreateUDFs(exec_state, *expression));
+  }
+  return Status::OK();
+}
+
+Status ScalarExpressionEvaluator::CreateUDFs(ExecState* exec_state,
+                                             const plan::ScalarExpression& expr) {
+  for (const auto* dep : expr.Deps()) {
+    PL_RETURN_IF_ERROR(CreateUDFs(exec_state, *dep));
+  }
+  if (expr.ExpressionType() != plan::Expression::kFunc) {
+    return Status::OK();
+  }
+  const auto& fn = static_cast<const plan::ScalarFunc&>(expr);
+  auto def = exec_state->GetScalarUDFDefinition(fn.udf_id());
+  auto udf = def->Make();
+  PL_RETURN_IF_ERROR(BindConstantArgs(exec_state, fn, def, udf.get()));
+  func_to_udf_map_[&fn] = std::move(udf);
+  return Status::OK();
+}
+
+Status ScalarExpressionEvaluator::BindConstantArgs(ExecState* exec_state,
+                                                   const plan::ScalarFunc& fn,
+                                                   udf::ScalarUDFDefinition* def,
+                                                   udf::ScalarUDF* udf) {
+  const auto& init_arguments = def->init_arguments();
+  const auto& arg_deps = fn.arg_deps();
+  if (init_arguments.empty() || init_arguments.size() > arg_deps.size()) {
+    return Status::OK();
+  }
+
+  // Init binds the trailing arguments of Exec, which all need to be constants.
+  size_t offset = arg_deps.size() - init_arguments.size();
+  std::vector<types::SharedColumnWrapper> values;
+  std::vector<const BaseValueType*> args;
+  for (size_t i = offset; i < arg_deps.size(); ++i) {
+    if (arg_deps[i]->ExpressionType() != plan::Expression::kConstant) {
+      return Status::OK();
+    }
+    const auto& val = static_cast<const plan::ScalarValue&>(*arg_deps[i]);
+    values.push_back(EvalScalarToColumnWrapper(exec_state, val, 1));
+    args.push_back(values.back()->UnsafeRawData());
+  }
+  return def->ExecInit(udf, function_ctx_, args);
+}
+
 std::string ScalarExpressionEvaluator::DebugString() {
   std::vector<std::string> debug_strs(expressions_.size());
   std::transform(begin(expressions_), end(expressions_), begin(debug_strs),
@@ -152,11 +200,7 @@ std::string ScalarExpressionEvaluator::DebugString() {
 }
 
 Status VectorNativeScalarExpressionEvaluator::Open(ExecState* exec_state) {
-  for (const auto& kv : exec_state->id_to_scalar_udf_map()) {
-    auto udf = kv.second->Make();
-    id_to_udf_map_[kv.first] = std::move(udf);
-  }
-  return Status::OK();
+  return OpenUDFs(exec_state);
 }
 
 Status VectorNativeScalarExpressionEvaluator::Close(ExecState*) {
@@ -172,6 +216,11 @@ VectorNativeScalarExpressionEvaluator::EvaluateSingleExpression(
 
   size_t num_rows = input.num_rows();
 
+  if (expr.ExpressionType() == plan::Expression::kConstant) {
+    return EvalScalarToColumnWrapper(exec_state, static_cast<const plan::ScalarValue&>(expr),
+                                     num_rows);
+  }
+
   // Path for scalar funcs an their dependencies to get evaluated.
   // The Arrow arrays are converted to type erased column wrappers
   // and then evaluated.
@@ -180,7 +229,8 @@ VectorNativeScalarExpressionEvaluator::EvaluateSingleExpression(
       [&](const plan::ScalarValue& val,
           const std::vector<types::SharedColumnWrapper>& children) -> types::SharedColumnWrapper {
         DCHECK_EQ(children.size(), 0ULL);
-        return EvalScalarToColumnWrapper(exec_state, val, num_rows);
+        // Constant arguments are broadcast by the UDF wrappers, so only a single value is needed.
+        return EvalScalarToColumnWrapper(exec_state, val, 1);
       });
 
   walker.OnColumn(
@@ -200,7 +250,7 @@ VectorNativeScalarExpressionEvaluator::EvaluateSingleExpression(
         }
 
         auto def = exec_state->GetScalarUDFDefinition(fn.udf_id());
-        auto udf = id_to_udf_map_[fn.udf_id()].get();
+        auto udf = func_to_udf_map_[&fn].get();
 
         std::vector<const types::ColumnWrapper*> raw_children;
         raw_children.reserve(children.size());
@@ -251,11 +301,7 @@ Status VectorNativeScalarExpressionEvaluator::EvaluateSingleExpression(
 }
 
 Status ArrowNativeScalarExpressionEvaluator::Open(ExecState* exec_state) {
-  for (const auto& kv : exec_state->id_to_scalar_udf_map()) {
-    auto udf = kv.second->Make();
-    id_to_udf_map_[kv.first] = std::move(udf);
-  }
-  return Status::OK();
+  return OpenUDFs(exec_state);
 }
 Status ArrowNativeScalarExpressionEvaluator::Close(ExecState*) {
   // Nothing here yet.
@@ -266,12 +312,22 @@ Status exec::ArrowNativeScalarExpressionEvaluator::EvaluateSingleExpression(
     exec::ExecState* exec_state, const RowBatch& input, const plan::ScalarExpression& expr,
     RowBatch* output) {
   size_t num_rows = input.num_rows();
+
+  // Fast path for just having a constant.
+  if (expr.ExpressionType() == plan::Expression::kConstant) {
+    auto arr =
+        EvalScalarToArrow(exec_state, static_cast<const plan::ScalarValue&>(expr), num_rows);
+    PL_RETURN_IF_ERROR(output->AddColumn(arr));
+    return Status::OK();
+  }
+
   plan::ExpressionWalker<std::shared_ptr<arrow::Array>> walker;
   walker.OnScalarValue(
       [&](const plan::ScalarValue& val, const std::vector<std::shared_ptr<arrow::Array>>& children)
           -> std::shared_ptr<arrow::Array> {
         DCHECK_EQ(children.size(), 0ULL);
-        return EvalScalarToArrow(exec_state, val, num_rows);
+        // Constant arguments are broadcast by the UDF wrappers, so only a single value is needed.
+        return EvalScalarToArrow(exec_state, val, 1);
       });
 
   walker.OnColumn(
@@ -291,7 +347,7 @@ Status exec::ArrowNativeScalarExpressionEvaluator::EvaluateSingleExpression(
         }
 
         auto def = exec_state->GetScalarUDFDefinition(fn.udf_id());
-        auto udf = id_to_udf_map_[fn.udf_id()].get();
+        auto udf = func_to_udf_map_[&fn].get();
 
         auto output = MakeArrowBuilder(def->exec_return_type(), arrow::default_memory_pool());
 
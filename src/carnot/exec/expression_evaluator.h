@@ -26,6 +26,8 @@
 #include <utility>
 #include <vector>
 
+#include <absl/container/flat_hash_map.h>
+
 #include "src/carnot/exec/exec_state.h"
 #include "src/carnot/plan/scalar_expression.h"
 #include "src/carnot/udf/base.h"
@@ -121,9 +123,23 @@ class ScalarExpressionEvaluator : public ExpressionEvaluator {
                                           const table_store::schema::RowBatch& input,
                                           const plan::ScalarExpression& expr,
                                           table_store::schema::RowBatch* output) = 0;
+
+  /**
+   * Creates a UDF instance for every scalar func in expressions_. Constant arguments are
+   * bound to the instances of UDFs that support it, see udf::ScalarUDF.
+   */
+  Status OpenUDFs(ExecState* exec_state);
+
   plan::ConstScalarExpressionVector expressions_;
   udf::FunctionContext* function_ctx_ = nullptr;
-  std::map<int64_t, std::unique_ptr<udf::ScalarUDF>> id_to_udf_map_;
+  // UDF instances are created per scalar func (rather than per UDF id), since the constant
+  // arguments bound to an instance differ between call sites.
+  absl::flat_hash_map<const plan::ScalarFunc*, std::unique_ptr<udf::ScalarUDF>> func_to_udf_map_;
+
+ private:
+  Status CreateUDFs(ExecState* exec_state, const plan::ScalarExpression& expr);
+  Status BindConstantArgs(ExecState* exec_state, const plan::ScalarFunc& fn,
+                          udf::ScalarUDFDefinition* def, udf::ScalarUDF* udf);
 };
 
 /**
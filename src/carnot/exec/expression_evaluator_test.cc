@@ -60,6 +60,43 @@ class AddUDF : public udf::ScalarUDF {
   }
 };
 
+// Only produces correct results if the constant argument was bound with Init.
+class BoundAddUDF : public udf::ScalarUDF {
+ public:
+  Status Init(FunctionContext*, types::Int64Value v2) {
+    bound_v2_ = v2.val;
+    bound_ = true;
+    return Status::OK();
+  }
+  types::Int64Value Exec(FunctionContext*, types::Int64Value v1, types::Int64Value) {
+    return bound_ ? v1.val + bound_v2_ : -1;
+  }
+
+ private:
+  int64_t bound_v2_ = 0;
+  bool bound_ = false;
+};
+
+constexpr char kBoundAddScalarFuncConstPbtxt[] = R"(
+func {
+  name: "bound_add"
+  id: 1
+  args {
+    column {
+      node: 0
+      index: 0
+    }
+  }
+  args {
+    constant {
+      data_type: INT64,
+      int64_value: 1337
+    }
+  }
+  args_data_types: INT64
+  args_data_types: INT64
+})";
+
 std::shared_ptr<plan::ScalarExpression> AddScalarExpr() {
   planpb::ScalarExpression se_pb;
   google::protobuf::TextFormat::MergeFromString(kAddScalarFuncPbtxt, &se_pb);
@@ -99,10 +136,14 @@ class ScalarExpressionTest : public ::testing::TestWithParam<ScalarExpressionEva
     auto table_store = std::make_shared<table_store::TableStore>();
 
     EXPECT_TRUE(func_registry_->Register<AddUDF>("add").ok());
+    EXPECT_TRUE(func_registry_->Register<BoundAddUDF>("bound_add").ok());
     exec_state_ = std::make_unique<ExecState>(func_registry_.get(), table_store,
                                               MockResultSinkStubGenerator, sole::uuid4(), nullptr);
     EXPECT_OK(exec_state_->AddScalarUDF(
         0, "add", std::vector<types::DataType>({types::DataType::INT64, types::DataType::INT64})));
+    EXPECT_OK(exec_state_->AddScalarUDF(
+        1, "bound_add",
+        std::vector<types::DataType>({types::DataType::INT64, types::DataType::INT64})));
 
     std::vector<types::Int64Value> in1 = {1, 2, 3};
     std::vector<types::Int64Value> in2 = {3, 4, 5};
@@ -180,6 +221,21 @@ TEST_P(ScalarExpressionTest, eval_col_const) {
   EXPECT_EQ(1340, casted->Value(2));
 }
 
+TEST_P(ScalarExpressionTest, eval_col_const_bound) {
+  RowDescriptor rd_output({types::DataType::INT64});
+  RowBatch output_rb(rd_output, input_rb_->num_rows());
+
+  auto se = ScalarExpressionOf(kBoundAddScalarFuncConstPbtxt);
+  RunEvaluator({se}, &output_rb);
+
+  auto out_col = output_rb.ColumnAt(0);
+  EXPECT_EQ(3, out_col->length());
+  auto casted = static_cast<arrow::Int64Array*>(out_col.get());
+  EXPECT_EQ(1338, casted->Value(0));
+  EXPECT_EQ(1339, casted->Value(1));
+  EXPECT_EQ(1340, casted->Value(2));
+}
+
 TEST_P(ScalarExpressionTest, eval_add_nested) {
   RowDescriptor rd_output({types::DataType::INT64});
   RowBatch output_rb(rd_output, input_rb_->num_rows());
@@ -356,6 +356,18 @@ class ExecNodeTester {
     return *this;
   }
 
+  /**
+   * Removes the oldest rowbatch output by ConsumeNext/GenerateNext, so that it can be passed on
+   * to another node.
+   * @return the rowbatch.
+   */
+  std::unique_ptr<table_store::schema::RowBatch> PopRowBatch() {
+    DCHECK(current_row_batches_.size());
+    auto rb = std::move(current_row_batches_.front());
+    current_row_batches_.pop();
+    return rb;
+  }
+
   /**
    * Checks that the row batch matches the last rowbatch output by ConsumeNext/GenerateNext.
    * @param expected_rb Row batch that should match the last rowbatch output by
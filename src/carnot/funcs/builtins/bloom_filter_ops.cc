@@ -0,0 +1,64 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/funcs/builtins/bloom_filter_ops.h"
+
+#include <absl/strings/escaping.h>
+
+namespace px {
+namespace carnot {
+namespace builtins {
+
+std::string SerializeBloomFilter(const bloomfilter::XXHash64BloomFilter& filter) {
+  return absl::Base64Escape(filter.ToProto().SerializeAsString());
+}
+
+StatusOr<std::unique_ptr<bloomfilter::XXHash64BloomFilter>> DeserializeBloomFilter(
+    std::string_view serialized_filter) {
+  std::string pb_str;
+  if (!absl::Base64Unescape(serialized_filter, &pb_str)) {
+    return error::InvalidArgument("Bloom filter isn't valid base64");
+  }
+  bloomfilter::XXHash64BloomFilterPB pb;
+  if (!pb.ParseFromString(pb_str)) {
+    return error::InvalidArgument("Bloom filter isn't a valid XXHash64BloomFilter proto");
+  }
+  return bloomfilter::XXHash64BloomFilter::FromProto(pb);
+}
+
+void RegisterBloomFilterOpsOrDie(udf::Registry* registry) {
+  CHECK(registry != nullptr);
+  /*****************************************
+   * Scalar UDFs.
+   *****************************************/
+  registry->RegisterOrDie<BloomFilterContainsUDF<types::Int64Value>>("_bloom_filter_contains");
+  registry->RegisterOrDie<BloomFilterContainsUDF<types::Time64NSValue>>("_bloom_filter_contains");
+  registry->RegisterOrDie<BloomFilterContainsUDF<types::StringValue>>("_bloom_filter_contains");
+  registry->RegisterOrDie<BloomFilterContainsUDF<types::UInt128Value>>("_bloom_filter_contains");
+  /*****************************************
+   * Aggregate UDFs.
+   *****************************************/
+  registry->RegisterOrDie<BloomFilterBuildUDA<types::Int64Value>>("_build_bloom_filter");
+  registry->RegisterOrDie<BloomFilterBuildUDA<types::Time64NSValue>>("_build_bloom_filter");
+  registry->RegisterOrDie<BloomFilterBuildUDA<types::StringValue>>("_build_bloom_filter");
+  registry->RegisterOrDie<BloomFilterBuildUDA<types::UInt128Value>>("_build_bloom_filter");
+}
+
+}  // namespace builtins
+}  // namespace carnot
+}  // namespace px
@@ -0,0 +1,125 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include "src/carnot/udf/registry.h"
+#include "src/shared/bloomfilter/bloomfilter.h"
+#include "src/shared/types/types.h"
+
+namespace px {
+namespace carnot {
+namespace builtins {
+
+/**
+ * Registers UDF operations that build and probe bloom filters.
+ * @param registry pointer to the registry.
+ */
+void RegisterBloomFilterOpsOrDie(udf::Registry* registry);
+
+/**
+ * Bloom filters are passed between queries as strings, e.g. from a query that builds the filter
+ * over the keys of the small side of a join to a query that drops the rows of the large side whose
+ * keys the filter doesn't contain. They are base64 encoded so they survive script arguments.
+ */
+std::string SerializeBloomFilter(const bloomfilter::XXHash64BloomFilter& filter);
+StatusOr<std::unique_ptr<bloomfilter::XXHash64BloomFilter>> DeserializeBloomFilter(
+    std::string_view serialized_filter);
+
+// The bytes that are hashed to insert a value into a bloom filter or to look it up.
+template <typename TArg>
+std::string_view BloomFilterKey(const TArg& arg) {
+  return std::string_view(reinterpret_cast<const char*>(&arg.val), sizeof(arg.val));
+}
+inline std::string_view BloomFilterKey(const types::StringValue& arg) { return arg; }
+
+template <typename TArg>
+class BloomFilterBuildUDA : public udf::UDA {
+ public:
+  // Sized for the small side of a join. Inserting more keys raises the false positive rate, but a
+  // bloom filter never has false negatives, so filtering with it never drops a matching row.
+  static constexpr int64_t kMaxEntries = 10000;
+  static constexpr double kErrorRate = 0.01;
+
+  BloomFilterBuildUDA()
+      : filter_(bloomfilter::XXHash64BloomFilter::Create(kMaxEntries, kErrorRate)
+                    .ConsumeValueOrDie()) {}
+  BloomFilterBuildUDA(const BloomFilterBuildUDA& other)
+      : filter_(std::make_unique<bloomfilter::XXHash64BloomFilter>(*other.filter_)) {}
+
+  void Update(FunctionContext*, TArg key) { filter_->Insert(BloomFilterKey(key)); }
+  void Merge(FunctionContext*, const BloomFilterBuildUDA& other) {
+    // Every instance is created with the same size, so the merge can't fail.
+    PL_CHECK_OK(filter_->Merge(*other.filter_));
+  }
+  StringValue Finalize(FunctionContext*) { return SerializeBloomFilter(*filter_); }
+
+  StringValue Serialize(FunctionContext*) { return SerializeBloomFilter(*filter_); }
+
+  Status Deserialize(FunctionContext*, const StringValue& data) {
+    PL_ASSIGN_OR_RETURN(filter_, DeserializeBloomFilter(data));
+    return Status::OK();
+  }
+
+ private:
+  std::unique_ptr<bloomfilter::XXHash64BloomFilter> filter_;
+};
+
+template <typename TArg>
+class BloomFilterContainsUDF : public udf::ScalarUDF {
+ public:
+  // Called when the filter is a constant, so that it's only deserialized once.
+  Status Init(FunctionContext*, StringValue serialized_filter) {
+    // An undecodable filter doesn't fail the query: Exec keeps every record instead.
+    SetFilter(serialized_filter);
+    filter_init_ = true;
+    return Status::OK();
+  }
+
+  BoolValue Exec(FunctionContext*, TArg key, StringValue serialized_filter) {
+    // A constant filter was bound by Init, and is the same for every record. Otherwise, the
+    // filter is only decoded again when it changes, comparing the cheap size first.
+    if (!filter_init_ && (serialized_filter.size() != serialized_filter_.size() ||
+                          serialized_filter != serialized_filter_)) {
+      SetFilter(serialized_filter);
+    }
+    // Keep the record if there is no valid filter: the filter only prunes records that can't match.
+    return filter_ == nullptr || filter_->Contains(BloomFilterKey(key));
+  }
+
+ private:
+  // Deserializes the filter, leaving filter_ empty if it's invalid, so that an invalid filter is
+  // only decoded once.
+  void SetFilter(const StringValue& serialized_filter) {
+    auto filter_or_s = DeserializeBloomFilter(serialized_filter);
+    filter_ = filter_or_s.ok() ? filter_or_s.ConsumeValueOrDie() : nullptr;
+    serialized_filter_ = serialized_filter;
+  }
+
+  std::unique_ptr<bloomfilter::XXHash64BloomFilter> filter_;
+  // The serialized form of filter_, to find out when a filter that isn't a constant changes.
+  std::string serialized_filter_;
+  bool filter_init_ = false;
+};
+
+}  // namespace builtins
+}  // namespace carnot
+}  // namespace px
@@ -0,0 +1,97 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include "src/carnot/funcs/builtins/bloom_filter_ops.h"
+#include "src/carnot/udf/test_utils.h"
+#include "src/common/base/test_utils.h"
+
+namespace px {
+namespace carnot {
+namespace builtins {
+
+TEST(BloomFilterOps, build_and_probe_strings) {
+  auto uda_tester = udf::UDATester<BloomFilterBuildUDA<types::StringValue>>();
+  std::string filter = uda_tester.ForInput("svc-a").ForInput("svc-b").Result();
+
+  auto udf_tester = udf::UDFTester<BloomFilterContainsUDF<types::StringValue>>();
+  udf_tester.ForInput("svc-a", filter).Expect(true);
+  udf_tester.ForInput("svc-b", filter).Expect(true);
+  udf_tester.ForInput("svc-c", filter).Expect(false);
+}
+
+TEST(BloomFilterOps, build_and_probe_upids) {
+  auto uda_tester = udf::UDATester<BloomFilterBuildUDA<types::UInt128Value>>();
+  std::string filter =
+      uda_tester.ForInput(absl::MakeUint128(1, 2)).ForInput(absl::MakeUint128(3, 4)).Result();
+
+  BloomFilterContainsUDF<types::UInt128Value> udf;
+  ASSERT_OK(udf.Init(nullptr, filter));
+  EXPECT_TRUE(udf.Exec(nullptr, absl::MakeUint128(1, 2), filter).val);
+  EXPECT_TRUE(udf.Exec(nullptr, absl::MakeUint128(3, 4), filter).val);
+  EXPECT_FALSE(udf.Exec(nullptr, absl::MakeUint128(2, 1), filter).val);
+}
+
+TEST(BloomFilterOps, merge_partial_filters) {
+  auto uda_tester1 = udf::UDATester<BloomFilterBuildUDA<types::Int64Value>>();
+  auto uda_tester2 = udf::UDATester<BloomFilterBuildUDA<types::Int64Value>>();
+  uda_tester1.ForInput(1).ForInput(2);
+  uda_tester2.ForInput(3);
+  ASSERT_OK(uda_tester1.Deserialize(uda_tester2.Serialize()));
+  std::string filter = uda_tester1.Result();
+
+  auto udf_tester = udf::UDFTester<BloomFilterContainsUDF<types::Int64Value>>();
+  udf_tester.ForInput(1, filter).Expect(true);
+  udf_tester.ForInput(2, filter).Expect(true);
+  udf_tester.ForInput(3, filter).Expect(true);
+  udf_tester.ForInput(4, filter).Expect(false);
+}
+
+TEST(BloomFilterOps, invalid_filter) {
+  BloomFilterContainsUDF<types::Int64Value> udf;
+  EXPECT_OK(udf.Init(nullptr, "not a filter"));
+  // Without a valid filter every record is kept.
+  EXPECT_TRUE(udf.Exec(nullptr, 1, "not a filter").val);
+  EXPECT_TRUE(udf.Exec(nullptr, 2, "not a filter").val);
+
+  // When the filter isn't a constant, the invalid filter is replaced by the next valid one.
+  BloomFilterContainsUDF<types::Int64Value> column_udf;
+  EXPECT_TRUE(column_udf.Exec(nullptr, 4, "not a filter").val);
+  auto uda_tester = udf::UDATester<BloomFilterBuildUDA<types::Int64Value>>();
+  std::string filter = uda_tester.ForInput(1).Result();
+  EXPECT_TRUE(column_udf.Exec(nullptr, 1, filter).val);
+  EXPECT_FALSE(column_udf.Exec(nullptr, 4, filter).val);
+}
+
+TEST(BloomFilterOps, constant_filter_bound_by_init) {
+  auto uda_tester = udf::UDATester<BloomFilterBuildUDA<types::Int64Value>>();
+  std::string filter = uda_tester.ForInput(1).Result();
+
+  // The filter bound by Init is used for every record, without comparing the filter argument.
+  BloomFilterContainsUDF<types::Int64Value> udf;
+  EXPECT_OK(udf.Init(nullptr, filter));
+  EXPECT_TRUE(udf.Exec(nullptr, 1, filter).val);
+  EXPECT_FALSE(udf.Exec(nullptr, 4, filter).val);
+  EXPECT_FALSE(udf.Exec(nullptr, 4, "").val);
+}
+
+}  // namespace builtins
+}  // namespace carnot
+}  // namespace px
@@ -17,6 +17,7 @@
  */
 
 #include "src/carnot/funcs/builtins/builtins.h"
+#include "src/carnot/funcs/builtins/bloom_filter_ops.h"
 #include "src/carnot/funcs/builtins/collections.h"
 #include "src/carnot/funcs/builtins/conditionals.h"
 #include "src/carnot/funcs/builtins/json_ops.h"
@@ -34,6 +35,7 @@ namespace carnot {
 namespace builtins {
 
 void RegisterBuiltinsOrDie(udf::Registry* registry) {
+  RegisterBloomFilterOpsOrDie(registry);
   RegisterCollectionOpsOrDie(registry);
   RegisterConditionalOpsOrDie(registry);
   RegisterMathOpsOrDie(registry);
@@ -19,10 +19,12 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 
 #include <rapidjson/document.h>
+#include <rapidjson/reader.h>
 #include <rapidjson/stringbuffer.h>
 #include <rapidjson/writer.h>
 
@@ -33,36 +35,200 @@ namespace px {
 namespace carnot {
 namespace builtins {
 
+/**
+ * JSONKeyPlucker finds the value of a top level key in a serialized JSON object.
+ *
+ * The document is scanned with rapidjson's SAX reader and scanning stops as soon as the value
+ * of the key has been read, so no DOM is built and the rest of the document is never parsed.
+ * Object and array values are re-serialized as they are scanned.
+ *
+ * An instance can be reused for many documents, which lets the reader reuse its buffers.
+ */
+class JSONKeyPlucker : public rapidjson::BaseReaderHandler<rapidjson::UTF8<>, JSONKeyPlucker> {
+ public:
+  JSONKeyPlucker() : writer_(buffer_) {}
+
+  /**
+   * Finds the value of key in the JSON object json.
+   * @return true if json is an object that has the key.
+   */
+  bool Pluck(const std::string& json, std::string_view key) {
+    key_ = key;
+    depth_ = 0;
+    capturing_ = false;
+    found_ = false;
+    buffer_.Clear();
+    writer_.Reset(buffer_);
+
+    rapidjson::StringStream ss(json.c_str());
+    // The parse is terminated by the handler once the value is found, so the result is not
+    // used.
+    reader_.Parse(ss, *this);
+    return found_;
+  }
+
+  /**
+   * The type of the plucked value. Only valid if Pluck returned true.
+   */
+  rapidjson::Type type() const { return type_; }
+
+  /**
+   * @return The plucked string, or the serialized JSON of any other plucked value.
+   */
+  std::string AsString() const {
+    if (type_ == rapidjson::kStringType) {
+      return string_value_;
+    }
+    return buffer_.GetString();
+  }
+
+  /**
+   * @return The plucked value as an int, or 0 if it's not an integer.
+   */
+  int64_t AsInt64() const { return type_ == rapidjson::kNumberType && is_int_ ? int64_value_ : 0; }
+
+  /**
+   * @return The plucked value as a float, or 0.0 if it's not a number.
+   */
+  double AsFloat64() const { return type_ == rapidjson::kNumberType ? double_value_ : 0.0; }
+
+  // rapidjson SAX handler functions. Returning false terminates the parse.
+  bool Null() {
+    return Scalar(rapidjson::kNullType, [&] { writer_.Null(); });
+  }
+  bool Bool(bool b) {
+    return Scalar(b ? rapidjson::kTrueType : rapidjson::kFalseType, [&] { writer_.Bool(b); });
+  }
+  bool Int(int i) {
+    SetNumber(i, i, /*is_int*/ true);
+    return Scalar(rapidjson::kNumberType, [&] { writer_.Int(i); });
+  }
+  bool Uint(unsigned u) {
+    SetNumber(u, u, /*is_int*/ true);
+    return Scalar(rapidjson::kNumberType, [&] { writer_.Uint(u); });
+  }
+  bool Int64(int64_t i) {
+    SetNumber(i, static_cast<double>(i), /*is_int*/ true);
+    return Scalar(rapidjson::kNumberType, [&] { writer_.Int64(i); });
+  }
+  bool Uint64(uint64_t u) {
+    SetNumber(static_cast<int64_t>(u), static_cast<double>(u), /*is_int*/ true);
+    return Scalar(rapidjson::kNumberType, [&] { writer_.Uint64(u); });
+  }
+  bool Double(double d) {
+    SetNumber(0, d, /*is_int*/ false);
+    return Scalar(rapidjson::kNumberType, [&] { writer_.Double(d); });
+  }
+  bool String(const char* str, rapidjson::SizeType length, bool copy) {
+    if (capturing_ && depth_ == capture_depth_) {
+      string_value_.assign(str, length);
+    }
+    return Scalar(rapidjson::kStringType, [&] { writer_.String(str, length, copy); });
+  }
+  bool Key(const char* str, rapidjson::SizeType length, bool copy) {
+    if (capturing_) {
+      writer_.Key(str, length, copy);
+    } else if (depth_ == 1 && std::string_view(str, length) == key_) {
+      capturing_ = true;
+      capture_depth_ = depth_;
+    }
+    return true;
+  }
+  bool StartObject() {
+    if (capturing_) {
+      writer_.StartObject();
+    }
+    ++depth_;
+    return true;
+  }
+  bool EndObject(rapidjson::SizeType member_count) {
+    --depth_;
+    if (capturing_) {
+      writer_.EndObject(member_count);
+      return !MaybeFinish(rapidjson::kObjectType);
+    }
+    return true;
+  }
+  bool StartArray() {
+    if (!capturing_) {
+      // Arrays are only skipped inside of the root object.
+      ++depth_;
+      return depth_ > 1;
+    }
+    writer_.StartArray();
+    ++depth_;
+    return true;
+  }
+  bool EndArray(rapidjson::SizeType element_count) {
+    --depth_;
+    if (capturing_) {
+      writer_.EndArray(element_count);
+      return !MaybeFinish(rapidjson::kArrayType);
+    }
+    return true;
+  }
+
+ private:
+  void SetNumber(int64_t i, double d, bool is_int) {
+    if (capturing_ && depth_ == capture_depth_) {
+      int64_value_ = i;
+      double_value_ = d;
+      is_int_ = is_int;
+    }
+  }
+
+  template <typename TWriteFn>
+  bool Scalar(rapidjson::Type type, TWriteFn write_fn) {
+    if (!capturing_) {
+      // A scalar at the root means the document is not an object.
+      return depth_ > 0;
+    }
+    write_fn();
+    return !MaybeFinish(type);
+  }
+
+  // Returns true if the captured value is complete.
+  bool MaybeFinish(rapidjson::Type type) {
+    if (depth_ != capture_depth_) {
+      return false;
+    }
+    type_ = type;
+    capturing_ = false;
+    found_ = true;
+    return true;
+  }
+
+  rapidjson::Reader reader_;
+  rapidjson::StringBuffer buffer_;
+  rapidjson::Writer<rapidjson::StringBuffer> writer_;
+
+  std::string_view key_;
+  int depth_ = 0;
+  int capture_depth_ = 0;
+  bool capturing_ = false;
+  bool found_ = false;
+
+  rapidjson::Type type_ = rapidjson::kNullType;
+  std::string string_value_;
+  int64_t int64_value_ = 0;
+  double double_value_ = 0.0;
+  bool is_int_ = false;
+};
+
 // TODO(zasgar): PL-419 To have proper support for JSON we need structs and nullable types.
 // Revisit when we have them.
 class PluckUDF : public udf::ScalarUDF {
  public:
   StringValue Exec(FunctionContext*, StringValue in, StringValue key) {
-    rapidjson::Document d;
-    rapidjson::ParseResult ok = d.Parse(in.data());
     // TODO(zasgar/michellenguyen, PP-419): Replace with null when available.
-    if (ok == nullptr) {
-      return "";
-    }
-    if (!d.IsObject()) {
-      return "";
-    }
-    if (!d.HasMember(key.data())) {
+    if (!plucker_.Pluck(in, key)) {
       return "";
     }
-    const auto& plucked_value = d[key.data()];
-    if (plucked_value.IsNull()) {
+    if (plucker_.type() == rapidjson::kNullType) {
       return "";
     }
-    if (plucked_value.IsString()) {
-      return plucked_value.GetString();
-    }
-
     // This is robust to nested JSON.
-    rapidjson::StringBuffer sb;
-    rapidjson::Writer<rapidjson::StringBuffer> writer(sb);
-    plucked_value.Accept(writer);
-    return sb.GetString();
+    return plucker_.AsString();
   }
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder(
@@ -82,22 +248,19 @@ class PluckUDF : public udf::ScalarUDF {
         .Arg("key", "The key to get the value for.")
         .Returns("The value for the key as a string.");
   }
+
+ private:
+  JSONKeyPlucker plucker_;
 };
 
 class PluckAsInt64UDF : public udf::ScalarUDF {
  public:
   Int64Value Exec(FunctionContext*, StringValue in, StringValue key) {
-    rapidjson::Document d;
-    rapidjson::ParseResult ok = d.Parse(in.data());
     // TODO(zasgar/michellenguyen, PP-419): Replace with null when available.
-    if (ok == nullptr) {
+    if (!plucker_.Pluck(in, key)) {
       return 0;
     }
-    if (!d.IsObject()) {
-      return 0;
-    }
-    const auto& plucked_value = d[key.data()];
-    return plucked_value.GetInt64();
+    return plucker_.AsInt64();
   }
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder(
@@ -117,22 +280,19 @@ class PluckAsInt64UDF : public udf::ScalarUDF {
         .Arg("key", "The key to get the value for.")
         .Returns("The value for the key as an int.");
   }
+
+ private:
+  JSONKeyPlucker plucker_;
 };
 
 class PluckAsFloat64UDF : public udf::ScalarUDF {
  public:
   Float64Value Exec(FunctionContext*, StringValue in, StringValue key) {
-    rapidjson::Document d;
-    rapidjson::ParseResult ok = d.Parse(in.data());
     // TODO(zasgar/michellenguyen, PP-419): Replace with null when available.
-    if (ok == nullptr) {
+    if (!plucker_.Pluck(in, key)) {
       return 0.0;
     }
-    if (!d.IsObject()) {
-      return 0.0;
-    }
-    const auto& plucked_value = d[key.data()];
-    return plucked_value.GetDouble();
+    return plucker_.AsFloat64();
   }
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder(
@@ -155,6 +315,9 @@ class PluckAsFloat64UDF : public udf::ScalarUDF {
         .Arg("key", "The key to get the value for.")
         .Returns("The value for the key as a float");
   }
+
+ private:
+  JSONKeyPlucker plucker_;
 };
 
 /**
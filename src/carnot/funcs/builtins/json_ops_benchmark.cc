@@ -0,0 +1,138 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <benchmark/benchmark.h>
+
+#include <string>
+#include <vector>
+
+#include <absl/strings/str_cat.h>
+#include <absl/strings/substitute.h>
+
+#include "src/carnot/funcs/builtins/json_ops.h"
+#include "src/carnot/udf/udf_definition.h"
+#include "src/common/base/base.h"
+#include "src/shared/types/column_wrapper.h"
+#include "src/shared/types/types.h"
+
+using px::carnot::builtins::PluckAsInt64UDF;
+using px::carnot::builtins::PluckUDF;
+using px::carnot::udf::FunctionContext;
+using px::carnot::udf::ScalarUDF;
+using px::carnot::udf::ScalarUDFDefinition;
+using px::types::Int64Value;
+using px::types::Int64ValueColumnWrapper;
+using px::types::StringValue;
+using px::types::StringValueColumnWrapper;
+
+// Pluck implemented by parsing the whole document into a rapidjson DOM, used as the baseline.
+class DOMPluckUDF : public ScalarUDF {
+ public:
+  StringValue Exec(FunctionContext*, StringValue in, StringValue key) {
+    rapidjson::Document d;
+    rapidjson::ParseResult ok = d.Parse(in.data());
+    if (ok == nullptr || !d.IsObject() || !d.HasMember(key.data())) {
+      return "";
+    }
+    const auto& plucked_value = d[key.data()];
+    if (plucked_value.IsString()) {
+      return plucked_value.GetString();
+    }
+    rapidjson::StringBuffer sb;
+    rapidjson::Writer<rapidjson::StringBuffer> writer(sb);
+    plucked_value.Accept(writer);
+    return sb.GetString();
+  }
+};
+
+// Generates request body like JSON objects with num_keys object valued keys, "key_0" ..
+// "key_<num_keys-1>", followed by the int valued key "count".
+std::vector<StringValue> GenerateJSONDocs(int num_docs, int num_keys) {
+  std::vector<StringValue> docs;
+  docs.reserve(num_docs);
+  for (int i = 0; i < num_docs; ++i) {
+    std::string doc = "{";
+    for (int k = 0; k < num_keys; ++k) {
+      absl::StrAppend(&doc, k == 0 ? "" : ",",
+                      absl::Substitute(R"("key_$0": {"id": $1, "name": "name_$1"})", k, i));
+    }
+    absl::StrAppend(&doc, absl::Substitute(R"(,"count": $0})", i));
+    docs.push_back(doc);
+  }
+  return docs;
+}
+
+// NOLINTNEXTLINE : runtime/references.
+template <typename TUDF, typename TOutputColumn>
+void BenchmarkPluck(benchmark::State& state, const std::string& key) {
+  constexpr int kNumDocs = 1024;
+  int num_keys = state.range(0);
+  auto docs = GenerateJSONDocs(kNumDocs, num_keys);
+  StringValueColumnWrapper docs_col(docs);
+  // The key is a constant, so it's broadcast from a single value.
+  StringValueColumnWrapper key_col(1, key);
+  TOutputColumn out(docs.size());
+
+  ScalarUDFDefinition def("pluck");
+  PL_CHECK_OK(def.template Init<TUDF>());
+  auto u = def.Make();
+
+  size_t bytes = 0;
+  for (const auto& doc : docs) {
+    bytes += doc.size();
+  }
+
+  // NOLINTNEXTLINE : clang-analyzer-deadcode.DeadStores.
+  for (auto _ : state) {
+    PL_CHECK_OK(def.ExecBatch(u.get(), nullptr, {&docs_col, &key_col}, &out, docs.size()));
+    benchmark::DoNotOptimize(out);
+  }
+  state.SetBytesProcessed(int64_t(state.iterations()) * bytes);
+}
+
+// NOLINTNEXTLINE : runtime/references.
+static void BM_PluckDOMFirstKey(benchmark::State& state) {
+  BenchmarkPluck<DOMPluckUDF, StringValueColumnWrapper>(state, "key_0");
+}
+
+// NOLINTNEXTLINE : runtime/references.
+static void BM_PluckDOMLastKey(benchmark::State& state) {
+  BenchmarkPluck<DOMPluckUDF, StringValueColumnWrapper>(
+      state, absl::Substitute("key_$0", state.range(0) - 1));
+}
+
+// NOLINTNEXTLINE : runtime/references.
+static void BM_PluckFirstKey(benchmark::State& state) {
+  BenchmarkPluck<PluckUDF, StringValueColumnWrapper>(state, "key_0");
+}
+
+// NOLINTNEXTLINE : runtime/references.
+static void BM_PluckLastKey(benchmark::State& state) {
+  BenchmarkPluck<PluckUDF, StringValueColumnWrapper>(
+      state, absl::Substitute("key_$0", state.range(0) - 1));
+}
+
+// NOLINTNEXTLINE : runtime/references.
+static void BM_PluckInt64LastKey(benchmark::State& state) {
+  BenchmarkPluck<PluckAsInt64UDF, Int64ValueColumnWrapper>(state, "count");
+}
+
+BENCHMARK(BM_PluckDOMFirstKey)->RangeMultiplier(4)->Range(1, 64);
+BENCHMARK(BM_PluckDOMLastKey)->RangeMultiplier(4)->Range(1, 64);
+BENCHMARK(BM_PluckFirstKey)->RangeMultiplier(4)->Range(1, 64);
+BENCHMARK(BM_PluckLastKey)->RangeMultiplier(4)->Range(1, 64);
+BENCHMARK(BM_PluckInt64LastKey)->RangeMultiplier(4)->Range(1, 64);
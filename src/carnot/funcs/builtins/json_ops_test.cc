@@ -60,6 +60,27 @@ TEST(JSONOps, PluckUDF_non_object_input_return_empty) {
   udf_tester.ForInput("[\"asdad\"]", "str_key").Expect("");
 }
 
+TEST(JSONOps, PluckUDF_nested_key_not_plucked) {
+  auto udf_tester = udf::UDFTester<PluckUDF>();
+  udf_tester.ForInput(kTestJSONStr, "abc").Expect("");
+}
+
+TEST(JSONOps, PluckUDF_number_and_array) {
+  auto udf_tester = udf::UDFTester<PluckUDF>();
+  udf_tester.ForInput(kTestJSONStr, "int64_key").Expect("34243242341");
+  udf_tester.ForInput(R"({"a": [1, {"b": null}, "c"], "d": 2})", "a")
+      .Expect(R"([1,{"b":null},"c"])");
+  udf_tester.ForInput(R"({"a": null})", "a").Expect("");
+}
+
+TEST(JSONOps, PluckUDF_reused_for_many_inputs) {
+  auto udf_tester = udf::UDFTester<PluckUDF>();
+  udf_tester.ForInput(kTestJSONStr, "str_key").Expect(R"({"abc":"def"})");
+  udf_tester.ForInput(kTestJSONStr, "str_plain").Expect("abc");
+  udf_tester.ForInput("asdad", "str_key").Expect("");
+  udf_tester.ForInput(kTestJSONStr, "str_key").Expect(R"({"abc":"def"})");
+}
+
 TEST(JSONOps, PluckAsInt64UDF) {
   auto udf_tester = udf::UDFTester<PluckAsInt64UDF>();
   udf_tester.ForInput(kTestJSONStr, "int64_key").Expect(34243242341);
@@ -75,6 +96,13 @@ TEST(JSONOps, PluckAsIntUDF_non_object_input_return_empty) {
   udf_tester.ForInput("[\"asdad\"]", "int64_key").Expect(0);
 }
 
+TEST(JSONOps, PluckAsInt64UDF_non_int_value_return_zero) {
+  auto udf_tester = udf::UDFTester<PluckAsInt64UDF>();
+  udf_tester.ForInput(kTestJSONStr, "str_plain").Expect(0);
+  udf_tester.ForInput(kTestJSONStr, "float64_key").Expect(0);
+  udf_tester.ForInput(kTestJSONStr, "blah").Expect(0);
+}
+
 TEST(JSONOps, PluckAsFloat64UDF) {
   auto udf_tester = udf::UDFTester<PluckAsFloat64UDF>();
   udf_tester.ForInput(kTestJSONStr, "float64_key").Expect(123423.5234);
@@ -90,6 +118,11 @@ TEST(JSONOps, PluckAsFloatUDF_non_object_input_return_empty) {
   udf_tester.ForInput("[\"asdad\"]", "float64_key").Expect(0.0);
 }
 
+TEST(JSONOps, PluckAsFloat64UDF_int_value) {
+  auto udf_tester = udf::UDFTester<PluckAsFloat64UDF>();
+  udf_tester.ForInput(kTestJSONStr, "int64_key").Expect(34243242341.0);
+}
+
 TEST(JSONOps, ScriptReferenceUDF_no_args) {
   auto udf_tester = udf::UDFTester<ScriptReferenceUDF<>>();
   auto res = udf_tester.ForInput("text", "px/script").Result();
@@ -17,6 +17,10 @@
  */
 
 #include "src/carnot/funcs/builtins/ml_ops.h"
+
+#include <absl/strings/ascii.h>
+#include <absl/strings/charconv.h>
+
 #include "src/carnot/udf/registry.h"
 #include "src/common/base/base.h"
 
@@ -39,30 +43,58 @@ void RegisterMLOpsOrDie(udf::Registry* registry) {
   registry->RegisterOrDie<ReservoirSampleUDA<types::StringValue>>("sample");
 }
 
-int load_floats_from_json(std::string in, Eigen::VectorXf* out, int max_num) {
-  rapidjson::Document d;
-  rapidjson::ParseResult ok = d.Parse(in.data());
+int load_floats_from_json(std::string_view in, Eigen::VectorXf* out, int max_num) {
+  // This is called for every embedding, so the array is scanned in place instead of building a
+  // rapidjson document.
+  const char* pos = in.data();
+  const char* end = in.data() + in.size();
+  auto skip_whitespace = [&]() {
+    while (pos != end && absl::ascii_isspace(*pos)) {
+      ++pos;
+    }
+  };
+
+  skip_whitespace();
   // TODO(zasgar/michellenguyen, PP-419): Replace with null when available.
-  if (ok == nullptr) {
+  if (pos == end || *pos != '[') {
     return 0;
   }
-  if (!d.IsArray()) {
+  ++pos;
+  skip_whitespace();
+  if (pos != end && *pos == ']') {
     return 0;
   }
 
   int count = 0;
-  for (rapidjson::Value::ConstValueIterator itr = d.Begin(); itr != d.End(); ++itr) {
+  while (pos != end) {
     if (count == max_num) {
       return count;
     }
-    const rapidjson::Value& val = *itr;
-    if (!val.IsDouble()) {
+    float val;
+    auto res = absl::from_chars(pos, end, val);
+    if (res.ec != std::errc() || res.ptr == pos) {
       return 0;
     }
-    out->operator()(count) = val.GetFloat();
+    out->operator()(count) = val;
     count++;
+
+    pos = res.ptr;
+    skip_whitespace();
+    if (pos == end) {
+      return 0;
+    }
+    if (*pos == ']') {
+      ++pos;
+      skip_whitespace();
+      return pos == end ? count : 0;
+    }
+    if (*pos != ',') {
+      return 0;
+    }
+    ++pos;
+    skip_whitespace();
   }
-  return count;
+  return 0;
 }
 
 std::string write_ints_to_json(int* arr, int num) {
@@ -26,6 +26,7 @@
 
 #include <memory>
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include "src/carnot/exec/ml/coreset.h"
@@ -46,7 +47,12 @@ using exec::ml::CoresetTree;
 using exec::ml::KMeans;
 using exec::ml::KMeansCoreset;
 
-int load_floats_from_json(std::string in, Eigen::VectorXf* out, int max_num);
+/**
+ * Reads a JSON array of numbers (eg. an embedding) into out.
+ * @return the number of floats read (at most max_num), or 0 if the input is not a valid array
+ * of numbers.
+ */
+int load_floats_from_json(std::string_view in, Eigen::VectorXf* out, int max_num);
 std::string write_ints_to_json(int* arr, int num);
 
 class TransformerUDF : public udf::ScalarUDF {
@@ -89,15 +95,14 @@ class KMeansUDA : public udf::UDA {
  public:
   KMeansUDA() : KMeansUDA(64) {}
   explicit KMeansUDA(int d)
-      : d_(d), coreset_(/*base_bucket_size*/ 64, d, /*r*/ 4, /*coreset_size*/ 64) {}
+      : d_(d), coreset_(/*base_bucket_size*/ 64, d, /*r*/ 4, /*coreset_size*/ 64), point_(d) {}
   void Update(FunctionContext*, StringValue in, Int64Value k) {
     if (k_ == -1) {
       k_ = k.val;
     }
-    Eigen::VectorXf point(d_);
-    int d = load_floats_from_json(in, &point, d_);
+    int d = load_floats_from_json(in, &point_, d_);
     DCHECK_EQ(d_, d);
-    coreset_.Update(point);
+    coreset_.Update(point_);
   }
   void Merge(FunctionContext*, const KMeansUDA& other) { coreset_.Merge(other.coreset_); }
   StringValue Finalize(FunctionContext*) {
@@ -118,27 +123,37 @@ class KMeansUDA : public udf::UDA {
   int d_;
   int k_ = -1;
   CoresetDriver<CoresetTree<KMeansCoreset>> coreset_;
+  // Reused across updates to avoid allocating a vector per record.
+  Eigen::VectorXf point_;
 };
 
 class KMeansUDF : public udf::ScalarUDF {
  public:
   KMeansUDF() : KMeansUDF(64) {}
-  explicit KMeansUDF(int d) : d_(d) {}
+  explicit KMeansUDF(int d) : d_(d), point_(d) {}
+
+  // Called when the model is a constant, so that it's decoded before the first record.
+  Status Init(FunctionContext*, StringValue kmeans_json) {
+    kmeans_ = std::make_unique<KMeans>(0);
+    kmeans_->FromJSON(kmeans_json);
+    return Status::OK();
+  }
 
   Int64Value Exec(FunctionContext*, StringValue embedding, StringValue kmeans_json) {
     if (kmeans_ == nullptr) {
       kmeans_ = std::make_unique<KMeans>(0);
       kmeans_->FromJSON(kmeans_json);
     }
-    Eigen::VectorXf point(d_);
-    int d = load_floats_from_json(embedding, &point, d_);
+    int d = load_floats_from_json(embedding, &point_, d_);
     DCHECK_EQ(d_, d);
-    return kmeans_->Transform(point);
+    return kmeans_->Transform(point_);
   }
 
  private:
   int d_;
   std::unique_ptr<KMeans> kmeans_;
+  // Reused across records to avoid allocating a vector per record.
+  Eigen::VectorXf point_;
 };
 
 template <typename TArg>
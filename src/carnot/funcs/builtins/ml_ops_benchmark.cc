@@ -83,5 +83,26 @@ static void BM_SentencePiece(benchmark::State& state) {
   }
 }
 
+// NOLINTNEXTLINE : runtime/references.
+static void BM_LoadFloatsFromJSON(benchmark::State& state) {
+  int d = state.range(0);
+  Eigen::VectorXf embedding = Eigen::VectorXf::Random(d);
+  rapidjson::StringBuffer sb;
+  rapidjson::Writer<rapidjson::StringBuffer> writer(sb);
+  writer.StartArray();
+  for (int i = 0; i < d; ++i) {
+    writer.Double(embedding(i));
+  }
+  writer.EndArray();
+  std::string json = sb.GetString();
+
+  Eigen::VectorXf out(d);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(px::carnot::builtins::load_floats_from_json(json, &out, d));
+  }
+  state.SetBytesProcessed(state.iterations() * json.size());
+}
+
+BENCHMARK(BM_LoadFloatsFromJSON)->RangeMultiplier(4)->Range(16, 1024);
 BENCHMARK(BM_SentencePiece)->Unit(benchmark::kMillisecond);
 BENCHMARK(BM_TransformerModel)->Unit(benchmark::kMillisecond);
@@ -51,6 +51,30 @@ std::string write_vector_to_json(const Eigen::VectorXf& vector) {
   return sb.GetString();
 }
 
+TEST(LoadFloatsFromJSON, basic) {
+  Eigen::VectorXf out(4);
+  EXPECT_EQ(3, load_floats_from_json("[1.5, -2.0,3e-2]", &out, 4));
+  EXPECT_FLOAT_EQ(1.5, out(0));
+  EXPECT_FLOAT_EQ(-2.0, out(1));
+  EXPECT_FLOAT_EQ(0.03, out(2));
+
+  // Reading stops after max_num floats.
+  EXPECT_EQ(2, load_floats_from_json(" [ 4.0 , 5.0 , 6.0 ] ", &out, 2));
+  EXPECT_FLOAT_EQ(4.0, out(0));
+  EXPECT_FLOAT_EQ(5.0, out(1));
+}
+
+TEST(LoadFloatsFromJSON, invalid) {
+  Eigen::VectorXf out(4);
+  EXPECT_EQ(0, load_floats_from_json("", &out, 4));
+  EXPECT_EQ(0, load_floats_from_json("[]", &out, 4));
+  EXPECT_EQ(0, load_floats_from_json("{\"a\": 1.0}", &out, 4));
+  EXPECT_EQ(0, load_floats_from_json("[1.0, \"a\"]", &out, 4));
+  EXPECT_EQ(0, load_floats_from_json("[1.0, 2.0", &out, 4));
+  EXPECT_EQ(0, load_floats_from_json("[1.0 2.0]", &out, 4));
+  EXPECT_EQ(0, load_floats_from_json("[1.0, 2.0] abc", &out, 4));
+}
+
 TEST(KMeans, basic) {
   int k = 3;
   int d = 2;
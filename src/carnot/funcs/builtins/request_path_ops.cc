@@ -41,19 +41,23 @@ void RegisterRequestPathOpsOrDie(udf::Registry* registry) {
 }
 
 RequestPath::RequestPath(std::string request_path) {
+  std::vector<std::string_view> path_components;
+  SplitPathComponents(request_path, &path_components);
+  path_components_.assign(path_components.begin(), path_components.end());
+}
+
+void RequestPath::SplitPathComponents(std::string_view request_path,
+                                      std::vector<std::string_view>* path_components) {
+  path_components->clear();
   // Chop off request params for now. In the future, we want to keep these around and include
   // them in the clustering.
-  std::string request_path_no_params;
-  auto param_index = request_path.find('?');
-  if (param_index == std::string::npos) {
-    request_path_no_params = request_path;
-  } else {
-    request_path_no_params = request_path.substr(0, param_index);
+  auto request_path_no_params = request_path.substr(0, request_path.find('?'));
+  if (!request_path_no_params.empty() && request_path_no_params.front() == '/') {
+    request_path_no_params.remove_prefix(1);
   }
-  if (request_path_no_params[0] == '/') {
-    request_path_no_params = request_path_no_params.substr(1, request_path_no_params.size() - 1);
+  for (std::string_view path_component : absl::StrSplit(request_path_no_params, '/')) {
+    path_components->push_back(path_component);
   }
-  path_components_ = absl::StrSplit(request_path_no_params, '/');
 }
 
 double RequestPath::Similarity(const RequestPath& other) const {
@@ -141,6 +145,22 @@ bool RequestPath::Matches(const RequestPath& templ) const {
   return true;
 }
 
+bool RequestPath::Matches(const std::vector<std::string_view>& path_components,
+                          const RequestPath& templ) {
+  if (static_cast<int64_t>(path_components.size()) != templ.depth()) {
+    return false;
+  }
+  for (const auto& [i, path_component] : Enumerate(path_components)) {
+    if (templ.path_components()[i] == kAnyToken) {
+      continue;
+    }
+    if (path_component != templ.path_components()[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
 void RequestPathCluster::Merge(const RequestPathCluster& other_cluster) {
   MergeCentroids(other_cluster.centroid_);
   MergeMembers(other_cluster.members_);
@@ -333,6 +353,97 @@ void RequestPathClustering::Merge(const RequestPathClustering& other_clustering)
   }
 }
 
+CompiledRequestPathClustering::CompiledRequestPathClustering(
+    const RequestPathClustering& clustering) {
+  // Clusters are indexed in the same order that RequestPathClustering considers them, so that
+  // ties in similarity resolve to the same cluster.
+  for (const auto& cluster : clustering.clusters()) {
+    const auto& centroid = cluster.centroid();
+    auto& depth_index = depth_indices_[centroid.depth()];
+    if (depth_index.postings.empty()) {
+      depth_index.postings.resize(centroid.depth());
+    }
+    int32_t offset = depth_index.cluster_indices.size();
+    depth_index.cluster_indices.push_back(clusters_.size());
+
+    for (const auto& [i, path_component] : Enumerate(centroid.path_components())) {
+      if (path_component == RequestPath::kAnyToken) {
+        continue;
+      }
+      auto token_id = token_ids_.try_emplace(path_component, token_ids_.size()).first->second;
+      depth_index.postings[i][token_id].push_back(offset);
+    }
+
+    CompiledCluster compiled_cluster;
+    compiled_cluster.centroid = centroid.ToString();
+    for (const auto& member : cluster.members()) {
+      compiled_cluster.members.insert(member.ToString());
+    }
+    clusters_.push_back(std::move(compiled_cluster));
+  }
+}
+
+std::string_view CompiledRequestPathClustering::NormalizePath(std::string_view request_path) {
+  // Matches RequestPath::ToString, which drops the params and always has a leading "/".
+  auto request_path_no_params = request_path.substr(0, request_path.find('?'));
+  if (!request_path_no_params.empty() && request_path_no_params.front() == '/') {
+    return request_path_no_params;
+  }
+  normalized_path_.assign("/");
+  normalized_path_.append(request_path_no_params);
+  return normalized_path_;
+}
+
+std::string_view CompiledRequestPathClustering::Predict(std::string_view request_path) {
+  RequestPath::SplitPathComponents(request_path, &path_components_);
+  auto normalized_path = NormalizePath(request_path);
+
+  auto it = depth_indices_.find(path_components_.size());
+  if (it == depth_indices_.end()) {
+    return normalized_path;
+  }
+  const auto& depth_index = it->second;
+
+  // The similarity of each cluster is the number of path components equal to the centroid's,
+  // which is the number of postings the cluster shows up in.
+  scores_.assign(depth_index.cluster_indices.size(), 0);
+  for (const auto& [i, path_component] : Enumerate(path_components_)) {
+    if (path_component == RequestPath::kAnyToken) {
+      continue;
+    }
+    auto token_it = token_ids_.find(path_component);
+    if (token_it == token_ids_.end()) {
+      continue;
+    }
+    const auto& postings = depth_index.postings[i];
+    auto postings_it = postings.find(token_it->second);
+    if (postings_it == postings.end()) {
+      continue;
+    }
+    for (auto offset : postings_it->second) {
+      ++scores_[offset];
+    }
+  }
+
+  int64_t max_offset = -1;
+  int32_t max_score = 0;
+  for (const auto& [offset, score] : Enumerate(scores_)) {
+    if (score > max_score) {
+      max_offset = offset;
+      max_score = score;
+    }
+  }
+  if (max_offset == -1) {
+    return normalized_path;
+  }
+
+  const auto& cluster = clusters_[depth_index.cluster_indices[max_offset]];
+  if (cluster.members.contains(normalized_path)) {
+    return normalized_path;
+  }
+  return cluster.centroid;
+}
+
 }  // namespace builtins
 }  // namespace carnot
 }  // namespace px
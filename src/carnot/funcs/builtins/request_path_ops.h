@@ -83,6 +83,25 @@ class RequestPath {
    */
   bool Matches(const RequestPath& templ) const;
 
+  /**
+   * Same as Matches, but for a request path that was split with SplitPathComponents.
+   * @param path_components the path components of the request path to check.
+   * @param templ Template request path to match against.
+   * @return whether they match.
+   */
+  static bool Matches(const std::vector<std::string_view>& path_components,
+                      const RequestPath& templ);
+
+  /**
+   * Splits a request path into its path components, following the same rules as the RequestPath
+   * constructor (request params are dropped and a leading "/" is ignored). The components are
+   * views into request_path, so nothing is copied.
+   * @param request_path the unparsed request path.
+   * @param path_components output vector, cleared before the components are added.
+   */
+  static void SplitPathComponents(std::string_view request_path,
+                                  std::vector<std::string_view>* path_components);
+
   template <typename H>
   friend H AbslHashValue(H h, const RequestPath& request_path) {
     return H::combine(std::move(h), request_path.ToString());
@@ -207,8 +226,69 @@ class RequestPathClustering {
   double thresh_ = 0.5;
 };
 
+/**
+ * A read-only form of RequestPathClustering that is built once and used for prediction.
+ *
+ * Centroid path components are interned, and for each (depth, position) an index maps every
+ * interned token to the clusters whose centroid has that token at that position. Wildcard
+ * components never add to the similarity of a cluster, so they are left out of the index.
+ * Predicting then takes one token lookup per path component and a walk over the matching
+ * clusters, instead of a string comparison against every component of every centroid of the same
+ * depth. Predict works on views into its input and reuses scratch buffers between calls, so it
+ * doesn't allocate per request path.
+ */
+class CompiledRequestPathClustering {
+ public:
+  CompiledRequestPathClustering() = default;
+  explicit CompiledRequestPathClustering(const RequestPathClustering& clustering);
+
+  /**
+   * Equivalent to RequestPathClustering::Predict(RequestPath(request_path)).ToString().
+   * @param request_path request path to get prediction for.
+   * @return the predicted request path. The view is only valid until the next call to Predict.
+   */
+  std::string_view Predict(std::string_view request_path);
+
+ private:
+  struct CompiledCluster {
+    std::string centroid;
+    // Members of the cluster while it is below the minimum cardinality, see RequestPathCluster.
+    absl::flat_hash_set<std::string> members;
+  };
+
+  struct DepthIndex {
+    // Indices into clusters_ of the clusters with this depth, in the order they were added.
+    std::vector<int64_t> cluster_indices;
+    // For each path position, interned token -> offsets into cluster_indices.
+    std::vector<absl::flat_hash_map<int32_t, std::vector<int32_t>>> postings;
+  };
+
+  std::string_view NormalizePath(std::string_view request_path);
+
+  absl::flat_hash_map<std::string, int32_t> token_ids_;
+  absl::flat_hash_map<int64_t, DepthIndex> depth_indices_;
+  std::vector<CompiledCluster> clusters_;
+
+  // Scratch space reused across calls to Predict.
+  std::vector<std::string_view> path_components_;
+  std::vector<int32_t> scores_;
+  std::string normalized_path_;
+};
+
 class RequestPathClusteringPredictUDF : public udf::ScalarUDF {
  public:
+  // Called when the clustering is a constant, so that it's deserialized before the first record.
+  Status Init(FunctionContext*, StringValue serialized_clustering) {
+    auto clustering_or_s = RequestPathClustering::FromJSON(serialized_clustering);
+    if (!clustering_or_s.ok()) {
+      // Leave the clustering uninitialized so that Exec reports the error per record.
+      return Status::OK();
+    }
+    clustering_ = CompiledRequestPathClustering(clustering_or_s.ConsumeValueOrDie());
+    clustering_init_ = true;
+    return Status::OK();
+  }
+
   StringValue Exec(FunctionContext*, StringValue request_path_str,
                    StringValue serialized_clustering) {
     if (!clustering_init_) {
@@ -216,14 +296,13 @@ class RequestPathClusteringPredictUDF : public udf::ScalarUDF {
       if (!clustering_or_s.ok()) {
         return clustering_or_s.msg();
       }
-      clustering_ = clustering_or_s.ConsumeValueOrDie();
+      clustering_ = CompiledRequestPathClustering(clustering_or_s.ConsumeValueOrDie());
       clustering_init_ = true;
     }
-    auto request_path = RequestPath(request_path_str);
-    return clustering_.Predict(request_path).ToString();
+    return std::string(clustering_.Predict(request_path_str));
   }
 
-  RequestPathClustering clustering_;
+  CompiledRequestPathClustering clustering_;
   bool clustering_init_ = false;
 };
 
@@ -251,9 +330,25 @@ class RequestPathClusteringFitUDA : public udf::UDA {
 
 class RequestPathEndpointMatcherUDF : public udf::ScalarUDF {
  public:
+  // Called when endpoint is a constant, so that it's only parsed once.
+  Status Init(FunctionContext*, StringValue endpoint) {
+    endpoint_ = RequestPath(endpoint);
+    endpoint_init_ = true;
+    return Status::OK();
+  }
+
   BoolValue Exec(FunctionContext*, StringValue request_path, StringValue endpoint) {
-    return RequestPath(request_path).Matches(RequestPath(endpoint));
+    RequestPath::SplitPathComponents(request_path, &path_components_);
+    if (endpoint_init_) {
+      return RequestPath::Matches(path_components_, endpoint_);
+    }
+    return RequestPath::Matches(path_components_, RequestPath(endpoint));
   }
+
+ private:
+  std::vector<std::string_view> path_components_;
+  RequestPath endpoint_;
+  bool endpoint_init_ = false;
 };
 
 }  // namespace builtins
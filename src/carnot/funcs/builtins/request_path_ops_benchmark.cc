@@ -0,0 +1,94 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <benchmark/benchmark.h>
+
+#include <string>
+#include <vector>
+
+#include <absl/strings/substitute.h>
+
+#include "src/carnot/funcs/builtins/request_path_ops.h"
+#include "src/common/base/base.h"
+
+using px::carnot::builtins::CompiledRequestPathClustering;
+using px::carnot::builtins::RequestPath;
+using px::carnot::builtins::RequestPathCluster;
+using px::carnot::builtins::RequestPathClustering;
+
+namespace {
+
+constexpr int kNumIDsPerEndpoint = 16;
+constexpr int kNumRequestPaths = 1024;
+
+std::string EndpointPath(int endpoint, int id) {
+  return absl::Substitute("/service_$0/api/v1/resource_$0/$1?verbose=true", endpoint, id);
+}
+
+// Fits a clustering with num_endpoints clusters, each of the form
+// /service_<n>/api/v1/resource_<n>/*.
+RequestPathClustering FitClustering(int num_endpoints) {
+  RequestPathClustering clustering;
+  for (int id = 0; id < kNumIDsPerEndpoint; ++id) {
+    for (int endpoint = 0; endpoint < num_endpoints; ++endpoint) {
+      clustering.Update(RequestPathCluster(RequestPath(EndpointPath(endpoint, id))));
+    }
+  }
+  return clustering;
+}
+
+std::vector<std::string> GenerateRequestPaths(int num_endpoints) {
+  std::vector<std::string> request_paths;
+  request_paths.reserve(kNumRequestPaths);
+  for (int i = 0; i < kNumRequestPaths; ++i) {
+    request_paths.push_back(EndpointPath(i % num_endpoints, 1000 + i));
+  }
+  return request_paths;
+}
+
+}  // namespace
+
+// NOLINTNEXTLINE : runtime/references.
+static void BM_RequestPathClusteringPredict(benchmark::State& state) {
+  auto clustering = FitClustering(state.range(0));
+  auto request_paths = GenerateRequestPaths(state.range(0));
+
+  // NOLINTNEXTLINE : clang-analyzer-deadcode.DeadStores.
+  for (auto _ : state) {
+    for (const auto& request_path : request_paths) {
+      benchmark::DoNotOptimize(clustering.Predict(RequestPath(request_path)).ToString());
+    }
+  }
+  state.SetItemsProcessed(int64_t(state.iterations()) * request_paths.size());
+}
+
+// NOLINTNEXTLINE : runtime/references.
+static void BM_CompiledRequestPathClusteringPredict(benchmark::State& state) {
+  CompiledRequestPathClustering clustering(FitClustering(state.range(0)));
+  auto request_paths = GenerateRequestPaths(state.range(0));
+
+  // NOLINTNEXTLINE : clang-analyzer-deadcode.DeadStores.
+  for (auto _ : state) {
+    for (const auto& request_path : request_paths) {
+      benchmark::DoNotOptimize(clustering.Predict(request_path));
+    }
+  }
+  state.SetItemsProcessed(int64_t(state.iterations()) * request_paths.size());
+}
+
+BENCHMARK(BM_RequestPathClusteringPredict)->RangeMultiplier(4)->Range(1, 256);
+BENCHMARK(BM_CompiledRequestPathClusteringPredict)->RangeMultiplier(4)->Range(1, 256);
@@ -93,6 +93,51 @@ TEST(RequestPathClusteringPredict, basic_low_cardinality) {
   udf_tester.ForInput("/a/b/c", serialized_clustering).Expect("/a/b/c");
 }
 
+TEST(CompiledRequestPathClustering, matches_clustering_predict) {
+  auto uda_tester = udf::UDATester<RequestPathClusteringFitUDA>();
+  auto serialized_clustering = uda_tester.ForInput("/a/b/c")
+                                   .ForInput("/a/b/d")
+                                   .ForInput("a/b/a")
+                                   .ForInput("/a/b/b")
+                                   .ForInput("/a/b/e")
+                                   .ForInput("a/b/f")
+                                   .ForInput("/x/y")
+                                   .ForInput("/x/z")
+                                   .ForInput("/users/1/orders")
+                                   .Result();
+  ASSERT_OK_AND_ASSIGN(auto clustering, RequestPathClustering::FromJSON(serialized_clustering));
+  CompiledRequestPathClustering compiled(clustering);
+
+  for (const char* request_path : {"/a/b/c", "a/b/zzz", "/a/q/c?k=v", "/x/y", "x/z", "/x/*",
+                                   "/users/2/orders", "/users/1/orders"}) {
+    EXPECT_EQ(clustering.Predict(RequestPath(request_path)).ToString(),
+              compiled.Predict(request_path))
+        << request_path;
+  }
+}
+
+TEST(CompiledRequestPathClustering, no_matching_cluster) {
+  auto uda_tester = udf::UDATester<RequestPathClusteringFitUDA>();
+  auto serialized_clustering = uda_tester.ForInput("/a/b/c").ForInput("/a/b/d").Result();
+  ASSERT_OK_AND_ASSIGN(auto clustering, RequestPathClustering::FromJSON(serialized_clustering));
+  CompiledRequestPathClustering compiled(clustering);
+
+  // Paths that don't share a component with any centroid of their depth are returned as is.
+  EXPECT_EQ("/q/r/s", compiled.Predict("q/r/s?k=v"));
+  EXPECT_EQ("/a/b", compiled.Predict("/a/b"));
+  EXPECT_EQ("/", compiled.Predict(""));
+}
+
+TEST(RequestPath, split_path_components) {
+  std::vector<std::string_view> path_components;
+  RequestPath::SplitPathComponents("/a/b/c?k=v/d", &path_components);
+  EXPECT_THAT(path_components, ::testing::ElementsAre("a", "b", "c"));
+  RequestPath::SplitPathComponents("a//b", &path_components);
+  EXPECT_THAT(path_components, ::testing::ElementsAre("a", "", "b"));
+  RequestPath::SplitPathComponents("", &path_components);
+  EXPECT_THAT(path_components, ::testing::ElementsAre(""));
+}
+
 TEST(RequestPathEndpointMatcher, basic) {
   auto udf_tester = udf::UDFTester<RequestPathEndpointMatcherUDF>();
   udf_tester.ForInput("/a/b/c", "/a/b/*").Expect(true);
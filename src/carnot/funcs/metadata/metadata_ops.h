@@ -27,6 +27,8 @@
 #include <utility>
 #include <vector>
 
+#include <absl/container/flat_hash_map.h>
+
 #include "src/carnot/udf/registry.h"
 #include "src/carnot/udf/type_inference.h"
 #include "src/shared/metadata/metadata_state.h"
@@ -52,6 +54,50 @@ inline const px::md::AgentMetadataState* GetMetadataState(px::carnot::udf::Funct
   return md;
 }
 
+/**
+ * @brief MetadataLookupCache memoizes the results of a metadata lookup UDF.
+ *
+ * Lookup UDFs are evaluated once per row, but a batch typically only contains a handful of
+ * distinct UPIDs or pod IDs. Caching the resolved string per key turns the repeated metadata
+ * walk (and any string formatting) into a single hash lookup. Entries are only valid for the
+ * metadata snapshot they were computed against, so the cache is dropped whenever the UDF sees a
+ * different (or since updated) AgentMetadataState. The cache is also bounded; it is cleared once
+ * it reaches kMaxEntries so high cardinality columns can't grow it without bound.
+ */
+template <typename TKey>
+class MetadataLookupCache {
+ public:
+  static constexpr size_t kMaxEntries = 4096;
+
+  template <typename TLookupFn>
+  const std::string& GetOrCompute(const px::md::AgentMetadataState* md, const TKey& key,
+                                  TLookupFn lookup_fn) {
+    if (md != md_ || md->update_count() != md_update_count_) {
+      entries_.clear();
+      md_ = md;
+      md_update_count_ = md->update_count();
+    }
+    auto it = entries_.find(key);
+    if (it != entries_.end()) {
+      return it->second;
+    }
+    if (entries_.size() >= kMaxEntries) {
+      entries_.clear();
+    }
+    return entries_.emplace(key, lookup_fn()).first->second;
+  }
+
+  size_t size() const { return entries_.size(); }
+
+ private:
+  const px::md::AgentMetadataState* md_ = nullptr;
+  uint64_t md_update_count_ = 0;
+  absl::flat_hash_map<TKey, std::string> entries_;
+};
+
+using UPIDLookupCache = MetadataLookupCache<absl::uint128>;
+using PodIDLookupCache = MetadataLookupCache<std::string>;
+
 class ASIDUDF : public ScalarUDF {
  public:
   Int64Value Exec(FunctionContext* ctx) {
@@ -91,13 +137,14 @@ class PodIDToPodNameUDF : public ScalarUDF {
  public:
   StringValue Exec(FunctionContext* ctx, StringValue pod_id) {
     auto md = GetMetadataState(ctx);
+    return cache_.GetOrCompute(md, pod_id, [&]() -> StringValue {
+      const auto* pod_info = md->k8s_metadata_state().PodInfoByID(pod_id);
+      if (pod_info != nullptr) {
+        return absl::Substitute("$0/$1", pod_info->ns(), pod_info->name());
+      }
 
-    const auto* pod_info = md->k8s_metadata_state().PodInfoByID(pod_id);
-    if (pod_info != nullptr) {
-      return absl::Substitute("$0/$1", pod_info->ns(), pod_info->name());
-    }
-
-    return "";
+      return "";
+    });
   }
   static udf::InfRuleVec SemanticInferenceRules() {
     return {udf::ExplicitRule::Create<PodIDToPodNameUDF>(types::ST_POD_NAME, {types::ST_NONE})};
@@ -109,6 +156,9 @@ class PodIDToPodNameUDF : public ScalarUDF {
         .Arg("pod_id", "The pod ID of the pod to get the name for.")
         .Returns("The k8s pod name for the pod ID passed in.");
   }
+
+ private:
+  PodIDLookupCache cache_;
 };
 
 class PodNameToPodIDUDF : public ScalarUDF {
@@ -164,13 +214,14 @@ class PodIDToNamespaceUDF : public ScalarUDF {
  public:
   StringValue Exec(FunctionContext* ctx, StringValue pod_id) {
     auto md = GetMetadataState(ctx);
+    return cache_.GetOrCompute(md, pod_id, [&]() -> StringValue {
+      const auto* pod_info = md->k8s_metadata_state().PodInfoByID(pod_id);
+      if (pod_info != nullptr) {
+        return pod_info->ns();
+      }
 
-    const auto* pod_info = md->k8s_metadata_state().PodInfoByID(pod_id);
-    if (pod_info != nullptr) {
-      return pod_info->ns();
-    }
-
-    return "";
+      return "";
+    });
   }
   static udf::InfRuleVec SemanticInferenceRules() {
     return {
@@ -183,6 +234,9 @@ class PodIDToNamespaceUDF : public ScalarUDF {
         .Arg("pod_id", "The Pod ID of the Pod to get the namespace for.")
         .Returns("The k8s namespace for the Pod ID passed in.");
   }
+
+ private:
+  PodIDLookupCache cache_;
 };
 
 class PodNameToNamespaceUDF : public ScalarUDF {
@@ -213,14 +267,15 @@ class UPIDToContainerIDUDF : public ScalarUDF {
  public:
   StringValue Exec(FunctionContext* ctx, UInt128Value upid_value) {
     auto md = GetMetadataState(ctx);
-
-    auto upid_uint128 = absl::MakeUint128(upid_value.High64(), upid_value.Low64());
-    auto upid = md::UPID(upid_uint128);
-    auto pid = md->GetPIDByUPID(upid);
-    if (pid == nullptr) {
-      return "";
-    }
-    return pid->cid();
+    return cache_.GetOrCompute(md, upid_value.val, [&]() -> StringValue {
+      auto upid_uint128 = absl::MakeUint128(upid_value.High64(), upid_value.Low64());
+      auto upid = md::UPID(upid_uint128);
+      auto pid = md->GetPIDByUPID(upid);
+      if (pid == nullptr) {
+        return "";
+      }
+      return pid->cid();
+    });
   }
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder("Get the Kubernetes container ID from a UPID.")
@@ -233,6 +288,9 @@ class UPIDToContainerIDUDF : public ScalarUDF {
         .Arg("upid", "The UPID of the process to get the container ID for.")
         .Returns("The k8s container ID for the UPID passed in.");
   }
+
+ private:
+  UPIDLookupCache cache_;
 };
 
 inline const md::ContainerInfo* UPIDToContainer(const px::md::AgentMetadataState* md,
@@ -250,11 +308,13 @@ class UPIDToContainerNameUDF : public ScalarUDF {
  public:
   StringValue Exec(FunctionContext* ctx, UInt128Value upid_value) {
     auto md = GetMetadataState(ctx);
-    auto container_info = UPIDToContainer(md, upid_value);
-    if (container_info == nullptr) {
-      return "";
-    }
-    return std::string(container_info->name());
+    return cache_.GetOrCompute(md, upid_value.val, [&]() -> StringValue {
+      auto container_info = UPIDToContainer(md, upid_value);
+      if (container_info == nullptr) {
+        return "";
+      }
+      return std::string(container_info->name());
+    });
   }
   static udf::InfRuleVec SemanticInferenceRules() {
     return {udf::ExplicitRule::Create<UPIDToContainerNameUDF>(types::ST_CONTAINER_NAME,
@@ -271,6 +331,9 @@ class UPIDToContainerNameUDF : public ScalarUDF {
         .Arg("upid", "The UPID of the process to get the container name for.")
         .Returns("The k8s container name for the UPID passed in.");
   }
+
+ private:
+  UPIDLookupCache cache_;
 };
 
 inline const px::md::PodInfo* UPIDtoPod(const px::md::AgentMetadataState* md,
@@ -304,11 +367,13 @@ class UPIDToNamespaceUDF : public ScalarUDF {
  public:
   StringValue Exec(FunctionContext* ctx, UInt128Value upid_value) {
     auto md = GetMetadataState(ctx);
-    auto pod_info = UPIDtoPod(md, upid_value);
-    if (pod_info == nullptr) {
-      return "";
-    }
-    return pod_info->ns();
+    return cache_.GetOrCompute(md, upid_value.val, [&]() -> StringValue {
+      auto pod_info = UPIDtoPod(md, upid_value);
+      if (pod_info == nullptr) {
+        return "";
+      }
+      return pod_info->ns();
+    });
   }
   static udf::InfRuleVec SemanticInferenceRules() {
     return {
@@ -325,17 +390,22 @@ class UPIDToNamespaceUDF : public ScalarUDF {
         .Arg("upid", "The UPID of the process to get the namespace for.")
         .Returns("The k8s namespace for the UPID passed in.");
   }
+
+ private:
+  UPIDLookupCache cache_;
 };
 
 class UPIDToPodIDUDF : public ScalarUDF {
  public:
   StringValue Exec(FunctionContext* ctx, UInt128Value upid_value) {
     auto md = GetMetadataState(ctx);
-    auto container_info = UPIDToContainer(md, upid_value);
-    if (container_info == nullptr) {
-      return "";
-    }
-    return std::string(container_info->pod_id());
+    return cache_.GetOrCompute(md, upid_value.val, [&]() -> StringValue {
+      auto container_info = UPIDToContainer(md, upid_value);
+      if (container_info == nullptr) {
+        return "";
+      }
+      return std::string(container_info->pod_id());
+    });
   }
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder("Get the Kubernetes Pod ID from a UPID.")
@@ -348,17 +418,22 @@ class UPIDToPodIDUDF : public ScalarUDF {
         .Arg("upid", "The UPID of the process to get the pod ID for.")
         .Returns("The k8s pod ID for the UPID passed in.");
   }
+
+ private:
+  UPIDLookupCache cache_;
 };
 
 class UPIDToPodNameUDF : public ScalarUDF {
  public:
   StringValue Exec(FunctionContext* ctx, UInt128Value upid_value) {
     auto md = GetMetadataState(ctx);
-    auto pod_info = UPIDtoPod(md, upid_value);
-    if (pod_info == nullptr) {
-      return "";
-    }
-    return absl::Substitute("$0/$1", pod_info->ns(), pod_info->name());
+    return cache_.GetOrCompute(md, upid_value.val, [&]() -> StringValue {
+      auto pod_info = UPIDtoPod(md, upid_value);
+      if (pod_info == nullptr) {
+        return "";
+      }
+      return absl::Substitute("$0/$1", pod_info->ns(), pod_info->name());
+    });
   }
   static udf::InfRuleVec SemanticInferenceRules() {
     return {udf::ExplicitRule::Create<UPIDToPodNameUDF>(types::ST_POD_NAME, {types::ST_NONE})};
@@ -374,6 +449,9 @@ class UPIDToPodNameUDF : public ScalarUDF {
         .Arg("upid", "The UPID of the process to get the pod name for.")
         .Returns("The k8s pod name for the UPID passed in.");
   }
+
+ private:
+  UPIDLookupCache cache_;
 };
 
 class ServiceIDToServiceNameUDF : public ScalarUDF {
@@ -469,22 +547,24 @@ class UPIDToServiceIDUDF : public ScalarUDF {
  public:
   StringValue Exec(FunctionContext* ctx, UInt128Value upid_value) {
     auto md = GetMetadataState(ctx);
-    auto pod_info = UPIDtoPod(md, upid_value);
-    if (pod_info == nullptr || pod_info->services().size() == 0) {
-      return "";
-    }
-    std::vector<std::string> running_service_ids;
-    for (const auto& service_id : pod_info->services()) {
-      auto service_info = md->k8s_metadata_state().ServiceInfoByID(service_id);
-      if (service_info == nullptr) {
-        continue;
+    return cache_.GetOrCompute(md, upid_value.val, [&]() -> StringValue {
+      auto pod_info = UPIDtoPod(md, upid_value);
+      if (pod_info == nullptr || pod_info->services().size() == 0) {
+        return "";
       }
-      if (service_info->stop_time_ns() == 0) {
-        running_service_ids.push_back(service_id);
+      std::vector<std::string> running_service_ids;
+      for (const auto& service_id : pod_info->services()) {
+        auto service_info = md->k8s_metadata_state().ServiceInfoByID(service_id);
+        if (service_info == nullptr) {
+          continue;
+        }
+        if (service_info->stop_time_ns() == 0) {
+          running_service_ids.push_back(service_id);
+        }
       }
-    }
 
-    return StringifyVector(running_service_ids);
+      return StringifyVector(running_service_ids);
+    });
   }
 
   static udf::ScalarUDFDocBuilder Doc() {
@@ -499,6 +579,9 @@ class UPIDToServiceIDUDF : public ScalarUDF {
         .Arg("upid", "The UPID of the process to get the service ID for.")
         .Returns("The kubernetes service ID for the UPID passed in.");
   }
+
+ private:
+  UPIDLookupCache cache_;
 };
 
 /**
@@ -508,22 +591,24 @@ class UPIDToServiceNameUDF : public ScalarUDF {
  public:
   StringValue Exec(FunctionContext* ctx, UInt128Value upid_value) {
     auto md = GetMetadataState(ctx);
-    auto pod_info = UPIDtoPod(md, upid_value);
-    if (pod_info == nullptr || pod_info->services().size() == 0) {
-      return "";
-    }
-    std::vector<std::string> running_service_names;
-    for (const auto& service_id : pod_info->services()) {
-      auto service_info = md->k8s_metadata_state().ServiceInfoByID(service_id);
-      if (service_info == nullptr) {
-        continue;
+    return cache_.GetOrCompute(md, upid_value.val, [&]() -> StringValue {
+      auto pod_info = UPIDtoPod(md, upid_value);
+      if (pod_info == nullptr || pod_info->services().size() == 0) {
+        return "";
       }
-      if (service_info->stop_time_ns() == 0) {
-        running_service_names.push_back(
-            absl::Substitute("$0/$1", service_info->ns(), service_info->name()));
+      std::vector<std::string> running_service_names;
+      for (const auto& service_id : pod_info->services()) {
+        auto service_info = md->k8s_metadata_state().ServiceInfoByID(service_id);
+        if (service_info == nullptr) {
+          continue;
+        }
+        if (service_info->stop_time_ns() == 0) {
+          running_service_names.push_back(
+              absl::Substitute("$0/$1", service_info->ns(), service_info->name()));
+        }
       }
-    }
-    return StringifyVector(running_service_names);
+      return StringifyVector(running_service_names);
+    });
   }
   static udf::InfRuleVec SemanticInferenceRules() {
     return {
@@ -542,6 +627,9 @@ class UPIDToServiceNameUDF : public ScalarUDF {
         .Arg("upid", "The UPID of the process to get the service name for.")
         .Returns("The Kubernetes Service Name for the UPID passed in.");
   }
+
+ private:
+  UPIDLookupCache cache_;
 };
 
 /**
@@ -551,12 +639,14 @@ class UPIDToNodeNameUDF : public ScalarUDF {
  public:
   StringValue Exec(FunctionContext* ctx, UInt128Value upid_value) {
     auto md = GetMetadataState(ctx);
-    auto pod_info = UPIDtoPod(md, upid_value);
-    if (pod_info == nullptr) {
-      return "";
-    }
-    std::string foo = std::string(pod_info->node_name());
-    return foo;
+    return cache_.GetOrCompute(md, upid_value.val, [&]() -> StringValue {
+      auto pod_info = UPIDtoPod(md, upid_value);
+      if (pod_info == nullptr) {
+        return "";
+      }
+      std::string foo = std::string(pod_info->node_name());
+      return foo;
+    });
   }
   static udf::InfRuleVec SemanticInferenceRules() {
     return {udf::ExplicitRule::Create<UPIDToNodeNameUDF>(types::ST_NODE_NAME, {types::ST_NONE})};
@@ -571,6 +661,9 @@ class UPIDToNodeNameUDF : public ScalarUDF {
         .Arg("upid", "The UPID of the process to get the node name for.")
         .Returns("The name of the node for the UPID passed in.");
   }
+
+ private:
+  UPIDLookupCache cache_;
 };
 
 /**
@@ -580,11 +673,13 @@ class UPIDToHostnameUDF : public ScalarUDF {
  public:
   StringValue Exec(FunctionContext* ctx, UInt128Value upid_value) {
     auto md = GetMetadataState(ctx);
-    auto pod_info = UPIDtoPod(md, upid_value);
-    if (pod_info == nullptr) {
-      return "";
-    }
-    return pod_info->hostname();
+    return cache_.GetOrCompute(md, upid_value.val, [&]() -> StringValue {
+      auto pod_info = UPIDtoPod(md, upid_value);
+      if (pod_info == nullptr) {
+        return "";
+      }
+      return pod_info->hostname();
+    });
   }
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder("Get the Hostname from a UPID.")
@@ -596,6 +691,9 @@ class UPIDToHostnameUDF : public ScalarUDF {
         .Arg("upid", "The UPID of the process to get the hostname for.")
         .Returns("The hostname for the UPID passed in.");
   }
+
+ private:
+  UPIDLookupCache cache_;
 };
 
 /**
@@ -605,24 +703,25 @@ class PodIDToServiceNameUDF : public ScalarUDF {
  public:
   StringValue Exec(FunctionContext* ctx, StringValue pod_id) {
     auto md = GetMetadataState(ctx);
-
-    const auto* pod_info = md->k8s_metadata_state().PodInfoByID(pod_id);
-    if (pod_info == nullptr) {
-      return "";
-    }
-
-    std::vector<std::string> running_service_names;
-    for (const auto& service_id : pod_info->services()) {
-      auto service_info = md->k8s_metadata_state().ServiceInfoByID(service_id);
-      if (service_info == nullptr) {
-        continue;
+    return cache_.GetOrCompute(md, pod_id, [&]() -> StringValue {
+      const auto* pod_info = md->k8s_metadata_state().PodInfoByID(pod_id);
+      if (pod_info == nullptr) {
+        return "";
       }
-      if (service_info->stop_time_ns() == 0) {
-        running_service_names.push_back(
-            absl::Substitute("$0/$1", service_info->ns(), service_info->name()));
+
+      std::vector<std::string> running_service_names;
+      for (const auto& service_id : pod_info->services()) {
+        auto service_info = md->k8s_metadata_state().ServiceInfoByID(service_id);
+        if (service_info == nullptr) {
+          continue;
+        }
+        if (service_info->stop_time_ns() == 0) {
+          running_service_names.push_back(
+              absl::Substitute("$0/$1", service_info->ns(), service_info->name()));
+        }
       }
-    }
-    return StringifyVector(running_service_names);
+      return StringifyVector(running_service_names);
+    });
   }
   static udf::InfRuleVec SemanticInferenceRules() {
     return {
@@ -638,6 +737,9 @@ class PodIDToServiceNameUDF : public ScalarUDF {
         .Arg("pod_id", "The Pod ID of the Pod to get service name for.")
         .Returns("The k8s service name for the Pod ID passed in.");
   }
+
+ private:
+  PodIDLookupCache cache_;
 };
 
 /**
@@ -647,23 +749,24 @@ class PodIDToServiceIDUDF : public ScalarUDF {
  public:
   StringValue Exec(FunctionContext* ctx, StringValue pod_id) {
     auto md = GetMetadataState(ctx);
-
-    const auto* pod_info = md->k8s_metadata_state().PodInfoByID(pod_id);
-    if (pod_info == nullptr) {
-      return "";
-    }
-
-    std::vector<std::string> running_service_ids;
-    for (const auto& service_id : pod_info->services()) {
-      auto service_info = md->k8s_metadata_state().ServiceInfoByID(service_id);
-      if (service_info == nullptr) {
-        continue;
+    return cache_.GetOrCompute(md, pod_id, [&]() -> StringValue {
+      const auto* pod_info = md->k8s_metadata_state().PodInfoByID(pod_id);
+      if (pod_info == nullptr) {
+        return "";
       }
-      if (service_info->stop_time_ns() == 0) {
-        running_service_ids.push_back(service_id);
+
+      std::vector<std::string> running_service_ids;
+      for (const auto& service_id : pod_info->services()) {
+        auto service_info = md->k8s_metadata_state().ServiceInfoByID(service_id);
+        if (service_info == nullptr) {
+          continue;
+        }
+        if (service_info->stop_time_ns() == 0) {
+          running_service_ids.push_back(service_id);
+        }
       }
-    }
-    return StringifyVector(running_service_ids);
+      return StringifyVector(running_service_ids);
+    });
   }
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder("Get the service ID for a given pod ID.")
@@ -674,6 +777,9 @@ class PodIDToServiceIDUDF : public ScalarUDF {
         .Arg("pod_id", "The Pod ID of the Pod to get service ID for.")
         .Returns("The k8s service ID for the Pod ID passed in.");
   }
+
+ private:
+  PodIDLookupCache cache_;
 };
 
 /**
@@ -683,13 +789,14 @@ class PodIDToNodeNameUDF : public ScalarUDF {
  public:
   StringValue Exec(FunctionContext* ctx, StringValue pod_id) {
     auto md = GetMetadataState(ctx);
-
-    const auto* pod_info = md->k8s_metadata_state().PodInfoByID(pod_id);
-    if (pod_info == nullptr) {
-      return "";
-    }
-    std::string foo = std::string(pod_info->node_name());
-    return foo;
+    return cache_.GetOrCompute(md, pod_id, [&]() -> StringValue {
+      const auto* pod_info = md->k8s_metadata_state().PodInfoByID(pod_id);
+      if (pod_info == nullptr) {
+        return "";
+      }
+      std::string foo = std::string(pod_info->node_name());
+      return foo;
+    });
   }
   static udf::InfRuleVec SemanticInferenceRules() {
     return {udf::ExplicitRule::Create<PodIDToNodeNameUDF>(types::ST_NODE_NAME, {types::ST_NONE})};
@@ -703,6 +810,9 @@ class PodIDToNodeNameUDF : public ScalarUDF {
         .Arg("pod_id", "The Pod ID of the Pod to get the node name for.")
         .Returns("The k8s node name for the Pod ID passed in.");
   }
+
+ private:
+  PodIDLookupCache cache_;
 };
 
 /**
@@ -1254,7 +1364,9 @@ class UPIDToPodStatusUDF : public ScalarUDF {
    */
   StringValue Exec(FunctionContext* ctx, UInt128Value upid_value) {
     auto md = GetMetadataState(ctx);
-    return PodInfoToPodStatus(UPIDtoPod(md, upid_value));
+    return cache_.GetOrCompute(md, upid_value.val, [&]() -> StringValue {
+      return PodInfoToPodStatus(UPIDtoPod(md, upid_value));
+    });
   }
 
   static udf::InfRuleVec SemanticInferenceRules() {
@@ -1276,6 +1388,9 @@ class UPIDToPodStatusUDF : public ScalarUDF {
         .Arg("upid", "The UPID to get the PodStatus for.")
         .Returns("The Kubernetes PodStatus for the UPID passed in.");
   }
+
+ private:
+  UPIDLookupCache cache_;
 };
 
 class UPIDToCmdLineUDF : public ScalarUDF {
@@ -1289,13 +1404,15 @@ class UPIDToCmdLineUDF : public ScalarUDF {
    */
   StringValue Exec(FunctionContext* ctx, UInt128Value upid_value) {
     auto md = GetMetadataState(ctx);
-    auto upid_uint128 = absl::MakeUint128(upid_value.High64(), upid_value.Low64());
-    auto upid = md::UPID(upid_uint128);
-    auto pid_info = md->GetPIDByUPID(upid);
-    if (pid_info == nullptr) {
-      return "";
-    }
-    return pid_info->cmdline();
+    return cache_.GetOrCompute(md, upid_value.val, [&]() -> StringValue {
+      auto upid_uint128 = absl::MakeUint128(upid_value.High64(), upid_value.Low64());
+      auto upid = md::UPID(upid_uint128);
+      auto pid_info = md->GetPIDByUPID(upid);
+      if (pid_info == nullptr) {
+        return "";
+      }
+      return pid_info->cmdline();
+    });
   }
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder("Get the command line arguments used to start a UPID.")
@@ -1306,6 +1423,9 @@ class UPIDToCmdLineUDF : public ScalarUDF {
         .Arg("upid", "The UPID to get the command line arguments for.")
         .Returns("The command line arguments for the UPID passed in, as a string.");
   }
+
+ private:
+  UPIDLookupCache cache_;
 };
 
 inline std::string PodInfoToPodQoS(const px::md::PodInfo* pod_info) {
@@ -1326,7 +1446,9 @@ class UPIDToPodQoSUDF : public ScalarUDF {
    */
   StringValue Exec(FunctionContext* ctx, UInt128Value upid_value) {
     auto md = GetMetadataState(ctx);
-    return PodInfoToPodQoS(UPIDtoPod(md, upid_value));
+    return cache_.GetOrCompute(md, upid_value.val, [&]() -> StringValue {
+      return PodInfoToPodQoS(UPIDtoPod(md, upid_value));
+    });
   }
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder("Get the Kubernetes QOS class for the UPID.")
@@ -1340,6 +1462,9 @@ class UPIDToPodQoSUDF : public ScalarUDF {
         .Arg("upid", "The UPID to get the Pod QOS class for.")
         .Returns("The Kubernetes Pod QOS class for the UPID passed in.");
   }
+
+ private:
+  UPIDLookupCache cache_;
 };
 
 class HostnameUDF : public ScalarUDF {
@@ -611,6 +611,63 @@ TEST_F(MetadataOpsTest, service_name_to_namespace_test) {
   udf_tester.ForInput("").Expect("");
 }
 
+TEST_F(MetadataOpsTest, upid_lookup_cache_reuses_results) {
+  auto function_ctx = std::make_unique<FunctionContext>(metadata_state_, nullptr);
+  UPIDToPodNameUDF udf;
+  auto upid1 = types::UInt128Value(528280977975, 89101);
+  auto upid2 = types::UInt128Value(528280977975, 468);
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_EQ("pl/running_pod", udf.Exec(function_ctx.get(), upid1));
+    EXPECT_EQ("pl/terminating_pod", udf.Exec(function_ctx.get(), upid2));
+  }
+
+  // A cache only ever holds one result per key.
+  UPIDLookupCache cache;
+  int num_lookups = 0;
+  auto lookup = [&]() -> StringValue {
+    ++num_lookups;
+    return "pl/running_pod";
+  };
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_EQ("pl/running_pod", cache.GetOrCompute(metadata_state_.get(), upid1.val, lookup));
+  }
+  EXPECT_EQ(1, num_lookups);
+  EXPECT_EQ(1U, cache.size());
+}
+
+TEST_F(MetadataOpsTest, upid_lookup_cache_invalidated_on_new_state) {
+  UPIDLookupCache cache;
+  auto upid1 = types::UInt128Value(528280977975, 89101);
+  int num_lookups = 0;
+  auto lookup = [&]() -> StringValue {
+    ++num_lookups;
+    return "";
+  };
+  cache.GetOrCompute(metadata_state_.get(), upid1.val, lookup);
+  EXPECT_EQ(1, num_lookups);
+
+  // A different snapshot must not be served results computed against the old one.
+  auto new_state = metadata_state_->CloneToShared();
+  cache.GetOrCompute(new_state.get(), upid1.val, lookup);
+  EXPECT_EQ(2, num_lookups);
+
+  // Neither should the same snapshot after it has been updated.
+  new_state->MarkUPIDAsStopped(md::UPID(123, 567, 89101), 100);
+  cache.GetOrCompute(new_state.get(), upid1.val, lookup);
+  EXPECT_EQ(3, num_lookups);
+}
+
+TEST_F(MetadataOpsTest, pod_id_lookup_cache_invalidated_on_update) {
+  auto function_ctx = std::make_unique<FunctionContext>(metadata_state_, nullptr);
+  PodIDToServiceIDUDF udf;
+  EXPECT_EQ("3_uid", udf.Exec(function_ctx.get(), "1_uid"));
+
+  updates_->enqueue(px::metadatapb::testutils::CreateServiceWithSamePodUpdatePB());
+  EXPECT_OK(px::md::ApplyK8sUpdates(11, metadata_state_.get(), &md_filter_, updates_.get()));
+  EXPECT_THAT(udf.Exec(function_ctx.get(), "1_uid"),
+              AnyOf("[\"3_uid\",\"5_uid\"]", "[\"5_uid\",\"3_uid\"]"));
+}
+
 }  // namespace metadata
 }  // namespace funcs
 }  // namespace carnot
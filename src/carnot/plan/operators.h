@@ -143,6 +143,11 @@ class AggregateOperator : public Operator {
   const std::vector<GroupInfo>& groups() const { return groups_; }
   const std::vector<std::shared_ptr<AggregateExpression>>& values() const { return values_; }
   bool windowed() const { return pb_.windowed(); }
+  bool partial_agg() const { return pb_.partial_agg(); }
+  bool finalize_results() const { return pb_.finalize_results(); }
+  bool HasWindowGroup() const { return pb_.has_window_group_idx(); }
+  int64_t window_group_idx() const { return pb_.window_group_idx().value(); }
+  int64_t allowed_lateness_ns() const { return pb_.allowed_lateness_ns(); }
 
  private:
   std::vector<std::shared_ptr<AggregateExpression>> values_;
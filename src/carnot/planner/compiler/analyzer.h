@@ -101,6 +101,7 @@ class Analyzer : public RuleExecutor<IR> {
     RuleBatch* resolution_verification_batch =
         CreateRuleBatch<FailOnMax>("ResolutionVerification", 1);
     resolution_verification_batch->AddRule<VerifyFilterExpressionRule>(compiler_state_);
+    resolution_verification_batch->AddRule<VerifyWindowedAggRule>(compiler_state_);
   }
 
   void CreateRemoveIROnlyNodesBatch() {
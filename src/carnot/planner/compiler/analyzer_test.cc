@@ -1000,6 +1000,54 @@ TEST_F(AnalyzerTest, map_only_streaming_test) {
   EXPECT_TRUE(static_cast<MemorySourceIR*>(srcs[0])->streaming());
 }
 
+constexpr char kWindowedAggStreamQuery[] = R"query(
+import px
+df = px.DataFrame(table='http_events')
+df.window = px.bin(df.time_, px.seconds(10))
+df = df.groupby(['window']).agg(count=('http_resp_latency_ns', px.count))
+px.display(df.stream())
+)query";
+
+TEST_F(AnalyzerTest, windowed_agg_streaming_test) {
+  auto ir_graph_status = CompileGraph(kWindowedAggStreamQuery);
+  ASSERT_OK(ir_graph_status);
+  auto ir_graph = ir_graph_status.ConsumeValueOrDie();
+  ASSERT_OK(HandleRelation(ir_graph));
+
+  auto srcs = ir_graph->FindNodesThatMatch(MemorySource());
+  ASSERT_EQ(1, srcs.size());
+  EXPECT_TRUE(static_cast<MemorySourceIR*>(srcs[0])->streaming());
+
+  auto aggs = ir_graph->FindNodesThatMatch(BlockingAgg());
+  ASSERT_EQ(1, aggs.size());
+  auto agg = static_cast<BlockingAggIR*>(aggs[0]);
+  EXPECT_TRUE(agg->windowed());
+  // Rows may be late by the configured lateness, plus the width of the windows.
+  EXPECT_EQ(FLAGS_planner_stream_agg_allowed_lateness_ms * 1000 * 1000,
+            agg->allowed_lateness_ns());
+  EXPECT_EQ(10LL * 1000 * 1000 * 1000, agg->window_width_ns());
+
+  planpb::Operator pb;
+  ASSERT_OK(agg->ToProto(&pb));
+  EXPECT_EQ(agg->allowed_lateness_ns() + agg->window_width_ns(), pb.agg_op().allowed_lateness_ns());
+}
+
+constexpr char kUnwindowedAggStreamQuery[] = R"query(
+import px
+df = px.DataFrame(table='http_events')
+df = df.groupby(['http_resp_status']).agg(count=('http_resp_latency_ns', px.count))
+px.display(df.stream())
+)query";
+
+TEST_F(AnalyzerTest, unwindowed_agg_streaming_test) {
+  auto ir_graph_status = CompileGraph(kUnwindowedAggStreamQuery);
+  ASSERT_OK(ir_graph_status);
+  auto ir_graph = ir_graph_status.ConsumeValueOrDie();
+  auto handle_status = HandleRelation(ir_graph);
+  ASSERT_NOT_OK(handle_status);
+  EXPECT_THAT(handle_status, HasCompilerError("must group by exactly one time column"));
+}
+
 }  // namespace compiler
 }  // namespace planner
 }  // namespace carnot
@@ -0,0 +1,124 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/planner/compiler/optimizer/join_build_side.h"
+
+#include <algorithm>
+#include <string>
+
+namespace px {
+namespace carnot {
+namespace planner {
+namespace compiler {
+
+std::optional<double> OperatorSizeEstimator::EstimateBytes(OperatorIR* op) {
+  auto it = estimates_.find(op->id());
+  if (it != estimates_.end()) {
+    return it->second;
+  }
+  auto estimate = EstimateBytesImpl(op);
+  estimates_[op->id()] = estimate;
+  return estimate;
+}
+
+std::optional<double> OperatorSizeEstimator::EstimateMemorySourceBytes(MemorySourceIR* mem_src) {
+  const TableSizeMap& table_sizes = compiler_state_->table_sizes();
+  auto size_it = table_sizes.find(mem_src->table_name());
+  if (size_it == table_sizes.end()) {
+    return std::nullopt;
+  }
+  double bytes = static_cast<double>(size_it->second);
+
+  // Scale by the fraction of the table's columns that the source reads.
+  auto relation_it = compiler_state_->relation_map()->find(mem_src->table_name());
+  if (relation_it != compiler_state_->relation_map()->end() &&
+      relation_it->second.NumColumns() > 0 && !mem_src->select_all()) {
+    bytes *= static_cast<double>(mem_src->column_names().size()) /
+             static_cast<double>(relation_it->second.NumColumns());
+  }
+  return bytes;
+}
+
+std::optional<double> OperatorSizeEstimator::EstimateBytesImpl(OperatorIR* op) {
+  if (Match(op, MemorySource())) {
+    return EstimateMemorySourceBytes(static_cast<MemorySourceIR*>(op));
+  }
+  if (op->parents().empty()) {
+    // UDTF sources, empty sources and sources from other agents have unknown sizes.
+    return std::nullopt;
+  }
+
+  double total = 0;
+  double largest = 0;
+  for (OperatorIR* parent : op->parents()) {
+    auto parent_bytes = EstimateBytes(parent);
+    if (!parent_bytes.has_value()) {
+      return std::nullopt;
+    }
+    total += *parent_bytes;
+    largest = std::max(largest, *parent_bytes);
+  }
+
+  if (Match(op, Filter())) {
+    return total * kFilterSelectivity;
+  }
+  if (Match(op, BlockingAgg())) {
+    if (static_cast<BlockingAggIR*>(op)->groups().empty()) {
+      return kRowBytes;
+    }
+    return total * kGroupedAggSelectivity;
+  }
+  if (Match(op, Join())) {
+    // Assume the join keys are mostly unique on one side, so each row of the larger input
+    // matches about one row of the smaller input.
+    return largest;
+  }
+  // Unions output all of their inputs, every other operator is assumed to keep its input size.
+  return total;
+}
+
+StatusOr<bool> JoinBuildSideRule::Apply(IRNode* ir_node) {
+  if (!Match(ir_node, Join())) {
+    return false;
+  }
+  auto join = static_cast<JoinIR*>(ir_node);
+  if (join->join_type() != JoinIR::JoinType::kInner &&
+      join->join_type() != JoinIR::JoinType::kOuter) {
+    return false;
+  }
+  const auto& column_names = join->column_names();
+  if (std::find(column_names.begin(), column_names.end(), "time_") != column_names.end()) {
+    return false;
+  }
+
+  DCHECK_EQ(join->parents().size(), 2UL);
+  auto build_bytes = estimator_.EstimateBytes(join->parents()[0]);
+  auto probe_bytes = estimator_.EstimateBytes(join->parents()[1]);
+  if (!build_bytes.has_value() || !probe_bytes.has_value() || *build_bytes <= *probe_bytes) {
+    return false;
+  }
+  VLOG(1) << absl::Substitute("Swapping the inputs of $0, build side: $1 bytes, probe side: $2",
+                              join->DebugString(), *build_bytes, *probe_bytes);
+  PL_RETURN_IF_ERROR(join->SwapParents());
+  return true;
+}
+
+}  // namespace compiler
+}  // namespace planner
+}  // namespace carnot
+}  // namespace px
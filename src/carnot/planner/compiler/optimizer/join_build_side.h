@@ -0,0 +1,89 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+#include <optional>
+
+#include <absl/container/flat_hash_map.h>
+
+#include "src/carnot/planner/compiler_state/compiler_state.h"
+#include "src/carnot/planner/ir/ir_nodes.h"
+#include "src/carnot/planner/rules/rules.h"
+
+namespace px {
+namespace carnot {
+namespace planner {
+namespace compiler {
+
+/**
+ * @brief Estimates the number of bytes that operators output, starting from the table sizes in
+ * the compiler state. The estimates are coarse: they are only meant to rank the inputs of an
+ * operator against each other.
+ */
+class OperatorSizeEstimator {
+ public:
+  // The fraction of its input that a filter is assumed to keep.
+  static constexpr double kFilterSelectivity = 0.5;
+  // The fraction of its input that a grouped aggregate is assumed to output.
+  static constexpr double kGroupedAggSelectivity = 0.1;
+  // The size assumed for a single row, i.e. the output of an aggregate without groups.
+  static constexpr double kRowBytes = 64;
+
+  explicit OperatorSizeEstimator(CompilerState* compiler_state)
+      : compiler_state_(compiler_state) {}
+
+  /**
+   * @brief Returns the estimated number of bytes that the operator outputs, or std::nullopt if
+   * the operator reads from a source with an unknown size.
+   */
+  std::optional<double> EstimateBytes(OperatorIR* op);
+
+ private:
+  std::optional<double> EstimateBytesImpl(OperatorIR* op);
+  std::optional<double> EstimateMemorySourceBytes(MemorySourceIR* mem_src);
+
+  CompilerState* compiler_state_;
+  absl::flat_hash_map<int64_t, std::optional<double>> estimates_;
+};
+
+/**
+ * @brief Makes the smaller input of each inner and outer join its left input, which the
+ * EquijoinNode buffers as the build side while it streams the right input as the probe side.
+ *
+ * Left joins are skipped because swapping their inputs would turn them into right joins, which the
+ * executor doesn't support. Joins that output time_ are skipped too: they probe with the input
+ * that supplies time_ to keep the output ordered. Joins with an input of unknown size are left as
+ * written.
+ */
+class JoinBuildSideRule : public Rule {
+ public:
+  explicit JoinBuildSideRule(CompilerState* compiler_state)
+      : Rule(compiler_state, /*use_topo*/ true, /*reverse_topological_execution*/ false),
+        estimator_(compiler_state) {}
+
+ protected:
+  StatusOr<bool> Apply(IRNode* ir_node) override;
+
+ private:
+  OperatorSizeEstimator estimator_;
+};
+
+}  // namespace compiler
+}  // namespace planner
+}  // namespace carnot
+}  // namespace px
@@ -0,0 +1,140 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+
+#include "src/carnot/planner/compiler/analyzer.h"
+#include "src/carnot/planner/compiler/optimizer/join_build_side.h"
+#include "src/carnot/planner/compiler/test_utils.h"
+
+namespace px {
+namespace carnot {
+namespace planner {
+namespace compiler {
+
+using ::testing::ElementsAre;
+
+constexpr char kJoinQueryTpl[] = R"query(
+import px
+src1 = px.DataFrame(table='cpu', select=['upid', 'cpu0', 'cpu1'])
+src2 = px.DataFrame(table='network', select=['bytes_in', 'upid', 'bytes_out'])
+join = src1.merge(src2, how='$0', left_on=['upid'], right_on=['upid'], suffixes=['', '_x'])
+px.display(join, 'joined')
+)query";
+
+class JoinBuildSideTest : public ASTVisitorTest {
+ protected:
+  StatusOr<std::shared_ptr<IR>> CompileAndAnalyze(const std::string& join_type) {
+    PL_ASSIGN_OR_RETURN(auto ir_graph, CompileGraph(absl::Substitute(kJoinQueryTpl, join_type)));
+    PL_ASSIGN_OR_RETURN(std::unique_ptr<Analyzer> analyzer,
+                        Analyzer::Create(compiler_state_.get()));
+    PL_RETURN_IF_ERROR(analyzer->Execute(ir_graph.get()));
+    return ir_graph;
+  }
+
+  JoinIR* GetJoin(IR* ir_graph) {
+    auto joins = ir_graph->FindNodesThatMatch(Join());
+    CHECK_EQ(joins.size(), 1UL);
+    return static_cast<JoinIR*>(joins[0]);
+  }
+};
+
+TEST_F(JoinBuildSideTest, smaller_input_becomes_build_side) {
+  compiler_state_->set_table_sizes({{"cpu", 100000}, {"network", 1000}});
+  ASSERT_OK_AND_ASSIGN(auto ir_graph, CompileAndAnalyze("inner"));
+  JoinIR* join = GetJoin(ir_graph.get());
+  OperatorIR* cpu_src = join->parents()[0];
+  OperatorIR* network_src = join->parents()[1];
+
+  JoinBuildSideRule rule(compiler_state_.get());
+  ASSERT_OK_AND_ASSIGN(bool did_swap, rule.Execute(ir_graph.get()));
+  EXPECT_TRUE(did_swap);
+
+  EXPECT_THAT(join->parents(), ElementsAre(network_src, cpu_src));
+  EXPECT_MATCH(join->left_on_columns()[0], ColumnNode("upid", 0));
+  EXPECT_MATCH(join->right_on_columns()[0], ColumnNode("upid", 1));
+  // The output doesn't change.
+  EXPECT_THAT(join->column_names(),
+              ElementsAre("upid", "cpu0", "cpu1", "bytes_in", "upid_x", "bytes_out"));
+  EXPECT_MATCH(join->output_columns()[0], ColumnNode("upid", 1));
+  EXPECT_MATCH(join->output_columns()[3], ColumnNode("bytes_in", 0));
+
+  planpb::Operator pb;
+  ASSERT_OK(join->ToProto(&pb));
+  ASSERT_EQ(pb.join_op().equality_conditions_size(), 1);
+  EXPECT_EQ(pb.join_op().equality_conditions(0).left_column_index(), 1);
+  EXPECT_EQ(pb.join_op().equality_conditions(0).right_column_index(), 0);
+
+  // The smaller input is already the build side.
+  ASSERT_OK_AND_ASSIGN(did_swap, rule.Execute(ir_graph.get()));
+  EXPECT_FALSE(did_swap);
+}
+
+TEST_F(JoinBuildSideTest, keeps_smaller_build_side) {
+  compiler_state_->set_table_sizes({{"cpu", 1000}, {"network", 100000}});
+  ASSERT_OK_AND_ASSIGN(auto ir_graph, CompileAndAnalyze("inner"));
+
+  JoinBuildSideRule rule(compiler_state_.get());
+  ASSERT_OK_AND_ASSIGN(bool did_swap, rule.Execute(ir_graph.get()));
+  EXPECT_FALSE(did_swap);
+}
+
+TEST_F(JoinBuildSideTest, unknown_sizes_keep_build_side) {
+  compiler_state_->set_table_sizes({{"cpu", 100000}});
+  ASSERT_OK_AND_ASSIGN(auto ir_graph, CompileAndAnalyze("inner"));
+
+  JoinBuildSideRule rule(compiler_state_.get());
+  ASSERT_OK_AND_ASSIGN(bool did_swap, rule.Execute(ir_graph.get()));
+  EXPECT_FALSE(did_swap);
+}
+
+TEST_F(JoinBuildSideTest, left_join_keeps_build_side) {
+  compiler_state_->set_table_sizes({{"cpu", 100000}, {"network", 1000}});
+  ASSERT_OK_AND_ASSIGN(auto ir_graph, CompileAndAnalyze("left"));
+
+  JoinBuildSideRule rule(compiler_state_.get());
+  ASSERT_OK_AND_ASSIGN(bool did_swap, rule.Execute(ir_graph.get()));
+  EXPECT_FALSE(did_swap);
+}
+
+TEST_F(JoinBuildSideTest, estimates_operator_sizes) {
+  compiler_state_->set_table_sizes({{"cpu", 1000}});
+  auto mem_src = MakeMemSource("cpu", cpu_relation);
+  auto filter = MakeFilter(mem_src, MakeEqualsFunc(MakeColumn("cpu0", 0), MakeColumn("cpu1", 0)));
+  auto agg = MakeBlockingAgg(filter, {MakeColumn("upid", 0)},
+                             {{"mean", MakeMeanFunc(MakeColumn("cpu0", 0))}});
+  auto unknown_src = MakeMemSource("network", network_relation);
+  auto union_op = MakeUnion({mem_src, unknown_src});
+
+  OperatorSizeEstimator estimator(compiler_state_.get());
+  EXPECT_EQ(estimator.EstimateBytes(mem_src), 1000);
+  EXPECT_EQ(estimator.EstimateBytes(filter), 1000 * OperatorSizeEstimator::kFilterSelectivity);
+  EXPECT_EQ(estimator.EstimateBytes(agg), 1000 * OperatorSizeEstimator::kFilterSelectivity *
+                                              OperatorSizeEstimator::kGroupedAggSelectivity);
+  EXPECT_EQ(estimator.EstimateBytes(unknown_src), std::nullopt);
+  EXPECT_EQ(estimator.EstimateBytes(union_op), std::nullopt);
+}
+
+}  // namespace compiler
+}  // namespace planner
+}  // namespace carnot
+}  // namespace px
@@ -20,6 +20,9 @@
 
 #include <algorithm>
 #include <queue>
+#include <string>
+#include <utility>
+#include <vector>
 
 namespace px {
 namespace carnot {
@@ -469,6 +472,120 @@ bool ParentsHaveBeenObserved(const absl::flat_hash_set<int64_t>& observed_ops, O
   return true;
 }
 
+/**
+ * @brief An expression that several sibling maps compute under the same name.
+ */
+struct SharedMapExpression {
+  std::string name;
+  ExpressionIR* expr;
+  std::vector<MapIR*> maps;
+};
+
+/**
+ * @brief Returns the function expressions that at least two of the maps compute under the same
+ * name, with at most one expression per name.
+ */
+std::vector<SharedMapExpression> FindSharedMapExpressions(OperatorIR* parent,
+                                                          const std::vector<MapIR*>& maps) {
+  std::vector<SharedMapExpression> candidates;
+  for (MapIR* map : maps) {
+    for (const auto& e : map->col_exprs()) {
+      // Columns and constants are cheaper to evaluate than to pass along. Hoisting an expression
+      // that replaces a parent column would change the input of the map's other expressions.
+      if (!Match(e.node, Func()) || parent->relation().HasColumn(e.name)) {
+        continue;
+      }
+      auto it = std::find_if(candidates.begin(), candidates.end(), [&e](const auto& candidate) {
+        return candidate.name == e.name && candidate.expr->Equals(e.node);
+      });
+      if (it == candidates.end()) {
+        candidates.push_back({e.name, e.node, {map}});
+      } else {
+        it->maps.push_back(map);
+      }
+    }
+  }
+
+  std::vector<SharedMapExpression> shared;
+  absl::flat_hash_set<std::string> shared_names;
+  for (auto& candidate : candidates) {
+    if (candidate.maps.size() < 2 || shared_names.contains(candidate.name)) {
+      continue;
+    }
+    shared_names.insert(candidate.name);
+    shared.push_back(std::move(candidate));
+  }
+  return shared;
+}
+
+StatusOr<bool> MergeNodesRule::HoistSharedMapExpressions(IR* graph) {
+  std::vector<OperatorIR*> ops;
+  for (IRNode* node : graph->FindNodesThatMatch(Operator())) {
+    ops.push_back(static_cast<OperatorIR*>(node));
+  }
+  // Sort so that the ids of the new nodes don't depend on the hash set iteration order.
+  std::sort(ops.begin(), ops.end(),
+            [](OperatorIR* a, OperatorIR* b) { return a->id() < b->id(); });
+
+  bool did_hoist = false;
+  for (OperatorIR* parent : ops) {
+    if (!parent->IsRelationInit()) {
+      continue;
+    }
+    std::vector<MapIR*> maps;
+    for (OperatorIR* child : parent->Children()) {
+      if (Match(child, Map()) && child->parents().size() == 1) {
+        maps.push_back(static_cast<MapIR*>(child));
+      }
+    }
+    if (maps.size() < 2) {
+      continue;
+    }
+    std::vector<SharedMapExpression> shared = FindSharedMapExpressions(parent, maps);
+    if (shared.empty()) {
+      continue;
+    }
+    did_hoist = true;
+
+    // The hoisted map takes over the first instance of each expression, the other instances are
+    // deleted when the maps replace them with a column.
+    ColExpressionVector hoisted_exprs;
+    for (const auto& s : shared) {
+      hoisted_exprs.emplace_back(s.name, s.expr);
+    }
+    PL_ASSIGN_OR_RETURN(MapIR * hoisted, graph->CreateNode<MapIR>(parent->ast(), parent,
+                                                                  hoisted_exprs,
+                                                                  /* keep_input_columns */ true));
+    OperatorRelationRule relation_rule(compiler_state_);
+    PL_ASSIGN_OR_RETURN(bool did_set_relation, relation_rule.Apply(hoisted));
+    DCHECK(did_set_relation) << hoisted->DebugString();
+    if (parent->is_type_resolved()) {
+      PL_RETURN_IF_ERROR(ResolveOperatorType(hoisted, compiler_state_));
+    }
+
+    std::vector<MapIR*> users;
+    for (const auto& s : shared) {
+      for (MapIR* map : s.maps) {
+        PL_ASSIGN_OR_RETURN(ColumnIR * col, graph->CreateNode<ColumnIR>(s.expr->ast(), s.name,
+                                                                        /* parent_op_idx */ 0));
+        col->ResolveColumnType(hoisted->relation());
+        if (hoisted->is_type_resolved()) {
+          PL_RETURN_IF_ERROR(
+              ResolveExpressionType(col, compiler_state_, {hoisted->resolved_type()}));
+        }
+        PL_RETURN_IF_ERROR(map->UpdateColExpr(s.name, col));
+        if (std::find(users.begin(), users.end(), map) == users.end()) {
+          users.push_back(map);
+        }
+      }
+    }
+    for (MapIR* map : users) {
+      PL_RETURN_IF_ERROR(map->ReplaceParent(parent, hoisted));
+    }
+  }
+  return did_hoist;
+}
+
 StatusOr<bool> MergeNodesRule::Execute(IR* graph) {
   bool did_merge = false;
   // Start at the sources as all copies must start at the sources.
@@ -523,7 +640,10 @@ StatusOr<bool> MergeNodesRule::Execute(IR* graph) {
       matching_set_q.push(s);
     }
   }
-  return did_merge;
+
+  // Siblings that couldn't be merged may still share expressions.
+  PL_ASSIGN_OR_RETURN(bool did_hoist, HoistSharedMapExpressions(graph));
+  return did_merge || did_hoist;
 }
 
 }  // namespace compiler
@@ -105,6 +105,19 @@ class MergeNodesRule : public Rule {
    */
   StatusOr<OperatorIR*> MergeOps(IR* graph, const std::vector<OperatorIR*>& operators_to_merge);
 
+  /**
+   * @brief Hoists function expressions that sibling Maps compute identically, under the same
+   * name, into a single Map that feeds those siblings. The siblings then read the result as a
+   * column, so each shared expression is evaluated once.
+   *
+   * Sibling maps that differ in any expression can't be merged by MergeOps, but often repeat most
+   * of their work, e.g. the metadata lookups that every widget of a script adds to the same table.
+   *
+   * @param graph the graph to optimize.
+   * @return StatusOr<bool> true if any expression was hoisted.
+   */
+  StatusOr<bool> HoistSharedMapExpressions(IR* graph);
+
  private:
   // TODO(philkuz) need to remove the dependency on Rule so we don't have to override Apply().
   StatusOr<bool> Apply(IRNode*) override {
@@ -135,6 +135,52 @@ TEST_F(MergeNodesTest, merge_maps) {
       << expr_fn1->DebugString();
 }
 
+TEST_F(MergeNodesTest, hoist_shared_map_expressions) {
+  // Maps that share one expression but differ in another can't be merged, but the shared
+  // expression should be computed once in a map that feeds both of them.
+  auto mem_src = MakeMemSource("cpu", cpu_relation);
+  auto map0 = MakeMap(mem_src, {{"fn", MakeAddFunc(MakeColumn("cpu0", 0), MakeInt(2))},
+                                {"fn0", MakeAddFunc(MakeColumn("cpu1", 0), MakeInt(3))}});
+  MakeMemSink(map0, "");
+  auto map1 = MakeMap(mem_src, {{"fn", MakeAddFunc(MakeColumn("cpu0", 0), MakeInt(2))},
+                                {"fn1", MakeAddFunc(MakeColumn("cpu2", 0), MakeInt(4))}});
+  MakeMemSink(map1, "");
+
+  EXPECT_OK(Analyze(graph));
+
+  MergeNodesRule rule(compiler_state_.get());
+  auto result = rule.HoistSharedMapExpressions(graph.get());
+  ASSERT_OK(result);
+  EXPECT_TRUE(result.ConsumeValueOrDie());
+
+  ASSERT_EQ(map0->parents().size(), 1);
+  ASSERT_EQ(map1->parents().size(), 1);
+  EXPECT_EQ(map0->parents()[0], map1->parents()[0]);
+  ASSERT_MATCH(map0->parents()[0], Map());
+  auto hoisted = static_cast<MapIR*>(map0->parents()[0]);
+  EXPECT_EQ(hoisted->parents()[0], mem_src);
+  EXPECT_THAT(hoisted->relation().col_names(),
+              ElementsAre("cpu0", "cpu1", "cpu2", "upid", "agent_id", "fn"));
+
+  const auto& hoisted_exprs = hoisted->col_exprs();
+  auto fn_it = std::find_if(hoisted_exprs.begin(), hoisted_exprs.end(),
+                            [](const ColumnExpression& e) { return e.name == "fn"; });
+  ASSERT_NE(fn_it, hoisted_exprs.end());
+  EXPECT_MATCH(fn_it->node, Add(ColumnNode("cpu0"), Int(2)));
+
+  EXPECT_EQ(map0->col_exprs()[0].name, "fn");
+  EXPECT_MATCH(map0->col_exprs()[0].node, ColumnNode("fn"));
+  EXPECT_MATCH(map0->col_exprs()[1].node, Add(ColumnNode("cpu1"), Int(3)));
+  EXPECT_EQ(map1->col_exprs()[0].name, "fn");
+  EXPECT_MATCH(map1->col_exprs()[0].node, ColumnNode("fn"));
+  EXPECT_MATCH(map1->col_exprs()[1].node, Add(ColumnNode("cpu2"), Int(4)));
+
+  // Running again finds nothing more to hoist.
+  result = rule.HoistSharedMapExpressions(graph.get());
+  ASSERT_OK(result);
+  EXPECT_FALSE(result.ConsumeValueOrDie());
+}
+
 TEST_F(MergeNodesTest, merge_memory_sources_different_columns) {
   // Test to make sure weird map merging works as expected.
   std::vector<OperatorIR*> srcs;
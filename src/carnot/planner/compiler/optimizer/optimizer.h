@@ -24,6 +24,7 @@
 #include <vector>
 
 #include "src/carnot/planner/compiler/optimizer/filter_push_down.h"
+#include "src/carnot/planner/compiler/optimizer/join_build_side.h"
 #include "src/carnot/planner/compiler/optimizer/merge_nodes.h"
 #include "src/carnot/planner/compiler_state/compiler_state.h"
 #include "src/carnot/planner/compiler_state/registry_info.h"
@@ -67,11 +68,17 @@ class Optimizer : public RuleExecutor<IR> {
     prune_unused_columns->AddRule<PruneUnusedColumnsRule>();
   }
 
+  void CreateJoinBuildSideBatch() {
+    RuleBatch* join_build_side_batch = CreateRuleBatch<TryUntilMax>("JoinBuildSide", 1);
+    join_build_side_batch->AddRule<JoinBuildSideRule>(compiler_state_);
+  }
+
   Status Init() {
     CreatePruneUnconnectedOpsBatch();
     CreateFilterPushdownBatch();
     CreateMergeNodesBatch();
     CreatePruneUnusedColumnsBatch();
+    CreateJoinBuildSideBatch();
     return Status::OK();
   }
 
@@ -34,6 +34,8 @@ namespace carnot {
 namespace planner {
 
 using RelationMap = std::unordered_map<std::string, table_store::schema::Relation>;
+// Maps a table name to the number of bytes stored in the table.
+using TableSizeMap = std::unordered_map<std::string, int64_t>;
 class CompilerState : public NotCopyable {
  public:
   /**
@@ -90,6 +92,13 @@ class CompilerState : public NotCopyable {
   int64_t max_output_rows_per_table() { return max_output_rows_per_table_; }
   bool has_max_output_rows_per_table() { return max_output_rows_per_table_ > 0; }
 
+  /**
+   * @brief The sizes of the tables that the query can read. The optimizer uses these to estimate
+   * the cost of operators. Tables that aren't in the map have an unknown size.
+   */
+  const TableSizeMap& table_sizes() const { return table_sizes_; }
+  void set_table_sizes(TableSizeMap table_sizes) { table_sizes_ = std::move(table_sizes); }
+
  private:
   std::unique_ptr<RelationMap> relation_map_;
   RegistryInfo* registry_info_;
@@ -98,6 +107,7 @@ class CompilerState : public NotCopyable {
   std::map<RegistryKey, int64_t> uda_to_id_map_;
 
   int64_t max_output_rows_per_table_ = 0;
+  TableSizeMap table_sizes_;
   const std::string result_address_;
   const std::string result_ssl_targetname_;
 };
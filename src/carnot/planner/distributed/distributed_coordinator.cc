@@ -28,6 +28,7 @@
 #include "src/carnot/planner/distributed/distributed_splitter.h"
 #include "src/carnot/planner/distributed/distributed_stitcher_rules.h"
 #include "src/carnot/planner/distributed/grpc_source_conversion.h"
+#include "src/carnot/planner/distributed/parallel_for.h"
 #include "src/carnot/planner/distributed/plan_clusters.h"
 #include "src/carnot/planner/distributed/removable_ops_rule.h"
 #include "src/carnot/planner/rules/rules.h"
@@ -35,6 +36,10 @@
 #include "src/common/uuid/uuid.h"
 #include "src/shared/upid/upid.h"
 
+DEFINE_bool(planner_partial_agg, gflags::BoolFromEnv("PL_PLANNER_PARTIAL_AGG", false),
+            "Whether to split aggregates into partial aggregates on the agents and a finalize "
+            "aggregate on Kelvin, so that agents only send one row per group to Kelvin.");
+
 namespace px {
 namespace carnot {
 namespace planner {
@@ -200,8 +205,17 @@ StatusOr<AgentToPlanMap> GetUniquePEMPlans(IR* query, DistributedPlan* plan,
   if (!remaining_agents.empty()) {
     clusters.emplace_back(remaining_agents, absl::flat_hash_set<OperatorIR*>{});
   }
-  for (const auto& c : clusters) {
-    PL_ASSIGN_OR_RETURN(auto cluster_plan_uptr, c.CreatePlan(query));
+  // Each cluster plan is an independent clone of the query, so they're built in parallel and then
+  // added in cluster order.
+  std::vector<std::unique_ptr<IR>> cluster_plans(clusters.size());
+  PL_RETURN_IF_ERROR(
+      ParallelFor(clusters.size(), /*min_items_per_thread*/ 1, [&](size_t i) -> Status {
+        PL_ASSIGN_OR_RETURN(cluster_plans[i], clusters[i].CreatePlan(query));
+        return Status::OK();
+      }));
+  for (size_t i = 0; i < clusters.size(); ++i) {
+    const auto& c = clusters[i];
+    auto cluster_plan_uptr = std::move(cluster_plans[i]);
     auto cluster_plan = cluster_plan_uptr.get();
     if (cluster_plan->FindNodesThatMatch(Operator()).empty()) {
       continue;
@@ -219,10 +233,8 @@ StatusOr<AgentToPlanMap> GetUniquePEMPlans(IR* query, DistributedPlan* plan,
 }
 
 StatusOr<std::unique_ptr<DistributedPlan>> CoordinatorImpl::CoordinateImpl(const IR* logical_plan) {
-  // TODO(zasgar) set support_partial_agg to true to enable partial aggs.
-  PL_ASSIGN_OR_RETURN(
-      std::unique_ptr<DistributedSplitter> splitter,
-      DistributedSplitter::Create(compiler_state_, /* support_partial_agg */ false));
+  PL_ASSIGN_OR_RETURN(std::unique_ptr<DistributedSplitter> splitter,
+                      DistributedSplitter::Create(compiler_state_, FLAGS_planner_partial_agg));
   PL_ASSIGN_OR_RETURN(std::unique_ptr<BlockingSplitPlan> split_plan,
                       splitter->SplitKelvinAndAgents(logical_plan));
   auto distributed_plan = std::make_unique<DistributedPlan>();
@@ -27,6 +27,8 @@
 #include "src/carnot/planner/ir/ir_nodes.h"
 #include "src/carnot/planner/ir/pattern_match.h"
 
+DECLARE_bool(planner_partial_agg);
+
 namespace px {
 namespace carnot {
 namespace planner {
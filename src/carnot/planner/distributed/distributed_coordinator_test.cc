@@ -140,6 +140,36 @@ TEST_F(CoordinatorTest, three_pems_one_kelvin) {
   }
 }
 
+TEST_F(CoordinatorTest, partial_agg) {
+  bool prev_partial_agg = FLAGS_planner_partial_agg;
+  FLAGS_planner_partial_agg = true;
+  auto ps = LoadDistributedStatePb(kThreePEMsOneKelvinDistributedState);
+  auto coordinator = Coordinator::Create(compiler_state_.get(), ps).ConsumeValueOrDie();
+
+  auto mem_src = MakeMemSource(MakeRelation());
+  auto count_col = MakeColumn("count", 0, types::DataType::INT64);
+  count_col->ResolveColumnType(types::INT64);
+  auto mean_func = MakeMeanFuncWithFloatType(MakeColumn("count", 0, types::DataType::INT64));
+  mean_func->SetSupportsPartial(true);
+  auto agg = MakeBlockingAgg(mem_src, {count_col}, {{"mean", mean_func}});
+  ASSERT_OK(agg->SetRelation(
+      table_store::schema::Relation({types::INT64, types::FLOAT64}, {"count", "mean"})));
+  MakeMemSink(agg, "out");
+
+  auto physical_plan = coordinator->Coordinate(graph.get()).ConsumeValueOrDie();
+  FLAGS_planner_partial_agg = prev_partial_agg;
+
+  // The agents partially aggregate their data, and Kelvin merges the partial aggregates.
+  auto kelvin_plan = physical_plan->Get(0)->plan();
+  EXPECT_EQ(kelvin_plan->FindNodesThatMatch(FinalizeAgg()).size(), 1);
+  EXPECT_EQ(kelvin_plan->FindNodesThatMatch(PartialAgg()).size(), 0);
+  for (int64_t i = 1; i <= 3; ++i) {
+    auto pem_plan = physical_plan->Get(i)->plan();
+    EXPECT_EQ(pem_plan->FindNodesThatMatch(PartialAgg()).size(), 1);
+    EXPECT_EQ(pem_plan->FindNodesThatMatch(FinalizeAgg()).size(), 0);
+  }
+}
+
 TEST_F(CoordinatorTest, one_pem_three_kelvin) {
   auto ps = LoadDistributedStatePb(kOnePEMThreeKelvinsDistributedState);
   auto coordinator = Coordinator::Create(compiler_state_.get(), ps).ConsumeValueOrDie();
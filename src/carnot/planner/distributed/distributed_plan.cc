@@ -16,34 +16,54 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include <utility>
+#include <vector>
+
 #include "src/carnot/planner/distributed/distributed_plan.h"
+#include "src/carnot/planner/distributed/parallel_for.h"
 
 namespace px {
 namespace carnot {
 namespace planner {
 namespace distributed {
 
+// Below this many plans per thread, spawning threads costs more than it saves.
+constexpr size_t kMinPlansPerThread = 16;
+
 StatusOr<distributedpb::DistributedPlan> DistributedPlan::ToProto() const {
   distributedpb::DistributedPlan physical_plan_pb;
   auto physical_plan_dag = physical_plan_pb.mutable_dag();
   auto qb_address_to_plan_pb = physical_plan_pb.mutable_qb_address_to_plan();
   auto qb_address_to_dag_id_pb = physical_plan_pb.mutable_qb_address_to_dag_id();
 
-  for (int64_t i : dag_.TopologicalSort()) {
+  std::vector<int64_t> topo_order = dag_.TopologicalSort();
+  for (int64_t i : topo_order) {
     CarnotInstance* carnot = Get(i);
     CHECK_EQ(carnot->id(), i) << absl::Substitute("Index in node ($1) and DAG ($0) don't agree.", i,
                                                   carnot->id());
     DCHECK(carnot->plan()) << absl::Substitute("$0 doesn't have a plan set.",
                                                carnot->DebugString());
-    PL_ASSIGN_OR_RETURN(auto plan_proto, carnot->PlanProto());
+  }
+
+  // Serializing the per-agent plans dominates for large clusters and each one only reads its own
+  // IR, so they are built in parallel. The output is assembled afterwards in topological order to
+  // keep it independent of thread scheduling.
+  std::vector<planpb::Plan> plan_protos(topo_order.size());
+  PL_RETURN_IF_ERROR(ParallelFor(topo_order.size(), kMinPlansPerThread, [&](size_t idx) -> Status {
+    PL_ASSIGN_OR_RETURN(plan_protos[idx], Get(topo_order[idx])->PlanProto());
+    return Status::OK();
+  }));
+
+  for (size_t idx = 0; idx < topo_order.size(); ++idx) {
+    int64_t i = topo_order[idx];
+    CarnotInstance* carnot = Get(i);
+    planpb::Plan* plan_proto = &(*qb_address_to_plan_pb)[carnot->QueryBrokerAddress()];
+    *plan_proto = std::move(plan_protos[idx]);
     for (int64_t parent_i : dag_.ParentsOf(i)) {
-      *(plan_proto.add_incoming_agent_ids()) = Get(parent_i)->carnot_info().agent_id();
+      *(plan_proto->add_incoming_agent_ids()) = Get(parent_i)->carnot_info().agent_id();
     }
-    (*qb_address_to_plan_pb)[carnot->QueryBrokerAddress()] = plan_proto;
+    plan_proto->mutable_plan_options()->CopyFrom(plan_options_);
     (*qb_address_to_dag_id_pb)[carnot->QueryBrokerAddress()] = i;
-
-    auto plan_opts = (*qb_address_to_plan_pb)[carnot->QueryBrokerAddress()].mutable_plan_options();
-    plan_opts->CopyFrom(plan_options_);
   }
   dag_.ToProto(physical_plan_dag);
   return physical_plan_pb;
@@ -57,6 +77,7 @@ StatusOr<int64_t> DistributedPlan::AddCarnot(const distributedpb::CarnotInfo& ca
   PL_ASSIGN_OR_RETURN(sole::uuid uuid, ParseUUID(carnot_info.agent_id()));
   uuid_to_id_map_[uuid] = carnot_id;
   dag_.AddNode(carnot_id);
+  changes_.MarkChanged(carnot_id);
   return carnot_id;
 }
 
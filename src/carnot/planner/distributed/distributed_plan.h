@@ -112,14 +112,25 @@ class DistributedPlan {
     return id_node_iter->second.get();
   }
 
-  void AddEdge(CarnotInstance* from, CarnotInstance* to) { dag_.AddEdge(from->id(), to->id()); }
-  void AddEdge(int64_t from, int64_t to) { dag_.AddEdge(from, to); }
+  void AddEdge(CarnotInstance* from, CarnotInstance* to) { AddEdge(from->id(), to->id()); }
+  void AddEdge(int64_t from, int64_t to) {
+    dag_.AddEdge(from, to);
+    changes_.MarkChanged(from);
+    changes_.MarkChanged(to);
+  }
   bool HasNode(int64_t node_id) const { return dag_.HasNode(node_id); }
 
   Status DeleteNode(int64_t node) {
     if (!HasNode(node)) {
       return error::InvalidArgument("No node $0 exists in graph.", node);
     }
+    for (int64_t parent : dag_.ParentsOf(node)) {
+      changes_.MarkChanged(parent);
+    }
+    for (int64_t child : dag_.DependenciesOf(node)) {
+      changes_.MarkChanged(child);
+    }
+    changes_.MarkChanged(node);
     dag_.DeleteNode(node);
     return Status::OK();
   }
@@ -128,6 +139,9 @@ class DistributedPlan {
 
   const plan::DAG& dag() const { return dag_; }
 
+  const ChangeLog& changes() const { return changes_; }
+  void MarkChanged(int64_t node_id) { changes_.MarkChanged(node_id); }
+
   void SetPlanOptions(planpb::PlanOptions plan_options) { plan_options_.CopyFrom(plan_options); }
 
   void AddPlan(std::unique_ptr<IR> plan) { plan_pool_.push_back(std::move(plan)); }
@@ -158,6 +172,10 @@ class DistributedPlan {
 
   CarnotInstance* kelvin() const { return kelvin_; }
 
+  // Set when agents are pruned from the plan based on their metadata filters.
+  void MarkUsesMetadataFilters() { uses_metadata_filters_ = true; }
+  bool uses_metadata_filters() const { return uses_metadata_filters_; }
+
  private:
   plan::DAG dag_;
   absl::flat_hash_map<int64_t, std::unique_ptr<CarnotInstance>> id_to_node_map_;
@@ -168,6 +186,8 @@ class DistributedPlan {
   absl::flat_hash_map<sole::uuid, int64_t> uuid_to_id_map_;
   int64_t id_counter_ = 0;
   planpb::PlanOptions plan_options_;
+  ChangeLog changes_;
+  bool uses_metadata_filters_ = false;
 };
 
 }  // namespace distributed
@@ -26,7 +26,13 @@
 #include "src/carnot/planner/distributed/distributed_rules.h"
 #include "src/carnot/planner/distributed/distributed_stitcher_rules.h"
 #include "src/carnot/planner/distributed/grpc_source_conversion.h"
+#include "src/carnot/planner/distributed/parallel_for.h"
 #include "src/carnot/planner/rules/rules.h"
+
+DEFINE_int32(planner_num_threads, gflags::Int32FromEnv("PL_PLANNER_NUM_THREADS", 8),
+             "The maximum number of threads used to finalize the per-agent plans of a "
+             "distributed plan. Set to 1 to finalize them serially.");
+
 namespace px {
 namespace carnot {
 namespace planner {
@@ -78,10 +84,12 @@ StatusOr<std::unique_ptr<DistributedPlan>> DistributedPlanner::Plan(
 
   PL_RETURN_IF_ERROR(StitchPlan(distributed_plan.get()));
 
-  AnnotateAbortableSrcsForLimitsRule rule;
-  for (IR* agent_plan : distributed_plan->UniquePlans()) {
-    rule.Execute(agent_plan);
-  }
+  std::vector<IR*> unique_plans = distributed_plan->UniquePlans();
+  PL_RETURN_IF_ERROR(
+      ParallelFor(unique_plans.size(), /*min_items_per_thread*/ 1, [&](size_t i) -> Status {
+        AnnotateAbortableSrcsForLimitsRule rule;
+        return rule.Execute(unique_plans[i]).status();
+      }));
 
   return distributed_plan;
 }
@@ -30,6 +30,8 @@
 #include "src/carnot/planner/ir/pattern_match.h"
 #include "src/carnot/planner/rules/rule_executor.h"
 
+DECLARE_int32(planner_num_threads);
+
 namespace px {
 namespace carnot {
 namespace planner {
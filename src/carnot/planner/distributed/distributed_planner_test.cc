@@ -18,6 +18,7 @@
 
 #include <gmock/gmock.h>
 #include <google/protobuf/text_format.h>
+#include <google/protobuf/util/message_differencer.h>
 #include <gtest/gtest.h>
 
 #include <utility>
@@ -208,6 +209,33 @@ TEST_F(DistributedPlannerTest, three_agents_one_kelvin) {
   EXPECT_THAT(grpc_sink_destinations, UnorderedElementsAreArray(grpc_source_ids));
 }
 
+TEST_F(DistributedPlannerTest, parallel_finalization_is_deterministic) {
+  auto mem_src = MakeMemSource(MakeRelation());
+  auto mem_sink = MakeMemSink(mem_src, "out");
+  PL_CHECK_OK(mem_sink->SetRelation(MakeRelation()));
+
+  distributedpb::DistributedState ps_pb =
+      LoadDistributedStatePb(testutils::ManyPEMsOneKelvinDistributedState(100));
+  std::unique_ptr<DistributedPlanner> physical_planner =
+      DistributedPlanner::Create().ConsumeValueOrDie();
+
+  int32_t prev_num_threads = FLAGS_planner_num_threads;
+  FLAGS_planner_num_threads = 1;
+  auto serial_plan = physical_planner->Plan(ps_pb, compiler_state_.get(), graph.get())
+                         .ConsumeValueOrDie()
+                         ->ToProto()
+                         .ConsumeValueOrDie();
+  FLAGS_planner_num_threads = 8;
+  auto parallel_plan = physical_planner->Plan(ps_pb, compiler_state_.get(), graph.get())
+                           .ConsumeValueOrDie()
+                           ->ToProto()
+                           .ConsumeValueOrDie();
+  FLAGS_planner_num_threads = prev_num_threads;
+
+  EXPECT_EQ(serial_plan.qb_address_to_plan_size(), 101);
+  EXPECT_TRUE(google::protobuf::util::MessageDifferencer::Equals(serial_plan, parallel_plan));
+}
+
 using DistributedPlannerUDTFTests = DistributedRulesTest;
 TEST_F(DistributedPlannerUDTFTests, UDTFOnlyOnPEMsDoesntRunOnKelvin) {
   uint32_t asid = 123;
@@ -0,0 +1,73 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "src/common/base/base.h"
+
+DECLARE_int32(planner_num_threads);
+
+namespace px {
+namespace carnot {
+namespace planner {
+namespace distributed {
+
+/**
+ * @brief Runs fn(i) for every i in [0, n) on up to FLAGS_planner_num_threads threads, including
+ * the calling thread. Each thread gets at least min_items_per_thread items, so that small inputs
+ * are handled on the calling thread alone.
+ *
+ * fn must only write to state owned by item i. Returns the error of the lowest failed i, so the
+ * result doesn't depend on how the items were scheduled.
+ */
+template <typename TFn>
+Status ParallelFor(size_t n, size_t min_items_per_thread, TFn fn) {
+  std::vector<Status> statuses(n);
+  std::atomic<size_t> next = 0;
+  auto run = [&]() {
+    for (size_t i = next++; i < n; i = next++) {
+      statuses[i] = fn(i);
+    }
+  };
+
+  size_t max_threads = static_cast<size_t>(std::max(FLAGS_planner_num_threads, 1));
+  size_t num_threads = std::min(max_threads, n / std::max<size_t>(min_items_per_thread, 1));
+  std::vector<std::thread> threads;
+  for (size_t t = 1; t < num_threads; ++t) {
+    threads.emplace_back(run);
+  }
+  run();
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  for (const auto& s : statuses) {
+    PL_RETURN_IF_ERROR(s);
+  }
+  return Status::OK();
+}
+
+}  // namespace distributed
+}  // namespace planner
+}  // namespace carnot
+}  // namespace px
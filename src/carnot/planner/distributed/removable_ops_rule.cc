@@ -121,6 +121,7 @@ class StringBloomFilterMatcher : public FilterExpressionMatcher {
       return true;
     }
     // The filter is removed if we don't contain the entity.
+    carnot->distributed_plan()->MarkUsesMetadataFilters();
     return md_filter->ContainsEntity(md_type_, val_);
   }
 
@@ -0,0 +1,63 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <vector>
+
+#include <absl/container/flat_hash_set.h>
+
+namespace px {
+namespace carnot {
+namespace planner {
+
+/**
+ * @brief Records the ids of the nodes of a plan graph in the order in which they changed, so that
+ * passes over the graph can revisit only the nodes that changed since they last ran.
+ *
+ * A node is recorded when it's created or deleted, when one of its edges is added or removed, and
+ * when a rule reports that applying it to the node changed the graph.
+ */
+class ChangeLog {
+ public:
+  /**
+   * @brief The number of changes recorded so far. Only comparable between calls on the same log.
+   */
+  size_t version() const { return log_.size(); }
+
+  void MarkChanged(int64_t node_id) { log_.push_back(node_id); }
+
+  /**
+   * @brief Returns the ids of the nodes changed after the given version. The ids may belong to
+   * nodes that have since been deleted.
+   */
+  absl::flat_hash_set<int64_t> ChangedSince(size_t version) const {
+    absl::flat_hash_set<int64_t> changed;
+    for (size_t i = version; i < log_.size(); ++i) {
+      changed.insert(log_[i]);
+    }
+    return changed;
+  }
+
+ private:
+  std::vector<int64_t> log_;
+};
+
+}  // namespace planner
+}  // namespace carnot
+}  // namespace px
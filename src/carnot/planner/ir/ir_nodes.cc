@@ -30,6 +30,8 @@ using table_store::schema::Relation;
 
 Status IR::AddEdge(int64_t from_node, int64_t to_node) {
   dag_.AddEdge(from_node, to_node);
+  changes_.MarkChanged(from_node);
+  changes_.MarkChanged(to_node);
   return Status::OK();
 }
 
@@ -54,6 +56,8 @@ Status IR::DeleteEdge(int64_t from_node, int64_t to_node) {
     return error::InvalidArgument("No edge ($0, $1) exists.", from_node, to_node);
   }
   dag_.DeleteEdge(from_node, to_node);
+  changes_.MarkChanged(from_node);
+  changes_.MarkChanged(to_node);
   return Status::OK();
 }
 
@@ -78,7 +82,9 @@ Status IR::DeleteOrphansInSubtree(int64_t id) {
 Status IR::DeleteSubtree(int64_t id) {
   for (const auto& p : dag_.ParentsOf(id)) {
     dag_.DeleteEdge(p, id);
+    changes_.MarkChanged(p);
   }
+  changes_.MarkChanged(id);
   return DeleteOrphansInSubtree(id);
 }
 
@@ -86,6 +92,14 @@ Status IR::DeleteNode(int64_t node) {
   if (!dag_.HasNode(node)) {
     return error::InvalidArgument("No node $0 exists in graph.", node);
   }
+  // The neighbors lose an edge along with the node.
+  for (int64_t parent : dag_.ParentsOf(node)) {
+    changes_.MarkChanged(parent);
+  }
+  for (int64_t child : dag_.DependenciesOf(node)) {
+    changes_.MarkChanged(child);
+  }
+  changes_.MarkChanged(node);
   dag_.DeleteNode(node);
   id_node_map_.erase(node);
   return Status::OK();
@@ -238,6 +252,9 @@ Status OperatorIR::ReplaceParent(OperatorIR* old_parent, OperatorIR* new_parent)
     if (parents_[i] == old_parent) {
       parents_[i] = new_parent;
       graph()->dag().ReplaceParentEdge(id(), old_parent->id(), new_parent->id());
+      graph()->MarkChanged(id());
+      graph()->MarkChanged(old_parent->id());
+      graph()->MarkChanged(new_parent->id());
       return Status::OK();
     }
   }
@@ -798,7 +815,14 @@ Status BlockingAggIR::ToProto(planpb::Operator* op) const {
     pb->add_group_names(group->col_name());
   }
 
-  pb->set_windowed(false);
+  pb->set_windowed(windowed_);
+  if (windowed_) {
+    PL_ASSIGN_OR_RETURN(auto window_group_idx, WindowGroupIdx());
+    pb->mutable_window_group_idx()->set_value(window_group_idx);
+    // A window is identified by its start, so a row that is allowed_lateness_ns_ late may be for
+    // a window that starts up to a window width before the window of the newest rows.
+    pb->set_allowed_lateness_ns(allowed_lateness_ns_ + window_width_ns_);
+  }
   pb->set_partial_agg(partial_agg_);
   pb->set_finalize_results(finalize_results_);
 
@@ -806,6 +830,27 @@ Status BlockingAggIR::ToProto(planpb::Operator* op) const {
   return Status::OK();
 }
 
+StatusOr<int64_t> BlockingAggIR::WindowGroupIdx() const {
+  int64_t window_group_idx = -1;
+  for (size_t idx = 0; idx < groups().size(); ++idx) {
+    if (groups()[idx]->EvaluatedDataType() != types::TIME64NS) {
+      continue;
+    }
+    if (window_group_idx != -1) {
+      window_group_idx = -1;
+      break;
+    }
+    window_group_idx = idx;
+  }
+  if (window_group_idx == -1) {
+    return CreateIRNodeError(
+        "Aggregates in df.stream() must group by exactly one time column, e.g. "
+        "px.bin(df.time_, window), so that the results of each window can be emitted once it "
+        "closes");
+  }
+  return window_group_idx;
+}
+
 StatusOr<absl::flat_hash_set<ColumnIR*>> ExpressionIR::InputColumns() {
   if (Match(this, DataNode())) {
     return absl::flat_hash_set<ColumnIR*>{};
@@ -1384,6 +1429,9 @@ Status BlockingAggIR::CopyFromNodeImpl(
 
   finalize_results_ = blocking_agg->finalize_results_;
   partial_agg_ = blocking_agg->partial_agg_;
+  windowed_ = blocking_agg->windowed_;
+  allowed_lateness_ns_ = blocking_agg->allowed_lateness_ns_;
+  window_width_ns_ = blocking_agg->window_width_ns_;
   pre_split_proto_ = blocking_agg->pre_split_proto_;
 
   return Status::OK();
@@ -1935,6 +1983,33 @@ StatusOr<std::vector<absl::flat_hash_set<std::string>>> JoinIR::RequiredInputCol
   return ret;
 }
 
+Status JoinIR::SwapParents() {
+  DCHECK_EQ(parents().size(), 2UL) << "There should be exactly two parents.";
+  std::vector<OperatorIR*> old_parents = parents();
+  for (OperatorIR* parent : old_parents) {
+    PL_RETURN_IF_ERROR(RemoveParent(parent));
+  }
+  PL_RETURN_IF_ERROR(AddParent(old_parents[1]));
+  PL_RETURN_IF_ERROR(AddParent(old_parents[0]));
+
+  for (const auto& columns : {left_on_columns_, right_on_columns_, output_columns_}) {
+    for (ColumnIR* col : columns) {
+      DCHECK_LT(col->container_op_parent_idx(), 2);
+      // 1 -> 0, 0 -> 1
+      col->SetContainingOperatorParentIdx(1 - col->container_op_parent_idx());
+    }
+  }
+  // The left keys must refer to the new left parent when the equality conditions are written out.
+  std::swap(left_on_columns_, right_on_columns_);
+
+  // TODO(philkuz) dependent upon how we actually do anything with output columns, this might change
+  if (suffix_strs_.size() != 0) {
+    DCHECK_EQ(suffix_strs_.size(), 2UL);
+    std::swap(suffix_strs_[0], suffix_strs_[1]);
+  }
+  return Status::OK();
+}
+
 Status JoinIR::SetOutputColumns(const std::vector<std::string>& column_names,
                                 const std::vector<ColumnIR*>& columns) {
   DCHECK_EQ(column_names.size(), columns.size());
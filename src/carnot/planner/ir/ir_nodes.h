@@ -32,6 +32,7 @@
 
 #include "src/carnot/dag/dag.h"
 #include "src/carnot/planner/compiler_error_context/compiler_error_context.h"
+#include "src/carnot/planner/ir/change_log.h"
 #include "src/carnot/planner/compiler_state/compiler_state.h"
 #include "src/carnot/planner/compilerpb/compiler_status.pb.h"
 #include "src/carnot/planner/ir/ir_node_traits.h"
@@ -228,6 +229,7 @@ class IR {
     id_node_counter = std::max(id + 1, id_node_counter);
     auto node = std::make_unique<TOperator>(id);
     dag_.AddNode(node->id());
+    changes_.MarkChanged(node->id());
     node->set_graph(this);
     if (ast != nullptr) {
       node->SetLineCol(ast);
@@ -322,6 +324,14 @@ class IR {
 
   plan::DAG& dag() { return dag_; }
   const plan::DAG& dag() const { return dag_; }
+
+  /**
+   * @brief The log of the nodes that changed in this graph. Edits made directly on dag() must be
+   * recorded with MarkChanged().
+   */
+  const ChangeLog& changes() const { return changes_; }
+  void MarkChanged(int64_t node_id) { changes_.MarkChanged(node_id); }
+
   std::string DebugString();
   std::string OperatorsDebugString();
 
@@ -419,6 +429,7 @@ class IR {
   plan::DAG dag_;
   std::unordered_map<int64_t, IRNodePtr> id_node_map_;
   int64_t id_node_counter = 0;
+  ChangeLog changes_;
 };
 
 // Forward declaration for types that are used in OperatorIR. They are declared later in this
@@ -1599,6 +1610,22 @@ class BlockingAggIR : public GroupAcceptorIR {
 
   bool partial_agg() const { return partial_agg_; }
   bool finalize_results() const { return finalize_results_; }
+
+  void SetWindowed(bool windowed) { windowed_ = windowed; }
+  bool windowed() const { return windowed_; }
+  // Returns the index of the group that holds the start of each window. That is the only group of
+  // type TIME64NS, and it is an error for a windowed aggregate to have none or several of them.
+  StatusOr<int64_t> WindowGroupIdx() const;
+  // How late rows of a windowed aggregate may arrive, compared to the newest rows, and still be
+  // counted in their window.
+  void SetAllowedLatenessNS(int64_t allowed_lateness_ns) {
+    allowed_lateness_ns_ = allowed_lateness_ns;
+  }
+  int64_t allowed_lateness_ns() const { return allowed_lateness_ns_; }
+  // The width of the windows, if known (e.g. from px.bin(df.time_, width)), or 0.
+  void SetWindowWidthNS(int64_t window_width_ns) { window_width_ns_ = window_width_ns; }
+  int64_t window_width_ns() const { return window_width_ns_; }
+
   void SetPreSplitProto(const planpb::AggregateOperator& pre_split_proto) {
     pre_split_proto_ = pre_split_proto;
   }
@@ -1614,6 +1641,11 @@ class BlockingAggIR : public GroupAcceptorIR {
   bool partial_agg_ = true;
   // Whether this finalizes the result of a partial aggregate.
   bool finalize_results_ = true;
+  // Whether this aggregates a stream, emitting the results of each time window as it closes
+  // instead of once at the end of the input.
+  bool windowed_ = false;
+  int64_t allowed_lateness_ns_ = 0;
+  int64_t window_width_ns_ = 0;
   planpb::AggregateOperator pre_split_proto_;
 };
 
@@ -2056,6 +2088,12 @@ class JoinIR : public OperatorIR {
                           const std::vector<ColumnIR*>& columns);
   bool specified_as_right() const { return specified_as_right_; }
 
+  /**
+   * @brief Swaps the left and right parents of the join. The join keys, suffixes and the parent
+   * index of every column are swapped with them, so the output columns don't change.
+   */
+  Status SwapParents();
+
   StatusOr<std::vector<absl::flat_hash_set<std::string>>> RequiredInputColumns() const override;
 
   const std::tuple<std::shared_ptr<TableType>, std::shared_ptr<TableType>> left_right_table_types()
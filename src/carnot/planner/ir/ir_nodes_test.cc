@@ -450,6 +450,52 @@ TEST(ToProto, agg_ir) {
   ASSERT_OK(agg->ToProto(&pb));
 
   EXPECT_THAT(pb, EqualsProto(kExpectedAggPb));
+
+  // Without a time group, the aggregate can't be windowed.
+  agg->SetWindowed(true);
+  planpb::Operator windowed_pb;
+  EXPECT_NOT_OK(agg->ToProto(&windowed_pb));
+}
+
+TEST(ToProto, windowed_agg_ir) {
+  auto ast = MakeTestAstPtr();
+  auto graph = std::make_shared<IR>();
+  auto mem_src = graph
+                     ->CreateNode<MemorySourceIR>(
+                         ast, "source", std::vector<std::string>{"group1", "window", "column"})
+                     .ValueOrDie();
+  table_store::schema::Relation rel({types::INT64, types::TIME64NS, types::INT64},
+                                    {"group1", "window", "column"});
+  EXPECT_OK(mem_src->SetRelation(rel));
+  auto col = graph->CreateNode<ColumnIR>(ast, "column", /*parent_op_idx*/ 0).ValueOrDie();
+  col->ResolveColumnType(types::INT64);
+  auto agg_func = graph
+                      ->CreateNode<FuncIR>(ast, FuncIR::Op{FuncIR::Opcode::non_op, "", "mean"},
+                                           std::vector<ExpressionIR*>{col})
+                      .ValueOrDie();
+
+  auto group1 = graph->CreateNode<ColumnIR>(ast, "group1", /*parent_op_idx*/ 0).ValueOrDie();
+  group1->ResolveColumnType(types::INT64);
+  auto window = graph->CreateNode<ColumnIR>(ast, "window", /*parent_op_idx*/ 0).ValueOrDie();
+  window->ResolveColumnType(types::TIME64NS);
+
+  auto agg = graph
+                 ->CreateNode<BlockingAggIR>(ast, mem_src, std::vector<ColumnIR*>{group1, window},
+                                             ColExpressionVector{{"mean", agg_func}})
+                 .ValueOrDie();
+  agg->SetWindowed(true);
+  agg->SetAllowedLatenessNS(5000);
+  agg->SetWindowWidthNS(1000);
+
+  // Windowed aggregates keep the flag when they are copied, e.g. by the distributed splitter.
+  ASSERT_OK_AND_ASSIGN(BlockingAggIR * cloned_agg, graph->CopyNode(agg));
+  ASSERT_OK(cloned_agg->CopyParentsFrom(agg));
+  planpb::Operator pb;
+  ASSERT_OK(cloned_agg->ToProto(&pb));
+  EXPECT_TRUE(pb.agg_op().windowed());
+  ASSERT_TRUE(pb.agg_op().has_window_group_idx());
+  EXPECT_EQ(1, pb.agg_op().window_group_idx().value());
+  EXPECT_EQ(6000, pb.agg_op().allowed_lateness_ns());
 }
 
 TEST(ToProto, agg_ir_with_presplit_proto) {
@@ -18,10 +18,15 @@
 
 #include "src/carnot/planner/logical_planner.h"
 
+#include <algorithm>
+#include <optional>
 #include <utility>
 
 #include "src/shared/scriptspb/scripts.pb.h"
 
+DEFINE_int32(planner_plan_cache_size, 128,
+             "The number of scripts to cache compiled plans for. Zero disables the cache.");
+
 namespace px {
 namespace carnot {
 namespace planner {
@@ -52,16 +57,19 @@ StatusOr<std::unique_ptr<RelationMap>> MakeRelationMapFromDistributedState(
 
 StatusOr<std::unique_ptr<CompilerState>> CreateCompilerState(
     const distributedpb::LogicalPlannerState& logical_state, RegistryInfo* registry_info,
-    int64_t max_output_rows_per_table) {
+    int64_t max_output_rows_per_table, int64_t time_now = px::CurrentTimeNS()) {
   PL_ASSIGN_OR_RETURN(std::unique_ptr<RelationMap> rel_map,
                       MakeRelationMapFromDistributedState(logical_state.distributed_state()));
-  // Create a CompilerState obj using the relation map and grabbing the current time.
+  // Create a CompilerState obj using the relation map and the given time.
 
   return std::make_unique<planner::CompilerState>(
-      std::move(rel_map), registry_info, px::CurrentTimeNS(), max_output_rows_per_table,
+      std::move(rel_map), registry_info, time_now, max_output_rows_per_table,
       logical_state.result_address(), logical_state.result_ssl_targetname());
 }
 
+LogicalPlanner::LogicalPlanner()
+    : plan_cache_(static_cast<size_t>(std::max(FLAGS_planner_plan_cache_size, 0))) {}
+
 StatusOr<std::unique_ptr<LogicalPlanner>> LogicalPlanner::Create(const udfspb::UDFInfo& udf_info) {
   auto planner = std::unique_ptr<LogicalPlanner>(new LogicalPlanner());
   PL_RETURN_IF_ERROR(planner->Init(udf_info));
@@ -80,11 +88,40 @@ Status LogicalPlanner::Init(const udfspb::UDFInfo& udf_info) {
 StatusOr<std::unique_ptr<distributed::DistributedPlan>> LogicalPlanner::Plan(
     const distributedpb::LogicalPlannerState& logical_state,
     const plannerpb::QueryRequest& query_request) {
+  return PlanAt(logical_state, query_request, px::CurrentTimeNS());
+}
+
+StatusOr<distributedpb::DistributedPlan> LogicalPlanner::PlanProto(
+    const distributedpb::LogicalPlannerState& logical_state,
+    const plannerpb::QueryRequest& query_request) {
+  int64_t time_now = px::CurrentTimeNS();
+  PlanCacheKey key = PlanCacheKey::Create(logical_state, query_request);
+  std::optional<distributedpb::DistributedPlan> cached_plan = plan_cache_.Lookup(key, time_now);
+  VLOG(1) << absl::Substitute("Plan cache $0: $1", cached_plan.has_value() ? "hit" : "miss",
+                              plan_cache_.stats().DebugString());
+  if (cached_plan.has_value()) {
+    return std::move(cached_plan.value());
+  }
+
+  PL_ASSIGN_OR_RETURN(std::unique_ptr<distributed::DistributedPlan> distributed_plan,
+                      PlanAt(logical_state, query_request, time_now));
+  // In the future, if we actually have plan options that will actually determine how the plan is
+  // constructed, we may want to pass the planOptions to planner.Plan. However, this
+  // will need to go through many more layers (such as the coordinator), so this is fine for now.
+  distributed_plan->SetPlanOptions(logical_state.plan_options());
+  PL_ASSIGN_OR_RETURN(distributedpb::DistributedPlan plan_pb, distributed_plan->ToProto());
+  plan_cache_.Insert(key, time_now, plan_pb, distributed_plan->uses_metadata_filters());
+  return plan_pb;
+}
+
+StatusOr<std::unique_ptr<distributed::DistributedPlan>> LogicalPlanner::PlanAt(
+    const distributedpb::LogicalPlannerState& logical_state,
+    const plannerpb::QueryRequest& query_request, int64_t time_now) {
   // Compile into the IR.
   auto ms = logical_state.plan_options().max_output_rows_per_table();
   VLOG(1) << "Max output rows: " << ms;
   PL_ASSIGN_OR_RETURN(std::unique_ptr<CompilerState> compiler_state,
-                      CreateCompilerState(logical_state, registry_info_.get(), ms));
+                      CreateCompilerState(logical_state, registry_info_.get(), ms, time_now));
 
   std::vector<plannerpb::FuncToExecute> exec_funcs(query_request.exec_funcs().begin(),
                                                    query_request.exec_funcs().end());
@@ -26,6 +26,7 @@
 #include "src/carnot/planner/distributed/distributed_plan.h"
 #include "src/carnot/planner/distributed/distributed_planner.h"
 #include "src/carnot/planner/distributed/tablet_rules.h"
+#include "src/carnot/planner/plan_cache.h"
 #include "src/carnot/planner/plannerpb/func_args.pb.h"
 #include "src/carnot/planner/probes/probes.h"
 #include "src/shared/scriptspb/scripts.pb.h"
@@ -59,6 +60,24 @@ class LogicalPlanner : public NotCopyable {
       const distributedpb::LogicalPlannerState& logical_state,
       const plannerpb::QueryRequest& query);
 
+  /**
+   * @brief Plans the query and returns the distributed plan proto, with the plan options of the
+   * logical state set. Reuses the plan of an earlier request for the same script, arguments,
+   * schema and agents when the plan cache allows it.
+   *
+   * @param logical_state: the distributed layout of the vizier instance.
+   * @param query: QueryRequest
+   * @return distributedpb::DistributedPlan or error if one occurs during compilation.
+   */
+  StatusOr<distributedpb::DistributedPlan> PlanProto(
+      const distributedpb::LogicalPlannerState& logical_state,
+      const plannerpb::QueryRequest& query);
+
+  /**
+   * @brief Returns the hit and miss counters of the plan cache.
+   */
+  PlanCache::Stats plan_cache_stats() const { return plan_cache_.stats(); }
+
   StatusOr<std::unique_ptr<compiler::MutationsIR>> CompileTrace(
       const distributedpb::LogicalPlannerState& logical_state,
       const plannerpb::CompileMutationsRequest& mutations_req);
@@ -85,12 +104,17 @@ class LogicalPlanner : public NotCopyable {
   Status Init(const udfspb::UDFInfo& udf_info);
 
  protected:
-  LogicalPlanner() {}
+  LogicalPlanner();
 
  private:
+  StatusOr<std::unique_ptr<distributed::DistributedPlan>> PlanAt(
+      const distributedpb::LogicalPlannerState& logical_state,
+      const plannerpb::QueryRequest& query, int64_t time_now);
+
   compiler::Compiler compiler_;
   std::unique_ptr<distributed::Planner> distributed_planner_;
   std::unique_ptr<planner::RegistryInfo> registry_info_;
+  PlanCache plan_cache_;
 };
 
 }  // namespace planner
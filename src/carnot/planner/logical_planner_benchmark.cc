@@ -42,6 +42,42 @@ void BM_Query(benchmark::State& state) {
   }
 }
 
+// Plans the same script repeatedly, the way live views do, so that the plan cache is used.
+// NOLINTNEXTLINE : runtime/references.
+void BM_QueryCached(benchmark::State& state) {
+  auto info = udfexporter::ExportUDFInfo().ConsumeValueOrDie()->info_pb();
+  auto planner = LogicalPlanner::Create(info).ConsumeValueOrDie();
+  auto planner_state = testutils::CreateTwoPEMsOneKelvinPlannerState(testutils::kHttpEventsSchema);
+  plannerpb::QueryRequest query_request;
+  query_request.set_query_str(testutils::kHttpRequestStats);
+  for (auto _ : state) {
+    auto plan_or_s = planner->PlanProto(planner_state, query_request);
+    EXPECT_OK(plan_or_s);
+  }
+  state.counters["hit_rate"] = planner->plan_cache_stats().hit_rate();
+}
+
+// Plans and serializes a query for a cluster of state.range(0) PEMs and one Kelvin, finalizing the
+// per-agent plans on up to state.range(1) threads.
+// NOLINTNEXTLINE : runtime/references.
+void BM_QueryManyAgents(benchmark::State& state) {
+  int32_t prev_num_threads = FLAGS_planner_num_threads;
+  FLAGS_planner_num_threads = state.range(1);
+  auto info = udfexporter::ExportUDFInfo().ConsumeValueOrDie()->info_pb();
+  auto planner = LogicalPlanner::Create(info).ConsumeValueOrDie();
+  auto planner_state = testutils::CreateManyPEMsOneKelvinPlannerState(
+      state.range(0), testutils::LoadSchemaPb(testutils::kHttpEventsSchema));
+  plannerpb::QueryRequest query_request;
+  query_request.set_query_str(testutils::kHttpRequestStats);
+  for (auto _ : state) {
+    auto plan_or_s = planner->Plan(planner_state, query_request);
+    EXPECT_OK(plan_or_s);
+    auto plan_pb_or_s = plan_or_s.ConsumeValueOrDie()->ToProto();
+    EXPECT_OK(plan_pb_or_s);
+  }
+  FLAGS_planner_num_threads = prev_num_threads;
+}
+
 // NOLINTNEXTLINE : runtime/references.
 void BM_GetMainFuncArgs(benchmark::State& state) {
   auto info = udfexporter::ExportUDFInfo().ConsumeValueOrDie()->info_pb();
@@ -56,6 +92,15 @@ void BM_GetMainFuncArgs(benchmark::State& state) {
 }
 
 BENCHMARK(BM_Query);
+BENCHMARK(BM_QueryCached);
+BENCHMARK(BM_QueryManyAgents)
+    ->Args({50, 1})
+    ->Args({50, 8})
+    ->Args({200, 1})
+    ->Args({200, 8})
+    ->Args({1000, 1})
+    ->Args({1000, 8})
+    ->Unit(benchmark::kMillisecond);
 // TODO(philkuz) need new query because Main doesn't exist in http request stats.
 // BENCHMARK(BM_GetAvailFlags);
 
@@ -70,6 +70,46 @@ TEST_F(LogicalPlannerTest, distributed_plan_test_basic_queries) {
   EXPECT_OK(plan->ToProto());
 }
 
+TEST_F(LogicalPlannerTest, plan_proto_uses_plan_cache) {
+  auto planner = LogicalPlanner::Create(info_).ConsumeValueOrDie();
+  auto ps = testutils::CreateTwoPEMsOneKelvinPlannerState(testutils::kHttpEventsSchema);
+  auto query_request = MakeQueryRequest(testutils::kHttpRequestStats);
+
+  // The first two plans are compiled, after which the plan is reused.
+  for (int i = 0; i < 4; ++i) {
+    ASSERT_OK_AND_ASSIGN(auto plan_pb, planner->PlanProto(ps, query_request));
+    EXPECT_GT(plan_pb.qb_address_to_plan_size(), 0);
+  }
+  auto stats = planner->plan_cache_stats();
+  EXPECT_EQ(stats.hits, 2);
+  EXPECT_EQ(stats.misses, 2);
+
+  // The memory sources read the last 30s relative to the time of the request.
+  int64_t time_now = px::CurrentTimeNS();
+  ASSERT_OK_AND_ASSIGN(auto plan_pb, planner->PlanProto(ps, query_request));
+  int num_mem_srcs = 0;
+  for (const auto& [qb_address, plan] : plan_pb.qb_address_to_plan()) {
+    for (const auto& fragment : plan.nodes()) {
+      for (const auto& node : fragment.nodes()) {
+        if (!node.op().has_mem_source_op()) {
+          continue;
+        }
+        ++num_mem_srcs;
+        int64_t start_time = node.op().mem_source_op().start_time().value();
+        EXPECT_GE(start_time, time_now - 30LL * 1000 * 1000 * 1000) << qb_address;
+        EXPECT_LE(start_time, px::CurrentTimeNS() - 30LL * 1000 * 1000 * 1000) << qb_address;
+      }
+    }
+  }
+  EXPECT_GT(num_mem_srcs, 0);
+  EXPECT_EQ(planner->plan_cache_stats().hits, 3);
+
+  // Changing the agents invalidates the plan.
+  auto other_ps = testutils::CreateOnePEMOneKelvinPlannerState(testutils::kHttpEventsSchema);
+  ASSERT_OK(planner->PlanProto(other_ps, query_request));
+  EXPECT_EQ(planner->plan_cache_stats().invalidations, 1);
+}
+
 constexpr char kSimpleQueryDefaultLimit[] = R"pxl(
 import px
 t1 = px.DataFrame(table='http_events', start_time='-120s', select=['time_'])
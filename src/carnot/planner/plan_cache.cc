@@ -0,0 +1,287 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/planner/plan_cache.h"
+
+#include <algorithm>
+#include <functional>
+#include <utility>
+#include <vector>
+
+#include <google/protobuf/io/coded_stream.h>
+#include <google/protobuf/io/zero_copy_stream_impl_lite.h>
+#include <google/protobuf/util/message_differencer.h>
+
+namespace px {
+namespace carnot {
+namespace planner {
+
+namespace {
+
+// Appends the serialization of msg to out. Deterministic, so that equal messages with map fields
+// produce the same bytes.
+void AppendDeterministic(const google::protobuf::Message& msg, std::string* out) {
+  google::protobuf::io::StringOutputStream stream(out);
+  google::protobuf::io::CodedOutputStream coded_stream(&stream);
+  coded_stream.SetSerializationDeterministic(true);
+  msg.SerializeToCodedStream(&coded_stream);
+}
+
+}  // namespace
+
+PlanCacheKey PlanCacheKey::Create(const distributedpb::LogicalPlannerState& logical_state,
+                                  const plannerpb::QueryRequest& query_request) {
+  PlanCacheKey key;
+  key.script = query_request.query_str();
+  for (const auto& exec_func : query_request.exec_funcs()) {
+    key.script += '\0';
+    AppendDeterministic(exec_func, &key.script);
+  }
+
+  const auto& distributed_state = logical_state.distributed_state();
+  std::string buf;
+  for (const auto& schema_info : distributed_state.schema_info()) {
+    AppendDeterministic(schema_info, &buf);
+  }
+  key.schema_version = std::hash<std::string>{}(buf);
+
+  // The agents are reported in no particular order, so sort them by agent id. The metadata
+  // filters change whenever pods come and go, and are versioned separately since only the plans
+  // of scripts that filter on metadata depend on them.
+  std::vector<std::pair<std::string, std::string>> agents;
+  std::vector<std::pair<std::string, std::string>> agents_metadata;
+  for (const auto& carnot_info : distributed_state.carnot_info()) {
+    std::string agent_id;
+    AppendDeterministic(carnot_info.agent_id(), &agent_id);
+    distributedpb::CarnotInfo planning_info = carnot_info;
+    planning_info.clear_metadata_info();
+    std::string serialized;
+    AppendDeterministic(planning_info, &serialized);
+    agents.emplace_back(agent_id, std::move(serialized));
+    serialized.clear();
+    AppendDeterministic(carnot_info.metadata_info(), &serialized);
+    agents_metadata.emplace_back(std::move(agent_id), std::move(serialized));
+  }
+  std::sort(agents.begin(), agents.end());
+  std::sort(agents_metadata.begin(), agents_metadata.end());
+
+  buf.clear();
+  for (const auto& [agent_id, metadata_info] : agents_metadata) {
+    buf += agent_id;
+    buf += metadata_info;
+  }
+  key.metadata_version = std::hash<std::string>{}(buf);
+
+  buf.clear();
+  for (const auto& [agent_id, carnot_info] : agents) {
+    buf += agent_id;
+    buf += carnot_info;
+  }
+  AppendDeterministic(logical_state.plan_options(), &buf);
+  buf += logical_state.result_address();
+  buf += '\0';
+  buf += logical_state.result_ssl_targetname();
+  key.distributed_state_version = std::hash<std::string>{}(buf);
+  return key;
+}
+
+double PlanCache::Stats::hit_rate() const {
+  int64_t lookups = hits + misses;
+  return lookups == 0 ? 0.0 : static_cast<double>(hits) / lookups;
+}
+
+std::string PlanCache::Stats::DebugString() const {
+  return absl::Substitute(
+      "hits=$0 misses=$1 uncacheable=$2 invalidations=$3 evictions=$4 size=$5 hit_rate=$6", hits,
+      misses, uncacheable, invalidations, evictions, size, hit_rate());
+}
+
+std::optional<distributedpb::DistributedPlan> PlanCache::Lookup(const PlanCacheKey& key,
+                                                                int64_t time_now) {
+  absl::MutexLock lock(&lock_);
+  auto it = entries_.find(key.script);
+  if (it == entries_.end()) {
+    ++stats_.misses;
+    return std::nullopt;
+  }
+  Entry& entry = it->second;
+  if (!VersionMatches(entry, key)) {
+    entries_.erase(it);
+    ++stats_.invalidations;
+    ++stats_.misses;
+    return std::nullopt;
+  }
+  entry.last_used = ++use_count_;
+
+  switch (entry.state) {
+    case EntryState::kPending:
+      ++stats_.misses;
+      return std::nullopt;
+    case EntryState::kUncacheable:
+      ++stats_.uncacheable;
+      ++stats_.misses;
+      return std::nullopt;
+    case EntryState::kReady:
+      break;
+  }
+
+  ++stats_.hits;
+  distributedpb::DistributedPlan plan = entry.plan;
+  for (const auto& relative_time : entry.relative_times) {
+    auto* mem_src = (*plan.mutable_qb_address_to_plan())[relative_time.qb_address]
+                        .mutable_nodes(relative_time.fragment_idx)
+                        ->mutable_nodes(relative_time.node_idx)
+                        ->mutable_op()
+                        ->mutable_mem_source_op();
+    auto* time = relative_time.is_start_time ? mem_src->mutable_start_time()
+                                             : mem_src->mutable_stop_time();
+    time->set_value(time_now + relative_time.offset_ns);
+  }
+  return plan;
+}
+
+void PlanCache::Insert(const PlanCacheKey& key, int64_t time_now,
+                       const distributedpb::DistributedPlan& plan, bool uses_metadata) {
+  if (capacity_ == 0) {
+    return;
+  }
+
+  absl::MutexLock lock(&lock_);
+  auto it = entries_.find(key.script);
+  if (it != entries_.end() && !VersionMatches(it->second, key)) {
+    entries_.erase(it);
+    ++stats_.invalidations;
+    it = entries_.end();
+  }
+
+  if (it == entries_.end()) {
+    EvictIfFull();
+    Entry& entry = entries_[key.script];
+    entry.schema_version = key.schema_version;
+    entry.distributed_state_version = key.distributed_state_version;
+    entry.metadata_version = key.metadata_version;
+    entry.uses_metadata = uses_metadata;
+    entry.compiled_at_ns = time_now;
+    entry.plan = plan;
+    entry.last_used = ++use_count_;
+    return;
+  }
+
+  Entry& entry = it->second;
+  if (entry.state != EntryState::kPending || time_now == entry.compiled_at_ns) {
+    return;
+  }
+  entry.uses_metadata = entry.uses_metadata || uses_metadata;
+
+  auto relative_times_or =
+      FindRelativeTimes(entry.plan, plan, time_now - entry.compiled_at_ns, time_now);
+  if (!relative_times_or.ok()) {
+    VLOG(1) << "Not caching the plan of the script: " << relative_times_or.msg();
+    entry.state = EntryState::kUncacheable;
+    entry.plan.Clear();
+    return;
+  }
+  entry.state = EntryState::kReady;
+  entry.compiled_at_ns = time_now;
+  entry.plan = plan;
+  entry.relative_times = relative_times_or.ConsumeValueOrDie();
+}
+
+PlanCache::Stats PlanCache::stats() const {
+  absl::MutexLock lock(&lock_);
+  Stats stats = stats_;
+  stats.size = entries_.size();
+  return stats;
+}
+
+StatusOr<std::vector<PlanCache::RelativeTime>> PlanCache::FindRelativeTimes(
+    const distributedpb::DistributedPlan& prev_plan, const distributedpb::DistributedPlan& plan,
+    int64_t delta_ns, int64_t time_now) {
+  std::vector<RelativeTime> relative_times;
+  // A copy of plan with the relative times of prev_plan, to compare the rest of the plans.
+  distributedpb::DistributedPlan normalized_plan = plan;
+
+  for (const auto& [qb_address, prev_carnot_plan] : prev_plan.qb_address_to_plan()) {
+    auto it = normalized_plan.mutable_qb_address_to_plan()->find(qb_address);
+    if (it == normalized_plan.mutable_qb_address_to_plan()->end()) {
+      return error::Internal("Plans differ in Carnot instance $0.", qb_address);
+    }
+    planpb::Plan* carnot_plan = &it->second;
+    if (prev_carnot_plan.nodes_size() != carnot_plan->nodes_size()) {
+      return error::Internal("Plans differ in fragments of $0.", qb_address);
+    }
+    for (int f = 0; f < carnot_plan->nodes_size(); ++f) {
+      const planpb::PlanFragment& prev_fragment = prev_carnot_plan.nodes(f);
+      planpb::PlanFragment* fragment = carnot_plan->mutable_nodes(f);
+      if (prev_fragment.nodes_size() != fragment->nodes_size()) {
+        return error::Internal("Plans differ in nodes of $0.", qb_address);
+      }
+      for (int n = 0; n < fragment->nodes_size(); ++n) {
+        const planpb::Operator& prev_op = prev_fragment.nodes(n).op();
+        planpb::Operator* op = fragment->mutable_nodes(n)->mutable_op();
+        if (!prev_op.has_mem_source_op() || !op->has_mem_source_op()) {
+          continue;
+        }
+        const planpb::MemorySourceOperator& prev_mem_src = prev_op.mem_source_op();
+        planpb::MemorySourceOperator* mem_src = op->mutable_mem_source_op();
+        for (bool is_start_time : {true, false}) {
+          bool has_time = is_start_time ? mem_src->has_start_time() : mem_src->has_stop_time();
+          bool prev_has_time =
+              is_start_time ? prev_mem_src.has_start_time() : prev_mem_src.has_stop_time();
+          if (!has_time || !prev_has_time) {
+            // A difference in presence is caught by the comparison below.
+            continue;
+          }
+          int64_t prev_time = is_start_time ? prev_mem_src.start_time().value()
+                                            : prev_mem_src.stop_time().value();
+          auto* time = is_start_time ? mem_src->mutable_start_time() : mem_src->mutable_stop_time();
+          // Subtract in unsigned arithmetic, since absolute bounds may be at the int64 limits.
+          int64_t moved_by = static_cast<int64_t>(static_cast<uint64_t>(time->value()) -
+                                                  static_cast<uint64_t>(prev_time));
+          if (moved_by != delta_ns) {
+            continue;
+          }
+          relative_times.push_back({qb_address, f, n, is_start_time, time->value() - time_now});
+          time->set_value(prev_time);
+        }
+      }
+    }
+  }
+
+  if (!google::protobuf::util::MessageDifferencer::Equals(prev_plan, normalized_plan)) {
+    return error::Internal("Plans differ in more than memory source time bounds.");
+  }
+  return relative_times;
+}
+
+void PlanCache::EvictIfFull() {
+  while (!entries_.empty() && entries_.size() >= capacity_) {
+    auto lru = entries_.begin();
+    for (auto it = entries_.begin(); it != entries_.end(); ++it) {
+      if (it->second.last_used < lru->second.last_used) {
+        lru = it;
+      }
+    }
+    entries_.erase(lru);
+    ++stats_.evictions;
+  }
+}
+
+}  // namespace planner
+}  // namespace carnot
+}  // namespace px
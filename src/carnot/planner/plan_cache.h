@@ -0,0 +1,156 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <absl/base/thread_annotations.h>
+#include <absl/container/flat_hash_map.h>
+#include <absl/synchronization/mutex.h>
+
+#include "src/carnot/planner/distributedpb/distributed_plan.pb.h"
+#include "src/carnot/planner/plannerpb/func_args.pb.h"
+#include "src/common/base/base.h"
+
+namespace px {
+namespace carnot {
+namespace planner {
+
+/**
+ * @brief PlanCacheKey identifies a planner request. The schema and the distributed state are
+ * reduced to fingerprints, so a change to the relations or to the set of agents produces a new
+ * version and invalidates the plan cached for the script. The fingerprints don't depend on the
+ * order the agents are listed in.
+ */
+struct PlanCacheKey {
+  // The query string followed by the serialized exec funcs and their arguments.
+  std::string script;
+  uint64_t schema_version = 0;
+  // Excludes the metadata filters of the agents, which change much more often than the rest.
+  uint64_t distributed_state_version = 0;
+  // The metadata filters of the agents, only compared for plans that were pruned with them.
+  uint64_t metadata_version = 0;
+
+  static PlanCacheKey Create(const distributedpb::LogicalPlannerState& logical_state,
+                             const plannerpb::QueryRequest& query_request);
+};
+
+/**
+ * @brief PlanCache keeps the compiled distributed plans of recently planned scripts, so that
+ * scripts that are re-run periodically (e.g. live views) skip compilation.
+ *
+ * Plans depend on the time they are compiled at through relative time bounds like
+ * start_time='-5m'. The first compilation of a script is only remembered. The second
+ * compilation, at a different time, is compared against the first: memory source time bounds
+ * that moved by exactly the time between the compilations are relative, and the plan is
+ * reused from then on with those bounds moved to the time of the lookup. If the plans differ in
+ * any other way (e.g. px.now() is used in an expression), the script is marked as uncacheable.
+ *
+ * Thread-safe.
+ */
+class PlanCache : public NotCopyable {
+ public:
+  struct Stats {
+    int64_t hits = 0;
+    // Includes the lookups counted as uncacheable.
+    int64_t misses = 0;
+    int64_t uncacheable = 0;
+    int64_t invalidations = 0;
+    int64_t evictions = 0;
+    size_t size = 0;
+
+    double hit_rate() const;
+    std::string DebugString() const;
+  };
+
+  /**
+   * @param capacity The number of scripts to keep plans for. Zero disables the cache.
+   */
+  explicit PlanCache(size_t capacity) : capacity_(capacity) {}
+
+  /**
+   * @brief Returns the cached plan for key, with its relative time bounds moved to time_now, or
+   * std::nullopt if there is no reusable plan.
+   */
+  std::optional<distributedpb::DistributedPlan> Lookup(const PlanCacheKey& key, int64_t time_now);
+
+  /**
+   * @brief Records a plan that was compiled for key at time_now. uses_metadata is set if the
+   * agents of the plan were pruned using their metadata filters, in which case the plan is also
+   * invalidated by a change to the filters.
+   */
+  void Insert(const PlanCacheKey& key, int64_t time_now,
+              const distributedpb::DistributedPlan& plan, bool uses_metadata = false);
+
+  Stats stats() const;
+
+ private:
+  // A memory source time bound that is relative to the time the plan is compiled at.
+  struct RelativeTime {
+    std::string qb_address;
+    int fragment_idx;
+    int node_idx;
+    bool is_start_time;
+    int64_t offset_ns;
+  };
+
+  enum class EntryState { kPending, kReady, kUncacheable };
+
+  struct Entry {
+    uint64_t schema_version = 0;
+    uint64_t distributed_state_version = 0;
+    uint64_t metadata_version = 0;
+    bool uses_metadata = false;
+    EntryState state = EntryState::kPending;
+    int64_t compiled_at_ns = 0;
+    distributedpb::DistributedPlan plan;
+    std::vector<RelativeTime> relative_times;
+    uint64_t last_used = 0;
+  };
+
+  /**
+   * @brief Compares two plans of a script, compiled delta_ns apart with the later one compiled at
+   * time_now. Returns the memory source time bounds of plan that moved by delta_ns, or an error
+   * if the plans differ in any other way.
+   */
+  static StatusOr<std::vector<RelativeTime>> FindRelativeTimes(
+      const distributedpb::DistributedPlan& prev_plan, const distributedpb::DistributedPlan& plan,
+      int64_t delta_ns, int64_t time_now);
+
+  static bool VersionMatches(const Entry& entry, const PlanCacheKey& key) {
+    return entry.schema_version == key.schema_version &&
+           entry.distributed_state_version == key.distributed_state_version &&
+           (!entry.uses_metadata || entry.metadata_version == key.metadata_version);
+  }
+
+  void EvictIfFull() ABSL_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  const size_t capacity_;
+
+  mutable absl::Mutex lock_;
+  absl::flat_hash_map<std::string, Entry> entries_ ABSL_GUARDED_BY(lock_);
+  uint64_t use_count_ ABSL_GUARDED_BY(lock_) = 0;
+  Stats stats_ ABSL_GUARDED_BY(lock_);
+};
+
+}  // namespace planner
+}  // namespace carnot
+}  // namespace px
@@ -0,0 +1,231 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <gmock/gmock.h>
+#include <google/protobuf/text_format.h>
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include "src/carnot/planner/plan_cache.h"
+#include "src/common/testing/protobuf.h"
+
+namespace px {
+namespace carnot {
+namespace planner {
+
+using px::testing::proto::EqualsProto;
+
+// $0 is the start time and $1 the stop time of the memory source, $2 the filter value.
+constexpr char kPlanTmpl[] = R"proto(
+qb_address_to_plan {
+  key: "pem"
+  value {
+    nodes {
+      id: 1
+      nodes {
+        id: 1
+        op {
+          op_type: MEMORY_SOURCE_OPERATOR
+          mem_source_op {
+            name: "http_events"
+            start_time { value: $0 }
+            stop_time { value: $1 }
+          }
+        }
+      }
+      nodes {
+        id: 2
+        op {
+          op_type: FILTER_OPERATOR
+          filter_op {
+            expression {
+              constant { data_type: TIME64NS time64_ns_value: $2 }
+            }
+          }
+        }
+      }
+    }
+  }
+}
+)proto";
+
+constexpr int64_t kMinute = 60LL * 1000 * 1000 * 1000;
+
+distributedpb::DistributedPlan MakePlan(int64_t start_time, int64_t stop_time,
+                                        int64_t filter_time = 0) {
+  distributedpb::DistributedPlan plan;
+  CHECK(google::protobuf::TextFormat::ParseFromString(
+      absl::Substitute(kPlanTmpl, start_time, stop_time, filter_time), &plan));
+  return plan;
+}
+
+PlanCacheKey MakeKey(std::string script, uint64_t schema_version = 1) {
+  PlanCacheKey key;
+  key.script = std::move(script);
+  key.schema_version = schema_version;
+  key.distributed_state_version = 1;
+  return key;
+}
+
+TEST(PlanCacheTest, RelativeTimesAreMovedToLookupTime) {
+  PlanCache cache(/* capacity */ 10);
+  PlanCacheKey key = MakeKey("script");
+  constexpr int64_t kStopTime = 1000;
+
+  // The start time is 5 minutes before the time of compilation, the stop time is absolute.
+  EXPECT_FALSE(cache.Lookup(key, 10 * kMinute).has_value());
+  cache.Insert(key, 10 * kMinute, MakePlan(5 * kMinute, kStopTime));
+
+  // The first plan is only remembered.
+  EXPECT_FALSE(cache.Lookup(key, 11 * kMinute).has_value());
+  cache.Insert(key, 11 * kMinute, MakePlan(6 * kMinute, kStopTime));
+
+  auto plan = cache.Lookup(key, 20 * kMinute);
+  ASSERT_TRUE(plan.has_value());
+  EXPECT_THAT(plan.value(), EqualsProto(MakePlan(15 * kMinute, kStopTime).DebugString()));
+
+  PlanCache::Stats stats = cache.stats();
+  EXPECT_EQ(stats.hits, 1);
+  EXPECT_EQ(stats.misses, 2);
+  EXPECT_EQ(stats.uncacheable, 0);
+  EXPECT_EQ(stats.size, 1);
+}
+
+TEST(PlanCacheTest, OtherTimeDependenceIsUncacheable) {
+  PlanCache cache(/* capacity */ 10);
+  PlanCacheKey key = MakeKey("script");
+
+  // The filter depends on the time of compilation as well.
+  cache.Insert(key, 10 * kMinute, MakePlan(5 * kMinute, 10 * kMinute, 10 * kMinute));
+  cache.Insert(key, 11 * kMinute, MakePlan(6 * kMinute, 11 * kMinute, 11 * kMinute));
+
+  EXPECT_FALSE(cache.Lookup(key, 20 * kMinute).has_value());
+  PlanCache::Stats stats = cache.stats();
+  EXPECT_EQ(stats.hits, 0);
+  EXPECT_EQ(stats.uncacheable, 1);
+}
+
+TEST(PlanCacheTest, VersionChangeInvalidates) {
+  PlanCache cache(/* capacity */ 10);
+  PlanCacheKey key = MakeKey("script");
+  cache.Insert(key, 10 * kMinute, MakePlan(5 * kMinute, 10 * kMinute));
+  cache.Insert(key, 11 * kMinute, MakePlan(6 * kMinute, 11 * kMinute));
+  EXPECT_TRUE(cache.Lookup(key, 12 * kMinute).has_value());
+
+  PlanCacheKey new_schema_key = MakeKey("script", /* schema_version */ 2);
+  EXPECT_FALSE(cache.Lookup(new_schema_key, 13 * kMinute).has_value());
+  EXPECT_EQ(cache.stats().invalidations, 1);
+  EXPECT_EQ(cache.stats().size, 0);
+
+  // The old version isn't brought back.
+  EXPECT_FALSE(cache.Lookup(key, 14 * kMinute).has_value());
+}
+
+// $0 and $1 are the agents, $2 is the bloom filter data of the first.
+constexpr char kPlannerStateTmpl[] = R"proto(
+distributed_state {
+  carnot_info { $0 }
+  carnot_info { $1 }
+}
+)proto";
+
+constexpr char kAgent1Tmpl[] = R"proto(
+query_broker_address: "pem1"
+agent_id { high_bits: 1 low_bits: 1 }
+has_data_store: true
+processes_data: true
+metadata_info {
+  metadata_fields: POD_NAME
+  xxhash64_bloom_filter { data: "$0" num_hashes: 2 }
+}
+)proto";
+
+constexpr char kAgent2[] = R"proto(
+query_broker_address: "pem2"
+agent_id { high_bits: 2 low_bits: 2 }
+has_data_store: true
+processes_data: true
+)proto";
+
+PlanCacheKey MakeKeyFromState(bool agents_reversed, std::string bloom_filter_data) {
+  std::string agent1 = absl::Substitute(kAgent1Tmpl, bloom_filter_data);
+  distributedpb::LogicalPlannerState state;
+  CHECK(google::protobuf::TextFormat::ParseFromString(
+      agents_reversed ? absl::Substitute(kPlannerStateTmpl, kAgent2, agent1)
+                      : absl::Substitute(kPlannerStateTmpl, agent1, kAgent2),
+      &state));
+  plannerpb::QueryRequest query_request;
+  query_request.set_query_str("script");
+  return PlanCacheKey::Create(state, query_request);
+}
+
+TEST(PlanCacheTest, KeyIgnoresAgentOrderAndMetadata) {
+  PlanCacheKey key = MakeKeyFromState(/* agents_reversed */ false, "abc");
+  PlanCacheKey reversed_key = MakeKeyFromState(/* agents_reversed */ true, "abc");
+  EXPECT_EQ(key.distributed_state_version, reversed_key.distributed_state_version);
+  EXPECT_EQ(key.metadata_version, reversed_key.metadata_version);
+
+  PlanCacheKey new_metadata_key = MakeKeyFromState(/* agents_reversed */ false, "def");
+  EXPECT_EQ(key.distributed_state_version, new_metadata_key.distributed_state_version);
+  EXPECT_NE(key.metadata_version, new_metadata_key.metadata_version);
+}
+
+TEST(PlanCacheTest, MetadataChangeOnlyInvalidatesPlansThatUseIt) {
+  PlanCache cache(/* capacity */ 10);
+  PlanCacheKey key = MakeKey("script");
+  PlanCacheKey md_key = MakeKey("md_script");
+  for (int64_t t : {10, 11}) {
+    cache.Insert(key, t * kMinute, MakePlan((t - 5) * kMinute, t * kMinute));
+    cache.Insert(md_key, t * kMinute, MakePlan((t - 5) * kMinute, t * kMinute),
+                 /* uses_metadata */ true);
+  }
+
+  key.metadata_version = 2;
+  md_key.metadata_version = 2;
+  EXPECT_TRUE(cache.Lookup(key, 12 * kMinute).has_value());
+  EXPECT_FALSE(cache.Lookup(md_key, 12 * kMinute).has_value());
+  EXPECT_EQ(cache.stats().invalidations, 1);
+}
+
+TEST(PlanCacheTest, EvictsLeastRecentlyUsed) {
+  PlanCache cache(/* capacity */ 2);
+  for (const auto& script : {"a", "b"}) {
+    cache.Insert(MakeKey(script), 10 * kMinute, MakePlan(5 * kMinute, 10 * kMinute));
+    cache.Insert(MakeKey(script), 11 * kMinute, MakePlan(6 * kMinute, 11 * kMinute));
+  }
+  EXPECT_TRUE(cache.Lookup(MakeKey("a"), 12 * kMinute).has_value());
+
+  cache.Insert(MakeKey("c"), 12 * kMinute, MakePlan(7 * kMinute, 12 * kMinute));
+  EXPECT_EQ(cache.stats().evictions, 1);
+  EXPECT_TRUE(cache.Lookup(MakeKey("a"), 13 * kMinute).has_value());
+  EXPECT_FALSE(cache.Lookup(MakeKey("b"), 13 * kMinute).has_value());
+}
+
+TEST(PlanCacheTest, ZeroCapacityDisables) {
+  PlanCache cache(/* capacity */ 0);
+  PlanCacheKey key = MakeKey("script");
+  cache.Insert(key, 10 * kMinute, MakePlan(5 * kMinute, 10 * kMinute));
+  cache.Insert(key, 11 * kMinute, MakePlan(6 * kMinute, 11 * kMinute));
+  EXPECT_FALSE(cache.Lookup(key, 12 * kMinute).has_value());
+  EXPECT_EQ(cache.stats().size, 0);
+}
+
+}  // namespace planner
+}  // namespace carnot
+}  // namespace px
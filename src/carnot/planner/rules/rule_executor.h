@@ -17,16 +17,26 @@
  */
 
 #pragma once
+#include <cctype>
+#include <chrono>
 #include <memory>
+#include <optional>
 #include <string>
+#include <string_view>
+#include <typeinfo>
 #include <unordered_map>
 #include <utility>
 #include <vector>
 
+#include <absl/container/flat_hash_map.h>
+#include <absl/container/flat_hash_set.h>
+
 #include "src/carnot/planner/compiler_state/compiler_state.h"
 #include "src/carnot/planner/ir/ir_nodes.h"
 #include "src/carnot/planner/rules/rules.h"
 
+DECLARE_bool(planner_incremental_rules);
+
 namespace px {
 namespace carnot {
 namespace planner {
@@ -116,6 +126,54 @@ class BaseRuleBatch {
 
 using RuleBatch = BaseRuleBatch<Rule>;
 
+/**
+ * @brief Counters for the executions of one rule of a rule batch.
+ */
+struct RuleExecutionStats {
+  std::string batch_name;
+  std::string rule_name;
+  // Number of times the rule was run over the whole graph.
+  int64_t num_full_runs = 0;
+  // Number of times a local rule was run over the neighborhood of the changed nodes only.
+  int64_t num_incremental_runs = 0;
+  // Number of times the rule was skipped because nothing changed since it last made no changes.
+  int64_t num_skipped_runs = 0;
+  // Number of runs that changed the graph.
+  int64_t num_changing_runs = 0;
+  int64_t num_nodes_applied = 0;
+  std::chrono::nanoseconds time{0};
+
+  std::string DebugString() const {
+    return absl::Substitute(
+        "$0/$1: full_runs=$2 incremental_runs=$3 skipped_runs=$4 changing_runs=$5 nodes=$6 "
+        "time=$7us",
+        batch_name, rule_name, num_full_runs, num_incremental_runs, num_skipped_runs,
+        num_changing_runs, num_nodes_applied,
+        std::chrono::duration_cast<std::chrono::microseconds>(time).count());
+  }
+};
+
+/**
+ * @brief Returns the unqualified class name of the rule, e.g. "ResolveTypesRule".
+ */
+template <typename TRule>
+std::string RuleName(const TRule& rule) {
+  // Itanium mangled names of classes in namespaces look like N2px6carnot7planner4NameE. Take the
+  // last length-prefixed component, stopping at template arguments.
+  std::string_view mangled = typeid(rule).name();
+  std::string_view name = mangled;
+  size_t pos = mangled.front() == 'N' ? 1 : 0;
+  while (pos < mangled.size() && std::isdigit(mangled[pos])) {
+    size_t len = 0;
+    while (pos < mangled.size() && std::isdigit(mangled[pos])) {
+      len = len * 10 + (mangled[pos++] - '0');
+    }
+    name = mangled.substr(pos, len);
+    pos += len;
+  }
+  return std::string(name);
+}
+
 template <typename TPlan>
 class RuleExecutor {
   using TRule = BaseRule<TPlan>;
@@ -123,17 +181,56 @@ class RuleExecutor {
 
  public:
   virtual ~RuleExecutor() = default;
-  // TODO(philkuz) figure out how to collect stats on the execution.
   Status Execute(TPlan* ir_graph) {
     for (const auto& rb : rule_batches) {
+      // The change log version after the last run of each rule that didn't change the graph, and
+      // the version at the start of the last run of each rule.
+      std::vector<std::optional<size_t>> unchanged_at(rb->rules().size());
+      std::vector<std::optional<size_t>> last_run_start(rb->rules().size());
       bool can_continue = true;
       int64_t iteration = 0;
       // We continue executing a batch until a stop condition is met.
       while (can_continue) {
         iteration += 1;
         bool graph_is_updated = false;
-        for (const auto& rule : rb->rules()) {
-          PL_ASSIGN_OR_RETURN(bool rule_updates_graph, rule->Execute(ir_graph));
+        for (size_t i = 0; i < rb->rules().size(); ++i) {
+          const auto& rule = rb->rules()[i];
+          RuleExecutionStats* stats = GetStats(rb.get(), i);
+          size_t version = ir_graph->changes().version();
+          // Rules are deterministic, so a rule that made no changes will make none again until
+          // the graph changes.
+          if (FLAGS_planner_incremental_rules && unchanged_at[i] == version) {
+            ++stats->num_skipped_runs;
+            continue;
+          }
+
+          auto start_time = std::chrono::steady_clock::now();
+          int64_t nodes_applied_before = rule->num_nodes_applied();
+          bool rule_updates_graph = false;
+          if (FLAGS_planner_incremental_rules && rule->local() && last_run_start[i].has_value()) {
+            PL_ASSIGN_OR_RETURN(
+                rule_updates_graph,
+                rule->ExecuteOnNodes(ir_graph, ChangedNeighborhood(ir_graph, *last_run_start[i])));
+            ++stats->num_incremental_runs;
+          } else {
+            PL_ASSIGN_OR_RETURN(rule_updates_graph, rule->Execute(ir_graph));
+            ++stats->num_full_runs;
+          }
+          stats->time += std::chrono::steady_clock::now() - start_time;
+          stats->num_nodes_applied += rule->num_nodes_applied() - nodes_applied_before;
+
+          last_run_start[i] = version;
+          if (rule_updates_graph) {
+            ++stats->num_changing_runs;
+            unchanged_at[i].reset();
+            // Rules that override Execute() don't record which nodes they changed. Record the
+            // change so that the other rules don't skip their next run.
+            if (ir_graph->changes().version() == version) {
+              ir_graph->MarkChanged(kUnknownNode);
+            }
+          } else {
+            unchanged_at[i] = ir_graph->changes().version();
+          }
           graph_is_updated = graph_is_updated || rule_updates_graph;
         }
         if (iteration >= rb->max_iterations() && graph_is_updated) {
@@ -141,17 +238,20 @@ class RuleExecutor {
           // TODO(philkuz) Reviewer: should this be a failure somehow?
           can_continue = false;
         }
-        // TODO(philkuz) in the future we might have a fast way to check whether the graph has
-        // changed. For now let's be lazy and leave it up to the user to make sure rules properly
-        // update.
         // (graph_is_updated == false) => the graph has reached a fixed point and is done
         if (!graph_is_updated) {
           can_continue = false;
         }
       }
     }
+    if (VLOG_IS_ON(1)) {
+      for (const auto& stats : rule_stats_) {
+        VLOG(1) << stats.DebugString();
+      }
+    }
     return Status::OK();
   }
+
   template <typename S, typename... Args>
   TRuleBatch* CreateRuleBatch(std::string name, Args... args) {
     std::unique_ptr<TRuleBatch> rb(new TRuleBatch(name, std::make_unique<S>(name, args...)));
@@ -160,8 +260,55 @@ class RuleExecutor {
     return out_ptr;
   }
 
+  /**
+   * @brief Per rule counters, accumulated over all the calls to Execute(). Ordered by batch, then
+   * by the order of the rules within the batch.
+   */
+  const std::vector<RuleExecutionStats>& rule_stats() const { return rule_stats_; }
+
  private:
+  // Node id recorded in the change log when a rule changed the graph without saying where.
+  static constexpr int64_t kUnknownNode = -1;
+
+  RuleExecutionStats* GetStats(TRuleBatch* rb, size_t rule_idx) {
+    auto [it, inserted] = stats_idx_.try_emplace(rb->rules()[rule_idx].get(), rule_stats_.size());
+    if (inserted) {
+      RuleExecutionStats stats;
+      stats.batch_name = rb->name();
+      stats.rule_name = RuleName(*rb->rules()[rule_idx]);
+      rule_stats_.push_back(std::move(stats));
+    }
+    return &rule_stats_[it->second];
+  }
+
+  /**
+   * @brief Returns the nodes changed since the given version together with their parents and
+   * children, or all of the nodes if a change was recorded without a node.
+   */
+  static absl::flat_hash_set<int64_t> ChangedNeighborhood(TPlan* graph, size_t version) {
+    absl::flat_hash_set<int64_t> changed = graph->changes().ChangedSince(version);
+    if (changed.contains(kUnknownNode)) {
+      return graph->dag().nodes();
+    }
+    absl::flat_hash_set<int64_t> neighborhood;
+    for (int64_t node : changed) {
+      if (!graph->HasNode(node)) {
+        continue;
+      }
+      neighborhood.insert(node);
+      for (int64_t parent : graph->dag().ParentsOf(node)) {
+        neighborhood.insert(parent);
+      }
+      for (int64_t child : graph->dag().DependenciesOf(node)) {
+        neighborhood.insert(child);
+      }
+    }
+    return neighborhood;
+  }
+
   std::vector<std::unique_ptr<TRuleBatch>> rule_batches;
+  std::vector<RuleExecutionStats> rule_stats_;
+  absl::flat_hash_map<const TRule*, size_t> stats_idx_;
 };
 
 }  // namespace planner
@@ -162,10 +162,100 @@ TEST_F(RuleExecutorTest, rules_in_batch_correspond) {
       .WillOnce(Return(true))
       .WillOnce(Return(false));
 
+  // rule1_2 isn't rerun in the third iteration because the graph is unchanged since its second
+  // run, which didn't change anything.
+  MockRule* rule1_2 = rule_batch1->AddRule<MockRule>(compiler_state_.get());
+  EXPECT_CALL(*rule1_2, Execute(_)).Times(2).WillOnce(Return(true)).WillRepeatedly(Return(false));
+
+  EXPECT_OK(executor->Execute(graph.get()));
+}
+
+TEST_F(RuleExecutorTest, rules_in_batch_correspond_not_incremental) {
+  FLAGS_planner_incremental_rules = false;
+  std::unique_ptr<TestExecutor> executor = std::move(TestExecutor::Create().ValueOrDie());
+  RuleBatch* rule_batch1 = executor->CreateRuleBatch<FailOnMax>("resolve", 10);
+  MockRule* rule1_1 = rule_batch1->AddRule<MockRule>(compiler_state_.get());
+  EXPECT_CALL(*rule1_1, Execute(_))
+      .Times(3)
+      .WillOnce(Return(false))
+      .WillOnce(Return(true))
+      .WillOnce(Return(false));
+
   MockRule* rule1_2 = rule_batch1->AddRule<MockRule>(compiler_state_.get());
   EXPECT_CALL(*rule1_2, Execute(_)).Times(3).WillOnce(Return(true)).WillRepeatedly(Return(false));
 
   EXPECT_OK(executor->Execute(graph.get()));
+  FLAGS_planner_incremental_rules = true;
+}
+
+// Records the nodes that it's applied to, without changing them.
+class RecordingLocalRule : public Rule {
+ public:
+  RecordingLocalRule()
+      : Rule(/*compiler_state*/ nullptr, /*use_topo*/ false,
+             /*reverse_topological_execution*/ false) {
+    set_local();
+  }
+
+  const std::vector<int64_t>& applied() const { return applied_; }
+
+ protected:
+  StatusOr<bool> Apply(IRNode* ir_node) override {
+    applied_.push_back(ir_node->id());
+    return false;
+  }
+
+ private:
+  std::vector<int64_t> applied_;
+};
+
+// Reports a change to the node with the given id the first time it's applied to it.
+class ChangeOnceRule : public Rule {
+ public:
+  explicit ChangeOnceRule(int64_t node_id)
+      : Rule(/*compiler_state*/ nullptr, /*use_topo*/ false,
+             /*reverse_topological_execution*/ false),
+        node_id_(node_id) {}
+
+ protected:
+  StatusOr<bool> Apply(IRNode* ir_node) override {
+    if (changed_ || ir_node->id() != node_id_) {
+      return false;
+    }
+    changed_ = true;
+    return true;
+  }
+
+ private:
+  int64_t node_id_;
+  bool changed_ = false;
+};
+
+// Tests that local rules are only rerun on the neighborhood of the nodes that changed.
+TEST_F(RuleExecutorTest, local_rules_rerun_on_changed_nodes) {
+  std::unique_ptr<TestExecutor> executor = std::move(TestExecutor::Create().ValueOrDie());
+  RuleBatch* rule_batch = executor->CreateRuleBatch<FailOnMax>("resolve", 10);
+  auto recording_rule = rule_batch->AddRule<RecordingLocalRule>();
+  rule_batch->AddRule<ChangeOnceRule>(int_constant->id());
+
+  ASSERT_OK(executor->Execute(graph.get()));
+
+  // The first run covers the whole graph, the second only the changed constant and its parent.
+  size_t num_nodes = graph->dag().nodes().size();
+  ASSERT_EQ(recording_rule->applied().size(), num_nodes + 2);
+  std::vector<int64_t> second_run(recording_rule->applied().begin() + num_nodes,
+                                  recording_rule->applied().end());
+  EXPECT_THAT(second_run, ::testing::UnorderedElementsAre(int_constant->id(), func->id()));
+
+  const auto& stats = executor->rule_stats();
+  ASSERT_EQ(stats.size(), 2);
+  EXPECT_EQ(stats[0].rule_name, "RecordingLocalRule");
+  EXPECT_EQ(stats[0].num_full_runs, 1);
+  EXPECT_EQ(stats[0].num_incremental_runs, 1);
+  EXPECT_EQ(stats[0].num_nodes_applied, static_cast<int64_t>(num_nodes) + 2);
+  EXPECT_EQ(stats[1].rule_name, "ChangeOnceRule");
+  EXPECT_EQ(stats[1].num_full_runs, 2);
+  EXPECT_EQ(stats[1].num_changing_runs, 1);
 }
 
 // Test to see that if the strategy exits, then following batches don't run.
@@ -25,6 +25,16 @@
 
 #include <absl/container/flat_hash_set.h>
 
+#include "src/carnot/planner/rules/rule_executor.h"
+
+DEFINE_bool(planner_incremental_rules, true,
+            "Whether the rule executor skips rules that can't change the graph since their last "
+            "run, and reruns local rules only on the neighborhood of the changed nodes.");
+DEFINE_int64(planner_stream_agg_allowed_lateness_ms, 10000,
+             "How late rows may arrive at the windowed aggregates of df.stream() queries, compared "
+             "to the newest rows, and still be counted in their window. Stirling pushes records "
+             "out of order, and some (e.g. from connection trackers) well after the push period.");
+
 namespace px {
 namespace carnot {
 namespace planner {
@@ -644,6 +654,35 @@ StatusOr<bool> VerifyFilterExpressionRule::Apply(IRNode* ir_node) {
   return false;
 }
 
+StatusOr<bool> VerifyWindowedAggRule::Apply(IRNode* ir_node) {
+  if (!Match(ir_node, BlockingAgg())) {
+    return false;
+  }
+  auto agg = static_cast<BlockingAggIR*>(ir_node);
+  if (!agg->windowed()) {
+    return false;
+  }
+  PL_ASSIGN_OR_RETURN(auto window_group_idx, agg->WindowGroupIdx());
+
+  // Windows computed as px.bin(df.time_, width) in the parent map have a known width.
+  DCHECK_EQ(agg->parents().size(), 1UL);
+  if (!Match(agg->parents()[0], Map())) {
+    return false;
+  }
+  auto map = static_cast<MapIR*>(agg->parents()[0]);
+  const std::string& window_col = agg->groups()[window_group_idx]->col_name();
+  for (const auto& col_expr : map->col_exprs()) {
+    if (col_expr.name != window_col || !Match(col_expr.node, Func())) {
+      continue;
+    }
+    auto func = static_cast<FuncIR*>(col_expr.node);
+    if (func->func_name() == "bin" && func->args().size() == 2 && Match(func->args()[1], Int())) {
+      agg->SetWindowWidthNS(static_cast<IntIR*>(func->args()[1])->val());
+    }
+  }
+  return false;
+}
+
 StatusOr<bool> DropToMapOperatorRule::Apply(IRNode* ir_node) {
   if (Match(ir_node, UnresolvedReadyOp(Drop()))) {
     return DropToMap(static_cast<DropIR*>(ir_node));
@@ -707,39 +746,9 @@ StatusOr<bool> SetupJoinTypeRule::Apply(IRNode* ir_node) {
   return false;
 }
 
-void SetupJoinTypeRule::FlipColumns(const std::vector<ColumnIR*>& columns) {
-  // Update the columns in the output_columns
-  for (ColumnIR* col : columns) {
-    DCHECK_LT(col->container_op_parent_idx(), 2);
-    // 1 -> 0, 0 -> 1
-    col->SetContainingOperatorParentIdx(1 - col->container_op_parent_idx());
-  }
-}
-
 Status SetupJoinTypeRule::ConvertRightJoinToLeftJoin(JoinIR* join_ir) {
-  DCHECK_EQ(join_ir->parents().size(), 2UL) << "There should be exactly two parents.";
   DCHECK(join_ir->join_type() == JoinIR::JoinType::kRight);
-
-  std::vector<OperatorIR*> old_parents = join_ir->parents();
-  for (OperatorIR* parent : old_parents) {
-    PL_RETURN_IF_ERROR(join_ir->RemoveParent(parent));
-  }
-
-  PL_RETURN_IF_ERROR(join_ir->AddParent(old_parents[1]));
-  PL_RETURN_IF_ERROR(join_ir->AddParent(old_parents[0]));
-
-  FlipColumns(join_ir->left_on_columns());
-  FlipColumns(join_ir->right_on_columns());
-  FlipColumns(join_ir->output_columns());
-
-  // TODO(philkuz) dependent upon how we actually do anything with output columns, this might change
-  if (join_ir->suffix_strs().size() != 0) {
-    DCHECK_EQ(join_ir->suffix_strs().size(), 2UL);
-    std::string left = join_ir->suffix_strs()[0];
-    std::string right = join_ir->suffix_strs()[1];
-    join_ir->SetSuffixStrs({right, left});
-  }
-
+  PL_RETURN_IF_ERROR(join_ir->SwapParents());
   return join_ir->SetJoinType(JoinIR::JoinType::kLeft);
 }
 
@@ -1281,8 +1290,8 @@ StatusOr<bool> ResolveStreamRule::Apply(IRNode* ir_node) {
 
   auto stream_node = static_cast<StreamIR*>(ir_node);
 
-  // Check for blocking nodes in the ancestors.
-  // Currently not supported to stream on queries containing blocking operators.
+  // Check for blocking nodes in the ancestors. Aggregates are supported by emitting the result of
+  // each time window once it closes. Other blocking operators are not yet supported in streams.
   DCHECK_EQ(stream_node->parents().size(), 1UL);
   OperatorIR* parent = stream_node->parents()[0];
   std::queue<OperatorIR*> nodes;
@@ -1292,7 +1301,11 @@ StatusOr<bool> ResolveStreamRule::Apply(IRNode* ir_node) {
     auto node = nodes.front();
     nodes.pop();
 
-    if (node->IsBlocking()) {
+    if (Match(node, BlockingAgg())) {
+      auto agg = static_cast<BlockingAggIR*>(node);
+      agg->SetWindowed(true);
+      agg->SetAllowedLatenessNS(FLAGS_planner_stream_agg_allowed_lateness_ms * 1000 * 1000);
+    } else if (node->IsBlocking()) {
       return error::Unimplemented("df.stream() not yet supported with blocking operator %s",
                                   node->DebugString());
     }
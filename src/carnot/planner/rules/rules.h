@@ -17,12 +17,14 @@
  */
 
 #pragma once
+#include <algorithm>
 #include <memory>
 #include <queue>
 #include <string>
 #include <vector>
 
 #include <absl/container/flat_hash_map.h>
+#include <absl/container/flat_hash_set.h>
 
 #include "src/carnot/planner/compiler_state/compiler_state.h"
 #include "src/carnot/planner/compiler_state/registry_info.h"
@@ -31,6 +33,8 @@
 #include "src/carnot/planner/ir/time.h"
 #include "src/carnot/planner/metadata/metadata_handler.h"
 
+DECLARE_int64(planner_stream_agg_allowed_lateness_ms);
+
 namespace px {
 namespace carnot {
 namespace planner {
@@ -46,6 +50,8 @@ struct RuleTraits<IR> {
 template <typename TPlan>
 class BaseRule {
  public:
+  using TNode = typename RuleTraits<TPlan>::node_type;
+
   BaseRule() = delete;
   BaseRule(CompilerState* compiler_state, bool use_topo, bool reverse_topological_execution)
       : compiler_state_(compiler_state),
@@ -65,38 +71,51 @@ class BaseRule {
     return any_changed;
   }
 
- protected:
-  StatusOr<bool> ExecuteTopologicalSorted(TPlan* graph) {
-    bool any_changed = false;
-    std::vector<int64_t> topo_graph = graph->dag().TopologicalSort();
-    if (reverse_topological_execution_) {
-      std::reverse(topo_graph.begin(), topo_graph.end());
-    }
-    for (int64_t node_i : topo_graph) {
-      // The node may have been deleted by a prior call to Apply on a parent or child node.
-      if (!graph->HasNode(node_i)) {
-        continue;
+  /**
+   * @brief Applies the rule to the nodes in node_ids only, in the same order Execute() would.
+   * Ids of nodes that no longer exist are ignored.
+   */
+  StatusOr<bool> ExecuteOnNodes(TPlan* graph, const absl::flat_hash_set<int64_t>& node_ids) {
+    std::vector<int64_t> nodes;
+    if (!use_topo_) {
+      nodes.assign(node_ids.begin(), node_ids.end());
+      std::sort(nodes.begin(), nodes.end());
+    } else {
+      for (int64_t node_i : TopologicalOrder(graph)) {
+        if (node_ids.contains(node_i)) {
+          nodes.push_back(node_i);
+        }
       }
-      PL_ASSIGN_OR_RETURN(bool node_is_changed, Apply(graph->Get(node_i)));
-      any_changed = any_changed || node_is_changed;
     }
+    PL_ASSIGN_OR_RETURN(bool any_changed, ApplyToNodes(graph, nodes));
+    PL_RETURN_IF_ERROR(EmptyDeleteQueue(graph));
     return any_changed;
   }
 
+  /**
+   * @brief Whether applying this rule to a node only depends on the state of that node and of its
+   * direct parents and children. The RuleExecutor reruns local rules on the neighborhood of the
+   * nodes that changed since their previous run, instead of on the whole graph. Rules that
+   * override Execute() must not be local.
+   */
+  bool local() const { return local_; }
+
+  /**
+   * @brief The number of nodes this rule was applied to since it was created.
+   */
+  int64_t num_nodes_applied() const { return num_nodes_applied_; }
+
+ protected:
+  StatusOr<bool> ExecuteTopologicalSorted(TPlan* graph) {
+    return ApplyToNodes(graph, TopologicalOrder(graph));
+  }
+
   StatusOr<bool> ExecuteUnsorted(TPlan* graph) {
-    bool any_changed = false;
     // We need to copy over nodes because the Apply() might add nodes which can affect traversal,
     // causing nodes to be skipped.
-    auto nodes = graph->dag().nodes();
-    for (int64_t node_i : nodes) {
-      // The node may have been deleted by a prior call to Apply on a parent or child node.
-      if (!graph->HasNode(node_i)) {
-        continue;
-      }
-      PL_ASSIGN_OR_RETURN(bool node_is_changed, Apply(graph->Get(node_i)));
-      any_changed = any_changed || node_is_changed;
-    }
-    return any_changed;
+    const auto& dag_nodes = graph->dag().nodes();
+    std::vector<int64_t> nodes(dag_nodes.begin(), dag_nodes.end());
+    return ApplyToNodes(graph, nodes);
   }
 
   /**
@@ -109,7 +128,20 @@ class BaseRule {
    * @return false: if the rule does nothing to the node.
    * @return Status: error if something goes wrong during the rule application.
    */
-  virtual StatusOr<bool> Apply(typename RuleTraits<TPlan>::node_type* node) = 0;
+  virtual StatusOr<bool> Apply(TNode* node) = 0;
+
+  /**
+   * @brief Returns false for nodes that Apply() never changes, so that they are skipped without
+   * calling Apply(). Rules that only match a few node types should override this with a check of
+   * the node type.
+   */
+  virtual bool MatchesNodeType(TNode*) const { return true; }
+
+  /**
+   * @brief Marks the rule as local. See local().
+   */
+  void set_local() { local_ = true; }
+
   void DeferNodeDeletion(int64_t node) { node_delete_q.push(node); }
 
   Status EmptyDeleteQueue(TPlan* graph) {
@@ -125,6 +157,39 @@ class BaseRule {
   CompilerState* compiler_state_;
   bool use_topo_;
   bool reverse_topological_execution_;
+
+ private:
+  std::vector<int64_t> TopologicalOrder(TPlan* graph) const {
+    std::vector<int64_t> topo_graph = graph->dag().TopologicalSort();
+    if (reverse_topological_execution_) {
+      std::reverse(topo_graph.begin(), topo_graph.end());
+    }
+    return topo_graph;
+  }
+
+  StatusOr<bool> ApplyToNodes(TPlan* graph, const std::vector<int64_t>& nodes) {
+    bool any_changed = false;
+    for (int64_t node_i : nodes) {
+      // The node may have been deleted by a prior call to Apply on a parent or child node.
+      if (!graph->HasNode(node_i)) {
+        continue;
+      }
+      TNode* node = graph->Get(node_i);
+      if (!MatchesNodeType(node)) {
+        continue;
+      }
+      ++num_nodes_applied_;
+      PL_ASSIGN_OR_RETURN(bool node_is_changed, Apply(node));
+      if (node_is_changed) {
+        graph->MarkChanged(node_i);
+      }
+      any_changed = any_changed || node_is_changed;
+    }
+    return any_changed;
+  }
+
+  bool local_ = false;
+  int64_t num_nodes_applied_ = 0;
 };
 
 using Rule = BaseRule<IR>;
@@ -162,6 +227,7 @@ class DataTypeRule : public Rule {
 
  protected:
   StatusOr<bool> Apply(IRNode* ir_node) override;
+  bool MatchesNodeType(IRNode* ir_node) const override { return ir_node->IsExpression(); }
   static StatusOr<bool> EvaluateMetadata(MetadataIR* md);
 };
 
@@ -190,10 +256,16 @@ class OperatorRelationRule : public Rule {
    */
  public:
   explicit OperatorRelationRule(CompilerState* compiler_state)
-      : Rule(compiler_state, /*use_topo*/ false, /*reverse_topological_execution*/ false) {}
+      : Rule(compiler_state, /*use_topo*/ false, /*reverse_topological_execution*/ false) {
+    // An operator's relation only depends on its parents' relations and its own expressions.
+    set_local();
+  }
 
   StatusOr<bool> Apply(IRNode* ir_node) override;
 
+ protected:
+  bool MatchesNodeType(IRNode* ir_node) const override { return ir_node->IsOperator(); }
+
  private:
   StatusOr<bool> SetBlockingAgg(BlockingAggIR* agg_ir) const;
   StatusOr<bool> SetMap(MapIR* map_ir) const;
@@ -293,16 +365,39 @@ class VerifyFilterExpressionRule : public Rule {
   StatusOr<bool> Apply(IRNode* ir_node) override;
 };
 
+class VerifyWindowedAggRule : public Rule {
+  /**
+   * @brief Checks that windowed (streaming) aggregates group by exactly one time column. The time
+   * column holds the start of each window, which decides when the results of a window can be
+   * emitted. Also records the width of the windows when it is known, since the allowed lateness
+   * has to cover it.
+   */
+ public:
+  explicit VerifyWindowedAggRule(CompilerState* compiler_state)
+      : Rule(compiler_state, /*use_topo*/ false, /*reverse_topological_execution*/ false) {}
+
+ protected:
+  StatusOr<bool> Apply(IRNode* ir_node) override;
+  bool MatchesNodeType(IRNode* ir_node) const override {
+    return ir_node->type() == IRNodeType::kBlockingAgg;
+  }
+};
+
 class DropToMapOperatorRule : public Rule {
   /**
    * @brief Takes a DropIR and converts it to the corresponding Map IR.
    */
  public:
   explicit DropToMapOperatorRule(CompilerState* compiler_state)
-      : Rule(compiler_state, /*use_topo*/ false, /*reverse_topological_execution*/ false) {}
+      : Rule(compiler_state, /*use_topo*/ false, /*reverse_topological_execution*/ false) {
+    set_local();
+  }
 
  protected:
   StatusOr<bool> Apply(IRNode* ir_node) override;
+  bool MatchesNodeType(IRNode* ir_node) const override {
+    return ir_node->type() == IRNodeType::kDrop;
+  }
 
  private:
   StatusOr<bool> DropToMap(DropIR* drop_ir);
@@ -325,7 +420,6 @@ class SetupJoinTypeRule : public Rule {
    * @brief Swaps the parents and updates any parent references within Join's children nodes.
    */
   Status ConvertRightJoinToLeftJoin(JoinIR* join_ir);
-  void FlipColumns(const std::vector<ColumnIR*>& cols);
 };
 
 /**
@@ -569,15 +663,19 @@ class ResolveTypesRule : public Rule {
    */
  public:
   explicit ResolveTypesRule(CompilerState* compiler_state)
-      : Rule(compiler_state, /*use_topo*/ true, /*reverse_topological_execution*/ false) {}
+      : Rule(compiler_state, /*use_topo*/ true, /*reverse_topological_execution*/ false) {
+    set_local();
+  }
 
  protected:
   StatusOr<bool> Apply(IRNode* ir_node) override;
+  bool MatchesNodeType(IRNode* ir_node) const override { return ir_node->IsOperator(); }
 };
 
 class ResolveStreamRule : public Rule {
   /**
    * @brief Resolves StreamIRs by setting their ancestor MemorySource nodes to streaming mode.
+   * Ancestor aggregates are made windowed, so that they emit results as the stream advances.
    */
  public:
   ResolveStreamRule()
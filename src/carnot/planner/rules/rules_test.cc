@@ -2479,16 +2479,75 @@ TEST_F(RulesTest, resolve_stream_no_stream) {
 }
 
 TEST_F(RulesTest, resolve_stream_blocking_ancestor) {
+  MemorySourceIR* mem_source = MakeMemSource();
+  LimitIR* limit = MakeLimit(mem_source, 10);
+  StreamIR* stream = graph->CreateNode<StreamIR>(ast, limit).ValueOrDie();
+  MakeMemSink(stream, "");
+
+  ResolveStreamRule rule;
+  auto result = rule.Execute(graph.get());
+  ASSERT_NOT_OK(result);
+}
+
+TEST_F(RulesTest, resolve_stream_agg_ancestor) {
   MemorySourceIR* mem_source = MakeMemSource();
   GroupByIR* group_by = MakeGroupBy(mem_source, {MakeColumn("col1", 0), MakeColumn("col2", 0)});
   BlockingAggIR* agg =
       MakeBlockingAgg(group_by, {}, {{"outcount", MakeMeanFunc(MakeColumn("count", 0))}});
   StreamIR* stream = graph->CreateNode<StreamIR>(ast, agg).ValueOrDie();
-  MakeMemSink(stream, "");
+  MemorySinkIR* sink = MakeMemSink(stream, "");
+  EXPECT_FALSE(agg->windowed());
 
   ResolveStreamRule rule;
   auto result = rule.Execute(graph.get());
-  ASSERT_NOT_OK(result);
+  ASSERT_OK(result);
+  EXPECT_TRUE(result.ValueOrDie());
+  EXPECT_TRUE(mem_source->streaming());
+  EXPECT_TRUE(agg->windowed());
+  EXPECT_THAT(sink->parents(), ElementsAre(agg));
+}
+
+TEST_F(RulesTest, verify_windowed_agg_time_group) {
+  MemorySourceIR* mem_source = MakeMemSource();
+  BlockingAggIR* agg =
+      MakeBlockingAgg(mem_source, {MakeColumn("time_", 0, types::TIME64NS)},
+                      {{"outcount", MakeMeanFunc(MakeColumn("count", 0))}});
+  MakeMemSink(agg, "");
+  agg->SetWindowed(true);
+
+  VerifyWindowedAggRule rule(compiler_state_.get());
+  auto result = rule.Execute(graph.get());
+  ASSERT_OK(result);
+  EXPECT_FALSE(result.ValueOrDie());
+}
+
+TEST_F(RulesTest, verify_windowed_agg_no_time_group) {
+  MemorySourceIR* mem_source = MakeMemSource();
+  BlockingAggIR* agg =
+      MakeBlockingAgg(mem_source, {MakeColumn("col1", 0, types::INT64)},
+                      {{"outcount", MakeMeanFunc(MakeColumn("count", 0))}});
+  MakeMemSink(agg, "");
+
+  VerifyWindowedAggRule rule(compiler_state_.get());
+  // Blocking aggregates don't need a time column.
+  ASSERT_OK(rule.Execute(graph.get()));
+
+  agg->SetWindowed(true);
+  EXPECT_NOT_OK(rule.Execute(graph.get()));
+}
+
+TEST_F(RulesTest, verify_windowed_agg_two_time_groups) {
+  MemorySourceIR* mem_source = MakeMemSource();
+  BlockingAggIR* agg = MakeBlockingAgg(
+      mem_source,
+      {MakeColumn("time_", 0, types::TIME64NS), MakeColumn("other_time", 0, types::TIME64NS)},
+      {{"outcount", MakeMeanFunc(MakeColumn("count", 0))}});
+  MakeMemSink(agg, "");
+  agg->SetWindowed(true);
+
+  // The window column would be ambiguous.
+  VerifyWindowedAggRule rule(compiler_state_.get());
+  EXPECT_NOT_OK(rule.Execute(graph.get()));
 }
 
 TEST_F(RulesTest, resolve_stream_non_mem_sink_child) {
@@ -536,6 +536,29 @@ std::string FourPEMsOneKelvinDistributedState() {
        MakeKelvinCarnotInfo("kelvin", "00000001-0000-0000-0000-000000000003", "1111", 789)});
 }
 
+/**
+ * @brief Makes a distributed state with num_pems untabletized PEMs and a single Kelvin. Used to
+ * exercise the distributed planner on large clusters.
+ */
+std::string ManyPEMsOneKelvinDistributedState(int64_t num_pems) {
+  std::vector<std::string> carnot_infos;
+  for (int64_t i = 1; i <= num_pems + 1; ++i) {
+    std::string id = std::to_string(i);
+    id = "00000001-0000-0000-0000-" + std::string(12 - id.size(), '0') + id;
+    if (i <= num_pems) {
+      carnot_infos.push_back(MakePEMCarnotInfo(absl::StrCat("pem", i), id, i, {""}));
+    } else {
+      carnot_infos.push_back(MakeKelvinCarnotInfo("kelvin", id, "1111", i));
+    }
+  }
+  return MakeDistributedState(carnot_infos);
+}
+
+distributedpb::LogicalPlannerState CreateManyPEMsOneKelvinPlannerState(
+    int64_t num_pems, table_store::schemapb::Schema schema) {
+  return LoadLogicalPlannerStatePB(ManyPEMsOneKelvinDistributedState(num_pems), schema);
+}
+
 distributedpb::LogicalPlannerState CreateTwoPEMsOneKelvinPlannerState(const std::string& schema) {
   std::string distributed_state_proto = TwoPEMsOneKelvinDistributedState();
   return LoadLogicalPlannerStatePB(distributed_state_proto, schema);
@@ -74,6 +74,12 @@ class AnyUDA : public BaseFunc {
  *      Status Init(FunctionContext *ctx, UDFValue... init_args) {}
  *  This function is called once during initialization of each instance (many instances
  *  may exists in a given query). The arguments are as provided by the query.
+ *
+ *  If the types of init_args match the trailing arguments of Exec, and the query passes
+ *  literals for those arguments, the expression evaluator binds them by calling Init with
+ *  the literal values before the first call to Exec. This allows the UDF to precompute state
+ *  (parsed patterns, decoded models, etc.) once instead of per record. Exec still receives
+ *  the values and must work when Init was not called (ie. the arguments are columns).
  */
 class ScalarUDF : public AnyUDF {
  public:
@@ -188,6 +194,24 @@ static constexpr types::DataType ReturnTypeHelper(ReturnType (TUDF::*)(Types...)
   return types::ValueTypeTraits<ReturnType>::data_type;
 }
 
+/**
+ * Checks that the init argument types are a non-empty suffix of the exec argument types.
+ */
+template <std::size_t NInit, std::size_t NExec>
+static constexpr bool InitArgsMatchTrailingExecArgs(
+    const std::array<types::DataType, NInit>& init_args,
+    const std::array<types::DataType, NExec>& exec_args) {
+  if (NInit == 0 || NInit > NExec) {
+    return false;
+  }
+  for (std::size_t i = 0; i < NInit; ++i) {
+    if (init_args[i] != exec_args[NExec - NInit + i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
 template <typename T, typename = void>
 struct check_init_fn {};
 
@@ -223,6 +247,24 @@ class ScalarUDFTraits {
    */
   static constexpr bool HasInit() { return has_udf_init_fn<T>::value; }
 
+  /**
+   * Arguments types of Init. Only valid if HasInit() is true.
+   * @return a vector of UDF data types.
+   */
+  static constexpr auto InitArguments() { return GetArgumentTypesHelper(&T::Init); }
+
+  /**
+   * Checks if the Init function binds the trailing arguments of Exec, ie. whether
+   * constant Exec arguments can be passed to Init once per instance.
+   * @return true if Init can be used to bind constant arguments.
+   */
+  static constexpr bool HasBindableInit() {
+    if constexpr (HasInit()) {
+      return InitArgsMatchTrailingExecArgs(InitArguments(), ExecArguments());
+    }
+    return false;
+  }
+
   /**
    * Returns the executor type of this UDF.
    */
@@ -95,6 +95,12 @@ class ScalarUDFDefinition : public UDFDefinition {
     exec_arguments_ = {begin(exec_arguments_array), end(exec_arguments_array)};
     exec_wrapper_fn_ = ScalarUDFWrapper<TUDF>::ExecBatch;
     exec_wrapper_arrow_fn_ = ScalarUDFWrapper<TUDF>::ExecBatchArrow;
+    exec_init_fn_ = ScalarUDFWrapper<TUDF>::Init;
+
+    if constexpr (ScalarUDFTraits<TUDF>::HasBindableInit()) {
+      auto init_arguments_array = ScalarUDFTraits<TUDF>::InitArguments();
+      init_arguments_ = {begin(init_arguments_array), end(init_arguments_array)};
+    }
 
     make_fn_ = ScalarUDFWrapper<TUDF>::Make;
 
@@ -111,6 +117,15 @@ class ScalarUDFDefinition : public UDFDefinition {
 
   std::unique_ptr<ScalarUDF> Make() { return make_fn_(); }
 
+  /**
+   * Binds constant arguments to the UDF instance by calling its Init function.
+   * @param args The values of the trailing Exec arguments, one per entry in init_arguments().
+   */
+  Status ExecInit(ScalarUDF* udf, FunctionContext* ctx,
+                  const std::vector<const types::BaseValueType*>& args) {
+    return exec_init_fn_(udf, ctx, args);
+  }
+
   Status ExecBatch(ScalarUDF* udf, FunctionContext* ctx,
                    const std::vector<const types::ColumnWrapper*>& inputs,
                    types::ColumnWrapper* output, int count) {
@@ -129,6 +144,11 @@ class ScalarUDFDefinition : public UDFDefinition {
    */
   types::DataType exec_return_type() const { return exec_return_type_; }
   const std::vector<types::DataType>& exec_arguments() const { return exec_arguments_; }
+  /**
+   * The types of the trailing Exec arguments that can be bound with ExecInit.
+   * Empty if the UDF does not support binding constant arguments.
+   */
+  const std::vector<types::DataType>& init_arguments() const { return init_arguments_; }
   udfspb::UDFSourceExecutor executor() const { return executor_; }
 
   const std::vector<types::DataType>& RegistryArgTypes() override { return exec_arguments_; }
@@ -137,9 +157,13 @@ class ScalarUDFDefinition : public UDFDefinition {
 
  private:
   std::vector<types::DataType> exec_arguments_;
+  std::vector<types::DataType> init_arguments_;
   types::DataType exec_return_type_;
   udfspb::UDFSourceExecutor executor_;
   std::function<std::unique_ptr<ScalarUDF>()> make_fn_;
+  std::function<Status(ScalarUDF*, FunctionContext* ctx,
+                       const std::vector<const types::BaseValueType*>& args)>
+      exec_init_fn_;
   std::function<Status(ScalarUDF*, FunctionContext* ctx,
                        const std::vector<const types::ColumnWrapper*>& inputs,
                        types::ColumnWrapper* output, int count)>
@@ -180,6 +204,8 @@ class UDADefinition : public UDFDefinition {
     merge_fn_ = UDAWrapper<T>::Merge;
     finalize_arrow_fn_ = UDAWrapper<T>::FinalizeArrow;
     finalize_value_fn = UDAWrapper<T>::FinalizeValue;
+    serialize_fn_ = UDAWrapper<T>::Serialize;
+    deserialize_fn_ = UDAWrapper<T>::Deserialize;
 
     supports_partial_ = UDAWrapper<T>::SupportsPartial;
     return Status::OK();
@@ -212,6 +238,12 @@ class UDADefinition : public UDFDefinition {
   Status FinalizeArrow(UDA* uda, FunctionContext* ctx, arrow::ArrayBuilder* output) {
     return finalize_arrow_fn_(uda, ctx, output);
   }
+  StatusOr<types::StringValue> Serialize(UDA* uda, FunctionContext* ctx) {
+    return serialize_fn_(uda, ctx);
+  }
+  Status Deserialize(UDA* uda, FunctionContext* ctx, const types::StringValue& data) {
+    return deserialize_fn_(uda, ctx, data);
+  }
 
  private:
   std::vector<types::DataType> update_arguments_;
@@ -232,6 +264,9 @@ class UDADefinition : public UDFDefinition {
   std::function<Status(UDA* uda, FunctionContext* ctx, types::BaseValueType* output)>
       finalize_value_fn;
   std::function<Status(UDA* uda1, UDA* uda2, FunctionContext* ctx)> merge_fn_;
+  std::function<StatusOr<types::StringValue>(UDA* uda, FunctionContext* ctx)> serialize_fn_;
+  std::function<Status(UDA* uda, FunctionContext* ctx, const types::StringValue& data)>
+      deserialize_fn_;
 };
 
 class UDTFDefinition : public UDFDefinition {
@@ -20,6 +20,7 @@
 #include <arrow/pretty_print.h>
 
 #include <algorithm>
+#include <string>
 
 #include "src/carnot/udf/udf_definition.h"
 #include "src/common/testing/testing.h"
@@ -186,6 +187,51 @@ TEST(UDADefinition, arrow_output) {
   EXPECT_EQ(5, casted->Value(0));
 }
 
+// MinSumUDA with support for partial aggregates.
+class PartialMinSumUDA : public MinSumUDA {
+ public:
+  void Merge(udf::FunctionContext*, const PartialMinSumUDA& other) {
+    sum_ = sum_.val + other.sum_.val;
+  }
+  types::StringValue Serialize(udf::FunctionContext*) { return std::to_string(sum_.val); }
+  Status Deserialize(udf::FunctionContext*, const types::StringValue& data) {
+    sum_ = std::stoll(data);
+    return Status::OK();
+  }
+};
+
+TEST(UDADefinition, serialize_deserialize) {
+  auto ctx = FunctionContext(nullptr, nullptr);
+  UDADefinition def("minsum");
+  EXPECT_OK(def.Init<PartialMinSumUDA>());
+  EXPECT_TRUE(def.supports_partial());
+
+  types::Int64ValueColumnWrapper v1({1, 2, 3});
+  types::Int64ValueColumnWrapper v2({5, 1, 3});
+
+  auto u1 = def.Make();
+  EXPECT_OK(def.ExecBatchUpdate(u1.get(), &ctx, {&v1, &v2}));
+  auto serialized_or_s = def.Serialize(u1.get(), &ctx);
+  ASSERT_OK(serialized_or_s);
+
+  auto u2 = def.Make();
+  EXPECT_OK(def.Deserialize(u2.get(), &ctx, serialized_or_s.ConsumeValueOrDie()));
+  types::Int64Value out;
+  EXPECT_OK(def.FinalizeValue(u2.get(), &ctx, &out));
+  EXPECT_EQ(5, out.val);
+}
+
+TEST(UDADefinition, serialize_without_partial_support) {
+  auto ctx = FunctionContext(nullptr, nullptr);
+  UDADefinition def("minsum");
+  EXPECT_OK(def.Init<MinSumUDA>());
+  EXPECT_FALSE(def.supports_partial());
+
+  auto u = def.Make();
+  EXPECT_NOT_OK(def.Serialize(u.get(), &ctx));
+  EXPECT_NOT_OK(def.Deserialize(u.get(), &ctx, "5"));
+}
+
 }  // namespace udf
 }  // namespace carnot
 }  // namespace px
@@ -43,12 +43,21 @@ class ScalarUDF1WithInit : ScalarUDF {
   types::Int64Value Exec(FunctionContext*, types::BoolValue, types::BoolValue) { return 0; }
 };
 
+class ScalarUDF1WithBindableInit : ScalarUDF {
+ public:
+  Status Init(FunctionContext*, types::Int64Value) { return Status::OK(); }
+  types::Int64Value Exec(FunctionContext*, types::BoolValue, types::Int64Value) { return 0; }
+};
+
 TEST(ScalarUDF, basic_tests) {
   EXPECT_EQ(types::DataType::INT64, ScalarUDFTraits<ScalarUDF1>::ReturnType());
   EXPECT_THAT(ScalarUDFTraits<ScalarUDF1>::ExecArguments(),
               ElementsAre(types::DataType::BOOLEAN, types::DataType::INT64));
   EXPECT_FALSE(ScalarUDFTraits<ScalarUDF1>::HasInit());
   EXPECT_TRUE(ScalarUDFTraits<ScalarUDF1WithInit>::HasInit());
+  EXPECT_FALSE(ScalarUDFTraits<ScalarUDF1>::HasBindableInit());
+  EXPECT_FALSE(ScalarUDFTraits<ScalarUDF1WithInit>::HasBindableInit());
+  EXPECT_TRUE(ScalarUDFTraits<ScalarUDF1WithBindableInit>::HasBindableInit());
 }
 
 TEST(UDFDataTypes, valid_tests) {
@@ -68,6 +68,33 @@ Status ExecWrapper(TUDF* udf, FunctionContext* ctx, size_t count, TOutput* out,
   return Status::OK();
 }
 
+/**
+ * Same as ExecWrapper, but each argument is indexed using a stride. A stride of 0 is used
+ * for broadcast arguments (ie. constants), which are passed in as a single value instead of
+ * being materialized into a full column.
+ *
+ * @return Status of execution.
+ */
+template <typename TUDF, typename TOutput, std::size_t... I>
+Status ExecWrapperBroadcast(TUDF* udf, FunctionContext* ctx, size_t count, TOutput* out,
+                            const std::vector<const types::BaseValueType*>& args,
+                            const std::array<size_t, sizeof...(I)>& strides,
+                            std::index_sequence<I...>) {
+  [[maybe_unused]] constexpr auto exec_argument_types = ScalarUDFTraits<TUDF>::ExecArguments();
+  for (size_t idx = 0; idx < count; ++idx) {
+    out[idx] = udf->Exec(
+        ctx, CastToUDFValueType<exec_argument_types[I]>(args[I])[idx * strides[I]]...);
+  }
+  return Status::OK();
+}
+
+/**
+ * Returns true if an input of the given size should be broadcast over count records.
+ */
+inline bool IsBroadcastInput(size_t input_size, size_t count) {
+  return input_size == 1 && count > 1;
+}
+
 // Returns the underlying data from a UDF value.
 template <typename T>
 inline auto UnWrap(const T& v) {
@@ -97,9 +124,12 @@ Status ExecWrapperArrow(TUDF* udf, FunctionContext* ctx, size_t count, TOutput*
   if constexpr (std::is_same_v<arrow::StringBuilder, TOutput>) {
     CHECK(out->ReserveData(reserved).ok());
   }
+  // Single element inputs are constants that get broadcast to all the records.
+  [[maybe_unused]] const std::array<size_t, sizeof...(I)> strides = {
+      (IsBroadcastInput(args[I]->length(), count) ? 0UL : 1UL)...};
   for (size_t idx = 0; idx < count; ++idx) {
-    auto res = UnWrap(
-        udf->Exec(ctx, types::GetValueFromArrowArray<exec_argument_types[I]>(args[I], idx)...));
+    auto res = UnWrap(udf->Exec(
+        ctx, types::GetValueFromArrowArray<exec_argument_types[I]>(args[I], idx * strides[I])...));
 
     // We use doubling to make sure we minimize the number of allocations.
     // PL_CARNOT_UPDATE_FOR_NEW_TYPES.
@@ -153,6 +183,29 @@ template <typename TUDF>
 struct ScalarUDFWrapper {
   static std::unique_ptr<ScalarUDF> Make() { return std::make_unique<TUDF>(); }
 
+  /**
+   * Binds the constant trailing arguments of Exec by calling the UDF's Init function.
+   * This is a no-op for UDFs that don't have a bindable Init function.
+   *
+   * @param udf a pointer to the UDF.
+   * @param ctx The function context.
+   * @param args The constant values, one per Init argument.
+   * @return Status of Init.
+   */
+  static Status Init(ScalarUDF* udf, FunctionContext* ctx,
+                     const std::vector<const types::BaseValueType*>& args) {
+    if constexpr (ScalarUDFTraits<TUDF>::HasBindableInit()) {
+      DCHECK(args.size() == ScalarUDFTraits<TUDF>::InitArguments().size());
+      return InitExecWrapper(
+          static_cast<TUDF*>(udf), ctx, args,
+          std::make_index_sequence<ScalarUDFTraits<TUDF>::InitArguments().size()>{});
+    }
+    PL_UNUSED(udf);
+    PL_UNUSED(ctx);
+    PL_UNUSED(args);
+    return Status::OK();
+  }
+
   /**
    * Provides a method that executes the tempalated UDF on a batch of inputs.
    * The input batches are represented as vector of arrow:array pointers.
@@ -222,6 +275,21 @@ struct ScalarUDFWrapper {
 
     using output_type = typename types::DataTypeTraits<return_type>::value_type;
     auto* casted_output = static_cast<output_type*>(output->UnsafeRawData());
+
+    // Single element inputs are constants that get broadcast to all the records.
+    std::array<size_t, exec_argument_types.size()> strides;
+    bool has_broadcast_input = false;
+    for (size_t i = 0; i < inputs.size(); ++i) {
+      bool broadcast = IsBroadcastInput(inputs[i]->Size(), count);
+      strides[i] = broadcast ? 0 : 1;
+      has_broadcast_input |= broadcast;
+    }
+    if (has_broadcast_input) {
+      return ExecWrapperBroadcast<TUDF>(static_cast<TUDF*>(udf), ctx, count, casted_output,
+                                        input_as_base_value, strides,
+                                        std::make_index_sequence<exec_argument_types.size()>{});
+    }
+
     // The outer wrapper just casts the output type and UDF type. We then pass in
     // the inputs with a sequence based on the number of arguments to iterate through and
     // cast the inputs.
@@ -229,6 +297,15 @@ struct ScalarUDFWrapper {
                              input_as_base_value,
                              std::make_index_sequence<exec_argument_types.size()>{});
   }
+
+ private:
+  template <std::size_t... I>
+  static Status InitExecWrapper(TUDF* udf, FunctionContext* ctx,
+                                const std::vector<const types::BaseValueType*>& args,
+                                std::index_sequence<I...>) {
+    [[maybe_unused]] constexpr auto init_argument_types = ScalarUDFTraits<TUDF>::InitArguments();
+    return udf->Init(ctx, *CastToUDFValueType<init_argument_types[I]>(args[I])...);
+  }
 };
 
 /**
@@ -353,6 +430,36 @@ struct UDAWrapper {
     *casted_output = casted_uda->Finalize(ctx);
     return Status::OK();
   }
+
+  /**
+   * Serialize the partial state of the UDA. Only valid for UDAs that support partial aggregates.
+   * @return The serialized state or an error if the UDA doesn't support partial aggregates.
+   */
+  static StatusOr<types::StringValue> Serialize(UDA* uda, FunctionContext* ctx) {
+    if constexpr (SupportsPartial) {
+      return static_cast<TUDA*>(uda)->Serialize(ctx);
+    }
+    PL_UNUSED(uda);
+    PL_UNUSED(ctx);
+    return error::Unimplemented("UDA '$0' does not support partial aggregates",
+                                typeid(TUDA).name());
+  }
+
+  /**
+   * Load the partial state produced by Serialize into the UDA. Only valid for UDAs that support
+   * partial aggregates.
+   * @return Status of the Deserialize.
+   */
+  static Status Deserialize(UDA* uda, FunctionContext* ctx, const types::StringValue& data) {
+    if constexpr (SupportsPartial) {
+      return static_cast<TUDA*>(uda)->Deserialize(ctx, data);
+    }
+    PL_UNUSED(uda);
+    PL_UNUSED(ctx);
+    PL_UNUSED(data);
+    return error::Unimplemented("UDA '$0' does not support partial aggregates",
+                                typeid(TUDA).name());
+  }
 };
 
 /**
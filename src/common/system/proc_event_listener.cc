@@ -0,0 +1,133 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/common/system/proc_event_listener.h"
+
+#include <linux/cn_proc.h>
+#include <linux/connector.h>
+#include <linux/netlink.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+
+namespace px {
+namespace system {
+
+StatusOr<std::unique_ptr<ProcEventListener>> ProcEventListener::Create() {
+  auto listener = std::unique_ptr<ProcEventListener>(new ProcEventListener);
+  PL_RETURN_IF_ERROR(listener->Connect());
+  PL_RETURN_IF_ERROR(listener->Subscribe(true));
+  return listener;
+}
+
+ProcEventListener::~ProcEventListener() {
+  if (fd_ >= 0) {
+    // Best effort: the subscription is dropped with the socket anyways.
+    PL_UNUSED(Subscribe(false));
+    close(fd_);
+  }
+}
+
+Status ProcEventListener::Connect() {
+  fd_ = socket(PF_NETLINK, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, NETLINK_CONNECTOR);
+  if (fd_ < 0) {
+    return error::Internal("Could not create NETLINK_CONNECTOR connection. [errno=$0]", errno);
+  }
+
+  struct sockaddr_nl nl_addr = {};
+  nl_addr.nl_family = AF_NETLINK;
+  nl_addr.nl_groups = CN_IDX_PROC;
+  nl_addr.nl_pid = 0;
+  if (bind(fd_, reinterpret_cast<struct sockaddr*>(&nl_addr), sizeof(nl_addr)) < 0) {
+    return error::Internal("Could not bind to the process connector. [errno=$0]", errno);
+  }
+  return Status::OK();
+}
+
+Status ProcEventListener::Subscribe(bool enable) {
+  // The message is a netlink header, followed by a connector header, followed by the operation.
+  constexpr size_t kPayloadSize = sizeof(struct cn_msg) + sizeof(enum proc_cn_mcast_op);
+  char buf[NLMSG_SPACE(kPayloadSize)] __attribute__((aligned(NLMSG_ALIGNTO))) = {};
+
+  auto* nl_hdr = reinterpret_cast<struct nlmsghdr*>(buf);
+  nl_hdr->nlmsg_len = NLMSG_LENGTH(kPayloadSize);
+  nl_hdr->nlmsg_type = NLMSG_DONE;
+
+  auto* cn_msg = reinterpret_cast<struct cn_msg*>(NLMSG_DATA(nl_hdr));
+  cn_msg->id.idx = CN_IDX_PROC;
+  cn_msg->id.val = CN_VAL_PROC;
+  cn_msg->len = sizeof(enum proc_cn_mcast_op);
+
+  auto* op = reinterpret_cast<enum proc_cn_mcast_op*>(cn_msg->data);
+  *op = enable ? PROC_CN_MCAST_LISTEN : PROC_CN_MCAST_IGNORE;
+
+  if (send(fd_, nl_hdr, nl_hdr->nlmsg_len, 0) < 0) {
+    return error::Internal("Could not subscribe to the process connector. [errno=$0]", errno);
+  }
+  return Status::OK();
+}
+
+Status ProcEventListener::ReadEvents(std::vector<int32_t>* started_pids,
+                                     std::vector<int32_t>* exited_pids) {
+  char buf[8192] __attribute__((aligned(NLMSG_ALIGNTO)));
+
+  while (true) {
+    ssize_t len = recv(fd_, buf, sizeof(buf), 0);
+    if (len < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      if (errno == EAGAIN || errno == EWOULDBLOCK) {
+        return Status::OK();
+      }
+      if (errno == ENOBUFS) {
+        return error::ResourceUnavailable("Process events were dropped.");
+      }
+      return error::Internal("Could not read from the process connector. [errno=$0]", errno);
+    }
+
+    for (auto* nl_hdr = reinterpret_cast<struct nlmsghdr*>(buf); NLMSG_OK(nl_hdr, len);
+         nl_hdr = NLMSG_NEXT(nl_hdr, len)) {
+      if (nl_hdr->nlmsg_type == NLMSG_ERROR || nl_hdr->nlmsg_type == NLMSG_NOOP) {
+        continue;
+      }
+      auto* cn_msg = reinterpret_cast<struct cn_msg*>(NLMSG_DATA(nl_hdr));
+      auto* event = reinterpret_cast<struct proc_event*>(cn_msg->data);
+      switch (event->what) {
+        case proc_event::PROC_EVENT_FORK:
+          // A new thread in an existing process is also reported as a fork.
+          if (event->event_data.fork.child_pid == event->event_data.fork.child_tgid) {
+            started_pids->push_back(event->event_data.fork.child_tgid);
+          }
+          break;
+        case proc_event::PROC_EVENT_EXIT:
+          if (event->event_data.exit.process_pid == event->event_data.exit.process_tgid) {
+            exited_pids->push_back(event->event_data.exit.process_tgid);
+          }
+          break;
+        default:
+          break;
+      }
+    }
+  }
+}
+
+}  // namespace system
+}  // namespace px
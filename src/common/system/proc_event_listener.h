@@ -0,0 +1,65 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "src/common/base/base.h"
+
+namespace px {
+namespace system {
+
+/**
+ * ProcEventListener receives process lifecycle events from the kernel, through the netlink
+ * process connector (NETLINK_CONNECTOR / CN_IDX_PROC).
+ *
+ * Only events of processes (thread group leaders) are reported; thread events are dropped.
+ * Note that this requires CAP_NET_ADMIN.
+ */
+class ProcEventListener {
+ public:
+  /**
+   * Creates a listener subscribed to the process events of the host.
+   */
+  static StatusOr<std::unique_ptr<ProcEventListener>> Create();
+
+  ~ProcEventListener();
+
+  /**
+   * Reads all pending events, without blocking.
+   *
+   * @param started_pids Appended with the PIDs of processes created since the last call.
+   * @param exited_pids Appended with the PIDs of processes that exited since the last call.
+   * @return error::ResourceUnavailable if events were dropped because the socket buffer
+   * overflowed, in which case the caller must fall back to a full rescan of the processes.
+   */
+  Status ReadEvents(std::vector<int32_t>* started_pids, std::vector<int32_t>* exited_pids);
+
+ private:
+  ProcEventListener() = default;
+
+  Status Connect();
+  Status Subscribe(bool enable);
+
+  int fd_ = -1;
+};
+
+}  // namespace system
+}  // namespace px
@@ -16,6 +16,7 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include <charconv>
 #include <fstream>
 #include <limits>
 #include <string>
@@ -615,6 +616,55 @@ Status ProcParser::ReadMountInfos(pid_t pid,
   return Status::OK();
 }
 
+namespace {
+
+Status ParseHex(std::string_view str, uint64_t* out) {
+  auto [ptr, ec] = std::from_chars(str.data(), str.data() + str.size(), *out, 16);
+  if (ec != std::errc() || ptr != str.data() + str.size()) {
+    return error::Internal("Could not parse hex value: $0", str);
+  }
+  return Status::OK();
+}
+
+Status ParseProcessMap(std::string_view line, ProcParser::ProcessMap* map) {
+  static constexpr int kProcMapNumFields = 6;
+  std::vector<std::string_view> fields =
+      absl::StrSplit(line, absl::MaxSplits(' ', kProcMapNumFields), absl::SkipWhitespace());
+  if (fields.size() < kProcMapNumFields - 1) {
+    return error::Internal("Could not parse maps entry: $0", line);
+  }
+
+  std::vector<std::string_view> addrs = absl::StrSplit(fields[0], '-');
+  if (addrs.size() != 2) {
+    return error::Internal("Could not parse address range: $0", fields[0]);
+  }
+  PL_RETURN_IF_ERROR(ParseHex(addrs[0], &map->vmem_start));
+  PL_RETURN_IF_ERROR(ParseHex(addrs[1], &map->vmem_end));
+  map->permissions = std::string(fields[1]);
+  PL_RETURN_IF_ERROR(ParseHex(fields[2], &map->offset));
+  map->dev = std::string(fields[3]);
+  if (!absl::SimpleAtoi(fields[4], &map->inode)) {
+    return error::Internal("Could not parse inode: $0", fields[4]);
+  }
+  if (fields.size() == kProcMapNumFields) {
+    map->pathname = std::string(absl::StripAsciiWhitespace(fields[5]));
+  }
+  return Status::OK();
+}
+
+}  // namespace
+
+Status ProcParser::ReadProcMaps(pid_t pid, std::vector<ProcParser::ProcessMap>* maps) const {
+  const std::filesystem::path proc_pid_maps_path = ProcPidPath(pid) / "maps";
+  PL_ASSIGN_OR_RETURN(std::string content, px::ReadFileToString(proc_pid_maps_path));
+  std::vector<std::string_view> lines = absl::StrSplit(content, "\n", absl::SkipWhitespace());
+  for (const auto line : lines) {
+    ProcParser::ProcessMap& map = maps->emplace_back();
+    PL_RETURN_IF_ERROR(ParseProcessMap(line, &map));
+  }
+  return Status::OK();
+}
+
 StatusOr<absl::flat_hash_set<std::string>> ProcParser::GetMapPaths(pid_t pid) {
   static constexpr int kProcMapNumFields = 6;
   absl::flat_hash_set<std::string> map_paths;
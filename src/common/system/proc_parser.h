@@ -27,12 +27,19 @@
 
 #include <absl/container/flat_hash_map.h>
 #include <absl/container/flat_hash_set.h>
+#include <absl/strings/str_cat.h>
 #include "src/common/base/base.h"
 #include "src/common/system/system.h"
 
 namespace px {
 namespace system {
 
+/**
+ * Returns whether the stats of a network interface are included in the network stats of a
+ * process, based on the conventional names of physical interfaces.
+ */
+bool ShouldIncludeNetIFace(const std::string_view iface);
+
 /*
  * ProcParser is use to parse system proc pseudo filesystem.
  */
@@ -243,6 +250,37 @@ class ProcParser {
 
   Status ReadMountInfos(pid_t pid, std::vector<MountInfo>* mount_infos) const;
 
+  /**
+   * Represents a record of the proc maps file, like /proc/[pid]/maps.
+   * See http://man7.org/linux/man-pages/man5/proc.5.html for more details.
+   */
+  struct ProcessMap {
+    uint64_t vmem_start = 0;
+    uint64_t vmem_end = 0;
+    // Permission string, like "r-xp".
+    std::string permissions;
+    // Offset into the mapped file.
+    uint64_t offset = 0;
+    // Device of the mapped file, as "major:minor".
+    std::string dev;
+    uint64_t inode = 0;
+    // Empty for anonymous mappings.
+    std::string pathname;
+
+    bool executable() const { return permissions.size() > 2 && permissions[2] == 'x'; }
+
+    std::string ToString() const {
+      return absl::Substitute("[$0-$1] perms=$2 offset=$3 dev=$4 inode=$5 path=$6",
+                              absl::Hex(vmem_start), absl::Hex(vmem_end), permissions,
+                              absl::Hex(offset), dev, inode, pathname);
+    }
+  };
+
+  /**
+   * Reads and parses all entries of /proc/<pid>/maps, in the order they appear in the file.
+   */
+  Status ReadProcMaps(pid_t pid, std::vector<ProcessMap>* maps) const;
+
   /**
    * Returns all mapped paths found in /proc/<pid>/maps.
    *
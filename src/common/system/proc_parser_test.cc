@@ -21,6 +21,7 @@
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
+#include <algorithm>
 #include <istream>
 #include <memory>
 #include <sstream>
@@ -226,6 +227,29 @@ TEST_F(ProcParserTest, ReadMountInfos) {
   }
 }
 
+TEST_F(ProcParserTest, ReadProcMaps) {
+  std::vector<ProcParser::ProcessMap> maps;
+  ASSERT_OK(parser_->ReadProcMaps(123, &maps));
+  ASSERT_GE(maps.size(), 2);
+
+  EXPECT_EQ(maps[0].vmem_start, 0x565078f64000);
+  EXPECT_EQ(maps[0].vmem_end, 0x565078f8c000);
+  EXPECT_EQ(maps[0].permissions, "r--p");
+  EXPECT_EQ(maps[0].offset, 0);
+  EXPECT_EQ(maps[0].dev, "103:02");
+  EXPECT_EQ(maps[0].inode, 27147818);
+  EXPECT_EQ(maps[0].pathname, "/usr/sbin/nginx");
+  EXPECT_FALSE(maps[0].executable());
+
+  EXPECT_EQ(maps[1].vmem_start, 0x565078f8c000);
+  EXPECT_EQ(maps[1].offset, 0x28000);
+  EXPECT_TRUE(maps[1].executable());
+
+  // Anonymous mappings have no pathname.
+  EXPECT_TRUE(std::any_of(maps.begin(), maps.end(),
+                          [](const auto& m) { return m.pathname.empty(); }));
+}
+
 TEST_F(ProcParserTest, GetMapPaths) {
   {
     EXPECT_OK_AND_THAT(
@@ -0,0 +1,550 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/common/system/proc_pid_sampler.h"
+
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <thread>
+
+#include <absl/strings/ascii.h>
+#include <absl/strings/numbers.h>
+#include <absl/strings/substitute.h>
+
+namespace px {
+namespace system {
+
+namespace {
+
+// Large enough for /proc/<pid>/stat and /proc/<pid>/io.
+constexpr size_t kReadBufSize = 4096;
+
+// Below this many PIDs per thread, the cost of handing off the work outweighs the parallelism.
+constexpr size_t kMinPIDsPerThread = 256;
+
+// By default, keep at most this many files open, and at most 1/kOpenFilesRLimitDivisor of the
+// file descriptors allowed by RLIMIT_NOFILE.
+constexpr size_t kMaxOpenFiles = 4096;
+constexpr rlim_t kOpenFilesRLimitDivisor = 8;
+
+// Field indexes in /proc/<pid>/stat. See ProcParser::ParseProcPIDStat().
+constexpr int kProcStatMinorFaultsField = 9;
+constexpr int kProcStatMajorFaultsField = 11;
+constexpr int kProcStatUTimeField = 13;
+constexpr int kProcStatKTimeField = 14;
+constexpr int kProcStatNumThreadsField = 19;
+constexpr int kProcStatVSizeField = 22;
+constexpr int kProcStatRSSField = 23;
+
+// Field indexes in the lines of /proc/<pid>/net/dev, after the interface name.
+constexpr int kProcNetDevNumValues = 16;
+constexpr int kProcNetDevRxBytesValue = 0;
+constexpr int kProcNetDevRxPacketsValue = 1;
+constexpr int kProcNetDevRxErrsValue = 2;
+constexpr int kProcNetDevRxDropValue = 3;
+constexpr int kProcNetDevTxBytesValue = 8;
+constexpr int kProcNetDevTxPacketsValue = 9;
+constexpr int kProcNetDevTxErrsValue = 10;
+constexpr int kProcNetDevTxDropValue = 11;
+
+/**
+ * Splits a buffer into whitespace separated fields, without copying.
+ */
+class FieldScanner {
+ public:
+  explicit FieldScanner(std::string_view buf) : buf_(buf) {}
+
+  // Returns the next field, or an empty string_view at the end of the buffer.
+  std::string_view Next() {
+    size_t begin = 0;
+    while (begin < buf_.size() && IsSpace(buf_[begin])) {
+      ++begin;
+    }
+    size_t end = begin;
+    while (end < buf_.size() && !IsSpace(buf_[end])) {
+      ++end;
+    }
+    std::string_view field = buf_.substr(begin, end - begin);
+    buf_.remove_prefix(end);
+    return field;
+  }
+
+ private:
+  static bool IsSpace(char c) { return c == ' ' || c == '\t' || c == '\n'; }
+
+  std::string_view buf_;
+};
+
+// Reads the whole file from offset 0. Returns the number of bytes read, or -1 on error.
+// The file contents are regenerated by the kernel on each read from offset 0.
+ssize_t PReadFile(int fd, char* buf, size_t size) {
+  size_t n = 0;
+  while (n < size) {
+    ssize_t r = pread(fd, buf + n, size - n, n);
+    if (r < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return -1;
+    }
+    if (r == 0) {
+      break;
+    }
+    n += r;
+  }
+  return n;
+}
+
+// Reads the whole file without keeping it open. Returns the number of bytes read, or -1 on error.
+ssize_t ReadFileOnce(const std::filesystem::path& path, char* buf, size_t size) {
+  int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return -1;
+  }
+  ssize_t n = PReadFile(fd, buf, size);
+  close(fd);
+  return n;
+}
+
+Status ParseStat(std::string_view content, int64_t ns_per_kernel_tick, int32_t bytes_per_page,
+                 ProcParser::ProcessStats* out) {
+  // The process name is surrounded by (), and may itself contain spaces or parentheses.
+  size_t name_begin = content.find('(');
+  size_t name_end = content.rfind(')');
+  if (name_begin == std::string_view::npos || name_end == std::string_view::npos ||
+      name_end <= name_begin + 1) {
+    return error::Internal("Failed to parse stat file, malformed process name.");
+  }
+
+  bool ok = absl::SimpleAtoi(content.substr(0, name_begin), &out->pid);
+  out->process_name.assign(content.substr(name_begin + 1, name_end - name_begin - 1));
+
+  // The fields following the name start with the state, which is field #2.
+  std::string_view fields[kProcStatRSSField + 1];
+  FieldScanner scanner(content.substr(name_end + 1));
+  for (int i = 2; i <= kProcStatRSSField; ++i) {
+    fields[i] = scanner.Next();
+    if (fields[i].empty()) {
+      return error::Internal("Incorrect number of fields in stat file.");
+    }
+  }
+
+  ok &= absl::SimpleAtoi(fields[kProcStatMinorFaultsField], &out->minor_faults);
+  ok &= absl::SimpleAtoi(fields[kProcStatMajorFaultsField], &out->major_faults);
+  ok &= absl::SimpleAtoi(fields[kProcStatUTimeField], &out->utime_ns);
+  ok &= absl::SimpleAtoi(fields[kProcStatKTimeField], &out->ktime_ns);
+  ok &= absl::SimpleAtoi(fields[kProcStatNumThreadsField], &out->num_threads);
+  ok &= absl::SimpleAtoi(fields[kProcStatVSizeField], &out->vsize_bytes);
+  ok &= absl::SimpleAtoi(fields[kProcStatRSSField], &out->rss_bytes);
+  if (!ok) {
+    return error::Internal("Failed to parse stat file. ATOI failed.");
+  }
+
+  // The kernel tracks utime and ktime in kernel ticks, and RSS in pages.
+  out->utime_ns *= ns_per_kernel_tick;
+  out->ktime_ns *= ns_per_kernel_tick;
+  out->rss_bytes *= bytes_per_page;
+  return Status::OK();
+}
+
+Status ParseIO(std::string_view content, ProcParser::ProcessStats* out) {
+  FieldScanner scanner(content);
+  bool ok = true;
+  for (std::string_view key = scanner.Next(); !key.empty(); key = scanner.Next()) {
+    std::string_view value = scanner.Next();
+    if (key == "rchar:") {
+      ok &= absl::SimpleAtoi(value, &out->rchar_bytes);
+    } else if (key == "wchar:") {
+      ok &= absl::SimpleAtoi(value, &out->wchar_bytes);
+    } else if (key == "read_bytes:") {
+      ok &= absl::SimpleAtoi(value, &out->read_bytes);
+    } else if (key == "write_bytes:") {
+      ok &= absl::SimpleAtoi(value, &out->write_bytes);
+    }
+  }
+  if (!ok) {
+    return error::Internal("Failed to parse io file. ATOI failed.");
+  }
+  return Status::OK();
+}
+
+Status ParseNetDev(std::string_view content, ProcParser::NetworkStats* out) {
+  // Ignore the first two lines since they are just headers.
+  constexpr int kHeaderLines = 2;
+  for (int i = 0; i < kHeaderLines; ++i) {
+    size_t eol = content.find('\n');
+    content.remove_prefix(eol == std::string_view::npos ? content.size() : eol + 1);
+  }
+
+  while (!content.empty()) {
+    size_t eol = content.find('\n');
+    std::string_view line = content.substr(0, eol);
+    content.remove_prefix(eol == std::string_view::npos ? content.size() : eol + 1);
+
+    // Large counters may directly follow the colon, so split on it rather than on spaces.
+    size_t colon = line.find(':');
+    if (colon == std::string_view::npos) {
+      continue;
+    }
+    std::string_view iface = absl::StripLeadingAsciiWhitespace(line.substr(0, colon));
+    if (!ShouldIncludeNetIFace(iface)) {
+      continue;
+    }
+
+    std::string_view values[kProcNetDevNumValues];
+    FieldScanner scanner(line.substr(colon + 1));
+    for (int i = 0; i < kProcNetDevNumValues; ++i) {
+      values[i] = scanner.Next();
+    }
+
+    int64_t val = 0;
+    bool ok = true;
+    ok &= absl::SimpleAtoi(values[kProcNetDevRxBytesValue], &val);
+    out->rx_bytes += val;
+    ok &= absl::SimpleAtoi(values[kProcNetDevRxPacketsValue], &val);
+    out->rx_packets += val;
+    ok &= absl::SimpleAtoi(values[kProcNetDevRxErrsValue], &val);
+    out->rx_errs += val;
+    ok &= absl::SimpleAtoi(values[kProcNetDevRxDropValue], &val);
+    out->rx_drops += val;
+    ok &= absl::SimpleAtoi(values[kProcNetDevTxBytesValue], &val);
+    out->tx_bytes += val;
+    ok &= absl::SimpleAtoi(values[kProcNetDevTxPacketsValue], &val);
+    out->tx_packets += val;
+    ok &= absl::SimpleAtoi(values[kProcNetDevTxErrsValue], &val);
+    out->tx_errs += val;
+    ok &= absl::SimpleAtoi(values[kProcNetDevTxDropValue], &val);
+    out->tx_drops += val;
+    if (!ok) {
+      return error::Internal("failed to parse net dev file");
+    }
+  }
+  return Status::OK();
+}
+
+}  // namespace
+
+size_t ProcPIDSampler::DefaultMaxOpenFiles() {
+  struct rlimit limit;
+  if (getrlimit(RLIMIT_NOFILE, &limit) != 0 || limit.rlim_cur == RLIM_INFINITY) {
+    return kMaxOpenFiles;
+  }
+  return std::min<size_t>(kMaxOpenFiles, limit.rlim_cur / kOpenFilesRLimitDivisor);
+}
+
+ProcPIDSampler::ProcPIDSampler(const system::Config& cfg, int num_threads,
+                               size_t max_open_files)
+    : num_threads_(std::max(num_threads, 1)), max_open_files_(max_open_files) {
+  CHECK(cfg.HasConfig()) << "System config is required for the ProcPIDSampler";
+  ns_per_kernel_tick_ = static_cast<int64_t>(1E9 / cfg.KernelTicksPerSecond());
+  bytes_per_page_ = cfg.PageSize();
+  proc_base_path_ = cfg.proc_path();
+
+  // The calling thread samples the first part of each batch, and the workers the rest.
+  workers_.reserve(num_threads_ - 1);
+  for (int t = 1; t < num_threads_; ++t) {
+    workers_.emplace_back(&ProcPIDSampler::WorkerLoop, this, t);
+  }
+}
+
+ProcPIDSampler::~ProcPIDSampler() {
+  {
+    std::lock_guard<std::mutex> lock(workers_mu_);
+    stop_workers_ = true;
+  }
+  work_cv_.notify_all();
+  for (auto& worker : workers_) {
+    worker.join();
+  }
+
+  for (auto& [pid, files] : files_) {
+    PL_UNUSED(pid);
+    ClosePIDFiles(&files);
+  }
+}
+
+void ProcPIDSampler::Touch(PIDFiles* files) {
+  files->batch = batch_;
+  if (files->in_lru) {
+    lru_.splice(lru_.begin(), lru_, files->lru_iter);
+  }
+}
+
+bool ProcPIDSampler::MakeRoomForFile() {
+  // PIDs are touched in the order they are used, so the files of the current batch are all in
+  // front of those of earlier batches.
+  while (num_open_files_ >= max_open_files_ && !lru_.empty()) {
+    auto iter = files_.find(lru_.back());
+    DCHECK(iter != files_.end());
+    if (iter->second.batch == batch_) {
+      return false;
+    }
+    ClosePIDFiles(&iter->second);
+  }
+  return num_open_files_ < max_open_files_;
+}
+
+Status ProcPIDSampler::OpenFile(int32_t pid, const std::filesystem::path& path,
+                                PIDFiles* files, int* fd) {
+  if (*fd >= 0 || !MakeRoomForFile()) {
+    return Status::OK();
+  }
+  *fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (*fd < 0) {
+    if (errno == EMFILE || errno == ENFILE) {
+      // Leave the remaining file descriptors to the rest of the process, and read the files
+      // that don't fit without keeping them open.
+      LOG_FIRST_N(WARNING, 1) << absl::Substitute(
+          "Out of file descriptors with $0 files open, lowering the limit of open files.",
+          num_open_files_);
+      max_open_files_ = num_open_files_ / 2;
+      return Status::OK();
+    }
+    return error::Internal("Failed to open file $0", path.string());
+  }
+
+  ++num_open_files_;
+  if (!files->in_lru) {
+    files->lru_iter = lru_.insert(lru_.begin(), pid);
+    files->in_lru = true;
+  }
+  return Status::OK();
+}
+
+void ProcPIDSampler::CloseFile(int* fd) {
+  if (*fd >= 0) {
+    close(*fd);
+    *fd = -1;
+    --num_open_files_;
+  }
+}
+
+void ProcPIDSampler::ClosePIDFiles(PIDFiles* files) {
+  CloseFile(&files->stat_fd);
+  CloseFile(&files->io_fd);
+  CloseFile(&files->net_dev_fd);
+  if (files->in_lru) {
+    lru_.erase(files->lru_iter);
+    files->in_lru = false;
+  }
+}
+
+Status ProcPIDSampler::OpenStatFiles(int32_t pid, PIDFiles* files) {
+  const std::filesystem::path pid_path = proc_base_path_ / std::to_string(pid);
+  PL_RETURN_IF_ERROR(OpenFile(pid, pid_path / "stat", files, &files->stat_fd));
+  PL_RETURN_IF_ERROR(OpenFile(pid, pid_path / "io", files, &files->io_fd));
+  return Status::OK();
+}
+
+Status ProcPIDSampler::ReadProcessStats(int32_t pid, const PIDFiles& files,
+                                        ProcParser::ProcessStats* out) const {
+  char buf[kReadBufSize];
+
+  // Files that were not kept open are read through their path.
+  ssize_t n = files.stat_fd >= 0
+                  ? PReadFile(files.stat_fd, buf, sizeof(buf))
+                  : ReadFileOnce(proc_base_path_ / std::to_string(pid) / "stat", buf, sizeof(buf));
+  if (n <= 0) {
+    return error::Internal("Failed to read stat file.");
+  }
+  PL_RETURN_IF_ERROR(
+      ParseStat(std::string_view(buf, n), ns_per_kernel_tick_, bytes_per_page_, out));
+
+  n = files.io_fd >= 0
+          ? PReadFile(files.io_fd, buf, sizeof(buf))
+          : ReadFileOnce(proc_base_path_ / std::to_string(pid) / "io", buf, sizeof(buf));
+  if (n <= 0) {
+    return error::Internal("Failed to read io file.");
+  }
+  return ParseIO(std::string_view(buf, n), out);
+}
+
+Status ProcPIDSampler::SampleProcessStats(int32_t pid, ProcParser::ProcessStats* out) {
+  PIDFiles& files = files_[pid];
+  Touch(&files);
+  PL_RETURN_IF_ERROR(OpenStatFiles(pid, &files));
+  if (ReadProcessStats(pid, files, out).ok()) {
+    return Status::OK();
+  }
+
+  // The files may belong to a process that has exited, and whose PID has since been reused.
+  // Re-open the files once to find out.
+  ClosePIDFiles(&files);
+  PL_RETURN_IF_ERROR(OpenStatFiles(pid, &files));
+  out->Clear();
+  return ReadProcessStats(pid, files, out);
+}
+
+void ProcPIDSampler::SampleRange(const std::vector<int32_t>& pids, size_t begin, size_t end,
+                                 std::vector<ProcessStatsSample>* samples) const {
+  for (size_t i = begin; i < end; ++i) {
+    ProcessStatsSample& sample = (*samples)[i];
+    if (!sample.status.ok()) {
+      continue;
+    }
+    auto iter = files_.find(pids[i]);
+    DCHECK(iter != files_.end());
+    sample.status = ReadProcessStats(pids[i], iter->second, &sample.stats);
+  }
+}
+
+void ProcPIDSampler::WorkerLoop(size_t worker_idx) {
+  uint64_t generation = 0;
+  std::unique_lock<std::mutex> lock(workers_mu_);
+  while (true) {
+    work_cv_.wait(lock, [&] { return stop_workers_ || work_generation_ != generation; });
+    if (stop_workers_) {
+      return;
+    }
+    generation = work_generation_;
+
+    // Workers beyond the number of threads needed by the batch have nothing to sample.
+    const std::vector<int32_t>& pids = *work_pids_;
+    std::vector<ProcessStatsSample>* samples = work_samples_;
+    size_t begin = std::min(worker_idx * work_pids_per_thread_, pids.size());
+    size_t end = worker_idx < work_num_threads_
+                     ? std::min(begin + work_pids_per_thread_, pids.size())
+                     : begin;
+
+    lock.unlock();
+    SampleRange(pids, begin, end, samples);
+    lock.lock();
+
+    if (--num_busy_workers_ == 0) {
+      done_cv_.notify_one();
+    }
+  }
+}
+
+void ProcPIDSampler::SampleProcessStats(const std::vector<int32_t>& pids,
+                                        std::vector<ProcessStatsSample>* samples) {
+  ++batch_;
+  samples->resize(pids.size());
+
+  // Files are opened up-front by this thread, so the sampling threads only read.
+  for (size_t i = 0; i < pids.size(); ++i) {
+    ProcessStatsSample& sample = (*samples)[i];
+    sample.pid = pids[i];
+    sample.stats.Clear();
+    PIDFiles& files = files_[pids[i]];
+    Touch(&files);
+    sample.status = OpenStatFiles(pids[i], &files);
+  }
+
+  const size_t num_threads = std::clamp<size_t>(pids.size() / kMinPIDsPerThread, 1, num_threads_);
+  const size_t pids_per_thread = (pids.size() + num_threads - 1) / num_threads;
+  if (num_threads > 1) {
+    {
+      std::lock_guard<std::mutex> lock(workers_mu_);
+      work_pids_ = &pids;
+      work_samples_ = samples;
+      work_num_threads_ = num_threads;
+      work_pids_per_thread_ = pids_per_thread;
+      num_busy_workers_ = workers_.size();
+      ++work_generation_;
+    }
+    work_cv_.notify_all();
+  }
+  SampleRange(pids, 0, std::min(pids_per_thread, pids.size()), samples);
+  if (num_threads > 1) {
+    std::unique_lock<std::mutex> lock(workers_mu_);
+    done_cv_.wait(lock, [this] { return num_busy_workers_ == 0; });
+  }
+
+  // Failed reads may be due to reused PIDs, so retry those with re-opened files.
+  for (auto& sample : *samples) {
+    if (!sample.status.ok()) {
+      sample.stats.Clear();
+      sample.status = SampleProcessStats(sample.pid, &sample.stats);
+    }
+  }
+
+  // Close the files of the processes that are gone.
+  for (auto iter = files_.begin(); iter != files_.end();) {
+    if (iter->second.batch != batch_) {
+      ClosePIDFiles(&iter->second);
+      files_.erase(iter++);
+    } else {
+      ++iter;
+    }
+  }
+
+  // The limit may have been lowered while running out of file descriptors.
+  while (num_open_files_ > max_open_files_ && !lru_.empty()) {
+    ClosePIDFiles(&files_[lru_.back()]);
+  }
+}
+
+Status ProcPIDSampler::SampleNetDev(int32_t pid, int64_t start_ts,
+                                    ProcParser::NetworkStats* out) {
+  PIDFiles& files = files_[pid];
+  Touch(&files);
+  // Unlike the stat and io files, which fail to read once their process exits, the file of an
+  // exited process still reads the stats of its network namespace. So don't reuse the file for
+  // another process with the same PID.
+  if (files.net_dev_start_ts != start_ts) {
+    CloseFile(&files.net_dev_fd);
+    files.net_dev_start_ts = start_ts;
+  }
+  const std::filesystem::path path = proc_base_path_ / std::to_string(pid) / "net" / "dev";
+  PL_RETURN_IF_ERROR(OpenFile(pid, path, &files, &files.net_dev_fd));
+
+  // Grow the buffer until the whole file fits.
+  if (net_dev_buf_.empty()) {
+    net_dev_buf_.resize(kReadBufSize);
+  }
+  auto read_file = [&]() {
+    return files.net_dev_fd >= 0
+               ? PReadFile(files.net_dev_fd, net_dev_buf_.data(), net_dev_buf_.size())
+               : ReadFileOnce(path, net_dev_buf_.data(), net_dev_buf_.size());
+  };
+  ssize_t n;
+  while ((n = read_file()) == static_cast<ssize_t>(net_dev_buf_.size())) {
+    net_dev_buf_.resize(2 * net_dev_buf_.size());
+  }
+  if (n <= 0) {
+    CloseFile(&files.net_dev_fd);
+    return error::Internal("Failed to read net/dev file of pid $0", pid);
+  }
+
+  // Accumulate into a copy, so a parse failure does not leave partial results.
+  ProcParser::NetworkStats stats = *out;
+  PL_RETURN_IF_ERROR(ParseNetDev(std::string_view(net_dev_buf_.data(), n), &stats));
+  *out = stats;
+  return Status::OK();
+}
+
+void ProcPIDSampler::RetainPIDs(const absl::flat_hash_set<int32_t>& pids) {
+  for (auto iter = files_.begin(); iter != files_.end();) {
+    if (!pids.contains(iter->first)) {
+      ClosePIDFiles(&iter->second);
+      files_.erase(iter++);
+    } else {
+      ++iter;
+    }
+  }
+  // The PIDs sampled from now on are part of the next batch.
+  ++batch_;
+}
+
+}  // namespace system
+}  // namespace px
@@ -0,0 +1,183 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <filesystem>
+#include <list>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include <absl/container/flat_hash_map.h>
+#include <absl/container/flat_hash_set.h>
+#include "src/common/base/base.h"
+#include "src/common/system/config.h"
+#include "src/common/system/proc_parser.h"
+
+namespace px {
+namespace system {
+
+/**
+ * ProcPIDSampler periodically samples the per-process files of the proc filesystem
+ * (/proc/<pid>/stat, /proc/<pid>/io and /proc/<pid>/net/dev).
+ *
+ * Unlike ProcParser, which opens and tokenizes each file on every call, the sampler keeps the
+ * files open across samples and re-reads them with pread(), and parses them in place without
+ * allocating. A batch of PIDs can be sampled by several threads.
+ *
+ * The number of files kept open is capped, evicting the files of the least recently sampled PIDs.
+ * Files beyond the cap, or that can't be kept open because the process is out of file
+ * descriptors, are opened, read and closed on each sample instead.
+ *
+ * The results are the same as those of ProcParser::ParseProcPIDStat(), ParseProcPIDStatIO()
+ * and ParseProcPIDNetDev().
+ */
+class ProcPIDSampler {
+ public:
+  /**
+   * @param cfg a reference to the system config. Only needs to be valid for the
+   * duration of the constructor call.
+   * @param num_threads Maximum number of threads used to sample a batch of PIDs. The threads are
+   * started once, and reused for every batch.
+   * @param max_open_files Maximum number of files kept open across samples.
+   */
+  explicit ProcPIDSampler(const system::Config& cfg, int num_threads = 1,
+                          size_t max_open_files = DefaultMaxOpenFiles());
+  ~ProcPIDSampler();
+
+  /**
+   * A fraction of RLIMIT_NOFILE, so that the samplers leave most file descriptors to the rest of
+   * the process (BPF maps, perf buffers, sockets...).
+   */
+  static size_t DefaultMaxOpenFiles();
+
+  ProcPIDSampler(const ProcPIDSampler&) = delete;
+  ProcPIDSampler& operator=(const ProcPIDSampler&) = delete;
+
+  struct ProcessStatsSample {
+    int32_t pid = -1;
+    Status status;
+    ProcParser::ProcessStats stats;
+  };
+
+  /**
+   * Samples the stat and io files of each of the PIDs. Files of PIDs that are not part of
+   * the batch are closed, so the batch is expected to be the full set of live PIDs.
+   *
+   * @param pids The PIDs to sample.
+   * @param samples One sample per PID, in the order of pids. The vector is reused across calls
+   * to avoid re-allocating the samples.
+   */
+  void SampleProcessStats(const std::vector<int32_t>& pids,
+                          std::vector<ProcessStatsSample>* samples);
+
+  /**
+   * Samples the stat and io files of a single PID.
+   */
+  Status SampleProcessStats(int32_t pid, ProcParser::ProcessStats* out);
+
+  /**
+   * Samples /proc/<pid>/net/dev, accumulating the stats of the physical interfaces into out.
+   *
+   * The open file stays bound to the network namespace of the process that had the PID when
+   * the file was first opened, and can still be read after that process exits. So the file is
+   * only reused for the same process, identified by its start time (as in its UPID), and
+   * callers should use RetainPIDs() to drop the PIDs they no longer sample.
+   */
+  Status SampleNetDev(int32_t pid, int64_t start_ts, ProcParser::NetworkStats* out);
+
+  /**
+   * Closes the files of all PIDs not in pids.
+   */
+  void RetainPIDs(const absl::flat_hash_set<int32_t>& pids);
+
+  size_t num_pids() const { return files_.size(); }
+  size_t num_open_files() const { return num_open_files_; }
+
+ private:
+  struct PIDFiles {
+    int stat_fd = -1;
+    int io_fd = -1;
+    int net_dev_fd = -1;
+    // The start time of the process that net_dev_fd was opened for.
+    int64_t net_dev_start_ts = 0;
+    // The last batch that included the PID.
+    uint64_t batch = 0;
+    // The position of the PID in lru_, once one of its files was kept open.
+    std::list<int32_t>::iterator lru_iter;
+    bool in_lru = false;
+  };
+
+  // Marks the files of pid as used by the current batch.
+  void Touch(PIDFiles* files);
+  // Opens the file of pid into fd, unless it is already open. If no more files can be kept
+  // open, fd is left closed, and the file is opened on each read instead.
+  Status OpenFile(int32_t pid, const std::filesystem::path& path, PIDFiles* files, int* fd);
+  // Opens the stat and io files of pid, if not already open.
+  Status OpenStatFiles(int32_t pid, PIDFiles* files);
+  void CloseFile(int* fd);
+  void ClosePIDFiles(PIDFiles* files);
+  // Closes the files of the least recently used PIDs, until another file can be kept open.
+  // The files of PIDs used by the current batch are kept. Returns false if there is no room.
+  bool MakeRoomForFile();
+
+  // Reads and parses the stat and io files. Thread-safe, as long as files is not modified.
+  Status ReadProcessStats(int32_t pid, const PIDFiles& files,
+                          ProcParser::ProcessStats* out) const;
+
+  void SampleRange(const std::vector<int32_t>& pids, size_t begin, size_t end,
+                   std::vector<ProcessStatsSample>* samples) const;
+  // Runs on each of the worker threads, sampling its part of each batch.
+  void WorkerLoop(size_t worker_idx);
+
+  std::filesystem::path proc_base_path_;
+  int64_t ns_per_kernel_tick_;
+  int32_t bytes_per_page_;
+  int num_threads_;
+
+  uint64_t batch_ = 0;
+  absl::flat_hash_map<int32_t, PIDFiles> files_;
+
+  size_t max_open_files_;
+  size_t num_open_files_ = 0;
+  // PIDs with open files, most recently used first.
+  std::list<int32_t> lru_;
+
+  // The worker threads, and the batch they are working on.
+  std::vector<std::thread> workers_;
+  std::mutex workers_mu_;
+  std::condition_variable work_cv_;
+  std::condition_variable done_cv_;
+  bool stop_workers_ = false;
+  uint64_t work_generation_ = 0;
+  size_t num_busy_workers_ = 0;
+  const std::vector<int32_t>* work_pids_ = nullptr;
+  std::vector<ProcessStatsSample>* work_samples_ = nullptr;
+  size_t work_num_threads_ = 0;
+  size_t work_pids_per_thread_ = 0;
+
+  // Buffer for net/dev files, which can be larger than the fixed size read buffers.
+  std::string net_dev_buf_;
+};
+
+}  // namespace system
+}  // namespace px
@@ -0,0 +1,103 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <memory>
+#include <vector>
+
+#include "src/common/base/base.h"
+#include "src/common/system/config_mock.h"
+#include "src/common/system/proc_parser.h"
+#include "src/common/system/proc_pid_sampler.h"
+#include "src/common/testing/temp_dir.h"
+#include "src/common/testing/test_environment.h"
+
+using ::px::system::MockConfig;
+using ::px::system::ProcParser;
+using ::px::system::ProcPIDSampler;
+using ::testing::NiceMock;
+using ::testing::Return;
+using ::testing::ReturnRef;
+
+// Files of this testdata process are replicated to build a synthetic /proc with many processes.
+constexpr std::string_view kTemplatePIDPath = "src/common/system/testdata/proc/123";
+
+class SyntheticProc {
+ public:
+  explicit SyntheticProc(int num_pids) {
+    const std::filesystem::path template_path = px::testing::TestFilePath(kTemplatePIDPath);
+    for (int pid = 1; pid <= num_pids; ++pid) {
+      const std::filesystem::path pid_path = temp_dir_.path() / std::to_string(pid);
+      std::filesystem::create_directories(pid_path);
+      std::filesystem::copy_file(template_path / "stat", pid_path / "stat");
+      std::filesystem::copy_file(template_path / "io", pid_path / "io");
+      pids_.push_back(pid);
+    }
+
+    ON_CALL(sysconfig_, HasConfig()).WillByDefault(Return(true));
+    ON_CALL(sysconfig_, PageSize()).WillByDefault(Return(4096));
+    ON_CALL(sysconfig_, KernelTicksPerSecond()).WillByDefault(Return(100));
+    ON_CALL(sysconfig_, proc_path()).WillByDefault(ReturnRef(temp_dir_.path()));
+  }
+
+  const px::system::Config& sysconfig() const { return sysconfig_; }
+  const std::vector<int32_t>& pids() const { return pids_; }
+
+ private:
+  px::testing::TempDir temp_dir_;
+  NiceMock<MockConfig> sysconfig_;
+  std::vector<int32_t> pids_;
+};
+
+// NOLINTNEXTLINE : runtime/references.
+static void BM_proc_parser(benchmark::State& state) {
+  SyntheticProc proc(state.range(0));
+  ProcParser parser(proc.sysconfig());
+
+  for (auto _ : state) {
+    for (int32_t pid : proc.pids()) {
+      ProcParser::ProcessStats stats;
+      PL_CHECK_OK(parser.ParseProcPIDStat(pid, &stats));
+      PL_CHECK_OK(parser.ParseProcPIDStatIO(pid, &stats));
+      benchmark::DoNotOptimize(stats);
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * proc.pids().size());
+}
+
+// NOLINTNEXTLINE : runtime/references.
+static void BM_proc_pid_sampler(benchmark::State& state) {
+  SyntheticProc proc(state.range(0));
+  ProcPIDSampler sampler(proc.sysconfig(), /*num_threads*/ state.range(1));
+  std::vector<ProcPIDSampler::ProcessStatsSample> samples;
+
+  for (auto _ : state) {
+    sampler.SampleProcessStats(proc.pids(), &samples);
+    benchmark::DoNotOptimize(samples);
+  }
+  state.SetItemsProcessed(state.iterations() * proc.pids().size());
+}
+
+BENCHMARK(BM_proc_parser)->Arg(100)->Arg(1000)->Arg(3000);
+BENCHMARK(BM_proc_pid_sampler)
+    ->Args({100, 1})
+    ->Args({1000, 1})
+    ->Args({3000, 1})
+    ->Args({1000, 4})
+    ->Args({3000, 4});
@@ -0,0 +1,265 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/common/system/proc_pid_sampler.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <vector>
+
+#include "src/common/system/config_mock.h"
+#include "src/common/testing/temp_dir.h"
+#include "src/common/testing/test_environment.h"
+#include "src/common/testing/testing.h"
+
+namespace px {
+namespace system {
+
+using ::testing::Return;
+using ::testing::ReturnRef;
+
+class ProcPIDSamplerTest : public ::testing::Test {
+ protected:
+  ProcPIDSamplerTest()
+      : proc_path_(testing::TestFilePath("src/common/system/testdata/proc")) {}
+
+  void SetUp() override {
+    system::MockConfig sysconfig;
+
+    EXPECT_CALL(sysconfig, HasConfig()).WillRepeatedly(Return(true));
+    EXPECT_CALL(sysconfig, PageSize()).WillRepeatedly(Return(4096));
+    EXPECT_CALL(sysconfig, KernelTicksPerSecond()).WillRepeatedly(Return(10000000));
+    EXPECT_CALL(sysconfig, proc_path()).WillRepeatedly(ReturnRef(proc_path_));
+    parser_ = std::make_unique<ProcParser>(sysconfig);
+    sampler_ = std::make_unique<ProcPIDSampler>(sysconfig);
+  }
+
+  std::filesystem::path proc_path_;
+  std::unique_ptr<ProcParser> parser_;
+  std::unique_ptr<ProcPIDSampler> sampler_;
+};
+
+void ExpectSameProcessStats(const ProcParser::ProcessStats& a,
+                            const ProcParser::ProcessStats& b) {
+  EXPECT_EQ(a.pid, b.pid);
+  EXPECT_EQ(a.process_name, b.process_name);
+  EXPECT_EQ(a.minor_faults, b.minor_faults);
+  EXPECT_EQ(a.major_faults, b.major_faults);
+  EXPECT_EQ(a.utime_ns, b.utime_ns);
+  EXPECT_EQ(a.ktime_ns, b.ktime_ns);
+  EXPECT_EQ(a.num_threads, b.num_threads);
+  EXPECT_EQ(a.vsize_bytes, b.vsize_bytes);
+  EXPECT_EQ(a.rss_bytes, b.rss_bytes);
+  EXPECT_EQ(a.rchar_bytes, b.rchar_bytes);
+  EXPECT_EQ(a.wchar_bytes, b.wchar_bytes);
+  EXPECT_EQ(a.read_bytes, b.read_bytes);
+  EXPECT_EQ(a.write_bytes, b.write_bytes);
+}
+
+TEST_F(ProcPIDSamplerTest, SameAsProcParser) {
+  ProcParser::ProcessStats expected;
+  ASSERT_OK(parser_->ParseProcPIDStat(123, &expected));
+  ASSERT_OK(parser_->ParseProcPIDStatIO(123, &expected));
+
+  ProcParser::ProcessStats stats;
+  ASSERT_OK(sampler_->SampleProcessStats(123, &stats));
+  ExpectSameProcessStats(stats, expected);
+
+  // Sample again, re-reading the files that were kept open.
+  stats.Clear();
+  ASSERT_OK(sampler_->SampleProcessStats(123, &stats));
+  ExpectSameProcessStats(stats, expected);
+}
+
+TEST_F(ProcPIDSamplerTest, NetDevSameAsProcParser) {
+  ProcParser::NetworkStats expected;
+  ASSERT_OK(parser_->ParseProcPIDNetDev(123, &expected));
+
+  ProcParser::NetworkStats stats;
+  ASSERT_OK(sampler_->SampleNetDev(123, /* start_ts */ 1, &stats));
+  EXPECT_EQ(stats.rx_bytes, expected.rx_bytes);
+  EXPECT_EQ(stats.rx_packets, expected.rx_packets);
+  EXPECT_EQ(stats.rx_errs, expected.rx_errs);
+  EXPECT_EQ(stats.rx_drops, expected.rx_drops);
+  EXPECT_EQ(stats.tx_bytes, expected.tx_bytes);
+  EXPECT_EQ(stats.tx_packets, expected.tx_packets);
+  EXPECT_EQ(stats.tx_errs, expected.tx_errs);
+  EXPECT_EQ(stats.tx_drops, expected.tx_drops);
+
+  EXPECT_NOT_OK(sampler_->SampleNetDev(456, /* start_ts */ 1, &stats));
+}
+
+TEST_F(ProcPIDSamplerTest, NetDevNotReusedForReusedPID) {
+  testing::TempDir proc_dir;
+  const std::filesystem::path net_dev_path = proc_dir.path() / "123" / "net" / "dev";
+  std::filesystem::create_directories(net_dev_path.parent_path());
+  std::filesystem::copy_file(proc_path_ / "123" / "net" / "dev", net_dev_path);
+
+  system::MockConfig sysconfig;
+  EXPECT_CALL(sysconfig, HasConfig()).WillRepeatedly(Return(true));
+  EXPECT_CALL(sysconfig, PageSize()).WillRepeatedly(Return(4096));
+  EXPECT_CALL(sysconfig, KernelTicksPerSecond()).WillRepeatedly(Return(10000000));
+  EXPECT_CALL(sysconfig, proc_path()).WillRepeatedly(ReturnRef(proc_dir.path()));
+  ProcPIDSampler sampler(sysconfig);
+
+  ProcParser::NetworkStats stats;
+  ASSERT_OK(sampler.SampleNetDev(123, /* start_ts */ 1, &stats));
+  const int64_t rx_bytes = stats.rx_bytes;
+
+  // Replace the file, like the directory of a new process with the same PID would.
+  const std::filesystem::path new_net_dev_path = proc_dir.path() / "new_dev";
+  {
+    std::ofstream out(new_net_dev_path);
+    out << "Inter-|   Receive\n"
+        << " face |bytes    packets errs drop fifo frame compressed multicast|bytes\n"
+        << " ens33: 7 1 0 0 0 0 0 0 8 1 0 0 0 0 0 0\n";
+  }
+  std::filesystem::rename(new_net_dev_path, net_dev_path);
+
+  // The same process keeps reading the file it opened.
+  stats.Clear();
+  ASSERT_OK(sampler.SampleNetDev(123, /* start_ts */ 1, &stats));
+  EXPECT_EQ(stats.rx_bytes, rx_bytes);
+
+  // A new process with the same PID gets its own file.
+  stats.Clear();
+  ASSERT_OK(sampler.SampleNetDev(123, /* start_ts */ 2, &stats));
+  EXPECT_EQ(stats.rx_bytes, 7);
+  EXPECT_EQ(stats.tx_bytes, 8);
+}
+
+TEST_F(ProcPIDSamplerTest, Batch) {
+  ProcParser::ProcessStats expected;
+  ASSERT_OK(parser_->ParseProcPIDStat(123, &expected));
+  ASSERT_OK(parser_->ParseProcPIDStatIO(123, &expected));
+
+  // PID 456 has no io file, and PID 1000 does not exist.
+  std::vector<ProcPIDSampler::ProcessStatsSample> samples;
+  sampler_->SampleProcessStats({123, 456, 1000}, &samples);
+  ASSERT_EQ(samples.size(), 3);
+  EXPECT_EQ(samples[0].pid, 123);
+  ASSERT_OK(samples[0].status);
+  ExpectSameProcessStats(samples[0].stats, expected);
+  EXPECT_EQ(samples[1].pid, 456);
+  EXPECT_NOT_OK(samples[1].status);
+  EXPECT_EQ(samples[2].pid, 1000);
+  EXPECT_NOT_OK(samples[2].status);
+
+  // PIDs not in the batch have their files closed.
+  sampler_->SampleProcessStats({123}, &samples);
+  ASSERT_EQ(samples.size(), 1);
+  ASSERT_OK(samples[0].status);
+  ExpectSameProcessStats(samples[0].stats, expected);
+  EXPECT_EQ(sampler_->num_pids(), 1);
+
+  sampler_->RetainPIDs({});
+  EXPECT_EQ(sampler_->num_pids(), 0);
+}
+
+// Creates a proc directory with a copy of the stat and io files of PID 123 for each of the pids.
+void CreateProcDir(const std::filesystem::path& src, const std::filesystem::path& dst,
+                   const std::vector<int32_t>& pids) {
+  for (int32_t pid : pids) {
+    const std::filesystem::path pid_path = dst / std::to_string(pid);
+    std::filesystem::create_directories(pid_path);
+    std::filesystem::copy_file(src / "123" / "stat", pid_path / "stat");
+    std::filesystem::copy_file(src / "123" / "io", pid_path / "io");
+  }
+}
+
+TEST_F(ProcPIDSamplerTest, BatchOverOpenFilesLimit) {
+  ProcParser::ProcessStats expected;
+  ASSERT_OK(parser_->ParseProcPIDStat(123, &expected));
+  ASSERT_OK(parser_->ParseProcPIDStatIO(123, &expected));
+
+  testing::TempDir proc_dir;
+  std::vector<int32_t> pids;
+  for (int32_t pid = 1000; pid < 1600; ++pid) {
+    pids.push_back(pid);
+  }
+  CreateProcDir(proc_path_, proc_dir.path(), pids);
+
+  system::MockConfig sysconfig;
+  EXPECT_CALL(sysconfig, HasConfig()).WillRepeatedly(Return(true));
+  EXPECT_CALL(sysconfig, PageSize()).WillRepeatedly(Return(4096));
+  EXPECT_CALL(sysconfig, KernelTicksPerSecond()).WillRepeatedly(Return(10000000));
+  EXPECT_CALL(sysconfig, proc_path()).WillRepeatedly(ReturnRef(proc_dir.path()));
+
+  // Enough PIDs for all the threads, and more files than can be kept open.
+  constexpr size_t kMaxOpenFiles = 100;
+  ProcPIDSampler sampler(sysconfig, /* num_threads */ 3, kMaxOpenFiles);
+
+  std::vector<ProcPIDSampler::ProcessStatsSample> samples;
+  for (int i = 0; i < 2; ++i) {
+    sampler.SampleProcessStats(pids, &samples);
+    ASSERT_EQ(samples.size(), pids.size());
+    for (size_t j = 0; j < pids.size(); ++j) {
+      EXPECT_EQ(samples[j].pid, pids[j]);
+      ASSERT_OK(samples[j].status);
+      ExpectSameProcessStats(samples[j].stats, expected);
+    }
+    EXPECT_EQ(sampler.num_open_files(), kMaxOpenFiles);
+  }
+
+  // The files of PIDs that were not kept open are read all the same.
+  ProcParser::ProcessStats stats;
+  ASSERT_OK(sampler.SampleProcessStats(pids.back(), &stats));
+  ExpectSameProcessStats(stats, expected);
+  EXPECT_EQ(sampler.num_open_files(), kMaxOpenFiles);
+
+  // The files of the least recently sampled PIDs make room for those of new PIDs.
+  sampler.SampleProcessStats({pids.back()}, &samples);
+  ASSERT_EQ(samples.size(), 1);
+  ASSERT_OK(samples[0].status);
+  EXPECT_EQ(sampler.num_open_files(), 2);
+  EXPECT_EQ(sampler.num_pids(), 1);
+}
+
+TEST_F(ProcPIDSamplerTest, NoOpenFiles) {
+  ProcParser::ProcessStats expected;
+  ASSERT_OK(parser_->ParseProcPIDStat(123, &expected));
+  ASSERT_OK(parser_->ParseProcPIDStatIO(123, &expected));
+  ProcParser::NetworkStats expected_net;
+  ASSERT_OK(parser_->ParseProcPIDNetDev(123, &expected_net));
+
+  system::MockConfig sysconfig;
+  EXPECT_CALL(sysconfig, HasConfig()).WillRepeatedly(Return(true));
+  EXPECT_CALL(sysconfig, PageSize()).WillRepeatedly(Return(4096));
+  EXPECT_CALL(sysconfig, KernelTicksPerSecond()).WillRepeatedly(Return(10000000));
+  EXPECT_CALL(sysconfig, proc_path()).WillRepeatedly(ReturnRef(proc_path_));
+  ProcPIDSampler sampler(sysconfig, /* num_threads */ 1, /* max_open_files */ 0);
+
+  ProcParser::ProcessStats stats;
+  ASSERT_OK(sampler.SampleProcessStats(123, &stats));
+  ExpectSameProcessStats(stats, expected);
+
+  ProcParser::NetworkStats net_stats;
+  ASSERT_OK(sampler.SampleNetDev(123, /* start_ts */ 1, &net_stats));
+  EXPECT_EQ(net_stats.rx_bytes, expected_net.rx_bytes);
+  EXPECT_EQ(net_stats.tx_bytes, expected_net.tx_bytes);
+
+  EXPECT_NOT_OK(sampler.SampleProcessStats(1000, &stats));
+  EXPECT_EQ(sampler.num_open_files(), 0);
+}
+
+}  // namespace system
+}  // namespace px
@@ -69,7 +69,7 @@ StatusOr<std::unique_ptr<XXHash64BloomFilter>> XXHash64BloomFilter::FromProto(
   return std::unique_ptr<XXHash64BloomFilter>(new XXHash64BloomFilter(data, pb.num_hashes()));
 }
 
-XXHash64BloomFilterPB XXHash64BloomFilter::ToProto() {
+XXHash64BloomFilterPB XXHash64BloomFilter::ToProto() const {
   XXHash64BloomFilterPB output;
   output.set_num_hashes(num_hashes_);
   std::string bytes_str{buffer_.begin(), buffer_.end()};
@@ -116,5 +116,18 @@ bool XXHash64BloomFilter::Contains(std::string_view item) const {
   return true;
 }
 
+Status XXHash64BloomFilter::Merge(const XXHash64BloomFilter& other) {
+  if (buffer_.size() != other.buffer_.size() || num_hashes_ != other.num_hashes_) {
+    return error::InvalidArgument(
+        "Can't merge bloom filters of different shapes: $0 bytes and $1 hashes vs $2 bytes and $3 "
+        "hashes",
+        buffer_.size(), num_hashes_, other.buffer_.size(), other.num_hashes_);
+  }
+  for (size_t i = 0; i < buffer_.size(); ++i) {
+    buffer_[i] |= other.buffer_[i];
+  }
+  return Status::OK();
+}
+
 }  // namespace bloomfilter
 }  // namespace px
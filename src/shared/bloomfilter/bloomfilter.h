@@ -40,7 +40,7 @@ class XXHash64BloomFilter {
   static StatusOr<std::unique_ptr<XXHash64BloomFilter>> Create(int64_t max_entries,
                                                                double error_rate);
   static StatusOr<std::unique_ptr<XXHash64BloomFilter>> FromProto(const XXHash64BloomFilterPB& pb);
-  XXHash64BloomFilterPB ToProto();
+  XXHash64BloomFilterPB ToProto() const;
 
   /**
    * Insert inserts an item into the bloom filter.
@@ -55,6 +55,12 @@ class XXHash64BloomFilter {
   bool Contains(std::string_view item) const;
   bool Contains(const std::string& item) const { return Contains(std::string_view(item)); }
 
+  /**
+   * Merge adds the items of another bloom filter to this one. Both filters must have the same
+   * size and number of hashes.
+   */
+  Status Merge(const XXHash64BloomFilter& other);
+
   /**
    * Get the buffer size in bytes of the bloom filter.
    */
@@ -18,6 +18,7 @@
 
 #include <gtest/gtest.h>
 
+#include "src/common/testing/testing.h"
 #include "src/shared/bloomfilter/bloomfilter.h"
 
 namespace px {
@@ -87,6 +88,21 @@ TEST(XXHash64BloomFilter, test_error_rate) {
   }
 }
 
+TEST(XXHash64BloomFilter, test_merge) {
+  auto bf1 = XXHash64BloomFilter::Create(10, 0.1).ConsumeValueOrDie();
+  auto bf2 = XXHash64BloomFilter::Create(10, 0.1).ConsumeValueOrDie();
+  bf1->Insert("foo");
+  bf2->Insert("bar");
+  EXPECT_OK(bf1->Merge(*bf2));
+  EXPECT_TRUE(bf1->Contains("foo"));
+  EXPECT_TRUE(bf1->Contains("bar"));
+  EXPECT_FALSE(bf1->Contains("not_present"));
+  EXPECT_FALSE(bf2->Contains("foo"));
+
+  auto bf3 = XXHash64BloomFilter::Create(1000, 0.1).ConsumeValueOrDie();
+  EXPECT_NOT_OK(bf1->Merge(*bf3));
+}
+
 TEST(XXHash64BloomFilter, test_create_from_proto) {
   std::vector<std::string> matches{"foo", "bar", "abc"};
   std::vector<std::string> non_matches{"123", "456", "789"};
@@ -0,0 +1,241 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <iterator>
+#include <memory>
+#include <utility>
+
+#include <absl/container/flat_hash_map.h>
+
+namespace px {
+namespace md {
+
+/**
+ * Returns true if ptr holds the only reference to its object, which makes it safe to modify
+ * the object in place.
+ */
+template <typename T>
+bool IsUniquelyOwned(const std::shared_ptr<T>& ptr) {
+  if (ptr.use_count() != 1) {
+    return false;
+  }
+  // Pairs with the release performed when the last other owner dropped its reference, so that
+  // any reads it made of the object happen before our writes.
+  std::atomic_thread_fence(std::memory_order_acquire);
+  return true;
+}
+
+/**
+ * ChunkedCOWMap is a hash map split into a fixed number of chunks that are shared between
+ * copies of the map. Copying the map only copies the chunk pointers, and a chunk is copied the
+ * first time it is modified while shared. Snapshots of large maps that only change a few keys
+ * between snapshots therefore cost O(kNumChunks + modified chunks) instead of O(size).
+ *
+ * A single instance is not thread-safe, but different copies may be used from different threads
+ * since a shared chunk is never modified in place.
+ *
+ * Only const iteration is supported. Values are modified through operator[], insert_or_assign or
+ * FindMutable, which make the owning chunk private first.
+ */
+template <typename TKey, typename TValue,
+          typename THash = absl::container_internal::hash_default_hash<TKey>,
+          typename TEq = absl::container_internal::hash_default_eq<TKey>>
+class ChunkedCOWMap {
+ public:
+  using Chunk = absl::flat_hash_map<TKey, TValue, THash, TEq>;
+  using key_type = TKey;
+  using mapped_type = TValue;
+  using value_type = typename Chunk::value_type;
+  using hasher = THash;
+  using key_equal = TEq;
+
+  static constexpr int kChunkBits = 6;
+  static constexpr size_t kNumChunks = 1 << kChunkBits;
+
+  class const_iterator {
+   public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = typename Chunk::value_type;
+    using reference = const value_type&;
+    using pointer = const value_type*;
+    using difference_type = std::ptrdiff_t;
+
+    const_iterator() = default;
+
+    reference operator*() const { return *it_; }
+    pointer operator->() const { return &*it_; }
+
+    const_iterator& operator++() {
+      ++it_;
+      SkipEmptyChunks();
+      return *this;
+    }
+
+    const_iterator operator++(int) {
+      const_iterator tmp = *this;
+      ++*this;
+      return tmp;
+    }
+
+    bool operator==(const const_iterator& other) const {
+      return chunk_idx_ == other.chunk_idx_ && (chunk_idx_ == kNumChunks || it_ == other.it_);
+    }
+    bool operator!=(const const_iterator& other) const { return !(*this == other); }
+
+   private:
+    friend class ChunkedCOWMap;
+
+    const_iterator(const ChunkedCOWMap* map, size_t chunk_idx, typename Chunk::const_iterator it)
+        : map_(map), chunk_idx_(chunk_idx), it_(it) {}
+
+    void SkipEmptyChunks() {
+      while (chunk_idx_ < kNumChunks && it_ == map_->chunks_[chunk_idx_]->end()) {
+        ++chunk_idx_;
+        if (chunk_idx_ < kNumChunks) {
+          it_ = map_->chunks_[chunk_idx_]->begin();
+        }
+      }
+    }
+
+    const ChunkedCOWMap* map_ = nullptr;
+    size_t chunk_idx_ = kNumChunks;
+    typename Chunk::const_iterator it_;
+  };
+  // Mutable iteration is not supported, but matchers and generic code expect the name.
+  using iterator = const_iterator;
+
+  ChunkedCOWMap() { chunks_.fill(EmptyChunk()); }
+  // Moves fall back to the copy, which is cheap and keeps the source valid.
+  ChunkedCOWMap(const ChunkedCOWMap&) = default;
+  ChunkedCOWMap& operator=(const ChunkedCOWMap&) = default;
+
+  size_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+
+  const_iterator begin() const {
+    const_iterator it(this, 0, chunks_[0]->begin());
+    it.SkipEmptyChunks();
+    return it;
+  }
+  const_iterator end() const { return const_iterator(); }
+
+  template <typename K>
+  const_iterator find(const K& key) const {
+    size_t idx = ChunkIndex(key);
+    const Chunk& chunk = *chunks_[idx];
+    auto it = chunk.find(key);
+    if (it == chunk.end()) {
+      return end();
+    }
+    return const_iterator(this, idx, it);
+  }
+
+  template <typename K>
+  bool contains(const K& key) const {
+    return chunks_[ChunkIndex(key)]->contains(key);
+  }
+
+  template <typename K>
+  size_t count(const K& key) const {
+    return contains(key) ? 1 : 0;
+  }
+
+  /**
+   * Returns a modifiable reference to the value of key, inserting a default value if needed.
+   */
+  TValue& operator[](const TKey& key) {
+    Chunk& chunk = MutableChunk(ChunkIndex(key));
+    size_t prev_size = chunk.size();
+    TValue& value = chunk[key];
+    size_ += chunk.size() - prev_size;
+    return value;
+  }
+
+  void insert_or_assign(const TKey& key, TValue value) { (*this)[key] = std::move(value); }
+
+  /**
+   * Returns a modifiable pointer to the value of key, or nullptr if key is not present.
+   * The chunk is only made private if the key exists.
+   */
+  template <typename K>
+  TValue* FindMutable(const K& key) {
+    size_t idx = ChunkIndex(key);
+    if (!chunks_[idx]->contains(key)) {
+      return nullptr;
+    }
+    return &MutableChunk(idx).find(key)->second;
+  }
+
+  template <typename K>
+  size_t erase(const K& key) {
+    size_t idx = ChunkIndex(key);
+    if (!chunks_[idx]->contains(key)) {
+      return 0;
+    }
+    MutableChunk(idx).erase(key);
+    --size_;
+    return 1;
+  }
+
+  void clear() {
+    chunks_.fill(EmptyChunk());
+    size_ = 0;
+  }
+
+  /**
+   * The number of non-empty chunks that are currently shared with another copy of this map.
+   */
+  size_t NumSharedChunks() const {
+    size_t n = 0;
+    for (const auto& chunk : chunks_) {
+      n += (chunk != EmptyChunk() && chunk.use_count() > 1) ? 1 : 0;
+    }
+    return n;
+  }
+
+ private:
+  template <typename K>
+  static size_t ChunkIndex(const K& key) {
+    // The low bits of the hash pick the slot inside a chunk, so the chunk uses the high bits.
+    return static_cast<uint64_t>(THash{}(key)) >> (64 - kChunkBits);
+  }
+
+  static const std::shared_ptr<Chunk>& EmptyChunk() {
+    // Never modified: it is always shared with this static reference.
+    static const auto* empty = new std::shared_ptr<Chunk>(std::make_shared<Chunk>());
+    return *empty;
+  }
+
+  Chunk& MutableChunk(size_t idx) {
+    std::shared_ptr<Chunk>& chunk = chunks_[idx];
+    if (!IsUniquelyOwned(chunk)) {
+      chunk = std::make_shared<Chunk>(*chunk);
+    }
+    return *chunk;
+  }
+
+  std::array<std::shared_ptr<Chunk>, kNumChunks> chunks_;
+  size_t size_ = 0;
+};
+
+}  // namespace md
+}  // namespace px
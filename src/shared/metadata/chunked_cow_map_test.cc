@@ -0,0 +1,111 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+
+#include "src/shared/metadata/chunked_cow_map.h"
+
+namespace px {
+namespace md {
+
+using ::testing::Pair;
+using ::testing::UnorderedElementsAre;
+
+TEST(ChunkedCOWMapTest, Basic) {
+  ChunkedCOWMap<std::string, int> map;
+  EXPECT_TRUE(map.empty());
+  EXPECT_EQ(map.begin(), map.end());
+
+  map["a"] = 1;
+  map["b"] = 2;
+  map.insert_or_assign("c", 3);
+  map["a"] = 4;
+
+  EXPECT_EQ(map.size(), 3);
+  EXPECT_THAT(map, UnorderedElementsAre(Pair("a", 4), Pair("b", 2), Pair("c", 3)));
+
+  std::string_view key = "b";
+  ASSERT_NE(map.find(key), map.end());
+  EXPECT_EQ(map.find(key)->second, 2);
+  EXPECT_TRUE(map.contains("c"));
+  EXPECT_EQ(map.find("d"), map.end());
+  EXPECT_EQ(map.FindMutable("d"), nullptr);
+
+  *map.FindMutable("c") = 5;
+  EXPECT_EQ(map.find("c")->second, 5);
+
+  EXPECT_EQ(map.erase("a"), 1);
+  EXPECT_EQ(map.erase("a"), 0);
+  EXPECT_EQ(map.size(), 2);
+  EXPECT_THAT(map, UnorderedElementsAre(Pair("b", 2), Pair("c", 5)));
+
+  map.clear();
+  EXPECT_TRUE(map.empty());
+  EXPECT_EQ(map.begin(), map.end());
+}
+
+TEST(ChunkedCOWMapTest, CopiesAreIsolated) {
+  ChunkedCOWMap<int, int> map;
+  for (int i = 0; i < 1000; ++i) {
+    map[i] = i;
+  }
+  EXPECT_EQ(map.NumSharedChunks(), 0);
+
+  ChunkedCOWMap<int, int> copy = map;
+  size_t num_chunks = map.NumSharedChunks();
+  EXPECT_EQ(num_chunks, (ChunkedCOWMap<int, int>::kNumChunks));
+
+  // Only the chunks holding the modified keys are copied.
+  copy[1] = -1;
+  copy.erase(2);
+  copy[1000] = 1000;
+  EXPECT_GE(copy.NumSharedChunks(), num_chunks - 3);
+  EXPECT_LT(copy.NumSharedChunks(), num_chunks);
+
+  EXPECT_EQ(map.size(), 1000);
+  EXPECT_EQ(map.find(1)->second, 1);
+  EXPECT_TRUE(map.contains(2));
+  EXPECT_FALSE(map.contains(1000));
+
+  EXPECT_EQ(copy.size(), 1000);
+  EXPECT_EQ(copy.find(1)->second, -1);
+  EXPECT_FALSE(copy.contains(2));
+  EXPECT_EQ(copy.find(1000)->second, 1000);
+
+  int64_t sum = 0;
+  for (const auto& [k, v] : map) {
+    sum += v;
+  }
+  EXPECT_EQ(sum, 999 * 1000 / 2);
+}
+
+TEST(ChunkedCOWMapTest, UniquelyOwned) {
+  auto ptr = std::make_shared<int>(1);
+  EXPECT_TRUE(IsUniquelyOwned(ptr));
+  auto other = ptr;
+  EXPECT_FALSE(IsUniquelyOwned(ptr));
+  other.reset();
+  EXPECT_TRUE(IsUniquelyOwned(ptr));
+}
+
+}  // namespace md
+}  // namespace px
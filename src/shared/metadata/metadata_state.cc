@@ -92,46 +92,43 @@ const ContainerInfo* K8sMetadataState::ContainerInfoByID(CIDView id) const {
   return it == containers_by_id_.end() ? nullptr : it->second.get();
 }
 
-std::unique_ptr<K8sMetadataState> K8sMetadataState::Clone() const {
-  auto other = std::make_unique<K8sMetadataState>();
-
-  other->pod_cidrs_ = pod_cidrs_;
-  other->service_cidr_ = service_cidr_;
-
-  other->k8s_objects_.reserve(k8s_objects_.size());
-  for (const auto& [k, v] : k8s_objects_) {
-    other->k8s_objects_[k] = v->Clone();
+ContainerInfo* K8sMetadataState::MutableContainerInfoByID(CIDView id) {
+  auto* cinfo = containers_by_id_.FindMutable(id);
+  if (cinfo == nullptr) {
+    return nullptr;
   }
-
-  other->pods_by_name_.reserve(pods_by_name_.size());
-  for (const auto& [k, v] : pods_by_name_) {
-    other->pods_by_name_[k] = v;
+  if (!IsUniquelyOwned(*cinfo)) {
+    *cinfo = (*cinfo)->Clone();
   }
+  return cinfo->get();
+}
 
-  other->pods_by_ip_.reserve(pods_by_ip_.size());
-  for (const auto& [k, v] : pods_by_ip_) {
-    other->pods_by_ip_[k] = v;
+template <typename T>
+T* K8sMetadataState::MutableK8sObject(UIDView uid) {
+  auto* obj = k8s_objects_.FindMutable(uid);
+  if (obj == nullptr) {
+    return nullptr;
   }
-
-  other->containers_by_id_.reserve(containers_by_id_.size());
-  for (const auto& [k, v] : containers_by_id_) {
-    other->containers_by_id_[k] = v->Clone();
+  if (!IsUniquelyOwned(*obj)) {
+    *obj = (*obj)->Clone();
   }
+  return static_cast<T*>(obj->get());
+}
 
-  other->services_by_name_.reserve(services_by_name_.size());
-  for (const auto& [k, v] : services_by_name_) {
-    other->services_by_name_[k] = v;
-  }
+std::unique_ptr<K8sMetadataState> K8sMetadataState::Clone() const {
+  auto other = std::make_unique<K8sMetadataState>();
 
-  other->namespaces_by_name_.reserve(namespaces_by_name_.size());
-  for (const auto& [k, v] : namespaces_by_name_) {
-    other->namespaces_by_name_[k] = v;
-  }
+  other->pod_cidrs_ = pod_cidrs_;
+  other->service_cidr_ = service_cidr_;
 
-  other->containers_by_name_.reserve(containers_by_name_.size());
-  for (const auto& [k, v] : containers_by_name_) {
-    other->containers_by_name_[k] = v;
-  }
+  // These only copy chunk pointers; objects are copied when either state modifies them.
+  other->k8s_objects_ = k8s_objects_;
+  other->pods_by_name_ = pods_by_name_;
+  other->pods_by_ip_ = pods_by_ip_;
+  other->containers_by_id_ = containers_by_id_;
+  other->services_by_name_ = services_by_name_;
+  other->namespaces_by_name_ = namespaces_by_name_;
+  other->containers_by_name_ = containers_by_name_;
   return other;
 }
 
@@ -164,15 +161,15 @@ std::string K8sMetadataState::DebugString(int indent_level) const {
 }
 
 Status K8sMetadataState::HandlePodUpdate(const PodUpdate& update) {
+  ++update_count_;
   const auto& object_uid = update.uid();
   const std::string& name = update.name();
   const std::string& ns = update.namespace_();
 
-  auto it = k8s_objects_.find(object_uid);
-  if (it == k8s_objects_.end()) {
-    auto pod = std::make_unique<PodInfo>(update);
+  if (!k8s_objects_.contains(object_uid)) {
+    auto pod = std::make_shared<PodInfo>(update);
     VLOG(1) << "Adding Pod: " << pod->DebugString();
-    it = k8s_objects_.try_emplace(object_uid, std::move(pod)).first;
+    k8s_objects_.insert_or_assign(object_uid, std::move(pod));
   }
 
   // We always just add to the container set even if the container is stopped.
@@ -180,9 +177,10 @@ Status K8sMetadataState::HandlePodUpdate(const PodUpdate& update) {
   // time. Also, because we expect eventual consistency container ID may or may not be available
   // before the container state is available. Upstream code using this needs to be aware that the
   // state might be periodically inconsistent.
-  auto pod_info = static_cast<PodInfo*>(it->second.get());
+  auto pod_info = MutableK8sObject<PodInfo>(object_uid);
   for (const auto& cid : update.container_ids()) {
-    if (containers_by_id_.find(cid) == containers_by_id_.end()) {
+    auto cinfo_it = containers_by_id_.find(cid);
+    if (cinfo_it == containers_by_id_.end()) {
       // We should be resilient to the case where we happened to miss a pod update
       // in the stream of events. If we did miss a pod update, just skip adding the
       // pod to this particular service to avoid dangling references.
@@ -191,7 +189,9 @@ Status K8sMetadataState::HandlePodUpdate(const PodUpdate& update) {
     }
 
     pod_info->AddContainer(cid);
-    containers_by_id_[cid]->set_pod_id(object_uid);
+    if (cinfo_it->second->pod_id() != object_uid) {
+      MutableContainerInfoByID(cid)->set_pod_id(object_uid);
+    }
   }
 
   pod_info->set_start_time_ns(update.start_timestamp_ns());
@@ -214,17 +214,17 @@ Status K8sMetadataState::HandlePodUpdate(const PodUpdate& update) {
 }
 
 Status K8sMetadataState::HandleContainerUpdate(const ContainerUpdate& update) {
+  ++update_count_;
   const auto& cid = update.cid();
 
-  auto it = containers_by_id_.find(cid);
-  if (it == containers_by_id_.end()) {
-    auto container = std::make_unique<ContainerInfo>(update);
+  if (!containers_by_id_.contains(cid)) {
+    auto container = std::make_shared<ContainerInfo>(update);
     VLOG(1) << "Adding Container: " << container->DebugString();
-    it = containers_by_id_.try_emplace(cid, std::move(container)).first;
+    containers_by_id_.insert_or_assign(cid, std::move(container));
   }
   VLOG(1) << "container update: " << update.name();
 
-  auto* container_info = it->second.get();
+  auto* container_info = MutableContainerInfoByID(cid);
   container_info->set_stop_time_ns(update.stop_timestamp_ns());
   container_info->set_state(ConvertToContainerState(update.container_state()));
   container_info->set_state_message(update.message());
@@ -236,30 +236,33 @@ Status K8sMetadataState::HandleContainerUpdate(const ContainerUpdate& update) {
 }
 
 Status K8sMetadataState::HandleServiceUpdate(const ServiceUpdate& update) {
+  ++update_count_;
   const auto& service_uid = update.uid();
   const std::string& name = update.name();
   const std::string& ns = update.namespace_();
 
-  auto it = k8s_objects_.find(service_uid);
-  if (it == k8s_objects_.end()) {
-    auto service = std::make_unique<ServiceInfo>(service_uid, ns, name);
+  if (!k8s_objects_.contains(service_uid)) {
+    auto service = std::make_shared<ServiceInfo>(service_uid, ns, name);
     VLOG(1) << "Adding Service: " << service->DebugString();
-    it = k8s_objects_.try_emplace(service_uid, std::move(service)).first;
+    k8s_objects_.insert_or_assign(service_uid, std::move(service));
   }
 
-  auto service_info = static_cast<ServiceInfo*>(it->second.get());
+  auto service_info = MutableK8sObject<ServiceInfo>(service_uid);
   for (const auto& uid : update.pod_ids()) {
-    if (k8s_objects_.find(uid) == k8s_objects_.end()) {
+    auto pod_it = k8s_objects_.find(uid);
+    if (pod_it == k8s_objects_.end()) {
       // We should be resilient to the case where we happened to miss a pod update
       // in the stream of events. If we did miss a pod update, just skip adding the
       // pod to this particular service to avoid dangling references.
       LOG(INFO) << absl::Substitute("Didn't find pod UID $0 for service $1/$2", uid, ns, name);
       continue;
     }
-    ECHECK(k8s_objects_[uid]->type() == K8sObjectType::kPod);
+    ECHECK(pod_it->second->type() == K8sObjectType::kPod);
     // We add the service uid to the pod. Lifetime of service still handled by the service object.
-    PodInfo* pod_info = static_cast<PodInfo*>(k8s_objects_[uid].get());
-    pod_info->AddService(service_uid);
+    // Pods that already list the service are left alone so they stay shared with older clones.
+    if (!static_cast<const PodInfo*>(pod_it->second.get())->services().contains(service_uid)) {
+      MutableK8sObject<PodInfo>(uid)->AddService(service_uid);
+    }
   }
   service_info->set_start_time_ns(update.start_timestamp_ns());
   service_info->set_stop_time_ns(update.stop_timestamp_ns());
@@ -271,18 +274,18 @@ Status K8sMetadataState::HandleServiceUpdate(const ServiceUpdate& update) {
 }
 
 Status K8sMetadataState::HandleNamespaceUpdate(const NamespaceUpdate& update) {
+  ++update_count_;
   const auto& namespace_uid = update.uid();
   const std::string& name = update.name();
   const std::string& ns = update.name();
 
-  auto it = k8s_objects_.find(namespace_uid);
-  if (it == k8s_objects_.end()) {
-    auto ns_obj = std::make_unique<NamespaceInfo>(namespace_uid, ns, name);
+  if (!k8s_objects_.contains(namespace_uid)) {
+    auto ns_obj = std::make_shared<NamespaceInfo>(namespace_uid, ns, name);
     VLOG(1) << "Adding Namespace: " << ns_obj->DebugString();
-    it = k8s_objects_.try_emplace(namespace_uid, std::move(ns_obj)).first;
+    k8s_objects_.insert_or_assign(namespace_uid, std::move(ns_obj));
   }
 
-  auto ns_info = static_cast<NamespaceInfo*>(it->second.get());
+  auto ns_info = MutableK8sObject<NamespaceInfo>(namespace_uid);
 
   ns_info->set_start_time_ns(update.start_timestamp_ns());
   ns_info->set_stop_time_ns(update.stop_timestamp_ns());
@@ -299,10 +302,7 @@ std::shared_ptr<AgentMetadataState> AgentMetadataState::CloneToShared() const {
   state->epoch_id_ = epoch_id_;
   state->asid_ = asid_;
   state->k8s_metadata_state_ = k8s_metadata_state_->Clone();
-  state->pids_by_upid_.reserve(pids_by_upid_.size());
-  for (const auto& [k, v] : pids_by_upid_) {
-    state->pids_by_upid_[k] = v->Clone();
-  }
+  state->pids_by_upid_ = pids_by_upid_;
   state->upids_ = upids_;
   return state;
 }
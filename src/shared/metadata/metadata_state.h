@@ -28,6 +28,7 @@
 
 #include "src/common/base/base.h"
 #include "src/shared/k8s/metadatapb/metadata.pb.h"
+#include "src/shared/metadata/chunked_cow_map.h"
 #include "src/shared/metadata/k8s_objects.h"
 #include "src/shared/metadata/pids.h"
 #include "src/shared/upid/upid.h"
@@ -38,10 +39,14 @@ namespace md {
 using K8sMetadataObjectUPtr = std::unique_ptr<K8sMetadataObject>;
 using ContainerInfoUPtr = std::unique_ptr<ContainerInfo>;
 using PIDInfoUPtr = std::unique_ptr<PIDInfo>;
+using PIDInfoMap = ChunkedCOWMap<UPID, std::shared_ptr<PIDInfo>>;
 using AgentID = sole::uuid;
 
 /**
  * This class contains all kubernetes relate metadata.
+ *
+ * All maps are ChunkedCOWMaps and objects are shared between clones, so Clone() is cheap.
+ * Objects are copied the first time they are modified while shared with a clone.
  */
 class K8sMetadataState : NotCopyable {
  public:
@@ -91,13 +96,15 @@ class K8sMetadataState : NotCopyable {
     };
   };
   using K8sEntityByNameMap =
-      absl::flat_hash_map<K8sNameIdent, UID, K8sIdentHashEq::Hash, K8sIdentHashEq::Eq>;
+      ChunkedCOWMap<K8sNameIdent, UID, K8sIdentHashEq::Hash, K8sIdentHashEq::Eq>;
 
   using PodsByNameMap = K8sEntityByNameMap;
   using ServicesByNameMap = K8sEntityByNameMap;
   using NamespacesByNameMap = K8sEntityByNameMap;
-  using ContainersByNameMap = absl::flat_hash_map<std::string, CID>;
-  using PodsByPodIpMap = absl::flat_hash_map<std::string, UID>;
+  using ContainersByNameMap = ChunkedCOWMap<std::string, CID>;
+  using PodsByPodIpMap = ChunkedCOWMap<std::string, UID>;
+  using K8sObjectsMap = ChunkedCOWMap<UID, std::shared_ptr<K8sMetadataObject>>;
+  using ContainersByIDMap = ChunkedCOWMap<CID, std::shared_ptr<ContainerInfo>>;
 
   void set_service_cidr(CIDRBlock cidr) {
     if (!service_cidr_.has_value() || service_cidr_.value() != cidr) {
@@ -115,7 +122,7 @@ class K8sMetadataState : NotCopyable {
 
   /**
    * PodInfoByID gets an unowned pointer to the Pod. This pointer will remain active
-   * for the lifetime of this metadata state instance.
+   * for the lifetime of this metadata state instance, or until the object is next updated.
    * @param pod_id the id of the POD.
    * @return Pointer to the PodInfo.
    */
@@ -157,7 +164,7 @@ class K8sMetadataState : NotCopyable {
 
   /**
    * ServiceInfoByID gets an unowned pointer to the Service. This pointer will remain active
-   * for the lifetime of this metadata state instance.
+   * for the lifetime of this metadata state instance, or until the object is next updated.
    * @param service_id the id of the Service.
    * @return Pointer to the ServiceInfo.
    */
@@ -172,7 +179,7 @@ class K8sMetadataState : NotCopyable {
 
   /**
    * NamespaceInfoByID gets an unowned pointer to the Namespace. This pointer will remain active
-   * for the lifetime of this metadata state instance.
+   * for the lifetime of this metadata state instance, or until the object is next updated.
    * @param ns_id the id of the Namespace.
    * @return Pointer to the NamespaceInfo.
    */
@@ -192,10 +199,31 @@ class K8sMetadataState : NotCopyable {
   Status HandleServiceUpdate(const ServiceUpdate& update);
   Status HandleNamespaceUpdate(const NamespaceUpdate& update);
 
-  absl::flat_hash_map<CID, ContainerInfoUPtr>& containers_by_id() { return containers_by_id_; }
+  const ContainersByIDMap& containers_by_id() const { return containers_by_id_; }
+
+  /**
+   * MutableContainerInfoByID returns a modifiable container info, copying it first if it is
+   * shared with a clone of this state.
+   * @param id The ID of the container.
+   * @return ContainerInfo or nullptr if not found.
+   */
+  ContainerInfo* MutableContainerInfoByID(CIDView id);
+
   std::string DebugString(int indent_level = 0) const;
 
+  /**
+   * The number of updates applied to this state. Lets readers that cache derived values detect
+   * in-place modification of a state they have already seen.
+   */
+  uint64_t update_count() const { return update_count_; }
+
  private:
+  // Returns the modifiable object of the given UID, copying it first if it is shared with a clone.
+  template <typename T>
+  T* MutableK8sObject(UIDView uid);
+
+  uint64_t update_count_ = 0;
+
   // The CIDR block used for services inside the cluster.
   std::optional<CIDRBlock> service_cidr_;
 
@@ -203,7 +231,7 @@ class K8sMetadataState : NotCopyable {
   std::vector<CIDRBlock> pod_cidrs_;
 
   // This stores K8s native objects (services, pods, etc).
-  absl::flat_hash_map<UID, K8sMetadataObjectUPtr> k8s_objects_;
+  K8sObjectsMap k8s_objects_;
 
   /**
    * Mapping of pods by name.
@@ -233,7 +261,7 @@ class K8sMetadataState : NotCopyable {
   /**
    * Mapping of containers by ID.
    */
-  absl::flat_hash_map<CID, ContainerInfoUPtr> containers_by_id_;
+  ContainersByIDMap containers_by_id_;
 };
 
 class AgentMetadataState : NotCopyable {
@@ -268,7 +296,7 @@ class AgentMetadataState : NotCopyable {
 
   std::shared_ptr<AgentMetadataState> CloneToShared() const;
 
-  PIDInfo* GetPIDByUPID(UPID upid) const {
+  const PIDInfo* GetPIDByUPID(UPID upid) const {
     auto it = pids_by_upid_.find(upid);
     if (it != pids_by_upid_.end()) {
       return it->second.get();
@@ -282,22 +310,32 @@ class AgentMetadataState : NotCopyable {
 
     pids_by_upid_[upid] = std::move(pid_info);
     upids_.insert(upid);
+    ++update_count_;
   }
 
   void MarkUPIDAsStopped(UPID upid, int64_t ts) {
-    auto* pid_info = GetPIDByUPID(upid);
+    auto* pid_info = pids_by_upid_.FindMutable(upid);
     if (pid_info != nullptr) {
-      pid_info->set_stop_time_ns(ts);
+      if (!IsUniquelyOwned(*pid_info)) {
+        *pid_info = (*pid_info)->Clone();
+      }
+      (*pid_info)->set_stop_time_ns(ts);
       upids_.erase(upid);
+      ++update_count_;
     } else {
       DCHECK(!upids_.contains(upid));
     }
   }
 
-  const absl::flat_hash_map<UPID, PIDInfoUPtr>& pids_by_upid() const { return pids_by_upid_; }
+  const PIDInfoMap& pids_by_upid() const { return pids_by_upid_; }
 
   const absl::flat_hash_set<md::UPID>& upids() const { return upids_; }
 
+  /**
+   * The number of PID and K8s updates applied to this state, see K8sMetadataState::update_count.
+   */
+  uint64_t update_count() const { return update_count_ + k8s_metadata_state_->update_count(); }
+
   std::string DebugString(int indent_level = 0) const;
 
  private:
@@ -314,6 +352,8 @@ class AgentMetadataState : NotCopyable {
    */
   uint64_t epoch_id_ = 0;
 
+  uint64_t update_count_ = 0;
+
   std::string hostname_;
   std::string pod_name_;
   uint32_t asid_;
@@ -324,7 +364,7 @@ class AgentMetadataState : NotCopyable {
   /**
    * Mapping of PIDs by UPID for active pods on the system.
    */
-  absl::flat_hash_map<UPID, PIDInfoUPtr> pids_by_upid_;
+  PIDInfoMap pids_by_upid_;
 
   /**
    * All active UPIDs. Unlike pids_by_upid_, this does not contain stopped pids.
@@ -0,0 +1,182 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <deque>
+#include <memory>
+#include <random>
+#include <string>
+
+#include <absl/strings/substitute.h>
+
+#include "src/shared/metadata/metadata_state.h"
+
+using ::px::md::AgentMetadataState;
+using ::px::md::K8sMetadataState;
+using ::px::md::PIDInfo;
+using ::px::md::UPID;
+
+namespace {
+
+constexpr int kContainersPerPod = 2;
+constexpr int kPodsPerService = 10;
+constexpr int kNumNamespaces = 20;
+// The number of processes on the local node, which are the only ones with PID info.
+constexpr int kNumLocalPIDs = 500;
+
+K8sMetadataState::ContainerUpdate MakeContainerUpdate(int pod, int container) {
+  K8sMetadataState::ContainerUpdate update;
+  update.set_cid(absl::Substitute("container_$0_$1", pod, container));
+  update.set_name(absl::Substitute("container_$0_$1", pod, container));
+  update.set_start_timestamp_ns(1);
+  update.set_container_state(px::shared::k8s::metadatapb::CONTAINER_STATE_RUNNING);
+  return update;
+}
+
+K8sMetadataState::PodUpdate MakePodUpdate(int pod) {
+  K8sMetadataState::PodUpdate update;
+  update.set_uid(absl::Substitute("pod_uid_$0", pod));
+  update.set_name(absl::Substitute("pod_$0", pod));
+  update.set_namespace_(absl::Substitute("ns_$0", pod % kNumNamespaces));
+  update.set_start_timestamp_ns(1);
+  update.set_phase(px::shared::k8s::metadatapb::RUNNING);
+  update.set_pod_ip(absl::Substitute("10.$0.$1.$2", pod >> 16, (pod >> 8) & 0xff, pod & 0xff));
+  update.set_host_ip("192.168.0.1");
+  for (int c = 0; c < kContainersPerPod; ++c) {
+    update.add_container_ids(absl::Substitute("container_$0_$1", pod, c));
+  }
+  return update;
+}
+
+K8sMetadataState::ServiceUpdate MakeServiceUpdate(int service) {
+  K8sMetadataState::ServiceUpdate update;
+  update.set_uid(absl::Substitute("service_uid_$0", service));
+  update.set_name(absl::Substitute("service_$0", service));
+  update.set_namespace_(absl::Substitute("ns_$0", service % kNumNamespaces));
+  update.set_start_timestamp_ns(1);
+  for (int p = service * kPodsPerService; p < (service + 1) * kPodsPerService; ++p) {
+    update.add_pod_ids(absl::Substitute("pod_uid_$0", p));
+  }
+  return update;
+}
+
+// Builds the metadata state of an agent in a cluster with the given number of pods.
+std::unique_ptr<AgentMetadataState> BuildClusterState(int num_pods) {
+  auto state = std::make_unique<AgentMetadataState>(/* asid */ 1);
+  K8sMetadataState* k8s_state = state->k8s_metadata_state();
+  for (int ns = 0; ns < kNumNamespaces; ++ns) {
+    K8sMetadataState::NamespaceUpdate update;
+    update.set_uid(absl::Substitute("ns_uid_$0", ns));
+    update.set_name(absl::Substitute("ns_$0", ns));
+    PL_CHECK_OK(k8s_state->HandleNamespaceUpdate(update));
+  }
+  for (int p = 0; p < num_pods; ++p) {
+    for (int c = 0; c < kContainersPerPod; ++c) {
+      PL_CHECK_OK(k8s_state->HandleContainerUpdate(MakeContainerUpdate(p, c)));
+    }
+    PL_CHECK_OK(k8s_state->HandlePodUpdate(MakePodUpdate(p)));
+  }
+  for (int s = 0; s < num_pods / kPodsPerService; ++s) {
+    PL_CHECK_OK(k8s_state->HandleServiceUpdate(MakeServiceUpdate(s)));
+  }
+  for (int i = 0; i < kNumLocalPIDs; ++i) {
+    UPID upid(/* asid */ 1, /* pid */ 100 + i, /* ts */ 1000);
+    std::string cid = absl::Substitute("container_$0_0", i % num_pods);
+    state->AddUPID(upid, std::make_unique<PIDInfo>(upid, "cmd", cid));
+  }
+  return state;
+}
+
+}  // namespace
+
+// Measures publishing a new metadata epoch with no changes since the previous epoch.
+// NOLINTNEXTLINE : runtime/references.
+static void BM_clone_to_shared(benchmark::State& state) {
+  auto md = BuildClusterState(state.range(0));
+  std::shared_ptr<AgentMetadataState> current = md->CloneToShared();
+  for (auto _ : state) {
+    current = md->CloneToShared();
+    benchmark::DoNotOptimize(current);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+// Replays a stream of K8s and PID updates, publishing a new epoch after every range(1) updates,
+// the way the metadata state manager does. The previous epoch is kept alive for readers.
+// NOLINTNEXTLINE : runtime/references.
+static void BM_update_epoch(benchmark::State& state) {
+  const int num_pods = state.range(0);
+  const int updates_per_epoch = state.range(1);
+  auto md = BuildClusterState(num_pods);
+  std::shared_ptr<AgentMetadataState> current = md->CloneToShared();
+
+  std::mt19937 rng(37);
+  std::uniform_int_distribution<int> pod_dist(0, num_pods - 1);
+  int64_t ts = 1;
+  uint32_t next_pid = 100 + kNumLocalPIDs;
+  std::deque<UPID> live_upids;
+  for (const auto& upid : md->upids()) {
+    live_upids.push_back(upid);
+  }
+
+  for (auto _ : state) {
+    K8sMetadataState* k8s_state = md->k8s_metadata_state();
+    for (int i = 0; i < updates_per_epoch; ++i) {
+      int pod = pod_dist(rng);
+      switch (i % 4) {
+        case 0: {
+          auto update = MakePodUpdate(pod);
+          update.set_phase(px::shared::k8s::metadatapb::SUCCEEDED);
+          update.set_stop_timestamp_ns(++ts);
+          PL_CHECK_OK(k8s_state->HandlePodUpdate(update));
+          break;
+        }
+        case 1: {
+          auto update = MakeContainerUpdate(pod, 0);
+          update.set_stop_timestamp_ns(++ts);
+          PL_CHECK_OK(k8s_state->HandleContainerUpdate(update));
+          break;
+        }
+        case 2:
+          PL_CHECK_OK(k8s_state->HandleServiceUpdate(MakeServiceUpdate(pod / kPodsPerService)));
+          break;
+        default: {
+          // Process churn: one process exits and another one starts.
+          md->MarkUPIDAsStopped(live_upids.front(), ++ts);
+          live_upids.pop_front();
+          UPID upid(/* asid */ 1, next_pid++, /* ts */ ts);
+          md->AddUPID(upid, std::make_unique<PIDInfo>(upid, "cmd", "container_0_0"));
+          live_upids.push_back(upid);
+          break;
+        }
+      }
+    }
+    current = md->CloneToShared();
+    benchmark::DoNotOptimize(current);
+  }
+  state.SetItemsProcessed(state.iterations() * updates_per_epoch);
+}
+
+BENCHMARK(BM_clone_to_shared)->Arg(1000)->Arg(10000)->Arg(50000);
+BENCHMARK(BM_update_epoch)
+    ->Args({1000, 10})
+    ->Args({10000, 10})
+    ->Args({10000, 100})
+    ->Args({50000, 100})
+    ->Args({50000, 1000});
@@ -229,5 +229,69 @@ TEST(K8sMetadataStateTest, HandleNamespaceUpdate) {
   EXPECT_EQ(8, info->stop_time_ns());
 }
 
+TEST(K8sMetadataStateTest, CloneIsIsolatedFromUpdates) {
+  K8sMetadataState state;
+
+  K8sMetadataState::ContainerUpdate container_update;
+  ASSERT_TRUE(
+      google::protobuf::TextFormat::MergeFromString(kContainer0UpdateTxt, &container_update))
+      << "Failed to parse proto";
+  K8sMetadataState::PodUpdate pod_update;
+  ASSERT_TRUE(google::protobuf::TextFormat::MergeFromString(kPod0UpdateTxt, &pod_update))
+      << "Failed to parse proto";
+  K8sMetadataState::ServiceUpdate service_update;
+  ASSERT_TRUE(
+      google::protobuf::TextFormat::MergeFromString(kRunningServiceUpdatePbTxt, &service_update))
+      << "Failed to parse proto";
+
+  EXPECT_OK(state.HandleContainerUpdate(container_update));
+  EXPECT_OK(state.HandlePodUpdate(pod_update));
+
+  auto clone = state.Clone();
+  // Unmodified objects are shared.
+  EXPECT_EQ(state.PodInfoByID("pod0"), clone->PodInfoByID("pod0"));
+  EXPECT_EQ(state.ContainerInfoByID("container0"), clone->ContainerInfoByID("container0"));
+
+  pod_update.set_stop_timestamp_ns(1000);
+  pod_update.set_name("pod0_renamed");
+  EXPECT_OK(state.HandlePodUpdate(pod_update));
+  EXPECT_OK(state.HandleServiceUpdate(service_update));
+  state.MutableContainerInfoByID("container0")->AddUPID(UPID(1, 2, 3));
+
+  EXPECT_EQ(1000, state.PodInfoByID("pod0")->stop_time_ns());
+  EXPECT_THAT(state.PodInfoByID("pod0")->services(), UnorderedElementsAre("3_uid"));
+  EXPECT_EQ("pod0", state.PodIDByName({"ns0", "pod0_renamed"}));
+  EXPECT_EQ(1, state.ContainerInfoByID("container0")->active_upids().size());
+
+  // The clone keeps the state from before the updates.
+  EXPECT_EQ(103, clone->PodInfoByID("pod0")->stop_time_ns());
+  EXPECT_EQ(0, clone->PodInfoByID("pod0")->services().size());
+  EXPECT_EQ("", clone->PodIDByName({"ns0", "pod0_renamed"}));
+  EXPECT_EQ(nullptr, clone->ServiceInfoByID("3_uid"));
+  EXPECT_EQ(0, clone->ContainerInfoByID("container0")->active_upids().size());
+}
+
+TEST(AgentMetadataStateTest, CloneToSharedIsIsolatedFromUpdates) {
+  AgentMetadataState state(/* asid */ 1);
+  UPID upid0(1, 100, 123);
+  UPID upid1(1, 200, 456);
+  state.AddUPID(upid0, std::make_unique<PIDInfo>(upid0, "cmd0", "container0"));
+
+  auto clone = state.CloneToShared();
+  EXPECT_EQ(state.GetPIDByUPID(upid0), clone->GetPIDByUPID(upid0));
+
+  state.MarkUPIDAsStopped(upid0, 1000);
+  state.AddUPID(upid1, std::make_unique<PIDInfo>(upid1, "cmd1", "container0"));
+
+  EXPECT_EQ(1000, state.GetPIDByUPID(upid0)->stop_time_ns());
+  EXPECT_EQ(2, state.pids_by_upid().size());
+  EXPECT_THAT(state.upids(), UnorderedElementsAre(upid1));
+
+  EXPECT_EQ(0, clone->GetPIDByUPID(upid0)->stop_time_ns());
+  EXPECT_EQ(nullptr, clone->GetPIDByUPID(upid1));
+  EXPECT_EQ(1, clone->pids_by_upid().size());
+  EXPECT_THAT(clone->upids(), UnorderedElementsAre(upid0));
+}
+
 }  // namespace md
 }  // namespace px
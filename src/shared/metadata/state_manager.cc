@@ -165,7 +165,10 @@ Status ProcessPIDUpdates(
     moodycamel::BlockingConcurrentQueue<std::unique_ptr<PIDStatusEvent>>* pid_updates) {
   const auto& k8s_md_state = md->k8s_metadata_state();
 
-  for (const auto& [cid, cinfo] : k8s_md_state->containers_by_id()) {
+  // Iterate over a snapshot of the containers, since modifying a container below may copy the
+  // chunk of the map that holds it. Taking the snapshot only copies chunk pointers.
+  const K8sMetadataState::ContainersByIDMap containers = k8s_md_state->containers_by_id();
+  for (const auto& [cid, cinfo] : containers) {
     if (cinfo->stop_time_ns() != 0) {
       // Ignore dead containers.
       // TODO(zasgar): Come up with a cleaner way of doing this. Probably by using active/inactive
@@ -193,7 +196,7 @@ Status ProcessPIDUpdates(
     if (pod_info->stop_time_ns() != 0) {
       VLOG(1) << absl::Substitute("Found a running container in a deleted pod [cid=$0, pod_id=$1]",
                                   cid, pod_id);
-      cinfo->set_stop_time_ns(pod_info->stop_time_ns());
+      k8s_md_state->MutableContainerInfoByID(cid)->set_stop_time_ns(pod_info->stop_time_ns());
       continue;
     }
 
@@ -211,11 +214,12 @@ Status ProcessPIDUpdates(
       // NOTE: Currently, MDS sends pods that do no belong to this Agent, so this is actually
       // required to avoid repeatedly printing out the warning message above.
       if (error::IsNotFound(s)) {
-        cinfo->set_stop_time_ns(ts);
-        for (const auto& upid : cinfo->active_upids()) {
+        ContainerInfo* mutable_cinfo = k8s_md_state->MutableContainerInfoByID(cid);
+        mutable_cinfo->set_stop_time_ns(ts);
+        for (const auto& upid : mutable_cinfo->active_upids()) {
           md->MarkUPIDAsStopped(upid, ts);
         }
-        cinfo->DeactivateAllUPIDs();
+        mutable_cinfo->DeactivateAllUPIDs();
       }
       continue;
     }
@@ -247,13 +251,18 @@ Status ProcessPIDUpdates(
         pid_updates->enqueue(std::move(pid_status_event));
       }
     }
+    if (upids_to_deactivate.empty() && cgroups_active_upids.empty()) {
+      // Leave the container shared with older states.
+      continue;
+    }
+    ContainerInfo* mutable_cinfo = k8s_md_state->MutableContainerInfoByID(cid);
     for (const auto& upid : upids_to_deactivate) {
-      cinfo->DeactivateUPID(upid);
+      mutable_cinfo->DeactivateUPID(upid);
     }
     // The pids left over in the cgroups upids are new processes.
     for (const auto& upid : cgroups_active_upids) {
       auto pid_info = std::make_unique<PIDInfo>(upid, proc_parser.GetPIDCmdline(upid.pid()), cid);
-      cinfo->AddUPID(upid);
+      mutable_cinfo->AddUPID(upid);
       // Push creation events to the queue.
       auto pid_status_event = std::make_unique<PIDStartedEvent>(*pid_info);
       pid_updates->enqueue(std::move(pid_status_event));
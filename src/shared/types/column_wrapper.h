@@ -58,6 +58,7 @@ class ColumnWrapper {
   virtual const BaseValueType* UnsafeRawData() const = 0;
   virtual DataType data_type() const = 0;
   virtual size_t Size() const = 0;
+  virtual size_t Capacity() const = 0;
   virtual bool Empty() const = 0;
   virtual int64_t Bytes() const = 0;
 
@@ -112,6 +113,7 @@ class ColumnWrapperTmpl : public ColumnWrapper {
   DataType data_type() const override { return ValueTypeTraits<T>::data_type; }
 
   size_t Size() const override { return data_.size(); }
+  size_t Capacity() const override { return data_.capacity(); }
   bool Empty() const override { return data_.empty(); }
 
   std::shared_ptr<arrow::Array> ConvertToArrow(arrow::MemoryPool* mem_pool) override {
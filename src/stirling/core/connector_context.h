@@ -28,6 +28,7 @@
 #include "src/shared/types/types.h"
 #include "src/shared/upid/upid.h"
 #include "src/stirling/utils/proc_tracker.h"
+#include "src/stirling/utils/upid_delta_log.h"
 
 namespace px {
 namespace stirling {
@@ -54,10 +55,16 @@ class ConnectorContext {
    */
   virtual const absl::flat_hash_set<md::UPID>& GetUPIDs() const = 0;
 
+  /**
+   * Return a log of the changes to the set returned by GetUPIDs(), if the context maintains one.
+   * ProcTrackers use it to apply only the changes since their last update.
+   */
+  virtual const UPIDDeltaLog* GetUPIDDeltaLog() const { return nullptr; }
+
   /**
    * Return detailed information on UPIDs.
    */
-  virtual const absl::flat_hash_map<md::UPID, md::PIDInfoUPtr>& GetPIDInfoMap() const = 0;
+  virtual const md::PIDInfoMap& GetPIDInfoMap() const = 0;
 
   /**
    * Return K8s information (Pod and container information)
@@ -83,9 +90,11 @@ class AgentContext : public ConnectorContext {
    * ConnectorContext with metadata state.
    * @param agent_metadata_state A read-only snapshot view of the metadata state. This state
    * should not be held onto for extended periods of time.
+   * @param upid_delta_log An optional log of the changes to the UPIDs of the metadata state.
    */
-  explicit AgentContext(std::shared_ptr<const md::AgentMetadataState> agent_metadata_state)
-      : agent_metadata_state_(std::move(agent_metadata_state)) {
+  explicit AgentContext(std::shared_ptr<const md::AgentMetadataState> agent_metadata_state,
+                        const UPIDDeltaLog* upid_delta_log = nullptr)
+      : agent_metadata_state_(std::move(agent_metadata_state)), upid_delta_log_(upid_delta_log) {
     DCHECK(agent_metadata_state_ != nullptr);
   }
 
@@ -95,7 +104,9 @@ class AgentContext : public ConnectorContext {
     return agent_metadata_state_->upids();
   }
 
-  const absl::flat_hash_map<md::UPID, md::PIDInfoUPtr>& GetPIDInfoMap() const override {
+  const UPIDDeltaLog* GetUPIDDeltaLog() const override { return upid_delta_log_; }
+
+  const md::PIDInfoMap& GetPIDInfoMap() const override {
     return agent_metadata_state_->pids_by_upid();
   }
 
@@ -107,6 +118,7 @@ class AgentContext : public ConnectorContext {
 
  private:
   std::shared_ptr<const md::AgentMetadataState> agent_metadata_state_;
+  const UPIDDeltaLog* upid_delta_log_;
 };
 
 /**
@@ -123,12 +135,27 @@ class StandaloneContext : public ConnectorContext {
     ECHECK_OK(SetClusterCIDR("127.0.0.1/32"));
   }
 
+  /**
+   * StandaloneContext whose UPIDs are maintained by the caller (see HostUPIDTracker),
+   * instead of being listed from the proc filesystem on construction.
+   * @param upid_delta_log The log holding the UPIDs; must outlive the context.
+   */
+  explicit StandaloneContext(const UPIDDeltaLog* upid_delta_log)
+      : upid_delta_log_(upid_delta_log) {
+    DCHECK(upid_delta_log_ != nullptr);
+    ECHECK_OK(SetClusterCIDR("127.0.0.1/32"));
+  }
+
   uint32_t GetASID() const override { return 0; }
 
-  const absl::flat_hash_set<md::UPID>& GetUPIDs() const override { return upids_; }
+  const absl::flat_hash_set<md::UPID>& GetUPIDs() const override {
+    return upid_delta_log_ != nullptr ? upid_delta_log_->upids() : upids_;
+  }
+
+  const UPIDDeltaLog* GetUPIDDeltaLog() const override { return upid_delta_log_; }
 
-  const absl::flat_hash_map<md::UPID, md::PIDInfoUPtr>& GetPIDInfoMap() const override {
-    static const absl::flat_hash_map<md::UPID, md::PIDInfoUPtr> kEmpty;
+  const md::PIDInfoMap& GetPIDInfoMap() const override {
+    static const md::PIDInfoMap kEmpty;
     return kEmpty;
   }
 
@@ -144,6 +171,7 @@ class StandaloneContext : public ConnectorContext {
  private:
   std::vector<CIDRBlock> cidrs_;
   absl::flat_hash_set<md::UPID> upids_;
+  const UPIDDeltaLog* upid_delta_log_ = nullptr;
 };
 
 }  // namespace stirling
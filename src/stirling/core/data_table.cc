@@ -17,6 +17,8 @@
  */
 
 #include <algorithm>
+#include <array>
+#include <numeric>
 #include <string>
 #include <utility>
 #include <vector>
@@ -27,6 +29,10 @@
 #include "src/stirling/core/types.h"
 #include "src/stirling/utils/index_sorted_vector.h"
 
+DEFINE_int32(stirling_data_table_tablet_idle_pushes, 10,
+             "Number of consecutive pushes without records after which a data table's tablet is "
+             "removed, and its buffers recycled.");
+
 namespace px {
 namespace stirling {
 
@@ -35,7 +41,7 @@ using types::DataType;
 
 DataTable::DataTable(const DataTableSchema& schema) : table_schema_(schema) {}
 
-void DataTable::InitBuffers(types::ColumnWrapperRecordBatch* record_batch_ptr) {
+void DataTable::InitBuffers(types::ColumnWrapperRecordBatch* record_batch_ptr, size_t capacity) {
   DCHECK(record_batch_ptr != nullptr);
   DCHECK(record_batch_ptr->empty());
 
@@ -44,86 +50,190 @@ void DataTable::InitBuffers(types::ColumnWrapperRecordBatch* record_batch_ptr) {
 
 #define TYPE_CASE(_dt_)                           \
   auto col = types::ColumnWrapper::Make(_dt_, 0); \
-  col->Reserve(kTargetCapacity);                  \
+  col->Reserve(capacity);                         \
   record_batch_ptr->push_back(col);
     PL_SWITCH_FOREACH_DATATYPE(type, TYPE_CASE);
 #undef TYPE_CASE
   }
 }
 
+void DataTable::AcquireBuffers(Tablet* tablet) {
+  DCHECK(tablet->records.empty());
+  if (buffer_pool_.empty()) {
+    InitBuffers(&tablet->records, tablet->capacity_hint);
+    ++stats_.buffers_allocated;
+    return;
+  }
+  tablet->records = std::move(buffer_pool_.back());
+  buffer_pool_.pop_back();
+  for (auto& col : tablet->records) {
+    // Don't let a tablet that only gets a few records hold on to a large pooled buffer.
+    if (col->Capacity() > 2 * tablet->capacity_hint) {
+      col->ShrinkToFit();
+    }
+    col->Reserve(tablet->capacity_hint);
+  }
+  ++stats_.buffers_reused;
+}
+
+void DataTable::ReleaseBuffers(types::ColumnWrapperRecordBatch* record_batch_ptr) {
+  if (!record_batch_ptr->empty() && buffer_pool_.size() < kMaxPooledBuffers) {
+    for (auto& col : *record_batch_ptr) {
+      col->Clear();
+      // Buffers may have grown past the target capacity; don't keep that memory around.
+      if (col->Capacity() > kTargetCapacity) {
+        col->ShrinkToFit();
+      }
+    }
+    buffer_pool_.push_back(std::move(*record_batch_ptr));
+  }
+  record_batch_ptr->clear();
+}
+
 Tablet* DataTable::GetTablet(types::TabletIDView tablet_id) {
+  const size_t num_tablets = tablets_.size();
   auto& tablet = tablets_[tablet_id];
+  if (tablets_.size() != num_tablets) {
+    tablet.tablet_id = types::TabletID(tablet_id);
+    tablet.capacity_hint = kTargetCapacity;
+    tablet.last_active_push = push_generation_;
+    ++stats_.tablets_created;
+  }
   if (tablet.records.empty()) {
-    InitBuffers(&tablet.records);
+    AcquireBuffers(&tablet);
   }
   return &tablet;
 }
 
+namespace {
+
+// Returns the sequence {begin, begin + 1, ..., end - 1}.
+std::vector<size_t> IndexRange(size_t begin, size_t end) {
+  std::vector<size_t> indexes(end - begin);
+  std::iota(indexes.begin(), indexes.end(), begin);
+  return indexes;
+}
+
+}  // namespace
+
 std::vector<TaggedRecordBatch> DataTable::ConsumeRecords() {
   std::vector<TaggedRecordBatch> tablets_out;
-  absl::flat_hash_map<types::TabletID, Tablet> carryover_tablets;
   uint64_t next_start_time = start_time_;
-
-  for (auto& [tablet_id, tablet] : tablets_) {
-    // Sort based on times.
-    std::vector<size_t> sort_indexes = utils::SortedIndexes(tablet.times);
-
-    // End time is cutoff time + 1, so call to SplitSortedVector() produces the following
-    // classification: which classified according to:
-    //   expired < start_time
-    //   pushable <= end_time
-    uint64_t end_time = cutoff_time_.has_value() ? (cutoff_time_.value() + 1)
-                                                 : std::numeric_limits<uint64_t>::max();
-
-    // Split the indexes into three groups:
-    // 1) Expired indexes: these are too old to return.
-    // 2) Pushable indexes: these are the ones that we return.
-    // 3) Carryover indexes: these are too new to return, so hold on to them until the next round.
-    auto positions =
-        utils::SplitSortedVector<2>(tablet.times, sort_indexes, {start_time_, end_time});
+  ++push_generation_;
+
+  // End time is cutoff time + 1, so the split below produces the following
+  // classification:
+  //   expired < start_time
+  //   pushable <= end_time
+  const uint64_t end_time = cutoff_time_.has_value() ? (cutoff_time_.value() + 1)
+                                                     : std::numeric_limits<uint64_t>::max();
+
+  for (auto iter = tablets_.begin(); iter != tablets_.end();) {
+    auto& [tablet_id, tablet] = *iter;
+
+    if (tablet.times.empty()) {
+      if (push_generation_ - tablet.last_active_push >
+          static_cast<uint64_t>(FLAGS_stirling_data_table_tablet_idle_pushes)) {
+        ReleaseBuffers(&tablet.records);
+        ++stats_.tablets_expired;
+        tablets_.erase(iter++);
+      } else {
+        ++iter;
+      }
+      continue;
+    }
+    tablet.last_active_push = push_generation_;
+    tablet.capacity_hint = std::min(tablet.times.size(), kTargetCapacity);
+
+    // Records are usually appended in time order, in which case no sorting is required,
+    // and each of the groups below is a contiguous range of records.
+    const bool sorted = std::is_sorted(tablet.times.begin(), tablet.times.end());
+
+    // Sort based on times. Left empty when already sorted.
+    std::vector<size_t> sort_indexes;
+
+    // Split the records into three groups:
+    // 1) Expired records: these are too old to return.
+    // 2) Pushable records: these are the ones that we return.
+    // 3) Carryover records: these are too new to return, so hold on to them until the next round.
+    std::array<size_t, 2> positions;
+    if (sorted) {
+      auto expired_end =
+          std::lower_bound(tablet.times.begin(), tablet.times.end(), start_time_);
+      auto pushable_end = std::lower_bound(expired_end, tablet.times.end(), end_time);
+      positions = {static_cast<size_t>(expired_end - tablet.times.begin()),
+                   static_cast<size_t>(pushable_end - tablet.times.begin())};
+    } else {
+      sort_indexes = utils::SortedIndexes(tablet.times);
+      positions = utils::SplitSortedVector<2>(tablet.times, sort_indexes, {start_time_, end_time});
+    }
     int num_expired = positions[0];
     int num_pushable = positions[1] - positions[0];
     int num_carryover = tablet.times.size() - positions[1];
 
+    // Returns the indexes of the records in the sorted range [begin, end).
+    auto indexes_in_range = [&](size_t begin, size_t end) {
+      if (sorted) {
+        return IndexRange(begin, end);
+      }
+      return std::vector<size_t>(sort_indexes.begin() + begin, sort_indexes.begin() + end);
+    };
+    auto sorted_time = [&](size_t i) { return tablet.times[sorted ? i : sort_indexes[i]]; };
+
     // Case 1: Expired records. Just print a message.
     LOG_IF(WARNING, num_expired != 0) << absl::Substitute(
         "$0 records for table $1 dropped due to late arrival [cutoff time=$2, oldest event "
         "time=$3].",
-        num_expired, table_schema_.name(), end_time, tablet.times[sort_indexes[0]]);
+        num_expired, table_schema_.name(), end_time, sorted_time(0));
 
-    // Case 2: Pushable records. Copy to output.
+    // Case 2: Pushable records.
     if (num_pushable > 0) {
-      // TODO(oazizi): Consider VectorView to avoid copying.
-      std::vector<size_t> push_indexes(sort_indexes.begin() + num_expired,
-                                       sort_indexes.end() - num_carryover);
+      next_start_time = std::max(next_start_time, sorted_time(positions[1] - 1));
+
       types::ColumnWrapperRecordBatch pushable_records;
-      for (auto& col : tablet.records) {
-        pushable_records.push_back(col->MoveIndexes(push_indexes));
+      // The table store does not account for the unused capacity of the buffers, so only the
+      // buffers that are mostly full are handed off.
+      bool mostly_full = std::all_of(
+          tablet.records.begin(), tablet.records.end(),
+          [](const auto& col) { return 4 * col->Size() >= 3 * col->Capacity(); });
+      if (sorted && num_expired == 0 && num_carryover == 0 && mostly_full) {
+        // Fast path: all records are pushed in their current order, so hand off the buffers
+        // instead of copying them out. The tablet gets new buffers on its next append.
+        pushable_records = std::move(tablet.records);
+        tablet.records.clear();
+      } else {
+        // The records are copied into right-sized buffers, and the tablet's buffers are recycled.
+        std::vector<size_t> push_indexes = indexes_in_range(positions[0], positions[1]);
+        for (auto& col : tablet.records) {
+          pushable_records.push_back(col->MoveIndexes(push_indexes));
+        }
       }
-      uint64_t last_time = tablet.times[push_indexes.back()];
-      next_start_time = std::max(next_start_time, last_time);
       tablets_out.push_back(TaggedRecordBatch{tablet_id, std::move(pushable_records)});
     }
 
     // Case 3: Carryover records.
+    types::ColumnWrapperRecordBatch carryover_records;
+    std::vector<uint64_t> carryover_times;
     if (num_carryover > 0) {
-      // TODO(oazizi): Consider VectorView to avoid copying.
-      std::vector<size_t> carryover_indexes(sort_indexes.begin() + num_pushable,
-                                            sort_indexes.end());
-      types::ColumnWrapperRecordBatch carryover_records;
+      std::vector<size_t> carryover_indexes = indexes_in_range(positions[1], tablet.times.size());
       for (auto& col : tablet.records) {
         carryover_records.push_back(col->MoveIndexes(carryover_indexes));
+        carryover_records.back()->Reserve(tablet.capacity_hint);
       }
 
-      std::vector<uint64_t> times(carryover_indexes.size());
-      for (size_t i = 0; i < times.size(); ++i) {
-        times[i] = tablet.times[carryover_indexes[i]];
+      carryover_times.resize(carryover_indexes.size());
+      for (size_t i = 0; i < carryover_times.size(); ++i) {
+        carryover_times[i] = tablet.times[carryover_indexes[i]];
       }
-      carryover_tablets[tablet_id] =
-          Tablet{tablet_id, std::move(times), std::move(carryover_records)};
     }
+
+    // Whatever is left of the buffers only holds moved-from records, so they can be recycled.
+    ReleaseBuffers(&tablet.records);
+    tablet.records = std::move(carryover_records);
+    tablet.times = std::move(carryover_times);
+
+    ++iter;
   }
-  tablets_ = std::move(carryover_tablets);
 
   start_time_ = next_start_time;
 
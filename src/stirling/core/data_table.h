@@ -30,6 +30,8 @@
 #include "src/common/base/mixins.h"
 #include "src/stirling/core/types.h"
 
+DECLARE_int32(stirling_data_table_tablet_idle_pushes);
+
 namespace px {
 namespace stirling {
 
@@ -46,6 +48,12 @@ struct Tablet {
   // TODO(oazizi): Convert this vector into a heap of {time, index} objects.
   std::vector<uint64_t> times;
   types::ColumnWrapperRecordBatch records;
+
+  // Number of records to reserve in new buffers, based on the size of the last push.
+  size_t capacity_hint = 0;
+
+  // The last push (see DataTable::push_generation_) that had records in this tablet.
+  uint64_t last_active_push = 0;
 };
 
 class DataTable : public NotCopyable {
@@ -69,6 +77,25 @@ class DataTable : public NotCopyable {
    */
   std::vector<TaggedRecordBatch> ConsumeRecords();
 
+  /**
+   * Counters of the buffer management of the tablets, for observability.
+   */
+  struct Stats {
+    // Record batches allocated for tablets, and those reused from the pool instead.
+    uint64_t buffers_allocated = 0;
+    uint64_t buffers_reused = 0;
+    // Tablets created, and those expired after being idle.
+    uint64_t tablets_created = 0;
+    uint64_t tablets_expired = 0;
+  };
+
+  const Stats& stats() const { return stats_; }
+
+  /**
+   * Number of tablets held by the table, including idle ones that have not yet expired.
+   */
+  size_t num_tablets() const { return tablets_.size(); }
+
   /**
    * Sets a cutoff time for the table. Any records that appear after this time
    * will not be pushed out on a call to ConsumeRecords(). Instead, they will
@@ -92,7 +119,7 @@ class DataTable : public NotCopyable {
     size_t occupancy = 0;
     for (auto& [tablet_id, tablet] : tablets_) {
       PL_UNUSED(tablet_id);
-      occupancy += tablet.records[0]->Size();
+      occupancy += tablet.times.size();
     }
     return occupancy;
   }
@@ -261,8 +288,20 @@ class DataTable : public NotCopyable {
   // ColumnWrapper specific members
   static constexpr size_t kTargetCapacity = 1024;
 
+  // Maximum number of record batches kept for reuse.
+  static constexpr size_t kMaxPooledBuffers = 16;
+
   // Initialize a new Active record batch.
-  void InitBuffers(types::ColumnWrapperRecordBatch* record_batch_ptr);
+  void InitBuffers(types::ColumnWrapperRecordBatch* record_batch_ptr,
+                   size_t capacity = kTargetCapacity);
+
+  // Gives the tablet empty buffers, reusing pooled ones if available. Pooled buffers with more
+  // than twice the tablet's capacity hint are released before being reused.
+  void AcquireBuffers(Tablet* tablet);
+
+  // Clears the record batch, and keeps its buffers for reuse if the pool is not full.
+  // At most kTargetCapacity records of capacity are retained per column.
+  void ReleaseBuffers(types::ColumnWrapperRecordBatch* record_batch_ptr);
 
   // Get a pointer to the Tablet, for appending. Used by RecordBuilder.
   Tablet* GetTablet(types::TabletIDView tablet_id);
@@ -271,8 +310,18 @@ class DataTable : public NotCopyable {
   const DataTableSchema& table_schema_;
 
   // Key is tablet id, value is tablet records.
+  // Tablets persist across pushes, and are only removed after being idle for
+  // --stirling_data_table_tablet_idle_pushes pushes.
   absl::flat_hash_map<types::TabletID, Tablet> tablets_;
 
+  // Empty record batches of expired tablets and of carried over records, for reuse.
+  std::vector<types::ColumnWrapperRecordBatch> buffer_pool_;
+
+  // Incremented on every call to ConsumeRecords().
+  uint64_t push_generation_ = 0;
+
+  Stats stats_;
+
   uint64_t start_time_ = 0;
 
   // The cutoff time is an optional field that sets up to which time
@@ -0,0 +1,114 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "src/common/base/base.h"
+#include "src/stirling/core/data_table.h"
+
+using px::stirling::DataElement;
+using px::stirling::DataTable;
+using px::stirling::DataTableSchema;
+using px::stirling::TaggedRecordBatch;
+namespace types = px::types;
+
+constexpr DataElement kElements[] = {
+    {"time_", "time", types::DataType::TIME64NS, types::SemanticType::ST_NONE,
+     types::PatternType::METRIC_COUNTER},
+    {"x", "an int value", types::DataType::INT64, types::SemanticType::ST_NONE,
+     types::PatternType::GENERAL},
+    {"y", "a float value", types::DataType::FLOAT64, types::SemanticType::ST_NONE,
+     types::PatternType::GENERAL},
+    {"s", "a string", types::DataType::STRING, types::SemanticType::ST_NONE,
+     types::PatternType::GENERAL},
+};
+constexpr auto kSchema = DataTableSchema("bench_table", "A table for benchmarking", kElements);
+
+// Returns num_records times, made of num_runs interleaved sorted runs.
+// A single run is the common case of records appended in time order.
+std::vector<uint64_t> MakeTimes(int num_records, int num_runs) {
+  std::vector<uint64_t> times;
+  const int run_length = (num_records + num_runs - 1) / num_runs;
+  for (int i = 0; i < num_records; ++i) {
+    times.push_back(1 + (i % run_length) * num_runs + i / run_length);
+  }
+  return times;
+}
+
+void FillAndConsume(const std::vector<uint64_t>& times, DataTable* data_table) {
+  for (uint64_t t : times) {
+    DataTable::RecordBuilder<&kSchema> r(data_table, t);
+    r.Append<r.ColIndex("time_")>(t);
+    r.Append<r.ColIndex("x")>(t * 2);
+    r.Append<r.ColIndex("y")>(t * 0.5);
+    r.Append<r.ColIndex("s")>("a short string value");
+  }
+  std::vector<TaggedRecordBatch> record_batches = data_table->ConsumeRecords();
+  benchmark::DoNotOptimize(record_batches);
+}
+
+// Args: {num_records, num_sorted_runs}.
+// NOLINTNEXTLINE : runtime/references.
+static void BM_consume_records(benchmark::State& state) {
+  std::vector<uint64_t> times = MakeTimes(state.range(0), state.range(1));
+
+  for (auto _ : state) {
+    DataTable data_table(kSchema);
+    FillAndConsume(times, &data_table);
+  }
+  state.SetItemsProcessed(state.iterations() * times.size());
+}
+
+// NOLINTNEXTLINE : runtime/references.
+static void BM_consume_records_shuffled(benchmark::State& state) {
+  std::vector<uint64_t> times = MakeTimes(state.range(0), 1);
+  std::shuffle(times.begin(), times.end(), std::default_random_engine(37));
+
+  for (auto _ : state) {
+    DataTable data_table(kSchema);
+    FillAndConsume(times, &data_table);
+  }
+  state.SetItemsProcessed(state.iterations() * times.size());
+}
+
+// With a cutoff time, half the records are carried over to the next push.
+// NOLINTNEXTLINE : runtime/references.
+static void BM_consume_records_carryover(benchmark::State& state) {
+  std::vector<uint64_t> times = MakeTimes(state.range(0), 1);
+
+  for (auto _ : state) {
+    DataTable data_table(kSchema);
+    data_table.SetConsumeRecordsCutoffTime(times.size() / 2);
+    FillAndConsume(times, &data_table);
+  }
+  state.SetItemsProcessed(state.iterations() * times.size());
+}
+
+BENCHMARK(BM_consume_records)
+    ->Args({1024, 1})
+    ->Args({16384, 1})
+    ->Args({1024, 4})
+    ->Args({16384, 4})
+    ->Args({16384, 32});
+BENCHMARK(BM_consume_records_shuffled)->Arg(1024)->Arg(16384);
+BENCHMARK(BM_consume_records_carryover)->Arg(1024)->Arg(16384);
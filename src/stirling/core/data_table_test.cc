@@ -314,6 +314,161 @@ TEST_F(DataTableTest, Carryover) {
   }
 }
 
+// Records that are appended in time order are pushed without reordering, but expired and
+// carryover records must still be split out.
+TEST_F(DataTableTest, SortedExpiryAndCarryover) {
+  auto append = [this](int time, int x, std::string s) {
+    DataTable::RecordBuilder<&kSchema> r(data_table_.get(), time);
+    r.Append<r.ColIndex("time_")>(time);
+    r.Append<r.ColIndex("x")>(x);
+    r.Append<r.ColIndex("s")>(std::move(s));
+  };
+
+  {
+    append(10, 1, "a");
+    append(20, 2, "b");
+
+    std::vector<TaggedRecordBatch> tablets = data_table_->ConsumeRecords();
+
+    ASSERT_EQ(tablets.size(), 1);
+    types::ColumnWrapperRecordBatch& rb = tablets[0].records;
+    ASSERT_EQ(rb[0]->Size(), 2);
+    EXPECT_EQ(rb[1]->Get<types::Int64Value>(0), 1);
+    EXPECT_EQ(rb[1]->Get<types::Int64Value>(1), 2);
+  }
+
+  // Time 5 is expired, and times 40 and 50 are carried over.
+  {
+    append(5, 0, "z");
+    append(30, 3, "c");
+    append(40, 4, "d");
+    append(50, 5, "e");
+
+    data_table_->SetConsumeRecordsCutoffTime(35);
+    std::vector<TaggedRecordBatch> tablets = data_table_->ConsumeRecords();
+
+    ASSERT_EQ(tablets.size(), 1);
+    types::ColumnWrapperRecordBatch& rb = tablets[0].records;
+    ASSERT_EQ(rb[0]->Size(), 1);
+    EXPECT_EQ(rb[0]->Get<types::Time64NSValue>(0), 30);
+    EXPECT_EQ(rb[1]->Get<types::Int64Value>(0), 3);
+    EXPECT_EQ(rb[2]->Get<types::StringValue>(0), "c");
+    EXPECT_EQ(data_table_->Occupancy(), 2);
+  }
+
+  {
+    append(60, 6, "f");
+
+    data_table_->SetConsumeRecordsCutoffTime(100);
+    std::vector<TaggedRecordBatch> tablets = data_table_->ConsumeRecords();
+
+    ASSERT_EQ(tablets.size(), 1);
+    types::ColumnWrapperRecordBatch& rb = tablets[0].records;
+    ASSERT_EQ(rb[0]->Size(), 3);
+    EXPECT_EQ(rb[2]->Get<types::StringValue>(0), "d");
+    EXPECT_EQ(rb[2]->Get<types::StringValue>(1), "e");
+    EXPECT_EQ(rb[2]->Get<types::StringValue>(2), "f");
+    EXPECT_EQ(data_table_->Occupancy(), 0);
+  }
+}
+
+class TabletizedDataTableTest : public ::testing::Test {
+ protected:
+  static constexpr DataElement kElements[] = {
+      {"time_", "time", types::DataType::TIME64NS, types::SemanticType::ST_NONE,
+       types::PatternType::METRIC_COUNTER},
+      {"pid", "a tablet key", types::DataType::INT64, types::SemanticType::ST_NONE,
+       types::PatternType::GENERAL},
+  };
+  static constexpr auto kSchema =
+      DataTableSchema("tabletized_table", "This is the table description", kElements, "pid");
+
+  void Append(int pid, uint64_t time) {
+    DataTable::RecordBuilder<&kSchema> r(&data_table_, std::to_string(pid), time);
+    r.Append<r.ColIndex("time_")>(time);
+    r.Append<r.ColIndex("pid")>(pid);
+  }
+
+  DataTable data_table_{kSchema};
+};
+
+TEST_F(TabletizedDataTableTest, TabletsReuseBuffersAndExpireWhenIdle) {
+  FLAGS_stirling_data_table_tablet_idle_pushes = 1;
+
+  // Tablet 2 is carried over, which frees its original buffers for reuse.
+  Append(1, 1);
+  Append(2, 2);
+  data_table_.SetConsumeRecordsCutoffTime(1);
+  std::vector<TaggedRecordBatch> record_batches = data_table_.ConsumeRecords();
+  ASSERT_EQ(record_batches.size(), 1);
+  EXPECT_EQ(record_batches[0].tablet_id, "1");
+  EXPECT_EQ(data_table_.num_tablets(), 2);
+  EXPECT_EQ(data_table_.Occupancy(), 1);
+  EXPECT_EQ(data_table_.stats().tablets_created, 2);
+  EXPECT_EQ(data_table_.stats().buffers_allocated, 2);
+
+  // Tablet 1 was pushed, but is kept, and gets the recycled buffers.
+  Append(1, 3);
+  EXPECT_EQ(data_table_.stats().tablets_created, 2);
+  EXPECT_EQ(data_table_.stats().buffers_allocated, 2);
+  EXPECT_EQ(data_table_.stats().buffers_reused, 1);
+
+  data_table_.SetConsumeRecordsCutoffTime(100);
+  record_batches = data_table_.ConsumeRecords();
+  ASSERT_EQ(record_batches.size(), 2);
+  for (const auto& record_batch : record_batches) {
+    ASSERT_EQ(record_batch.records[0]->Size(), 1);
+    EXPECT_EQ(std::to_string(record_batch.records[1]->Get<types::Int64Value>(0).val),
+              record_batch.tablet_id);
+  }
+
+  // Tablets expire once they have been idle for more than one push.
+  EXPECT_EQ(data_table_.ConsumeRecords().size(), 0);
+  EXPECT_EQ(data_table_.num_tablets(), 2);
+  EXPECT_EQ(data_table_.ConsumeRecords().size(), 0);
+  EXPECT_EQ(data_table_.num_tablets(), 0);
+  EXPECT_EQ(data_table_.stats().tablets_expired, 2);
+
+  FLAGS_stirling_data_table_tablet_idle_pushes = 10;
+}
+
+TEST_F(TabletizedDataTableTest, PartlyFilledBuffersAreCopiedOnPush) {
+  // The tablet's buffers have room for kTargetCapacity records, so the records are copied into
+  // right-sized buffers instead, and the tablet's buffers are recycled.
+  Append(1, 1);
+  Append(1, 2);
+  data_table_.SetConsumeRecordsCutoffTime(100);
+  std::vector<TaggedRecordBatch> record_batches = data_table_.ConsumeRecords();
+  ASSERT_EQ(record_batches.size(), 1);
+  for (const auto& col : record_batches[0].records) {
+    EXPECT_EQ(col->Size(), 2);
+    EXPECT_EQ(col->Capacity(), 2);
+  }
+
+  Append(1, 3);
+  EXPECT_EQ(data_table_.stats().buffers_allocated, 1);
+  EXPECT_EQ(data_table_.stats().buffers_reused, 1);
+}
+
+TEST_F(TabletizedDataTableTest, MostlyFullBuffersAreHandedOffOnPush) {
+  constexpr int kNumRecords = 800;
+  for (int i = 0; i < kNumRecords; ++i) {
+    Append(1, i);
+  }
+  data_table_.SetConsumeRecordsCutoffTime(kNumRecords);
+  std::vector<TaggedRecordBatch> record_batches = data_table_.ConsumeRecords();
+  ASSERT_EQ(record_batches.size(), 1);
+  for (const auto& col : record_batches[0].records) {
+    EXPECT_EQ(col->Size(), kNumRecords);
+    EXPECT_LE(col->Capacity(), 4 * kNumRecords / 3);
+  }
+
+  // The buffers went with the pushed records, so the tablet needs new ones.
+  Append(1, kNumRecords);
+  EXPECT_EQ(data_table_.stats().buffers_allocated, 2);
+  EXPECT_EQ(data_table_.stats().buffers_reused, 0);
+}
+
 class DataTableStressTest : public ::testing::Test {
  private:
   std::default_random_engine rng_;
@@ -0,0 +1,131 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/stirling/core/host_upid_tracker.h"
+
+#include <utility>
+
+#include "src/common/system/proc_parser.h"
+#include "src/stirling/core/connector_context.h"
+
+DEFINE_bool(stirling_proc_events, true,
+            "If true, track processes through kernel process events when running without the "
+            "agent's metadata, instead of rescanning /proc on every iteration.");
+DEFINE_int32(stirling_proc_rescan_period_secs, 30,
+             "When processes are tracked through process events, the period of the full /proc "
+             "rescans that correct any drift.");
+
+namespace px {
+namespace stirling {
+
+HostUPIDTracker::HostUPIDTracker(std::filesystem::path proc_path, uint32_t asid)
+    : proc_path_(std::move(proc_path)), asid_(asid) {}
+
+void HostUPIDTracker::Update() {
+  if (!initialized_) {
+    initialized_ = true;
+    if (FLAGS_stirling_proc_events) {
+      StatusOr<std::unique_ptr<system::ProcEventListener>> listener_or =
+          system::ProcEventListener::Create();
+      if (listener_or.ok()) {
+        proc_event_listener_ = listener_or.ConsumeValueOrDie();
+      } else {
+        LOG(WARNING) << absl::Substitute(
+            "Process events are unavailable, falling back to rescanning /proc. Message: $0",
+            listener_or.msg());
+      }
+    }
+  }
+
+  if (proc_event_listener_ == nullptr || std::chrono::steady_clock::now() >= next_rescan_time_) {
+    Rescan();
+    return;
+  }
+  ApplyEvents();
+}
+
+void HostUPIDTracker::Rescan() {
+  // Drop the pending events first, since the scan supersedes them.
+  // Events that arrive during the scan are applied by the next update; they are idempotent.
+  if (proc_event_listener_ != nullptr) {
+    started_pids_.clear();
+    exited_pids_.clear();
+    Status s = proc_event_listener_->ReadEvents(&started_pids_, &exited_pids_);
+    VLOG_IF(1, !s.ok()) << s.msg();
+  }
+
+  absl::flat_hash_set<md::UPID> upids = ListUPIDs(proc_path_, asid_);
+  upids_by_pid_.clear();
+  for (const auto& upid : upids) {
+    upids_by_pid_.emplace(upid.pid(), upid);
+  }
+  upid_delta_log_.Reset(std::move(upids));
+
+  next_rescan_time_ = std::chrono::steady_clock::now() +
+                      std::chrono::seconds(FLAGS_stirling_proc_rescan_period_secs);
+}
+
+void HostUPIDTracker::ApplyEvents() {
+  started_pids_.clear();
+  exited_pids_.clear();
+  Status s = proc_event_listener_->ReadEvents(&started_pids_, &exited_pids_);
+  if (!s.ok()) {
+    VLOG(1) << absl::Substitute("Rescanning /proc after failing to read process events: $0",
+                                s.msg());
+    Rescan();
+    return;
+  }
+  ApplyPIDChanges();
+}
+
+void HostUPIDTracker::ApplyPIDChanges() {
+  added_upids_.clear();
+  removed_upids_.clear();
+
+  // The order of events between the two lists is lost, so exits are applied first:
+  // a PID that exits and is then reused is correctly replaced, while a process that starts and
+  // exits in between two updates is skipped below, because its start time can't be read.
+  for (int32_t pid : exited_pids_) {
+    auto iter = upids_by_pid_.find(pid);
+    if (iter != upids_by_pid_.end()) {
+      removed_upids_.push_back(iter->second);
+      upids_by_pid_.erase(iter);
+    }
+  }
+
+  for (int32_t pid : started_pids_) {
+    StatusOr<int64_t> start_time =
+        system::GetPIDStartTimeTicks(proc_path_ / std::to_string(pid));
+    if (!start_time.ok()) {
+      continue;
+    }
+    md::UPID upid(asid_, pid, start_time.ValueOrDie());
+    auto [iter, inserted] = upids_by_pid_.try_emplace(pid, upid);
+    if (!inserted && iter->second != upid) {
+      // The exit of the previous process with this PID was missed.
+      removed_upids_.push_back(iter->second);
+      iter->second = upid;
+    }
+    added_upids_.push_back(upid);
+  }
+
+  upid_delta_log_.Apply(added_upids_, removed_upids_);
+}
+
+}  // namespace stirling
+}  // namespace px
@@ -0,0 +1,92 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <chrono>
+#include <filesystem>
+#include <memory>
+#include <vector>
+
+#include <absl/container/flat_hash_map.h>
+
+#include "src/common/base/base.h"
+#include "src/common/system/proc_event_listener.h"
+#include "src/shared/upid/upid.h"
+#include "src/stirling/utils/upid_delta_log.h"
+
+DECLARE_bool(stirling_proc_events);
+DECLARE_int32(stirling_proc_rescan_period_secs);
+
+namespace px {
+namespace stirling {
+
+/**
+ * HostUPIDTracker tracks the processes of the host, for when Stirling runs without the agent's
+ * metadata.
+ *
+ * Processes are tracked incrementally from the kernel's process events (see
+ * system::ProcEventListener), so the cost of an update is proportional to the number of
+ * process starts and exits rather than to the number of processes. The proc filesystem is still
+ * fully rescanned periodically, and whenever events are lost, to correct any drift. If process
+ * events are not available (e.g. missing CAP_NET_ADMIN), every update is a full rescan.
+ *
+ * Changes are recorded into a UPIDDeltaLog, which ProcTrackers can consume incrementally.
+ */
+class HostUPIDTracker : NotCopyMoveable {
+ public:
+  explicit HostUPIDTracker(std::filesystem::path proc_path, uint32_t asid = 0);
+
+  /**
+   * Brings the set of UPIDs up to date.
+   */
+  void Update();
+
+  const UPIDDeltaLog& upid_delta_log() const { return upid_delta_log_; }
+
+ private:
+  void Rescan();
+  void ApplyEvents();
+  // Applies the PIDs in started_pids_ and exited_pids_.
+  void ApplyPIDChanges();
+
+  const std::filesystem::path proc_path_;
+  const uint32_t asid_;
+
+  // Null if process events are unavailable.
+  std::unique_ptr<system::ProcEventListener> proc_event_listener_;
+  bool initialized_ = false;
+
+  std::chrono::steady_clock::time_point next_rescan_time_;
+
+  // Needed to find the UPIDs of exited processes, as the process events only carry PIDs.
+  absl::flat_hash_map<int32_t, md::UPID> upids_by_pid_;
+
+  UPIDDeltaLog upid_delta_log_;
+
+  // Reused across updates, to avoid re-allocations.
+  std::vector<int32_t> started_pids_;
+  std::vector<int32_t> exited_pids_;
+  std::vector<md::UPID> added_upids_;
+  std::vector<md::UPID> removed_upids_;
+
+  friend class HostUPIDTrackerTest;
+};
+
+}  // namespace stirling
+}  // namespace px
@@ -0,0 +1,145 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <absl/strings/str_join.h>
+
+#include "src/stirling/core/host_upid_tracker.h"
+
+#include "src/common/testing/temp_dir.h"
+#include "src/common/testing/testing.h"
+
+using ::testing::ElementsAre;
+using ::testing::Pair;
+using ::testing::UnorderedElementsAre;
+
+namespace px {
+namespace stirling {
+
+class HostUPIDTrackerTest : public ::testing::Test {
+ protected:
+  HostUPIDTrackerTest() : tracker_(tmp_dir_.path()) {}
+
+  void SetUp() override {
+    // Without process events, Update() is a full rescan.
+    FLAGS_stirling_proc_events = false;
+  }
+
+  void TearDown() override { FLAGS_stirling_proc_events = true; }
+
+  // Writes <proc>/<pid>/stat, with only the fields that matter here.
+  void StartProcess(int32_t pid, int64_t start_time) {
+    std::vector<std::string> fields(52, "0");
+    fields[0] = std::to_string(pid);
+    fields[1] = "(app)";
+    fields[2] = "S";
+    fields[21] = std::to_string(start_time);
+
+    const std::filesystem::path pid_path = tmp_dir_.path() / std::to_string(pid);
+    std::filesystem::create_directories(pid_path);
+    std::ofstream(pid_path / "stat") << absl::StrJoin(fields, " ") << "\n";
+  }
+
+  void StopProcess(int32_t pid) {
+    std::filesystem::remove_all(tmp_dir_.path() / std::to_string(pid));
+  }
+
+  // Applies one batch of process events.
+  void ApplyEvents(std::vector<int32_t> started_pids, std::vector<int32_t> exited_pids) {
+    tracker_.started_pids_ = std::move(started_pids);
+    tracker_.exited_pids_ = std::move(exited_pids);
+    tracker_.ApplyPIDChanges();
+  }
+
+  std::vector<std::pair<md::UPID, bool>> DeltasSince(uint64_t seq) {
+    std::vector<std::pair<md::UPID, bool>> deltas;
+    tracker_.upid_delta_log().ForEachDeltaSince(
+        seq, [&deltas](const md::UPID& upid, bool added) { deltas.emplace_back(upid, added); });
+    return deltas;
+  }
+
+  px::testing::TempDir tmp_dir_;
+  HostUPIDTracker tracker_;
+};
+
+TEST_F(HostUPIDTrackerTest, StartAndExit) {
+  StartProcess(100, 1000);
+  tracker_.Update();
+  EXPECT_THAT(tracker_.upid_delta_log().upids(), UnorderedElementsAre(md::UPID(0, 100, 1000)));
+
+  const uint64_t seq = tracker_.upid_delta_log().seq();
+  StartProcess(200, 2000);
+  StopProcess(100);
+  ApplyEvents(/* started_pids */ {200}, /* exited_pids */ {100});
+
+  EXPECT_THAT(tracker_.upid_delta_log().upids(), UnorderedElementsAre(md::UPID(0, 200, 2000)));
+  EXPECT_THAT(DeltasSince(seq), ElementsAre(Pair(md::UPID(0, 100, 1000), false),
+                                            Pair(md::UPID(0, 200, 2000), true)));
+}
+
+// A process that starts and exits in between two updates is not tracked, regardless of the
+// order of its events in the batch.
+TEST_F(HostUPIDTrackerTest, ExitBeforeStartInOneBatch) {
+  tracker_.Update();
+  const uint64_t seq = tracker_.upid_delta_log().seq();
+
+  ApplyEvents(/* started_pids */ {100}, /* exited_pids */ {100});
+
+  EXPECT_THAT(tracker_.upid_delta_log().upids(), ::testing::IsEmpty());
+  EXPECT_THAT(DeltasSince(seq), ::testing::IsEmpty());
+}
+
+// A PID that exits and is reused in the same batch is replaced by the new process.
+TEST_F(HostUPIDTrackerTest, PIDReusedInOneBatch) {
+  StartProcess(100, 1000);
+  tracker_.Update();
+  const uint64_t seq = tracker_.upid_delta_log().seq();
+
+  StopProcess(100);
+  StartProcess(100, 2000);
+  ApplyEvents(/* started_pids */ {100}, /* exited_pids */ {100});
+
+  EXPECT_THAT(tracker_.upid_delta_log().upids(), UnorderedElementsAre(md::UPID(0, 100, 2000)));
+  EXPECT_THAT(DeltasSince(seq), ElementsAre(Pair(md::UPID(0, 100, 1000), false),
+                                            Pair(md::UPID(0, 100, 2000), true)));
+}
+
+// The exit of the previous process with the PID was missed.
+TEST_F(HostUPIDTrackerTest, PIDReusedWithMissedExit) {
+  StartProcess(100, 1000);
+  tracker_.Update();
+  const uint64_t seq = tracker_.upid_delta_log().seq();
+
+  StartProcess(100, 2000);
+  ApplyEvents(/* started_pids */ {100}, /* exited_pids */ {});
+
+  EXPECT_THAT(tracker_.upid_delta_log().upids(), UnorderedElementsAre(md::UPID(0, 100, 2000)));
+  EXPECT_THAT(DeltasSince(seq), ElementsAre(Pair(md::UPID(0, 100, 1000), false),
+                                            Pair(md::UPID(0, 100, 2000), true)));
+}
+
+}  // namespace stirling
+}  // namespace px
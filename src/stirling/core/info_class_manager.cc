@@ -16,6 +16,7 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include <chrono>
 #include <memory>
 #include <utility>
 
@@ -36,11 +37,40 @@ bool InfoClassManager::PushRequired() const {
 void InfoClassManager::InitContext(ConnectorContext* ctx) { source_->InitContext(ctx); }
 
 void InfoClassManager::SampleData(ConnectorContext* ctx) {
+  auto start = std::chrono::steady_clock::now();
   source_->TransferData(ctx, source_table_num_, data_table_);
+  sampling_time_ += std::chrono::steady_clock::now() - start;
   sample_push_freq_mgr_.Sample();
 }
 
+void InfoClassManager::AdaptPeriods() {
+  auto now = std::chrono::steady_clock::now();
+  std::chrono::duration<double> elapsed = now - last_adapt_time_;
+  const double sampling_cost =
+      elapsed.count() > 0 ? std::chrono::duration<double>(sampling_time_) / elapsed : 0;
+
+  // Sources that output to multiple tables are sampled as a whole, by their own manager.
+  uint32_t sampling_count = 0;
+  if (source_ != nullptr) {
+    sampling_count = source_->output_multi_tables() ? source_->sample_push_mgr().sampling_count()
+                                                    : sample_push_freq_mgr_.sampling_count();
+  }
+
+  if (source_ != nullptr && source_->event_driven()) {
+    sample_push_freq_mgr_.AdaptPeriods(data_table_->OccupancyPct(),
+                                       sampling_count - last_sampling_count_,
+                                       source_->num_lost_events() - last_num_lost_events_,
+                                       sampling_cost);
+    last_num_lost_events_ = source_->num_lost_events();
+  }
+
+  last_adapt_time_ = now;
+  last_sampling_count_ = sampling_count;
+  sampling_time_ = std::chrono::nanoseconds::zero();
+}
+
 void InfoClassManager::PushData(DataPushCallback agent_callback) {
+  AdaptPeriods();
   auto record_batches = data_table_->ConsumeRecords();
   for (auto& record_batch : record_batches) {
     if (!record_batch.records.empty()) {
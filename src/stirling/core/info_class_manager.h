@@ -198,6 +198,9 @@ class InfoClassManager final : public NotCopyable {
   DataTable* data_table() const { return data_table_; }
 
  private:
+  // Adapts the sampling and push periods to the load since the last push.
+  void AdaptPeriods();
+
   inline static std::atomic<uint64_t> global_id_ = 0;
 
   stirlingpb::SourceType type_;
@@ -221,6 +224,12 @@ class InfoClassManager final : public NotCopyable {
   DataTable* data_table_ = nullptr;
 
   SamplePushFrequencyManager sample_push_freq_mgr_;
+
+  // Load signals since the last push, used to adapt the sampling and push periods.
+  std::chrono::nanoseconds sampling_time_{0};
+  std::chrono::steady_clock::time_point last_adapt_time_;
+  uint64_t last_num_lost_events_ = 0;
+  uint32_t last_sampling_count_ = 0;
 };
 
 using InfoClassManagerVec = std::vector<std::unique_ptr<InfoClassManager>>;
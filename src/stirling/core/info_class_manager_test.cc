@@ -18,6 +18,7 @@
 
 #include <gtest/gtest.h>
 
+#include "src/stirling/core/data_table.h"
 #include "src/stirling/core/info_class_manager.h"
 #include "src/stirling/source_connectors/seq_gen/seq_gen_connector.h"
 
@@ -48,5 +49,25 @@ TEST(InfoClassInfoSchemaTest, infoclass_mgr_proto_getters_test) {
   EXPECT_TRUE(subscribe_pb.subscribed());
 }
 
+TEST(InfoClassInfoSchemaTest, polling_source_periods_dont_adapt) {
+  InfoClassManager info_class_mgr(SeqGenConnector::kSeq0Table);
+  auto source = SeqGenConnector::Create("sequences");
+  info_class_mgr.SetSourceConnector(source.get(), SeqGenConnector::kSeq0TableNum);
+  DataTable data_table(SeqGenConnector::kSeq0Table);
+  info_class_mgr.SetDataTable(&data_table);
+  ASSERT_FALSE(source->event_driven());
+
+  // Lost events would shorten the periods of an event-driven source.
+  source->RecordLostEvents(10);
+  stirlingpb::InfoClass before_pb = info_class_mgr.ToProto();
+  info_class_mgr.PushData(
+      [](uint32_t, types::TabletID, std::unique_ptr<types::ColumnWrapperRecordBatch>) {
+        return Status::OK();
+      });
+  stirlingpb::InfoClass after_pb = info_class_mgr.ToProto();
+  EXPECT_EQ(before_pb.sampling_period_millis(), after_pb.sampling_period_millis());
+  EXPECT_EQ(before_pb.push_period_millis(), after_pb.push_period_millis());
+}
+
 }  // namespace stirling
 }  // namespace px
@@ -17,6 +17,8 @@
  */
 
 #ifdef __linux__
+#include <algorithm>
+#include <chrono>
 #include <cstring>
 #include <ctime>
 
@@ -50,14 +52,46 @@ void SourceConnector::TransferData(ConnectorContext* ctx, uint32_t table_num,
   DCHECK(ctx != nullptr);
   DCHECK_LT(table_num, num_tables())
       << absl::Substitute("Access to table out of bounds: table_num=$0", table_num);
+  auto start = std::chrono::steady_clock::now();
   TransferDataImpl(ctx, table_num, data_table);
+  transfer_time_ += std::chrono::steady_clock::now() - start;
 }
 
 void SourceConnector::TransferData(ConnectorContext* ctx,
                                    const std::vector<DataTable*>& data_tables) {
   DCHECK(ctx != nullptr);
   DCHECK_EQ(data_tables.size(), num_tables()) << "DataTable objects must all be specified.";
+  std::vector<double> prev_occupancy_pcts(data_tables.size(), 0);
+  for (size_t i = 0; i < data_tables.size(); ++i) {
+    if (data_tables[i] != nullptr) {
+      prev_occupancy_pcts[i] = data_tables[i]->OccupancyPct();
+    }
+  }
+  auto start = std::chrono::steady_clock::now();
   TransferDataImpl(ctx, data_tables);
+  auto elapsed = std::chrono::steady_clock::now() - start;
+  transfer_time_ += elapsed;
+
+  // The sampling period of event-driven sources that output to multiple tables is managed here,
+  // based on the occupancy that this sample added to the fullest of their tables.
+  if (event_driven_) {
+    double occupancy_pct = 0;
+    for (size_t i = 0; i < data_tables.size(); ++i) {
+      if (data_tables[i] != nullptr) {
+        occupancy_pct =
+            std::max(occupancy_pct, data_tables[i]->OccupancyPct() - prev_occupancy_pcts[i]);
+      }
+    }
+    const auto sampling_period = sample_push_freq_mgr_.sampling_period();
+    const double sampling_cost =
+        sampling_period.count() > 0 ? std::chrono::duration<double>(elapsed) /
+                                          std::chrono::duration<double>(sampling_period)
+                                    : 0;
+    sample_push_freq_mgr_.AdaptPeriods(occupancy_pct, /*num_samples*/ 1,
+                                       num_lost_events_ - last_num_lost_events_, sampling_cost);
+    last_num_lost_events_ = num_lost_events_;
+  }
+
   sample_push_freq_mgr_.Sample();
 }
 
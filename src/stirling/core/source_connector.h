@@ -18,6 +18,7 @@
 
 #pragma once
 
+#include <chrono>
 #include <string>
 #include <vector>
 
@@ -130,6 +131,29 @@ class SourceConnector : public NotCopyable {
            ClockRealTimeOffset();
   }
 
+  /**
+   * Records events that were lost before reaching the connector (e.g. perf buffer overflows).
+   * Used as a load signal to adapt the sampling and push periods.
+   */
+  void RecordLostEvents(uint64_t lost) { num_lost_events_ += lost; }
+
+  /**
+   * Total number of events lost, as recorded by RecordLostEvents().
+   */
+  uint64_t num_lost_events() const { return num_lost_events_; }
+
+  /**
+   * Whether the source reads events from perf buffers, instead of polling for its data. Only the
+   * sampling and push periods of event-driven sources adapt to the load: the data that a polling
+   * source collects per sample doesn't depend on how often it samples.
+   */
+  bool event_driven() const { return event_driven_; }
+
+  /**
+   * Total time spent transferring data, across all calls to TransferData().
+   */
+  std::chrono::nanoseconds transfer_time() const { return transfer_time_; }
+
   const SamplePushFrequencyManager& sample_push_mgr() const { return sample_push_freq_mgr_; }
   SamplePushFrequencyManager* mutable_sample_push_mgr() { return &sample_push_freq_mgr_; }
 
@@ -157,6 +181,8 @@ class SourceConnector : public NotCopyable {
 
   virtual Status StopImpl() = 0;
 
+  void set_event_driven() { event_driven_ = true; }
+
  protected:
   /**
    * Track state of connector. A connector's lifetime typically progresses sequentially
@@ -178,6 +204,15 @@ class SourceConnector : public NotCopyable {
   absl::flat_hash_set<int> pids_to_trace_;
 
  private:
+  // Load signals for adapting the sampling and push periods.
+  bool event_driven_ = false;
+  uint64_t num_lost_events_ = 0;
+  std::chrono::nanoseconds transfer_time_{0};
+
+  // The value of num_lost_events_ as of the last adaptation of the sampling period,
+  // for sources that output to multiple tables.
+  uint64_t last_num_lost_events_ = 0;
+
   std::atomic<State> state_ = State::kUninitialized;
 
   const std::string source_name_;
@@ -18,9 +18,47 @@
 
 #include "src/stirling/core/utils.h"
 
+#include <algorithm>
+
+DEFINE_bool(stirling_adaptive_periods, true,
+            "If true, the sampling and push periods of event-driven (perf buffer) sources adapt to "
+            "the data table occupancy, event loss and sampling cost, instead of staying fixed.");
+DEFINE_double(stirling_adaptive_period_min_factor, 0.25,
+              "Lower bound of the adapted sampling and push periods, as a factor of each table's "
+              "configured periods.");
+DEFINE_double(stirling_adaptive_period_max_factor, 4.0,
+              "Upper bound of the adapted sampling and push periods, as a factor of each table's "
+              "configured periods.");
+
 namespace px {
 namespace stirling {
 
+namespace {
+
+// Above this occupancy, the load is considered bursty and the periods are shortened.
+constexpr double kHighOccupancyPct = 0.5;
+// Below this occupancy, the load is considered idle and the periods are lengthened.
+constexpr double kLowOccupancyPct = 0.1;
+// Above this sampling cost, sampling more often is counter-productive, and is avoided.
+constexpr double kMaxSamplingCost = 0.5;
+
+constexpr double kShortenFactor = 0.5;
+constexpr double kLengthenFactor = 1.25;
+
+std::chrono::milliseconds ScalePeriod(std::chrono::milliseconds period, double factor,
+                                      std::chrono::milliseconds base) {
+  auto min_period = std::chrono::milliseconds(
+      static_cast<int64_t>(base.count() * FLAGS_stirling_adaptive_period_min_factor));
+  auto max_period = std::chrono::milliseconds(
+      static_cast<int64_t>(base.count() * FLAGS_stirling_adaptive_period_max_factor));
+  // Round away from the current period, so that short periods still change.
+  auto scaled = std::chrono::milliseconds(static_cast<int64_t>(
+      factor < 1 ? period.count() * factor : period.count() * factor + 1));
+  return std::clamp(scaled, std::min(min_period, base), std::max(max_period, base));
+}
+
+}  // namespace
+
 bool SamplePushFrequencyManager::SamplingRequired() const {
   return std::chrono::steady_clock::now() > NextSamplingTime();
 }
@@ -51,6 +89,38 @@ void SamplePushFrequencyManager::Push() {
   ++push_count_;
 }
 
+void SamplePushFrequencyManager::AdaptPeriods(double occupancy_percentage, uint32_t num_samples,
+                                              uint64_t lost_events, double sampling_cost) {
+  if (!FLAGS_stirling_adaptive_periods) {
+    return;
+  }
+
+  // Scale the occupancy to what the configured periods would have accumulated in a push.
+  const double base_samples_per_push =
+      base_sampling_period_.count() > 0
+          ? std::max(1.0, 1.0 * base_push_period_.count() / base_sampling_period_.count())
+          : 1.0;
+  occupancy_percentage = occupancy_percentage / std::max<uint32_t>(num_samples, 1) *
+                         base_samples_per_push;
+
+  const bool bursty = lost_events > 0 || occupancy_percentage > kHighOccupancyPct;
+  const bool idle = !bursty && occupancy_percentage < kLowOccupancyPct;
+
+  if (bursty) {
+    push_period_ = ScalePeriod(push_period_, kShortenFactor, base_push_period_);
+  } else if (idle) {
+    push_period_ = ScalePeriod(push_period_, kLengthenFactor, base_push_period_);
+  }
+
+  if (bursty) {
+    if (sampling_cost < kMaxSamplingCost) {
+      sampling_period_ = ScalePeriod(sampling_period_, kShortenFactor, base_sampling_period_);
+    }
+  } else if (idle || sampling_cost > kMaxSamplingCost) {
+    sampling_period_ = ScalePeriod(sampling_period_, kLengthenFactor, base_sampling_period_);
+  }
+}
+
 std::chrono::steady_clock::time_point SamplePushFrequencyManager::NextSamplingTime() const {
   return last_sampled_ + sampling_period_;
 }
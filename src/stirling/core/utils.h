@@ -19,6 +19,13 @@
 #pragma once
 
 #include <chrono>
+#include <cstdint>
+
+#include "src/common/base/base.h"
+
+DECLARE_bool(stirling_adaptive_periods);
+DECLARE_double(stirling_adaptive_period_min_factor);
+DECLARE_double(stirling_adaptive_period_max_factor);
 
 namespace px {
 namespace stirling {
@@ -64,8 +71,33 @@ class SamplePushFrequencyManager {
    */
   std::chrono::steady_clock::time_point NextPushTime() const;
 
-  void set_sampling_period(std::chrono::milliseconds period) { sampling_period_ = period; }
-  void set_push_period(std::chrono::milliseconds period) { push_period_ = period; }
+  /**
+   * Adapts the sampling and push periods to the load observed since the last adaptation:
+   * periods are shortened quickly under bursty load, to avoid losing events, and lengthened
+   * gradually when idle, to avoid wasted wakeups.
+   *
+   * Periods stay within [min_factor, max_factor] times the periods last set through
+   * set_sampling_period() and set_push_period() (see --stirling_adaptive_period_*_factor).
+   *
+   * The occupancy grows with the number of samples it accumulates, which the adaptation itself
+   * changes. So it is normalized to the number of samples per push of the configured periods.
+   *
+   * @param occupancy_percentage Occupancy of the data table(s) before being pushed.
+   * @param num_samples Number of samples that produced that occupancy.
+   * @param lost_events Number of events that the source lost.
+   * @param sampling_cost Fraction of the elapsed time that was spent sampling.
+   */
+  void AdaptPeriods(double occupancy_percentage, uint32_t num_samples, uint64_t lost_events,
+                    double sampling_cost);
+
+  void set_sampling_period(std::chrono::milliseconds period) {
+    sampling_period_ = period;
+    base_sampling_period_ = period;
+  }
+  void set_push_period(std::chrono::milliseconds period) {
+    push_period_ = period;
+    base_push_period_ = period;
+  }
   const auto& sampling_period() const { return sampling_period_; }
   const auto& push_period() const { return push_period_; }
   uint32_t sampling_count() const { return sampling_count_; }
@@ -93,6 +125,10 @@ class SamplePushFrequencyManager {
 
   uint32_t sampling_count_ = 0;
   uint32_t push_count_ = 0;
+
+  // The configured periods, which bound the adapted periods.
+  std::chrono::milliseconds base_sampling_period_{0};
+  std::chrono::milliseconds base_push_period_{0};
 };
 
 }  // namespace stirling
@@ -0,0 +1,99 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/stirling/core/utils.h"
+
+#include <gtest/gtest.h>
+
+namespace px {
+namespace stirling {
+
+using std::chrono_literals::operator""ms;
+
+class SamplePushFrequencyManagerTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    mgr_.set_sampling_period(100ms);
+    mgr_.set_push_period(1000ms);
+  }
+
+  SamplePushFrequencyManager mgr_;
+};
+
+TEST_F(SamplePushFrequencyManagerTest, ShortensPeriodsUnderLoad) {
+  mgr_.AdaptPeriods(/*occupancy_percentage*/ 0.8, /*num_samples*/ 10, /*lost_events*/ 0,
+                    /*sampling_cost*/ 0.01);
+  EXPECT_EQ(mgr_.sampling_period(), 50ms);
+  EXPECT_EQ(mgr_.push_period(), 500ms);
+
+  // Bounded by the min factor of the configured periods.
+  for (int i = 0; i < 10; ++i) {
+    mgr_.AdaptPeriods(/*occupancy_percentage*/ 0, /*num_samples*/ 10, /*lost_events*/ 10,
+                      /*sampling_cost*/ 0.01);
+  }
+  EXPECT_EQ(mgr_.sampling_period(), 25ms);
+  EXPECT_EQ(mgr_.push_period(), 250ms);
+}
+
+TEST_F(SamplePushFrequencyManagerTest, LengthensPeriodsWhenIdle) {
+  mgr_.AdaptPeriods(/*occupancy_percentage*/ 0, /*num_samples*/ 10, /*lost_events*/ 0,
+                    /*sampling_cost*/ 0.01);
+  EXPECT_GT(mgr_.sampling_period(), 100ms);
+  EXPECT_GT(mgr_.push_period(), 1000ms);
+
+  // Bounded by the max factor of the configured periods.
+  for (int i = 0; i < 100; ++i) {
+    mgr_.AdaptPeriods(/*occupancy_percentage*/ 0, /*num_samples*/ 10, /*lost_events*/ 0,
+                      /*sampling_cost*/ 0.01);
+  }
+  EXPECT_EQ(mgr_.sampling_period(), 400ms);
+  EXPECT_EQ(mgr_.push_period(), 4000ms);
+}
+
+TEST_F(SamplePushFrequencyManagerTest, ExpensiveSamplingIsNotShortened) {
+  mgr_.AdaptPeriods(/*occupancy_percentage*/ 0.8, /*num_samples*/ 10, /*lost_events*/ 0,
+                    /*sampling_cost*/ 0.9);
+  EXPECT_EQ(mgr_.sampling_period(), 100ms);
+  EXPECT_EQ(mgr_.push_period(), 500ms);
+}
+
+TEST_F(SamplePushFrequencyManagerTest, NormalizesOccupancyBySamples) {
+  // 40 samples instead of the configured 10 per push: the load per sample is moderate.
+  mgr_.AdaptPeriods(/*occupancy_percentage*/ 0.8, /*num_samples*/ 40, /*lost_events*/ 0,
+                    /*sampling_cost*/ 0.01);
+  EXPECT_EQ(mgr_.sampling_period(), 100ms);
+  EXPECT_EQ(mgr_.push_period(), 1000ms);
+
+  // A single sample filled the table by 8%, so 10 samples would have filled 80% of it.
+  mgr_.AdaptPeriods(/*occupancy_percentage*/ 0.08, /*num_samples*/ 1, /*lost_events*/ 0,
+                    /*sampling_cost*/ 0.01);
+  EXPECT_EQ(mgr_.sampling_period(), 50ms);
+  EXPECT_EQ(mgr_.push_period(), 500ms);
+}
+
+TEST_F(SamplePushFrequencyManagerTest, Disabled) {
+  FLAGS_stirling_adaptive_periods = false;
+  mgr_.AdaptPeriods(/*occupancy_percentage*/ 0.8, /*num_samples*/ 10, /*lost_events*/ 10,
+                    /*sampling_cost*/ 0.01);
+  EXPECT_EQ(mgr_.sampling_period(), 100ms);
+  EXPECT_EQ(mgr_.push_period(), 1000ms);
+  FLAGS_stirling_adaptive_periods = true;
+}
+
+}  // namespace stirling
+}  // namespace px
@@ -0,0 +1,44 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/stirling/obj_tools/binary_analysis_cache.h"
+
+#include <sys/stat.h>
+
+#include <cstring>
+
+namespace px {
+namespace stirling {
+namespace obj_tools {
+
+StatusOr<BinaryKey> GetBinaryKey(const std::filesystem::path& binary) {
+  struct stat st;
+  if (stat(binary.c_str(), &st) != 0) {
+    return error::Internal("Could not stat $0: $1", binary.string(), std::strerror(errno));
+  }
+
+  BinaryKey key;
+  key.dev = st.st_dev;
+  key.inode = st.st_ino;
+  key.mtime_ns = static_cast<int64_t>(st.st_mtim.tv_sec) * 1000 * 1000 * 1000 + st.st_mtim.tv_nsec;
+  return key;
+}
+
+}  // namespace obj_tools
+}  // namespace stirling
+}  // namespace px
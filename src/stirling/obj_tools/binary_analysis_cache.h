@@ -0,0 +1,197 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <sys/types.h>
+
+#include <deque>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include <absl/container/flat_hash_map.h>
+#include <absl/synchronization/mutex.h>
+
+#include "src/common/base/base.h"
+
+namespace px {
+namespace stirling {
+namespace obj_tools {
+
+/**
+ * Identifies the contents of a binary on disk without reading it.
+ * Two paths with the same key (e.g. the same image layer mounted into many containers)
+ * are guaranteed to have the same contents, unless the file was modified in place within the
+ * mtime granularity.
+ */
+struct BinaryKey {
+  dev_t dev = 0;
+  ino_t inode = 0;
+  int64_t mtime_ns = 0;
+
+  bool operator==(const BinaryKey& other) const {
+    return dev == other.dev && inode == other.inode && mtime_ns == other.mtime_ns;
+  }
+
+  template <typename H>
+  friend H AbslHashValue(H h, const BinaryKey& key) {
+    return H::combine(std::move(h), key.dev, key.inode, key.mtime_ns);
+  }
+
+  std::string ToString() const {
+    return absl::Substitute("[dev=$0 inode=$1 mtime_ns=$2]", dev, inode, mtime_ns);
+  }
+};
+
+/**
+ * Returns the key of the binary at the given path, by stat-ing it.
+ */
+StatusOr<BinaryKey> GetBinaryKey(const std::filesystem::path& binary);
+
+/**
+ * A thread-safe cache of results computed from analyzing a binary (e.g. symbol addresses and
+ * struct member offsets), so that the expensive ELF/DWARF analysis is done once per binary,
+ * rather than once per process or per path.
+ *
+ * Entries are primarily keyed by BinaryKey. Results may additionally be indexed by build-id, so
+ * that identical binaries that are not the same file (e.g. copied into different image layers)
+ * can also share the analysis, at the cost of only opening the ELF file.
+ *
+ * The cache is bounded; once full, the oldest entries are evicted first.
+ */
+template <typename TValue>
+class BinaryAnalysisCache {
+ public:
+  explicit BinaryAnalysisCache(size_t capacity) : capacity_(capacity) {}
+
+  /**
+   * Returns the cached analysis for the binary, or nullptr if it has not been analyzed.
+   */
+  std::shared_ptr<const TValue> Lookup(const BinaryKey& key) {
+    absl::MutexLock lock(&mu_);
+    auto iter = entries_.find(key);
+    if (iter == entries_.end()) {
+      ++misses_;
+      return nullptr;
+    }
+    ++hits_;
+    return iter->second.value;
+  }
+
+  /**
+   * Returns the cached analysis of any binary with the given build-id, or nullptr.
+   * On success, the result is also recorded under key, so subsequent lookups of key hit directly.
+   */
+  std::shared_ptr<const TValue> LookupBuildID(const BinaryKey& key, const std::string& build_id) {
+    if (build_id.empty()) {
+      return nullptr;
+    }
+    absl::MutexLock lock(&mu_);
+    auto iter = build_id_index_.find(build_id);
+    if (iter == build_id_index_.end()) {
+      return nullptr;
+    }
+    ++build_id_hits_;
+    std::shared_ptr<const TValue> value = iter->second;
+    InsertLocked(key, build_id, value);
+    return value;
+  }
+
+  /**
+   * Records the analysis of a binary. The build-id may be empty, if the binary has none.
+   * @return The cached value.
+   */
+  std::shared_ptr<const TValue> Insert(const BinaryKey& key, const std::string& build_id,
+                                       TValue value) {
+    auto ptr = std::make_shared<const TValue>(std::move(value));
+    absl::MutexLock lock(&mu_);
+    InsertLocked(key, build_id, ptr);
+    if (!build_id.empty()) {
+      build_id_index_[build_id] = ptr;
+    }
+    return ptr;
+  }
+
+  size_t size() const {
+    absl::MutexLock lock(&mu_);
+    return entries_.size();
+  }
+
+  int64_t hits() const {
+    absl::MutexLock lock(&mu_);
+    return hits_;
+  }
+
+  int64_t build_id_hits() const {
+    absl::MutexLock lock(&mu_);
+    return build_id_hits_;
+  }
+
+  int64_t misses() const {
+    absl::MutexLock lock(&mu_);
+    return misses_;
+  }
+
+ private:
+  struct Entry {
+    std::string build_id;
+    std::shared_ptr<const TValue> value;
+  };
+
+  void InsertLocked(const BinaryKey& key, const std::string& build_id,
+                    std::shared_ptr<const TValue> value) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    auto [iter, inserted] = entries_.insert_or_assign(key, Entry{build_id, std::move(value)});
+    PL_UNUSED(iter);
+    if (!inserted) {
+      return;
+    }
+    insertion_order_.push_back(key);
+    while (entries_.size() > capacity_) {
+      auto evicted = entries_.find(insertion_order_.front());
+      insertion_order_.pop_front();
+      if (evicted == entries_.end()) {
+        continue;
+      }
+      // Drop the build-id index entry too, unless it now refers to a newer analysis.
+      auto build_id_iter = build_id_index_.find(evicted->second.build_id);
+      if (build_id_iter != build_id_index_.end() &&
+          build_id_iter->second == evicted->second.value) {
+        build_id_index_.erase(build_id_iter);
+      }
+      entries_.erase(evicted);
+    }
+  }
+
+  const size_t capacity_;
+
+  mutable absl::Mutex mu_;
+  absl::flat_hash_map<BinaryKey, Entry> entries_ ABSL_GUARDED_BY(mu_);
+  absl::flat_hash_map<std::string, std::shared_ptr<const TValue>> build_id_index_
+      ABSL_GUARDED_BY(mu_);
+  std::deque<BinaryKey> insertion_order_ ABSL_GUARDED_BY(mu_);
+
+  int64_t hits_ ABSL_GUARDED_BY(mu_) = 0;
+  int64_t build_id_hits_ ABSL_GUARDED_BY(mu_) = 0;
+  int64_t misses_ ABSL_GUARDED_BY(mu_) = 0;
+};
+
+}  // namespace obj_tools
+}  // namespace stirling
+}  // namespace px
@@ -0,0 +1,100 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/stirling/obj_tools/binary_analysis_cache.h"
+
+#include <memory>
+#include <string>
+
+#include "src/common/fs/temp_file.h"
+#include "src/common/testing/testing.h"
+
+namespace px {
+namespace stirling {
+namespace obj_tools {
+
+TEST(GetBinaryKeyTest, ChangesWithMTime) {
+  std::unique_ptr<fs::TempFile> tmpf = fs::TempFile::Create();
+
+  ASSERT_OK_AND_ASSIGN(BinaryKey key1, GetBinaryKey(tmpf->path()));
+  ASSERT_OK_AND_ASSIGN(BinaryKey key2, GetBinaryKey(tmpf->path()));
+  EXPECT_EQ(key1, key2);
+
+  std::filesystem::last_write_time(
+      tmpf->path(), std::filesystem::last_write_time(tmpf->path()) + std::chrono::seconds(10));
+  ASSERT_OK_AND_ASSIGN(BinaryKey key3, GetBinaryKey(tmpf->path()));
+  EXPECT_FALSE(key1 == key3);
+  EXPECT_EQ(key1.inode, key3.inode);
+
+  EXPECT_NOT_OK(GetBinaryKey("/path/does/not/exist"));
+}
+
+TEST(BinaryAnalysisCacheTest, LookupAndInsert) {
+  BinaryAnalysisCache<std::string> cache(/* capacity */ 8);
+  BinaryKey key{.dev = 1, .inode = 2, .mtime_ns = 3};
+
+  EXPECT_EQ(cache.Lookup(key), nullptr);
+  cache.Insert(key, "", "analysis");
+
+  std::shared_ptr<const std::string> value = cache.Lookup(key);
+  ASSERT_NE(value, nullptr);
+  EXPECT_EQ(*value, "analysis");
+  EXPECT_EQ(cache.hits(), 1);
+  EXPECT_EQ(cache.misses(), 1);
+}
+
+TEST(BinaryAnalysisCacheTest, SharedByBuildID) {
+  BinaryAnalysisCache<std::string> cache(/* capacity */ 8);
+  BinaryKey key1{.dev = 1, .inode = 2, .mtime_ns = 3};
+  BinaryKey key2{.dev = 4, .inode = 5, .mtime_ns = 6};
+
+  cache.Insert(key1, "abcd", "analysis");
+
+  EXPECT_EQ(cache.Lookup(key2), nullptr);
+  EXPECT_EQ(cache.LookupBuildID(key2, ""), nullptr);
+  EXPECT_EQ(cache.LookupBuildID(key2, "ef01"), nullptr);
+  ASSERT_NE(cache.LookupBuildID(key2, "abcd"), nullptr);
+  EXPECT_EQ(cache.build_id_hits(), 1);
+
+  // The second binary is now directly indexed too.
+  std::shared_ptr<const std::string> value = cache.Lookup(key2);
+  ASSERT_NE(value, nullptr);
+  EXPECT_EQ(*value, "analysis");
+  EXPECT_EQ(cache.size(), 2);
+}
+
+TEST(BinaryAnalysisCacheTest, EvictsOldest) {
+  BinaryAnalysisCache<int> cache(/* capacity */ 2);
+  BinaryKey key1{.dev = 1, .inode = 1, .mtime_ns = 1};
+  BinaryKey key2{.dev = 1, .inode = 2, .mtime_ns = 1};
+  BinaryKey key3{.dev = 1, .inode = 3, .mtime_ns = 1};
+
+  cache.Insert(key1, "id1", 1);
+  cache.Insert(key2, "id2", 2);
+  cache.Insert(key3, "id3", 3);
+
+  EXPECT_EQ(cache.size(), 2);
+  EXPECT_EQ(cache.Lookup(key1), nullptr);
+  EXPECT_EQ(cache.LookupBuildID(key1, "id1"), nullptr);
+  EXPECT_NE(cache.Lookup(key2), nullptr);
+  EXPECT_NE(cache.Lookup(key3), nullptr);
+}
+
+}  // namespace obj_tools
+}  // namespace stirling
+}  // namespace px
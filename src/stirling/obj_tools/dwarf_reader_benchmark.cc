@@ -19,9 +19,11 @@
 #include <benchmark/benchmark.h>
 
 #include "src/common/base/base.h"
+#include "src/common/testing/temp_dir.h"
 #include "src/common/testing/test_environment.h"
 #include "src/stirling/obj_tools/dwarf_tools.h"
 
+using px::stirling::obj_tools::DwarfIndexMode;
 using px::stirling::obj_tools::DwarfReader;
 using px::testing::BazelBinTestFilePath;
 
@@ -72,14 +74,14 @@ void GetSymAddrs(DwarfReader* dwarf_reader, SymAddrs* symaddrs) {
 }
 
 // NOLINTNEXTLINE : runtime/references.
-static void BM_noindex(benchmark::State& state) {
+void RunLookups(benchmark::State& state, DwarfIndexMode index_mode) {
   size_t num_lookup_iterations = state.range(0);
 
   for (auto _ : state) {
     SymAddrs symaddrs;
 
     PL_ASSIGN_OR_EXIT(std::unique_ptr<DwarfReader> dwarf_reader,
-                      DwarfReader::Create(kBinary, /* index */ false));
+                      DwarfReader::Create(kBinary, index_mode));
 
     for (size_t i = 0; i < num_lookup_iterations; ++i) {
       GetSymAddrs(dwarf_reader.get(), &symaddrs);
@@ -88,21 +90,49 @@ static void BM_noindex(benchmark::State& state) {
   }
 }
 
+// Runs the lookups with the index persisted in a cache directory from a previous run.
+// NOLINTNEXTLINE : runtime/references.
+void RunWarmLookups(benchmark::State& state, DwarfIndexMode index_mode) {
+  px::testing::TempDir cache_dir;
+  FLAGS_stirling_dwarf_index_cache_dir = cache_dir.path().string();
+
+  // Populate the index cache.
+  PL_ASSIGN_OR_EXIT(std::unique_ptr<DwarfReader> dwarf_reader,
+                    DwarfReader::Create(kBinary, DwarfIndexMode::kEager));
+  dwarf_reader.reset();
+
+  RunLookups(state, index_mode);
+
+  FLAGS_stirling_dwarf_index_cache_dir = "";
+}
+
+// NOLINTNEXTLINE : runtime/references.
+static void BM_noindex(benchmark::State& state) {
+  RunLookups(state, DwarfIndexMode::kNone);
+}
+
 // NOLINTNEXTLINE : runtime/references.
 static void BM_indexed(benchmark::State& state) {
-  size_t num_lookup_iterations = state.range(0);
+  RunLookups(state, DwarfIndexMode::kEager);
+}
 
-  for (auto _ : state) {
-    SymAddrs symaddrs;
+// NOLINTNEXTLINE : runtime/references.
+static void BM_lazy_indexed(benchmark::State& state) {
+  RunLookups(state, DwarfIndexMode::kLazy);
+}
 
-    PL_ASSIGN_OR_EXIT(std::unique_ptr<DwarfReader> dwarf_reader, DwarfReader::Create(kBinary));
+// NOLINTNEXTLINE : runtime/references.
+static void BM_indexed_warm(benchmark::State& state) {
+  RunWarmLookups(state, DwarfIndexMode::kEager);
+}
 
-    for (size_t i = 0; i < num_lookup_iterations; ++i) {
-      GetSymAddrs(dwarf_reader.get(), &symaddrs);
-      benchmark::DoNotOptimize(symaddrs);
-    }
-  }
+// NOLINTNEXTLINE : runtime/references.
+static void BM_lazy_indexed_warm(benchmark::State& state) {
+  RunWarmLookups(state, DwarfIndexMode::kLazy);
 }
 
 BENCHMARK(BM_noindex)->RangeMultiplier(2)->Range(1, 16);
 BENCHMARK(BM_indexed)->RangeMultiplier(2)->Range(1, 16);
+BENCHMARK(BM_lazy_indexed)->RangeMultiplier(2)->Range(1, 16);
+BENCHMARK(BM_indexed_warm)->RangeMultiplier(2)->Range(1, 16);
+BENCHMARK(BM_lazy_indexed_warm)->RangeMultiplier(2)->Range(1, 16);
@@ -18,15 +18,28 @@
 
 #include "src/stirling/obj_tools/dwarf_tools.h"
 
+#include <unistd.h>
+
 #include <algorithm>
+#include <cstring>
+#include <sstream>
+#include <utility>
 
 #include <llvm/DebugInfo/DIContext.h>
 #include <llvm/Object/ObjectFile.h>
 
+#include <absl/strings/numbers.h>
+
+#include "src/common/base/file.h"
+#include "src/common/base/utils.h"
 #include "src/stirling/obj_tools/init.h"
 
 #include "src/shared/types/typespb/wrapper/types_pb_wrapper.h"
 
+DEFINE_string(stirling_dwarf_index_cache_dir, "",
+              "If set, DWARF indexes of binaries are persisted to this directory, keyed by "
+              "build-id, so they don't have to be recomputed for the same binary.");
+
 namespace px {
 namespace stirling {
 namespace obj_tools {
@@ -47,6 +60,61 @@ StatusOr<TValueType> AdaptLLVMOptional(llvm::Optional<TValueType>&& llvm_opt,
   return llvm_opt.getValue();
 }
 
+struct LowercaseHex {
+  static inline constexpr std::string_view kCharFormat = "%02x";
+  static inline constexpr int kSizePerByte = 2;
+  static inline constexpr bool kKeepPrintableChars = false;
+};
+
+// Returns the build-id recorded in the ELF notes of the object file, or an empty string.
+// The GNU build-id is preferred; Go binaries have their own build-id note.
+std::string ReadBuildID(const llvm::object::ObjectFile& obj_file) {
+  constexpr std::string_view kGNUBuildIDSection = ".note.gnu.build-id";
+  constexpr std::string_view kGoBuildIDSection = ".note.go.buildid";
+
+  std::string go_build_id;
+  for (const llvm::object::SectionRef& section : obj_file.sections()) {
+    llvm::Expected<llvm::StringRef> name_or = section.getName();
+    if (!name_or) {
+      llvm::consumeError(name_or.takeError());
+      continue;
+    }
+    std::string_view name(name_or->data(), name_or->size());
+    if (name != kGNUBuildIDSection && name != kGoBuildIDSection) {
+      continue;
+    }
+
+    llvm::Expected<llvm::StringRef> contents_or = section.getContents();
+    if (!contents_or) {
+      llvm::consumeError(contents_or.takeError());
+      continue;
+    }
+    std::string_view contents(contents_or->data(), contents_or->size());
+
+    // Structure of a note: namesz, descsz, type (32 bits each), followed by name and desc,
+    // each padded to 4 bytes.
+    constexpr size_t kHeaderSize = 3 * sizeof(uint32_t);
+    if (contents.size() < kHeaderSize) {
+      continue;
+    }
+    uint32_t name_size;
+    uint32_t desc_size;
+    std::memcpy(&name_size, contents.data(), sizeof(uint32_t));
+    std::memcpy(&desc_size, contents.data() + sizeof(uint32_t), sizeof(uint32_t));
+    size_t desc_pos = kHeaderSize + ((name_size + 3) & ~3U);
+    if (desc_pos + desc_size > contents.size()) {
+      continue;
+    }
+
+    std::string build_id = BytesToString<LowercaseHex>(contents.substr(desc_pos, desc_size));
+    if (name == kGNUBuildIDSection) {
+      return build_id;
+    }
+    go_build_id = std::move(build_id);
+  }
+  return go_build_id;
+}
+
 std::vector<DWARFDie> GetParamDIEs(const DWARFDie& function_die) {
   std::vector<DWARFDie> dies;
   for (auto& die : function_die.children()) {
@@ -99,7 +167,7 @@ std::string Dump(const llvm::DWARFDie& die) {
 uint8_t kAddressSize = sizeof(void*);
 
 StatusOr<std::unique_ptr<DwarfReader>> DwarfReader::Create(std::string_view obj_filename,
-                                                           bool index) {
+                                                           DwarfIndexMode index_mode) {
   using llvm::MemoryBuffer;
 
   std::error_code ec;
@@ -125,20 +193,36 @@ StatusOr<std::unique_ptr<DwarfReader>> DwarfReader::Create(std::string_view obj_
   }
 
   auto dwarf_reader = std::unique_ptr<DwarfReader>(
-      new DwarfReader(std::move(buffer), DWARFContext::create(*obj_file)));
+      new DwarfReader(std::move(buffer), DWARFContext::create(*obj_file), index_mode));
+  dwarf_reader->build_id_ = ReadBuildID(*obj_file);
 
   PL_RETURN_IF_ERROR(dwarf_reader->DetectSourceLanguage());
 
-  if (index) {
+  if (index_mode != DwarfIndexMode::kNone) {
+    Status s = dwarf_reader->LoadIndex();
+    if (!s.ok()) {
+      VLOG(1) << absl::Substitute("Not using cached DWARF index for $0: $1", obj_filename,
+                                  s.msg());
+    }
+  }
+
+  if (index_mode == DwarfIndexMode::kEager && !dwarf_reader->index_loaded_from_cache_) {
     dwarf_reader->IndexDIEs();
   }
 
+  if (index_mode == DwarfIndexMode::kLazy && !dwarf_reader->index_loaded_from_cache_) {
+    dwarf_reader->use_debug_names_ = dwarf_reader->DebugNamesCoversAllUnits();
+  }
+
   return dwarf_reader;
 }
 
 DwarfReader::DwarfReader(std::unique_ptr<llvm::MemoryBuffer> buffer,
-                         std::unique_ptr<llvm::DWARFContext> dwarf_context)
-    : memory_buffer_(std::move(buffer)), dwarf_context_(std::move(dwarf_context)) {
+                         std::unique_ptr<llvm::DWARFContext> dwarf_context,
+                         DwarfIndexMode index_mode)
+    : memory_buffer_(std::move(buffer)),
+      dwarf_context_(std::move(dwarf_context)),
+      index_mode_(index_mode) {
   // Only very first call will actually perform initialization.
   InitLLVMOnce();
 }
@@ -198,6 +282,35 @@ bool IsIndexedType(llvm::dwarf::Tag tag) {
 
 bool IsNamespace(llvm::dwarf::Tag tag) { return tag == llvm::dwarf::DW_TAG_namespace; }
 
+bool IsDeclaration(const DWARFDie& die) {
+  return llvm::dwarf::toUnsigned(die.find(llvm::dwarf::DW_AT_declaration), 0) != 0;
+}
+
+// Returns the name of the DIE, qualified by the names of its enclosing namespaces and types,
+// in the same way as the names used by DwarfReader::IndexCU().
+std::string QualifiedName(const DWARFDie& die) {
+  // Function definitions may be outside of their class, in which case the declaration has the
+  // qualifying parents.
+  DWARFDie named_die = die;
+  DWARFDie spec_die = die.getAttributeValueAsReferencedDie(llvm::dwarf::DW_AT_specification);
+  if (spec_die.isValid()) {
+    named_die = spec_die;
+  }
+
+  std::string name(GetShortName(die));
+  for (DWARFDie parent = named_die.getParent(); parent.isValid(); parent = parent.getParent()) {
+    if (!IsIndexedType(parent.getTag()) && !IsNamespace(parent.getTag())) {
+      break;
+    }
+    std::string_view parent_name = GetShortName(parent);
+    if (parent_name.empty()) {
+      break;
+    }
+    name = absl::StrCat(parent_name, "::", name);
+  }
+  return name;
+}
+
 }  // namespace
 
 Status DwarfReader::DetectSourceLanguage() {
@@ -221,84 +334,263 @@ Status DwarfReader::DetectSourceLanguage() {
 }
 
 void DwarfReader::IndexDIEs() {
-  DWARFContext::unit_iterator_range CUs = dwarf_context_->normal_units();
+  while (num_indexed_cus_ < dwarf_context_->getNumCompileUnits()) {
+    IndexCU(num_indexed_cus_++);
+  }
 
-  absl::flat_hash_map<const llvm::DWARFDebugInfoEntry*, std::string> dwarf_entry_names;
+  Status s = SaveIndex();
+  if (!s.ok()) {
+    VLOG(1) << absl::Substitute("Could not persist DWARF index: $0", s.msg());
+  }
+}
 
-  // Map from DW_AT_specification to DIE. Only DW_TAG_subprogram can have this attribute.
-  // Also only applies to CPP binaries.
-  absl::flat_hash_map<uint64_t, DWARFDie> fn_spec_offsets;
+void DwarfReader::IndexCU(uint32_t cu_idx) {
+  llvm::DWARFUnit* CU = dwarf_context_->getUnitAtIndex(cu_idx);
 
-  for (const auto& CU : CUs) {
-    for (const auto& Entry : CU->dies()) {
-      DWARFDie die = {CU.get(), &Entry};
+  absl::flat_hash_map<const llvm::DWARFDebugInfoEntry*, std::string> dwarf_entry_names;
 
-      if (die.isSubprogramDIE()) {
-        auto spec_or =
-            AdaptLLVMOptional(llvm::dwarf::toReference(die.find(llvm::dwarf::DW_AT_specification)),
-                              "Could not find attribute DW_AT_specification");
-        if (spec_or.ok()) {
-          fn_spec_offsets[spec_or.ValueOrDie()] = die;
-        }
+  for (const auto& Entry : CU->dies()) {
+    DWARFDie die = {CU, &Entry};
+
+    if (die.isSubprogramDIE()) {
+      // Map from DW_AT_specification to DIE. Only DW_TAG_subprogram can have this attribute.
+      // Also only applies to CPP binaries.
+      auto spec_or =
+          AdaptLLVMOptional(llvm::dwarf::toReference(die.find(llvm::dwarf::DW_AT_specification)),
+                            "Could not find attribute DW_AT_specification");
+      if (spec_or.ok()) {
+        fn_spec_offsets_[spec_or.ValueOrDie()] = die.getOffset();
+        // The definition is unnamed, and may be in another compile unit than the declarations
+        // of the function, so index it under the name of its declaration.
+        AddIndexEntry(llvm::dwarf::DW_TAG_subprogram, QualifiedName(die), die);
       }
+    }
 
-      // TODO(oazizi/yzhao): Change to use the demangled name of DW_AT_linkage_name as the key to
-      // index the function DIE. That removes the need of using manually-assembled names (through
-      // parent DIE).
+    // TODO(oazizi/yzhao): Change to use the demangled name of DW_AT_linkage_name as the key to
+    // index the function DIE. That removes the need of using manually-assembled names (through
+    // parent DIE).
 
-      auto name = std::string(GetShortName(die));
+    auto name = std::string(GetShortName(die));
 
-      if (name.empty()) {
-        continue;
-      }
+    if (name.empty()) {
+      continue;
+    }
 
-      llvm::dwarf::Tag tag = die.getTag();
+    llvm::dwarf::Tag tag = die.getTag();
 
-      if (IsIndexedType(tag) ||
-          // Namespace entry is processed here so that the name components can be generated.
-          IsNamespace(tag)) {
-        llvm::DWARFDie parent_die = die.getParent();
+    if (IsIndexedType(tag) ||
+        // Namespace entry is processed here so that the name components can be generated.
+        IsNamespace(tag)) {
+      llvm::DWARFDie parent_die = die.getParent();
 
-        if (parent_die.isValid()) {
-          const llvm::DWARFDebugInfoEntry* entry = parent_die.getDebugInfoEntry();
+      if (parent_die.isValid()) {
+        const llvm::DWARFDebugInfoEntry* entry = parent_die.getDebugInfoEntry();
 
-          if (entry != nullptr) {
-            auto iter = dwarf_entry_names.find(entry);
-            if (iter != dwarf_entry_names.end()) {
-              std::string_view parent_name = iter->second;
-              name = absl::StrCat(parent_name, "::", name);
-            }
+        if (entry != nullptr) {
+          auto iter = dwarf_entry_names.find(entry);
+          if (iter != dwarf_entry_names.end()) {
+            std::string_view parent_name = iter->second;
+            name = absl::StrCat(parent_name, "::", name);
           }
-          dwarf_entry_names[die.getDebugInfoEntry()] = name;
         }
+        dwarf_entry_names[die.getDebugInfoEntry()] = name;
+      }
 
-        if (IsIndexedType(tag)) {
-          auto& die_type_map = die_map_[tag];
+      if (IsIndexedType(tag)) {
+        AddIndexEntry(tag, name, die);
+      }
+    }
+  }
+}
 
-          // TODO(oazizi): What's the right way to deal with duplicate names?
-          // Only appears to happen with structs like the following:
-          //  ThreadStart, _IO_FILE, _IO_marker, G, in6_addr
-          // So probably okay for now. But need to be wary of this.
-          if (die_type_map.find(name) != die_type_map.end()) {
-            VLOG(1) << "Duplicate name: " << name;
-          }
-          die_type_map[name] = die;
-        }
+void DwarfReader::AddIndexEntry(llvm::dwarf::Tag tag, const std::string& name,
+                                const DWARFDie& die) {
+  auto [iter, inserted] = die_map_[tag].try_emplace(name, die.getOffset());
+  if (inserted) {
+    return;
+  }
+
+  // Duplicate names are mostly declarations in compile units that only use a type or function,
+  // and C structs like _IO_FILE that are defined in many compile units. Keep the first
+  // definition, which lazy indexing also finds first.
+  VLOG(1) << "Duplicate name: " << name;
+  if (IsDeclaration(dwarf_context_->getDIEForOffset(iter->second)) && !IsDeclaration(die)) {
+    iter->second = die.getOffset();
+  }
+}
+
+DWARFDie DwarfReader::ResolveIndexedDIE(llvm::dwarf::Tag tag, uint64_t offset) {
+  if (tag == llvm::dwarf::DW_TAG_subprogram) {
+    // Replace the DIE with the DW_TAG_subprogram die that has DW_AT_specification attribute.
+    auto spec_iter = fn_spec_offsets_.find(offset);
+    if (spec_iter != fn_spec_offsets_.end()) {
+      offset = spec_iter->second;
+    }
+  }
+  return dwarf_context_->getDIEForOffset(offset);
+}
+
+bool DwarfReader::DebugNamesCoversAllUnits() {
+  const llvm::DWARFDebugNames& debug_names = dwarf_context_->getDebugNames();
+  uint64_t num_cus = 0;
+  for (const llvm::DWARFDebugNames::NameIndex& name_index : debug_names) {
+    num_cus += name_index.getCUCount();
+  }
+  return num_cus != 0 && num_cus == dwarf_context_->getNumCompileUnits();
+}
+
+DWARFDie DwarfReader::FindDebugNamesDIE(std::string_view name, llvm::dwarf::Tag tag) {
+  // .debug_names is keyed by short names, so look up the last component of qualified names.
+  std::string_view short_name = name;
+  size_t pos = name.rfind("::");
+  if (pos != std::string_view::npos) {
+    short_name = name.substr(pos + 2);
+  }
+
+  // Pick among duplicates like AddIndexEntry(): the first definition, or else the first
+  // declaration, in .debug_info order.
+  DWARFDie result;
+  const llvm::DWARFDebugNames& debug_names = dwarf_context_->getDebugNames();
+  for (const llvm::DWARFDebugNames::Entry& entry :
+       debug_names.equal_range(llvm::StringRef(short_name.data(), short_name.size()))) {
+    if (entry.tag() != tag) {
+      continue;
+    }
+    llvm::Optional<uint64_t> cu_offset = entry.getCUOffset();
+    llvm::Optional<uint64_t> die_offset = entry.getDIEUnitOffset();
+    if (!cu_offset.hasValue() || !die_offset.hasValue()) {
+      continue;
+    }
+    DWARFDie die = dwarf_context_->getDIEForOffset(cu_offset.getValue() + die_offset.getValue());
+    if (!die.isValid() || QualifiedName(die) != name) {
+      continue;
+    }
+    if (!result.isValid() ||
+        std::make_pair(IsDeclaration(die), die.getOffset()) <
+            std::make_pair(IsDeclaration(result), result.getOffset())) {
+      result = die;
+    }
+  }
+  return result;
+}
+
+DWARFDie DwarfReader::FindIndexedDIE(std::string_view name, llvm::dwarf::Tag tag) {
+  while (true) {
+    const bool all_indexed = num_indexed_cus_ >= dwarf_context_->getNumCompileUnits();
+    auto& die_type_map = die_map_[tag];
+    auto iter = die_type_map.find(name);
+    if (iter != die_type_map.end()) {
+      DWARFDie die = ResolveIndexedDIE(tag, iter->second);
+      // The definition of a declaration may be in a compile unit that is not indexed yet.
+      if (all_indexed || !IsDeclaration(die)) {
+        return die;
+      }
+    } else if (use_debug_names_) {
+      return FindDebugNamesDIE(name, tag);
+    } else if (all_indexed) {
+      return {};
+    }
+
+    // Lazy mode: index the next compile unit, and try again.
+    IndexCU(num_indexed_cus_++);
+    if (num_indexed_cus_ == dwarf_context_->getNumCompileUnits()) {
+      Status s = SaveIndex();
+      if (!s.ok()) {
+        VLOG(1) << absl::Substitute("Could not persist DWARF index: $0", s.msg());
       }
     }
   }
+}
+
+namespace {
+constexpr std::string_view kIndexFileHeader = "px_dwarf_index_v2";
+}  // namespace
+
+std::filesystem::path DwarfReader::IndexCacheFile() const {
+  if (FLAGS_stirling_dwarf_index_cache_dir.empty() || build_id_.empty()) {
+    return {};
+  }
+  return std::filesystem::path(FLAGS_stirling_dwarf_index_cache_dir) /
+         absl::StrCat(build_id_, ".dwarf_index");
+}
+
+// The index file is a text file, with a header line, followed by one line per entry:
+//   <tag> <offset> <name>      for an indexed DIE.
+//   spec <offset> <offset>     for a function declaration and its definition.
+Status DwarfReader::SaveIndex() const {
+  std::filesystem::path file = IndexCacheFile();
+  if (file.empty()) {
+    return Status::OK();
+  }
+
+  std::string contents =
+      absl::StrCat(kIndexFileHeader, " ", dwarf_context_->getNumCompileUnits(), "\n");
+  for (const auto& [tag, die_type_map] : die_map_) {
+    for (const auto& [name, offset] : die_type_map) {
+      absl::StrAppend(&contents, static_cast<int>(tag), " ", offset, " ", name, "\n");
+    }
+  }
+  for (const auto& [decl_offset, def_offset] : fn_spec_offsets_) {
+    absl::StrAppend(&contents, "spec ", decl_offset, " ", def_offset, "\n");
+  }
+
+  // Write to a temporary file first, so that concurrent readers never see a partial index.
+  std::error_code ec;
+  std::filesystem::create_directories(file.parent_path(), ec);
+  std::filesystem::path tmp_file = file;
+  tmp_file += absl::StrCat(".tmp.", getpid(), ".", reinterpret_cast<uintptr_t>(this));
+  PL_RETURN_IF_ERROR(WriteFileFromString(tmp_file.string(), contents));
+  std::filesystem::rename(tmp_file, file, ec);
+  if (ec) {
+    std::filesystem::remove(tmp_file, ec);
+    return error::Internal("Could not write $0: $1", file.string(), ec.message());
+  }
+  return Status::OK();
+}
+
+Status DwarfReader::LoadIndex() {
+  std::filesystem::path file = IndexCacheFile();
+  if (file.empty() || !std::filesystem::exists(file)) {
+    return Status::OK();
+  }
 
-  auto& fn_dies = die_map_[llvm::dwarf::DW_TAG_subprogram];
+  PL_ASSIGN_OR_RETURN(std::string contents, ReadFileToString(file.string()));
+  std::istringstream stream(contents);
 
-  for (auto iter = fn_dies.begin(); iter != fn_dies.end(); ++iter) {
-    uint64_t offset = iter->second.getOffset();
-    auto spec_iter = fn_spec_offsets.find(offset);
-    if (spec_iter == fn_spec_offsets.end()) {
+  std::string header;
+  uint32_t num_cus = 0;
+  stream >> header >> num_cus;
+  if (header != kIndexFileHeader || num_cus != dwarf_context_->getNumCompileUnits()) {
+    return error::Internal("Index file $0 does not match the binary.", file.string());
+  }
+
+  absl::flat_hash_map<llvm::dwarf::Tag, absl::flat_hash_map<std::string, uint64_t>> die_map;
+  absl::flat_hash_map<uint64_t, uint64_t> fn_spec_offsets;
+  std::string type;
+  while (stream >> type) {
+    uint64_t offset = 0;
+    if (type == "spec") {
+      uint64_t def_offset = 0;
+      stream >> offset >> def_offset;
+      fn_spec_offsets[offset] = def_offset;
       continue;
     }
-    // Replace the DIE with the DW_TAG_subprogram die that has DW_AT_specification attribute.
-    iter->second = spec_iter->second;
+
+    int tag = 0;
+    std::string name;
+    if (!absl::SimpleAtoi(type, &tag) || !(stream >> offset) || !std::getline(stream, name) ||
+        name.size() < 2) {
+      return error::Internal("Index file $0 is corrupted.", file.string());
+    }
+    // Drop the separator.
+    die_map[static_cast<llvm::dwarf::Tag>(tag)][name.substr(1)] = offset;
   }
+
+  die_map_ = std::move(die_map);
+  fn_spec_offsets_ = std::move(fn_spec_offsets);
+  num_indexed_cus_ = num_cus;
+  index_loaded_from_cache_ = true;
+  return Status::OK();
 }
 
 StatusOr<std::vector<DWARFDie>> DwarfReader::GetMatchingDIEs(std::string_view name,
@@ -307,13 +599,12 @@ StatusOr<std::vector<DWARFDie>> DwarfReader::GetMatchingDIEs(std::string_view na
   std::vector<DWARFDie> dies;
 
   // Special case for types that are indexed.
-  if (type.has_value() && !die_map_.empty()) {
+  if (type.has_value() && index_mode_ != DwarfIndexMode::kNone) {
     llvm::dwarf::Tag tag = type.value();
     if (IsIndexedType(tag)) {
-      auto& die_type_map = die_map_[tag];
-      auto iter = die_type_map.find(name);
-      if (iter != die_type_map.end()) {
-        return std::vector<DWARFDie>{iter->second};
+      DWARFDie die = FindIndexedDIE(name, tag);
+      if (die.isValid()) {
+        return std::vector<DWARFDie>{die};
       }
 
       // Indexing was on, but nothing was found, so return empty vector.
@@ -23,6 +23,7 @@
 
 #include <absl/container/flat_hash_map.h>
 
+#include <filesystem>
 #include <limits>
 #include <map>
 #include <memory>
@@ -32,6 +33,8 @@
 
 #include "src/common/base/base.h"
 
+DECLARE_string(stirling_dwarf_index_cache_dir);
+
 namespace px {
 namespace stirling {
 namespace obj_tools {
@@ -163,17 +166,34 @@ inline bool operator==(const StructSpecEntry& a, const StructSpecEntry& b) {
 // DwarfReader
 //-----------------------------------------------------------------------------
 
+// Controls how DwarfReader indexes the DIEs of commonly looked-up types (structs and functions).
+enum class DwarfIndexMode {
+  // No index; every lookup scans all compile units.
+  kNone,
+
+  // Index all compile units on creation. Best when many different lookups are made.
+  kEager,
+
+  // Index on demand: use the .debug_names accelerator table if it covers the binary, otherwise
+  // index compile units one at a time until the looked-up name is found. Best for large binaries
+  // on which only a few lookups are made (e.g. uprobe deployment on Go binaries).
+  kLazy,
+};
+
 class DwarfReader {
  public:
   /**
    * Creates a DwarfReader that provides access to DWARF Debugging information entries (DIEs).
    * @param obj_filename The object file from which to read DWARF information.
-   * @param index If true, creates an index to speed up accesses when called more than once.
+   * @param index_mode How to index DIEs, to speed up accesses when called more than once.
+   *                   When --stirling_dwarf_index_cache_dir is set, a complete index is persisted
+   *                   there keyed by the build-id of the object file, and later loaded instead of
+   *                   being recomputed.
    * @return error if file does not exist or is not a valid object file. Otherwise returns
    * a unique pointer to a DwarfReader.
    */
-  static StatusOr<std::unique_ptr<DwarfReader>> Create(std::string_view obj_filename,
-                                                       bool index = true);
+  static StatusOr<std::unique_ptr<DwarfReader>> Create(
+      std::string_view obj_filename, DwarfIndexMode index_mode = DwarfIndexMode::kEager);
 
   /**
    * Searches the debug information for Debugging information entries (DIEs)
@@ -289,9 +309,19 @@ class DwarfReader {
 
   const llvm::dwarf::SourceLanguage& source_language() const { return source_language_; }
 
+  /**
+   * The build-id of the object file (GNU or Go), as a hex string. Empty if there is none.
+   */
+  const std::string& build_id() const { return build_id_; }
+
+  /**
+   * Returns true if the index was loaded from the index cache directory.
+   */
+  bool index_loaded_from_cache() const { return index_loaded_from_cache_; }
+
  private:
   DwarfReader(std::unique_ptr<llvm::MemoryBuffer> buffer,
-              std::unique_ptr<llvm::DWARFContext> dwarf_context);
+              std::unique_ptr<llvm::DWARFContext> dwarf_context, DwarfIndexMode index_mode);
 
   // Detects the source language of the dwarf content being read.
   Status DetectSourceLanguage();
@@ -300,6 +330,33 @@ class DwarfReader {
   // When making multiple DwarfReader calls, this speeds up the process at the cost of some memory.
   void IndexDIEs();
 
+  // Adds the DIEs of the compile unit at the given index to the index.
+  void IndexCU(uint32_t cu_idx);
+
+  // Indexes the DIE under the name. Of several DIEs with the same name, definitions are preferred
+  // over declarations, and otherwise the first one is kept, so that lazy and eager indexing agree.
+  void AddIndexEntry(llvm::dwarf::Tag tag, const std::string& name, const llvm::DWARFDie& die);
+
+  // Returns the indexed DIE with the given name, indexing more compile units if required in lazy
+  // mode, including while only a declaration of the name has been found. Returns an invalid DIE
+  // if there is no such DIE.
+  llvm::DWARFDie FindIndexedDIE(std::string_view name, llvm::dwarf::Tag tag);
+
+  // Looks up the name in the .debug_names accelerator table.
+  llvm::DWARFDie FindDebugNamesDIE(std::string_view name, llvm::dwarf::Tag tag);
+
+  // Returns the DIE at the indexed offset, after resolving function declarations to their
+  // definitions.
+  llvm::DWARFDie ResolveIndexedDIE(llvm::dwarf::Tag tag, uint64_t offset);
+
+  // Returns true if .debug_names exists and covers all compile units.
+  bool DebugNamesCoversAllUnits();
+
+  // Persists a complete index to, or loads it from, the index cache directory.
+  std::filesystem::path IndexCacheFile() const;
+  Status SaveIndex() const;
+  Status LoadIndex();
+
   static Status GetMatchingDIEs(llvm::DWARFContext::unit_iterator_range CUs, std::string_view name,
                                 std::optional<llvm::dwarf::Tag> tag,
                                 std::vector<llvm::DWARFDie>* dies_out);
@@ -316,8 +373,26 @@ class DwarfReader {
   std::unique_ptr<llvm::MemoryBuffer> memory_buffer_;
   std::unique_ptr<llvm::DWARFContext> dwarf_context_;
 
-  // Nested map: [tag][symbol_name] -> DWARFDie
-  absl::flat_hash_map<llvm::dwarf::Tag, absl::flat_hash_map<std::string, llvm::DWARFDie>> die_map_;
+  DwarfIndexMode index_mode_;
+
+  std::string build_id_;
+
+  // Nested map: [tag][symbol_name] -> offset of the DIE in .debug_info.
+  // Offsets rather than DWARFDie objects are stored, so that the index can be persisted, and so
+  // that compile units are only parsed when one of their DIEs is actually used.
+  absl::flat_hash_map<llvm::dwarf::Tag, absl::flat_hash_map<std::string, uint64_t>> die_map_;
+
+  // Map from the offset of a function declaration to the offset of its definition DIE (which has
+  // the DW_AT_specification attribute). Only applies to C++ binaries.
+  absl::flat_hash_map<uint64_t, uint64_t> fn_spec_offsets_;
+
+  // Compile units with index below this have been indexed.
+  uint32_t num_indexed_cus_ = 0;
+
+  // Whether lookups should use the .debug_names accelerator table in lazy mode.
+  bool use_debug_names_ = false;
+
+  bool index_loaded_from_cache_ = false;
 };
 
 //-----------------------------------------------------------------------------
@@ -18,6 +18,7 @@
 
 #include "src/stirling/obj_tools/dwarf_tools.h"
 
+#include "src/common/testing/temp_dir.h"
 #include "src/common/testing/test_environment.h"
 #include "src/common/testing/testing.h"
 
@@ -26,6 +27,7 @@ constexpr std::string_view kDummyGoBinary =
 constexpr std::string_view kGoGRPCServer =
     "src/stirling/testing/demo_apps/go_grpc_tls_pl/server/server_/server";
 constexpr std::string_view kCppBinary = "src/stirling/obj_tools/testdata/dummy_exe";
+constexpr std::string_view kCppMultiCUBinary = "src/stirling/obj_tools/testdata/multi_cu_exe";
 constexpr std::string_view kGoBinaryUnconventional =
     "src/stirling/obj_tools/testdata/sockshop_payments_service";
 
@@ -35,14 +37,16 @@ namespace obj_tools {
 
 using ::llvm::DWARFDie;
 using ::px::stirling::obj_tools::DwarfReader;
+using ::testing::Contains;
 using ::testing::ElementsAre;
 using ::testing::IsEmpty;
+using ::testing::Key;
 using ::testing::Pair;
 using ::testing::SizeIs;
 using ::testing::UnorderedElementsAre;
 
 struct DwarfReaderTestParam {
-  bool index;
+  DwarfIndexMode index_mode;
 };
 
 class DwarfReaderTest : public ::testing::TestWithParam<DwarfReaderTestParam> {
@@ -66,7 +70,7 @@ TEST_F(DwarfReaderTest, NonExistentPath) {
 
 TEST_F(DwarfReaderTest, SourceLanguage) {
   ASSERT_OK_AND_ASSIGN(std::unique_ptr<DwarfReader> dwarf_reader,
-                       DwarfReader::Create(kCppBinaryPath, /*index*/ true));
+                       DwarfReader::Create(kCppBinaryPath, DwarfIndexMode::kEager));
   // We use C++17, but the dwarf shows 14.
   EXPECT_EQ(dwarf_reader->source_language(), llvm::dwarf::DW_LANG_C_plus_plus_14);
 }
@@ -110,7 +114,7 @@ TEST_F(DwarfReaderTest, GetMatchingDIEs) {
 TEST_P(DwarfReaderTest, CppGetStructByteSize) {
   DwarfReaderTestParam p = GetParam();
   ASSERT_OK_AND_ASSIGN(std::unique_ptr<DwarfReader> dwarf_reader,
-                       DwarfReader::Create(kCppBinaryPath, p.index));
+                       DwarfReader::Create(kCppBinaryPath, p.index_mode));
 
   EXPECT_OK_AND_EQ(dwarf_reader->GetStructByteSize("ABCStruct32"), 12);
   EXPECT_OK_AND_EQ(dwarf_reader->GetStructByteSize("ABCStruct64"), 24);
@@ -119,7 +123,7 @@ TEST_P(DwarfReaderTest, CppGetStructByteSize) {
 TEST_P(DwarfReaderTest, GolangGetStructByteSize) {
   DwarfReaderTestParam p = GetParam();
   ASSERT_OK_AND_ASSIGN(std::unique_ptr<DwarfReader> dwarf_reader,
-                       DwarfReader::Create(kGoBinaryPath, p.index));
+                       DwarfReader::Create(kGoBinaryPath, p.index_mode));
 
   EXPECT_OK_AND_EQ(dwarf_reader->GetStructByteSize("main.Vertex"), 16);
 }
@@ -127,7 +131,7 @@ TEST_P(DwarfReaderTest, GolangGetStructByteSize) {
 TEST_P(DwarfReaderTest, CppGetStructMemberInfo) {
   DwarfReaderTestParam p = GetParam();
   ASSERT_OK_AND_ASSIGN(std::unique_ptr<DwarfReader> dwarf_reader,
-                       DwarfReader::Create(kCppBinaryPath, p.index));
+                       DwarfReader::Create(kCppBinaryPath, p.index_mode));
 
   EXPECT_OK_AND_EQ(dwarf_reader->GetStructMemberInfo("ABCStruct32", "b"),
                    (StructMemberInfo{4, TypeInfo{VarType::kBaseType, "int"}}));
@@ -137,7 +141,7 @@ TEST_P(DwarfReaderTest, CppGetStructMemberInfo) {
 TEST_P(DwarfReaderTest, GoGetStructMemberInfo) {
   DwarfReaderTestParam p = GetParam();
   ASSERT_OK_AND_ASSIGN(std::unique_ptr<DwarfReader> dwarf_reader,
-                       DwarfReader::Create(kGoBinaryPath, p.index));
+                       DwarfReader::Create(kGoBinaryPath, p.index_mode));
 
   EXPECT_OK_AND_EQ(dwarf_reader->GetStructMemberInfo("main.Vertex", "Y"),
                    (StructMemberInfo{8, TypeInfo{VarType::kBaseType, "float64"}}));
@@ -147,7 +151,7 @@ TEST_P(DwarfReaderTest, GoGetStructMemberInfo) {
 TEST_P(DwarfReaderTest, CppGetStructMemberOffset) {
   DwarfReaderTestParam p = GetParam();
   ASSERT_OK_AND_ASSIGN(std::unique_ptr<DwarfReader> dwarf_reader,
-                       DwarfReader::Create(kCppBinaryPath, p.index));
+                       DwarfReader::Create(kCppBinaryPath, p.index_mode));
 
   EXPECT_OK_AND_EQ(dwarf_reader->GetStructMemberOffset("ABCStruct32", "a"), 0);
   EXPECT_OK_AND_EQ(dwarf_reader->GetStructMemberOffset("ABCStruct32", "b"), 4);
@@ -157,7 +161,7 @@ TEST_P(DwarfReaderTest, CppGetStructMemberOffset) {
 TEST_P(DwarfReaderTest, GoGetStructMemberOffset) {
   DwarfReaderTestParam p = GetParam();
   ASSERT_OK_AND_ASSIGN(std::unique_ptr<DwarfReader> dwarf_reader,
-                       DwarfReader::Create(kGoBinaryPath, p.index));
+                       DwarfReader::Create(kGoBinaryPath, p.index_mode));
 
   EXPECT_OK_AND_EQ(dwarf_reader->GetStructMemberOffset("main.Vertex", "Y"), 8);
   EXPECT_NOT_OK(dwarf_reader->GetStructMemberOffset("main.Vertex", "bogus"));
@@ -167,7 +171,7 @@ TEST_P(DwarfReaderTest, GoGetStructMemberOffset) {
 TEST_P(DwarfReaderTest, GetStructMemberOffsetUnconventional) {
   DwarfReaderTestParam p = GetParam();
   ASSERT_OK_AND_ASSIGN(std::unique_ptr<DwarfReader> dwarf_reader,
-                       DwarfReader::Create(kGoBinaryUnconventionalPath, p.index));
+                       DwarfReader::Create(kGoBinaryUnconventionalPath, p.index_mode));
 
   EXPECT_OK_AND_EQ(dwarf_reader->GetStructMemberOffset("runtime.g", "goid"), 192);
 }
@@ -175,7 +179,7 @@ TEST_P(DwarfReaderTest, GetStructMemberOffsetUnconventional) {
 TEST_P(DwarfReaderTest, CppGetStructSpec) {
   DwarfReaderTestParam p = GetParam();
   ASSERT_OK_AND_ASSIGN(std::unique_ptr<DwarfReader> dwarf_reader,
-                       DwarfReader::Create(kCppBinaryPath, p.index));
+                       DwarfReader::Create(kCppBinaryPath, p.index_mode));
 
   EXPECT_OK_AND_EQ(
       dwarf_reader->GetStructSpec("OuterStruct"),
@@ -220,7 +224,7 @@ TEST_P(DwarfReaderTest, CppGetStructSpec) {
 TEST_P(DwarfReaderTest, GoGetStructSpec) {
   DwarfReaderTestParam p = GetParam();
   ASSERT_OK_AND_ASSIGN(std::unique_ptr<DwarfReader> dwarf_reader,
-                       DwarfReader::Create(kGoBinaryPath, p.index));
+                       DwarfReader::Create(kGoBinaryPath, p.index_mode));
 
   EXPECT_OK_AND_EQ(
       dwarf_reader->GetStructSpec("main.OuterStruct"),
@@ -265,7 +269,7 @@ TEST_P(DwarfReaderTest, GoGetStructSpec) {
 TEST_P(DwarfReaderTest, CppArgumentTypeByteSize) {
   DwarfReaderTestParam p = GetParam();
   ASSERT_OK_AND_ASSIGN(std::unique_ptr<DwarfReader> dwarf_reader,
-                       DwarfReader::Create(kCppBinaryPath, p.index));
+                       DwarfReader::Create(kCppBinaryPath, p.index_mode));
 
   EXPECT_OK_AND_EQ(dwarf_reader->GetArgumentTypeByteSize("CanYouFindThis", "a"), 4);
   EXPECT_OK_AND_EQ(dwarf_reader->GetArgumentTypeByteSize("ABCSum32", "x"), 12);
@@ -276,7 +280,7 @@ TEST_P(DwarfReaderTest, CppArgumentTypeByteSize) {
 TEST_P(DwarfReaderTest, GolangArgumentTypeByteSize) {
   DwarfReaderTestParam p = GetParam();
   ASSERT_OK_AND_ASSIGN(std::unique_ptr<DwarfReader> dwarf_reader,
-                       DwarfReader::Create(kGoBinaryPath, p.index));
+                       DwarfReader::Create(kGoBinaryPath, p.index_mode));
 
   // v is of type *Vertex.
   EXPECT_OK_AND_EQ(dwarf_reader->GetArgumentTypeByteSize("main.(*Vertex).Scale", "v"), 8);
@@ -289,7 +293,7 @@ TEST_P(DwarfReaderTest, GolangArgumentTypeByteSize) {
 TEST_P(DwarfReaderTest, CppArgumentLocation) {
   DwarfReaderTestParam p = GetParam();
   ASSERT_OK_AND_ASSIGN(std::unique_ptr<DwarfReader> dwarf_reader,
-                       DwarfReader::Create(kCppBinaryPath, p.index));
+                       DwarfReader::Create(kCppBinaryPath, p.index_mode));
 
   EXPECT_OK_AND_EQ(dwarf_reader->GetArgumentLocation("ABCSum32", "x"),
                    (ArgLocation{.loc_type = LocationType::kRegister, .offset = 32}));
@@ -308,7 +312,7 @@ TEST_P(DwarfReaderTest, CppArgumentLocation) {
 TEST_P(DwarfReaderTest, GolangArgumentLocation) {
   DwarfReaderTestParam p = GetParam();
   ASSERT_OK_AND_ASSIGN(std::unique_ptr<DwarfReader> dwarf_reader,
-                       DwarfReader::Create(kGoBinaryPath, p.index));
+                       DwarfReader::Create(kGoBinaryPath, p.index_mode));
 
   EXPECT_OK_AND_EQ(dwarf_reader->GetArgumentLocation("main.(*Vertex).Scale", "v"),
                    (ArgLocation{.loc_type = LocationType::kStack, .offset = 0}));
@@ -330,7 +334,7 @@ TEST_P(DwarfReaderTest, GolangArgumentLocation) {
 TEST_P(DwarfReaderTest, CppFunctionArgInfo) {
   DwarfReaderTestParam p = GetParam();
   ASSERT_OK_AND_ASSIGN(std::unique_ptr<DwarfReader> dwarf_reader,
-                       DwarfReader::Create(kCppBinaryPath, p.index));
+                       DwarfReader::Create(kCppBinaryPath, p.index_mode));
 
   EXPECT_OK_AND_THAT(
       dwarf_reader->GetFunctionArgInfo("CanYouFindThis"),
@@ -356,7 +360,7 @@ TEST_P(DwarfReaderTest, CppFunctionArgInfo) {
 TEST_P(DwarfReaderTest, CppFunctionRetValInfo) {
   DwarfReaderTestParam p = GetParam();
   ASSERT_OK_AND_ASSIGN(std::unique_ptr<DwarfReader> dwarf_reader,
-                       DwarfReader::Create(kCppBinaryPath, p.index));
+                       DwarfReader::Create(kCppBinaryPath, p.index_mode));
 
   EXPECT_OK_AND_EQ(dwarf_reader->GetFunctionRetValInfo("CanYouFindThis"),
                    (RetValInfo{TypeInfo{VarType::kBaseType, "int"}, 4}));
@@ -371,7 +375,7 @@ TEST_P(DwarfReaderTest, GoFunctionArgInfo) {
 
   {
     ASSERT_OK_AND_ASSIGN(std::unique_ptr<DwarfReader> dwarf_reader,
-                         DwarfReader::Create(kGoBinaryPath, p.index));
+                         DwarfReader::Create(kGoBinaryPath, p.index_mode));
 
     EXPECT_OK_AND_THAT(
         dwarf_reader->GetFunctionArgInfo("main.(*Vertex).Scale"),
@@ -420,7 +424,7 @@ TEST_P(DwarfReaderTest, GoFunctionArgInfo) {
 
   {
     ASSERT_OK_AND_ASSIGN(std::unique_ptr<DwarfReader> dwarf_reader,
-                         DwarfReader::Create(kGoServerBinaryPath, p.index));
+                         DwarfReader::Create(kGoServerBinaryPath, p.index_mode));
 
     //   func (f *http2Framer) WriteDataPadded(streamID uint32, endStream bool, data, pad []byte)
     //   error
@@ -447,7 +451,7 @@ TEST_P(DwarfReaderTest, GoFunctionArgLocationConsistency) {
   DwarfReaderTestParam p = GetParam();
 
   ASSERT_OK_AND_ASSIGN(std::unique_ptr<DwarfReader> dwarf_reader,
-                       DwarfReader::Create(kGoBinaryPath, p.index));
+                       DwarfReader::Create(kGoBinaryPath, p.index_mode));
 
   // First run GetFunctionArgInfo to automatically get all arguments.
   ASSERT_OK_AND_ASSIGN(auto function_arg_locations,
@@ -465,9 +469,65 @@ TEST_P(DwarfReaderTest, GoFunctionArgLocationConsistency) {
   }
 }
 
+TEST_F(DwarfReaderTest, IndexCache) {
+  constexpr std::string_view kStruct = "net/http.http2writeResHeaders";
+  constexpr std::string_view kFunction = "net/http.(*http2Framer).WriteDataPadded";
+
+  px::testing::TempDir cache_dir;
+  const std::string orig_cache_dir = FLAGS_stirling_dwarf_index_cache_dir;
+  FLAGS_stirling_dwarf_index_cache_dir = cache_dir.path().string();
+
+  ASSERT_OK_AND_ASSIGN(std::unique_ptr<DwarfReader> dwarf_reader,
+                       DwarfReader::Create(kGoServerBinaryPath, DwarfIndexMode::kEager));
+  ASSERT_FALSE(dwarf_reader->build_id().empty());
+  EXPECT_FALSE(dwarf_reader->index_loaded_from_cache());
+  ASSERT_OK_AND_ASSIGN(uint64_t expected_offset,
+                       dwarf_reader->GetStructMemberOffset(kStruct, "streamID"));
+  ASSERT_OK_AND_ASSIGN(auto expected_args, dwarf_reader->GetFunctionArgInfo(kFunction));
+
+  for (DwarfIndexMode mode : {DwarfIndexMode::kEager, DwarfIndexMode::kLazy}) {
+    ASSERT_OK_AND_ASSIGN(std::unique_ptr<DwarfReader> cached_dwarf_reader,
+                         DwarfReader::Create(kGoServerBinaryPath, mode));
+    EXPECT_TRUE(cached_dwarf_reader->index_loaded_from_cache());
+    EXPECT_OK_AND_EQ(cached_dwarf_reader->GetStructMemberOffset(kStruct, "streamID"),
+                     expected_offset);
+    EXPECT_NOT_OK(cached_dwarf_reader->GetStructMemberOffset(kStruct, "bogus"));
+    EXPECT_OK_AND_EQ(cached_dwarf_reader->GetFunctionArgInfo(kFunction), expected_args);
+  }
+
+  FLAGS_stirling_dwarf_index_cache_dir = orig_cache_dir;
+}
+
+// The first compile unit only declares the struct and the member function, so lazy indexing has
+// to go on to the second compile unit, and pick the same definitions as eager indexing.
+TEST_F(DwarfReaderTest, MultiCUDeclarationsResolveToDefinitions) {
+  const std::string path = px::testing::BazelBinTestFilePath(kCppMultiCUBinary);
+
+  std::vector<uint64_t> offsets;
+  for (DwarfIndexMode mode : {DwarfIndexMode::kEager, DwarfIndexMode::kLazy}) {
+    ASSERT_OK_AND_ASSIGN(std::unique_ptr<DwarfReader> dwarf_reader,
+                         DwarfReader::Create(path, mode));
+    EXPECT_OK_AND_EQ(dwarf_reader->GetStructByteSize("MultiCUStruct"), 8);
+    ASSERT_OK_AND_ASSIGN(auto args, dwarf_reader->GetFunctionArgInfo("MultiCUClass::Method"));
+    EXPECT_THAT(args, Contains(Key("a")));
+    EXPECT_THAT(args, Contains(Key("b")));
+
+    ASSERT_OK_AND_ASSIGN(
+        DWARFDie struct_die,
+        dwarf_reader->GetMatchingDIE("MultiCUStruct", llvm::dwarf::DW_TAG_structure_type));
+    ASSERT_OK_AND_ASSIGN(
+        DWARFDie fn_die,
+        dwarf_reader->GetMatchingDIE("MultiCUClass::Method", llvm::dwarf::DW_TAG_subprogram));
+    offsets.push_back(struct_die.getOffset());
+    offsets.push_back(fn_die.getOffset());
+  }
+  EXPECT_THAT(offsets, ElementsAre(offsets[0], offsets[1], offsets[0], offsets[1]));
+}
+
 INSTANTIATE_TEST_SUITE_P(DwarfReaderParameterizedTest, DwarfReaderTest,
-                         ::testing::Values(DwarfReaderTestParam{true},
-                                           DwarfReaderTestParam{false}));
+                         ::testing::Values(DwarfReaderTestParam{DwarfIndexMode::kEager},
+                                           DwarfReaderTestParam{DwarfIndexMode::kLazy},
+                                           DwarfReaderTestParam{DwarfIndexMode::kNone}));
 
 }  // namespace obj_tools
 }  // namespace stirling
@@ -19,10 +19,13 @@
 #include "src/stirling/obj_tools/elf_tools.h"
 
 #include <llvm-c/Disassembler.h>
+#include <llvm/Demangle/Demangle.h>
 #include <llvm/MC/MCDisassembler/MCDisassembler.h>
 #include <llvm/Support/TargetSelect.h>
 
 #include <absl/container/flat_hash_set.h>
+#include <algorithm>
+#include <fstream>
 #include <set>
 #include <utility>
 
@@ -46,7 +49,7 @@ struct LowercaseHex {
 }  // namespace
 
 Status ElfReader::LocateDebugSymbols(const std::filesystem::path& debug_file_dir) {
-  std::string build_id;
+  std::string& build_id = build_id_;
   std::string debug_link;
   bool found_symtab = false;
 
@@ -274,6 +277,66 @@ StatusOr<std::vector<ElfReader::SymbolInfo>> ElfReader::ListFuncSymbols(
   return symbol_infos;
 }
 
+ElfReader::Symbolizer::Symbolizer(std::vector<SymbolInfo> symbols) : symbols_(std::move(symbols)) {
+  std::sort(symbols_.begin(), symbols_.end(),
+            [](const SymbolInfo& a, const SymbolInfo& b) { return a.address < b.address; });
+}
+
+std::string_view ElfReader::Symbolizer::Lookup(uint64_t addr) const {
+  // Find the last symbol that starts at or before addr.
+  auto iter = std::upper_bound(symbols_.begin(), symbols_.end(), addr,
+                               [](uint64_t a, const SymbolInfo& s) { return a < s.address; });
+  if (iter == symbols_.begin()) {
+    return {};
+  }
+  --iter;
+  // Symbols without a size only match their start address.
+  if (addr >= iter->address + std::max<uint64_t>(iter->size, 1)) {
+    return {};
+  }
+  return iter->name;
+}
+
+StatusOr<std::unique_ptr<ElfReader::Symbolizer>> ElfReader::GetSymbolizer() {
+  PL_ASSIGN_OR_RETURN(std::vector<SymbolInfo> symbol_infos,
+                      SearchSymbols("", SymbolMatchType::kSubstr, ELFIO::STT_FUNC));
+  for (auto& symbol_info : symbol_infos) {
+    symbol_info.name = llvm::demangle(symbol_info.name);
+  }
+  return std::make_unique<Symbolizer>(std::move(symbol_infos));
+}
+
+StatusOr<int64_t> ElfReader::ExecutableSegmentVirtualAddrOffset() const {
+  // Segments are read from the binary itself; the ELFIO reader skips them, and might also
+  // be reading an external debug symbols file.
+  std::ifstream ifs(binary_path_, std::ios::binary);
+  if (!ifs) {
+    return error::Internal("Could not open $0", binary_path_);
+  }
+
+  ELFIO::Elf64_Ehdr ehdr;
+  if (!ifs.read(reinterpret_cast<char*>(&ehdr), sizeof(ehdr)) ||
+      ehdr.e_ident[ELFIO::EI_MAG0] != ELFIO::ELFMAG0 ||
+      ehdr.e_ident[ELFIO::EI_MAG1] != ELFIO::ELFMAG1 ||
+      ehdr.e_ident[ELFIO::EI_MAG2] != ELFIO::ELFMAG2 ||
+      ehdr.e_ident[ELFIO::EI_MAG3] != ELFIO::ELFMAG3 ||
+      ehdr.e_ident[ELFIO::EI_CLASS] != ELFIO::ELFCLASS64) {
+    return error::Internal("$0 is not a 64-bit ELF file", binary_path_);
+  }
+
+  for (int i = 0; i < ehdr.e_phnum; ++i) {
+    ELFIO::Elf64_Phdr phdr;
+    ifs.seekg(ehdr.e_phoff + i * ehdr.e_phentsize);
+    if (!ifs.read(reinterpret_cast<char*>(&phdr), sizeof(phdr))) {
+      return error::Internal("Could not read program headers of $0", binary_path_);
+    }
+    if (phdr.p_type == ELFIO::PT_LOAD && (phdr.p_flags & ELFIO::PF_X)) {
+      return static_cast<int64_t>(phdr.p_vaddr) - static_cast<int64_t>(phdr.p_offset);
+    }
+  }
+  return error::NotFound("Could not find an executable segment in $0", binary_path_);
+}
+
 std::optional<int64_t> ElfReader::SymbolAddress(std::string_view symbol) {
   auto symbol_infos_or = SearchSymbols(symbol, SymbolMatchType::kExact);
   if (symbol_infos_or.ok()) {
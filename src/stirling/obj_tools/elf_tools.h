@@ -62,6 +62,12 @@ class ElfReader {
 
   std::filesystem::path& debug_symbols_path() { return debug_symbols_path_; }
 
+  /**
+   * Returns the build-id of the binary as a lowercase hex string, or an empty string if the
+   * binary has no build-id.
+   */
+  const std::string& build_id() const { return build_id_; }
+
   struct SymbolInfo {
     std::string name;
     int type = -1;
@@ -100,6 +106,38 @@ class ElfReader {
    */
   StatusOr<std::vector<uint64_t>> FuncRetInstAddrs(const SymbolInfo& func_symbol);
 
+  /**
+   * An address to symbol lookup table for the function symbols of a binary.
+   * The symbols are kept sorted by address, so that a lookup is a binary search.
+   */
+  class Symbolizer {
+   public:
+    explicit Symbolizer(std::vector<SymbolInfo> symbols);
+
+    /**
+     * Returns the name of the function containing the given virtual address,
+     * or an empty string_view if no function contains it.
+     */
+    std::string_view Lookup(uint64_t addr) const;
+
+    size_t num_symbols() const { return symbols_.size(); }
+
+   private:
+    std::vector<SymbolInfo> symbols_;
+  };
+
+  /**
+   * Returns a Symbolizer for the function symbols of the binary, with demangled names.
+   */
+  StatusOr<std::unique_ptr<Symbolizer>> GetSymbolizer();
+
+  /**
+   * Returns the difference between the virtual address and the file offset of the executable
+   * segment of the binary. Adding it to a file offset (e.g. one computed from /proc/<pid>/maps)
+   * gives the virtual address used by the symbols.
+   */
+  StatusOr<int64_t> ExecutableSegmentVirtualAddrOffset() const;
+
  private:
   ElfReader() = default;
 
@@ -121,6 +159,8 @@ class ElfReader {
 
   std::filesystem::path debug_symbols_path_;
 
+  std::string build_id_;
+
   // Set up an elf reader, so we can extract debug symbols.
   ELFIO::elfio elf_reader_;
 };
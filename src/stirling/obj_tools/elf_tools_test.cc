@@ -89,6 +89,21 @@ TEST(ElfReaderTest, ListSymbolsSuffixMatch) {
                      ElementsAre(SymbolNameIs("CanYouFindThis")));
 }
 
+TEST(ElfReaderTest, Symbolizer) {
+  ASSERT_OK_AND_ASSIGN(std::unique_ptr<ElfReader> elf_reader,
+                       ElfReader::Create(kDummyExeFixture.Path()));
+  std::optional<int64_t> addr = elf_reader->SymbolAddress("CanYouFindThis");
+  ASSERT_TRUE(addr.has_value());
+
+  ASSERT_OK_AND_ASSIGN(std::unique_ptr<ElfReader::Symbolizer> symbolizer,
+                       elf_reader->GetSymbolizer());
+  EXPECT_EQ(symbolizer->Lookup(addr.value()), "CanYouFindThis");
+  EXPECT_EQ(symbolizer->Lookup(addr.value() + 1), "CanYouFindThis");
+  EXPECT_EQ(symbolizer->Lookup(0), "");
+
+  EXPECT_OK(elf_reader->ExecutableSegmentVirtualAddrOffset());
+}
+
 #ifdef __linux__
 TEST(ElfReaderTest, SymbolAddress) {
   const std::string path = kDummyExeFixture.Path().string();
@@ -60,6 +60,7 @@ void GenericHandleEvent(void* cb_cookie, void* data, int data_size) {
 // The input cb_cookie has to be DynamicTraceConnector*.
 void GenericHandleEventLoss(void* cb_cookie, uint64_t lost) {
   DCHECK_NE(cb_cookie, nullptr);
+  static_cast<DynamicTraceConnector*>(cb_cookie)->RecordLostEvents(lost);
   VLOG(1) << absl::Substitute("Lost $0 events", lost);
 }
 
@@ -184,6 +185,7 @@ Status DynamicTraceConnector::InitImpl() {
   };
 
   PL_RETURN_IF_ERROR(OpenPerfBuffer(spec, this));
+  set_event_driven();
 
   return Status::OK();
 }
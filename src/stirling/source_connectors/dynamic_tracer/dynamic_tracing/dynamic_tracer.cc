@@ -114,7 +114,10 @@ StatusOr<ObjInfo> Prepare(const ir::logical::TracepointDeployment& input_program
 
   const auto& debug_symbols_path = obj_info.elf_reader->debug_symbols_path().string();
 
-  obj_info.dwarf_reader = DwarfReader::Create(debug_symbols_path).ConsumeValueOr(nullptr);
+  // Only the few functions and structs referenced by the tracepoint are looked up, so index lazily.
+  obj_info.dwarf_reader =
+      DwarfReader::Create(debug_symbols_path, obj_tools::DwarfIndexMode::kLazy)
+          .ConsumeValueOr(nullptr);
 
   return obj_info;
 }
@@ -45,7 +45,7 @@ Status JVMStatsConnector::InitImpl() {
 }
 
 void JVMStatsConnector::FindJavaUPIDs(const ConnectorContext& ctx) {
-  proc_tracker_.Update(ctx.GetUPIDs());
+  proc_tracker_.Update(ctx.GetUPIDs(), ctx.GetUPIDDeltaLog());
 
   for (const auto& upid : proc_tracker_.new_upids()) {
     // The host PID 1 is not a Java app. However, when later invoking HsperfdataPath(), it could be
@@ -74,7 +74,7 @@ void NetworkStatsConnector::TransferNetworkStatsTable(ConnectorContext* ctx,
     }
 
     ProcParser::NetworkStats stats;
-    auto s = GetNetworkStatsForPod(*proc_parser_, *pod_info, k8s_md, &stats);
+    auto s = GetNetworkStatsForPod(*pod_info, k8s_md, &stats);
 
     if (!s.ok()) {
       VLOG(1) << absl::StrCat("Failed to get Pod network stats: ", s.msg());
@@ -94,10 +94,12 @@ void NetworkStatsConnector::TransferNetworkStatsTable(ConnectorContext* ctx,
     r.Append<r.ColIndex("tx_errors")>(stats.tx_errs);
     r.Append<r.ColIndex("tx_drops")>(stats.tx_drops);
   }
+
+  proc_sampler_->RetainPIDs(sampled_pids_);
+  sampled_pids_.clear();
 }
 
-Status NetworkStatsConnector::GetNetworkStatsForPod(const system::ProcParser& proc_parser,
-                                                    const md::PodInfo& pod_info,
+Status NetworkStatsConnector::GetNetworkStatsForPod(const md::PodInfo& pod_info,
                                                     const md::K8sMetadataState& k8s_metadata_state,
                                                     system::ProcParser::NetworkStats* stats) {
   DCHECK(stats != nullptr);
@@ -119,7 +121,8 @@ Status NetworkStatsConnector::GetNetworkStatsForPod(const system::ProcParser& pr
     }
 
     for (const auto& upid : container_info->active_upids()) {
-      auto s = proc_parser.ParseProcPIDNetDev(upid.pid(), stats);
+      sampled_pids_.insert(upid.pid());
+      auto s = proc_sampler_->SampleNetDev(upid.pid(), upid.start_ts(), stats);
       if (s.ok()) {
         // Since we just need to read one pid, we can bail on the first successful read.
         return s;
@@ -25,6 +25,7 @@
 #include <vector>
 
 #include "src/common/base/base.h"
+#include "src/common/system/proc_pid_sampler.h"
 #include "src/common/system/system.h"
 #include "src/shared/metadata/metadata.h"
 #include "src/stirling/core/canonical_types.h"
@@ -62,18 +63,20 @@ class NetworkStatsConnector : public SourceConnector {
  protected:
   explicit NetworkStatsConnector(std::string_view source_name)
       : SourceConnector(source_name, kTables) {
-    proc_parser_ = std::make_unique<system::ProcParser>(sysconfig_);
+    proc_sampler_ = std::make_unique<system::ProcPIDSampler>(sysconfig_);
   }
 
  private:
   void TransferNetworkStatsTable(ConnectorContext* ctx, DataTable* data_table);
 
-  static Status GetNetworkStatsForPod(const system::ProcParser& proc_parser,
-                                      const md::PodInfo& pod_info,
-                                      const md::K8sMetadataState& k8s_metadata_state,
-                                      system::ProcParser::NetworkStats* stats);
+  Status GetNetworkStatsForPod(const md::PodInfo& pod_info,
+                               const md::K8sMetadataState& k8s_metadata_state,
+                               system::ProcParser::NetworkStats* stats);
 
-  std::unique_ptr<system::ProcParser> proc_parser_;
+  std::unique_ptr<system::ProcPIDSampler> proc_sampler_;
+
+  // The PIDs sampled in the current iteration. Files of other PIDs are closed after each one.
+  absl::flat_hash_set<int32_t> sampled_pids_;
 };
 
 }  // namespace stirling
@@ -0,0 +1,156 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/stirling/source_connectors/perf_profiler/elf_symbolizer.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "src/common/system/config.h"
+
+namespace px {
+namespace stirling {
+
+using obj_tools::ElfReader;
+
+ElfSymbolizer::ElfSymbolizer() : proc_parser_(system::Config::GetInstance()) {}
+
+std::shared_ptr<const ElfSymbolizer::Binary> ElfSymbolizer::GetBinary(
+    uint32_t pid, const system::ProcParser::ProcessMap& map) {
+  const std::string file_key = absl::StrCat(map.dev, ":", map.inode);
+  auto file_iter = binaries_by_file_.find(file_key);
+  if (file_iter != binaries_by_file_.end()) {
+    if (auto binary = file_iter->second.lock(); binary != nullptr) {
+      return binary;
+    }
+  }
+
+  // Access the binary through the mount namespace of the process, so that binaries
+  // inside containers resolve to the right file.
+  const std::string path = absl::StrCat(system::Config::GetInstance().proc_path().string(), "/",
+                                        pid, "/root", map.pathname);
+  StatusOr<std::unique_ptr<ElfReader>> elf_reader_status = ElfReader::Create(path);
+  if (!elf_reader_status.ok()) {
+    VLOG(1) << absl::Substitute("Could not read ELF file $0: $1", path,
+                                elf_reader_status.msg());
+    return nullptr;
+  }
+  std::unique_ptr<ElfReader> elf_reader = elf_reader_status.ConsumeValueOrDie();
+
+  // The same binary may be reachable through different files (e.g. separate container layers).
+  const std::string& build_id = elf_reader->build_id();
+  if (!build_id.empty()) {
+    auto build_id_iter = binaries_by_build_id_.find(build_id);
+    if (build_id_iter != binaries_by_build_id_.end()) {
+      if (auto binary = build_id_iter->second.lock(); binary != nullptr) {
+        binaries_by_file_[file_key] = binary;
+        return binary;
+      }
+    }
+  }
+
+  StatusOr<std::unique_ptr<ElfReader::Symbolizer>> symbolizer = elf_reader->GetSymbolizer();
+  StatusOr<int64_t> vaddr_offset = elf_reader->ExecutableSegmentVirtualAddrOffset();
+  if (!symbolizer.ok() || !vaddr_offset.ok()) {
+    VLOG(1) << absl::Substitute("Could not load symbols of $0", path);
+    return nullptr;
+  }
+
+  auto binary = std::make_shared<Binary>();
+  binary->symbolizer = symbolizer.ConsumeValueOrDie();
+  binary->vaddr_offset = vaddr_offset.ValueOrDie();
+
+  binaries_by_file_[file_key] = binary;
+  if (!build_id.empty()) {
+    binaries_by_build_id_[build_id] = binary;
+  }
+  return binary;
+}
+
+const std::vector<ElfSymbolizer::Mapping>& ElfSymbolizer::GetMappings(uint32_t pid) {
+  auto [iter, inserted] = mappings_by_pid_.try_emplace(pid);
+  std::vector<Mapping>& mappings = iter->second;
+  if (!inserted) {
+    return mappings;
+  }
+
+  // Mappings are read once per process: on failure, or for libraries loaded later on
+  // (e.g. dlopen), lookups miss and the caller falls back to its own resolver.
+  std::vector<system::ProcParser::ProcessMap> maps;
+  Status s = proc_parser_.ReadProcMaps(pid, &maps);
+  if (!s.ok()) {
+    VLOG(1) << absl::Substitute("Could not read maps of pid $0: $1", pid, s.msg());
+    return mappings;
+  }
+
+  for (const auto& map : maps) {
+    // Only file-backed executable mappings contain symbolizable code.
+    if (!map.executable() || map.inode == 0 || map.pathname.empty() || map.pathname[0] != '/') {
+      continue;
+    }
+    Mapping& mapping = mappings.emplace_back();
+    mapping.vmem_start = map.vmem_start;
+    mapping.vmem_end = map.vmem_end;
+    mapping.offset = map.offset;
+    mapping.binary = GetBinary(pid, map);
+  }
+
+  std::sort(mappings.begin(), mappings.end(),
+            [](const Mapping& a, const Mapping& b) { return a.vmem_start < b.vmem_start; });
+  return mappings;
+}
+
+std::string_view ElfSymbolizer::Lookup(uint32_t pid, uintptr_t addr) {
+  const std::vector<Mapping>& mappings = GetMappings(pid);
+
+  auto iter = std::upper_bound(mappings.begin(), mappings.end(), addr,
+                               [](uintptr_t a, const Mapping& m) { return a < m.vmem_start; });
+  if (iter == mappings.begin()) {
+    return {};
+  }
+  --iter;
+  if (addr >= iter->vmem_end || iter->binary == nullptr) {
+    return {};
+  }
+
+  const Binary& binary = *iter->binary;
+  const uint64_t vaddr = addr - iter->vmem_start + iter->offset + binary.vaddr_offset;
+  return binary.symbolizer->Lookup(vaddr);
+}
+
+void ElfSymbolizer::RemovePID(uint32_t pid) {
+  mappings_by_pid_.erase(pid);
+
+  for (auto iter = binaries_by_file_.begin(); iter != binaries_by_file_.end();) {
+    if (iter->second.expired()) {
+      binaries_by_file_.erase(iter++);
+    } else {
+      ++iter;
+    }
+  }
+  for (auto iter = binaries_by_build_id_.begin(); iter != binaries_by_build_id_.end();) {
+    if (iter->second.expired()) {
+      binaries_by_build_id_.erase(iter++);
+    } else {
+      ++iter;
+    }
+  }
+}
+
+}  // namespace stirling
+}  // namespace px
@@ -0,0 +1,95 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <absl/container/flat_hash_map.h>
+
+#include "src/common/base/base.h"
+#include "src/common/system/proc_parser.h"
+#include "src/stirling/obj_tools/elf_tools.h"
+
+namespace px {
+namespace stirling {
+
+/**
+ * ElfSymbolizer resolves user-space addresses to symbols by reading the ELF symbol tables
+ * of the mapped binaries directly, rather than going through BCC.
+ *
+ * Each binary is loaded once into a sorted address->symbol table (obj_tools::ElfReader::Symbolizer)
+ * and shared by all processes that map it. Binaries are keyed by the device & inode of the
+ * mapped file and, when present, by the build-id; so many replicas of the same container image
+ * share one symbol table. Process addresses are translated into ELF virtual addresses using the
+ * offsets from /proc/<pid>/maps.
+ *
+ * Not thread-safe.
+ */
+class ElfSymbolizer {
+ public:
+  ElfSymbolizer();
+
+  /**
+   * Returns the symbol containing addr in the address space of pid,
+   * or an empty string_view if the address could not be resolved.
+   * The returned string_view is valid until the next call to RemovePID().
+   */
+  std::string_view Lookup(uint32_t pid, uintptr_t addr);
+
+  /**
+   * Drops the mappings of pid, and any binaries no longer mapped by a tracked process.
+   */
+  void RemovePID(uint32_t pid);
+
+  size_t num_pids() const { return mappings_by_pid_.size(); }
+  size_t num_binaries() const { return binaries_by_file_.size(); }
+
+ private:
+  struct Binary {
+    std::unique_ptr<obj_tools::ElfReader::Symbolizer> symbolizer;
+    // Difference between the ELF virtual address and the file offset of the executable segment.
+    int64_t vaddr_offset = 0;
+  };
+
+  struct Mapping {
+    uint64_t vmem_start = 0;
+    uint64_t vmem_end = 0;
+    uint64_t offset = 0;
+    // Null if the binary could not be loaded.
+    std::shared_ptr<const Binary> binary;
+  };
+
+  const std::vector<Mapping>& GetMappings(uint32_t pid);
+  std::shared_ptr<const Binary> GetBinary(uint32_t pid, const system::ProcParser::ProcessMap& map);
+
+  system::ProcParser proc_parser_;
+
+  // Executable mappings of each process, sorted by vmem_start.
+  absl::flat_hash_map<uint32_t, std::vector<Mapping>> mappings_by_pid_;
+
+  // Binaries are owned by the mappings of the processes that use them.
+  // Key is "<dev>:<inode>" of the mapped file.
+  absl::flat_hash_map<std::string, std::weak_ptr<const Binary>> binaries_by_file_;
+  absl::flat_hash_map<std::string, std::weak_ptr<const Binary>> binaries_by_build_id_;
+};
+
+}  // namespace stirling
+}  // namespace px
@@ -0,0 +1,62 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <gtest/gtest.h>
+#include <unistd.h>
+
+#include "src/common/testing/testing.h"
+#include "src/stirling/bpf_tools/macros.h"
+#include "src/stirling/source_connectors/perf_profiler/elf_symbolizer.h"
+
+// We declare this with C linkage (extern "C") so it has a simple symbol name.
+extern "C" {
+NO_OPT_ATTR int ElfSymbolizerTestFn(int x) { return x + 1; }
+}
+
+namespace px {
+namespace stirling {
+
+TEST(ElfSymbolizerTest, LookupOwnSymbol) {
+  ElfSymbolizer symbolizer;
+  const uintptr_t addr = reinterpret_cast<uintptr_t>(&ElfSymbolizerTestFn);
+
+  EXPECT_EQ(symbolizer.Lookup(getpid(), addr), "ElfSymbolizerTestFn");
+  EXPECT_EQ(symbolizer.num_pids(), 1);
+  const size_t num_binaries = symbolizer.num_binaries();
+  EXPECT_GE(num_binaries, 1);
+
+  // Lookups of other addresses in the same binary reuse the loaded binary.
+  EXPECT_EQ(symbolizer.Lookup(getpid(), addr + 1), "ElfSymbolizerTestFn");
+  EXPECT_EQ(symbolizer.num_binaries(), num_binaries);
+
+  // Unmapped addresses don't resolve.
+  EXPECT_EQ(symbolizer.Lookup(getpid(), 0), "");
+
+  symbolizer.RemovePID(getpid());
+  EXPECT_EQ(symbolizer.num_pids(), 0);
+  EXPECT_EQ(symbolizer.num_binaries(), 0);
+}
+
+TEST(ElfSymbolizerTest, UnknownPID) {
+  ElfSymbolizer symbolizer;
+  // PIDs are at most 2^22 on Linux.
+  EXPECT_EQ(symbolizer.Lookup(1 << 23, 0x1000), "");
+}
+
+}  // namespace stirling
+}  // namespace px
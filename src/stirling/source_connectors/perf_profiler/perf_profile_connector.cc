@@ -28,11 +28,16 @@
 
 BPF_SRC_STRVIEW(profiler_bcc_script, profiler);
 
+DEFINE_uint32(stirling_profiler_max_raw_stack_traces, 16384,
+              "The maximum number of raw stack traces whose stack-trace-ids are cached, to avoid "
+              "re-symbolizing them. Each one holds up to a few KB of addresses.");
+
 namespace px {
 namespace stirling {
 
 PerfProfileConnector::PerfProfileConnector(std::string_view source_name)
     : SourceConnector(source_name, kTables),
+      stack_trace_interner_(FLAGS_stirling_profiler_max_raw_stack_traces),
       dummy_symbolizer_(/*pid*/ 0, /*enable symbolization*/ false),
       kernel_symbolizer_(Symbolizer::kKernelPID, /*enable symbolization*/ true) {}
 
@@ -69,12 +74,11 @@ Status PerfProfileConnector::StopImpl() {
   return Status::OK();
 }
 
-std::string PerfProfileConnector::FoldedStackTraceString(const bool symbolize,
-                                                         ebpf::BPFStackTable* stack_traces,
-                                                         const stack_trace_key_t& key) {
-  // Here, we read the list of addresses from stack_traces and convert that
-  // list into a "folded" symbolic stack trace string. In line with this,
-  // we also clear the entries in stack_traces.
+std::string PerfProfileConnector::FoldedStackTraceString(
+    ebpf::BPFStackTable* stack_traces, const struct upid_t& upid,
+    const StackTraceInterner::RawStackTrace& raw_stack_trace) {
+  // Here, we convert the lists of addresses read from stack_traces into a "folded" symbolic
+  // stack trace string.
   constexpr std::string_view kKSymSuffix = "_[k]";
   constexpr std::string_view kSeparator = ";";
   constexpr uint64_t kSentinelAddr = 0xcccccccccccccccc;
@@ -82,16 +86,15 @@ std::string PerfProfileConnector::FoldedStackTraceString(const bool symbolize,
   std::string stack_trace_str;
   // TODO(oazizi): Add a stack_trace_str.reserve() heuristic.
 
-  auto& symbolizer = symbolize
-                         ? symbolizers_.try_emplace(key.upid, key.upid.pid, symbolize).first->second
-                         : dummy_symbolizer_;
-
-  // Clear the stack-traces map as we go along here; this has lower overhead
-  // compared to first reading the stack-traces map, then using clear_table_non_atomic().
-  constexpr bool kClearStackId = true;
+  const bool symbolize = raw_stack_trace.symbolize;
+  ElfSymbolizer* elf_symbolizer =
+      FLAGS_stirling_profiler_elf_symbolizer ? &elf_symbolizer_ : nullptr;
+  auto& symbolizer =
+      symbolize ? symbolizers_.try_emplace(upid, upid.pid, symbolize, elf_symbolizer).first->second
+                : dummy_symbolizer_;
 
   // Add user stack.
-  auto user_addrs = stack_traces->get_stack_addr(key.user_stack_id, kClearStackId);
+  const auto& user_addrs = raw_stack_trace.user_addrs;
   for (auto iter = user_addrs.rbegin(); iter != user_addrs.rend(); ++iter) {
     const auto& addr = *iter;
     if (addr == kSentinelAddr) {
@@ -106,7 +109,7 @@ std::string PerfProfileConnector::FoldedStackTraceString(const bool symbolize,
   }
 
   // Add kernel stack.
-  auto kernel_addrs = stack_traces->get_stack_addr(key.kernel_stack_id, kClearStackId);
+  const auto& kernel_addrs = raw_stack_trace.kernel_addrs;
   for (auto iter = kernel_addrs.rbegin(); iter != kernel_addrs.rend(); ++iter) {
     const auto& addr = *iter;
     stack_trace_str += kernel_symbolizer_.LookupSym(stack_traces, addr);
@@ -147,10 +150,12 @@ void PerfProfileConnector::CleanupSymbolizers(const absl::flat_hash_set<md::UPID
     upid.pid = md_upid.pid();
     upid.start_time_ticks = md_upid.start_ts();
     symbolizers_.erase(upid);
+    elf_symbolizer_.RemovePID(upid.pid);
 
     stack_traces_a_->free_symcache(md_upid.pid());
     stack_traces_b_->free_symcache(md_upid.pid());
   }
+  stack_trace_interner_.RemoveUPIDs(deleted_upids);
 }
 
 void PerfProfileConnector::TransferDataImpl(ConnectorContext* ctx, uint32_t table_num,
@@ -177,23 +182,10 @@ void PerfProfileConnector::TransferDataImpl(ConnectorContext* ctx, uint32_t tabl
   }
   DCHECK_EQ(push_count, read_and_clear_count_) << "stack trace handshake protocol out of sync.";
 
-  proc_tracker_.Update(ctx->GetUPIDs());
+  proc_tracker_.Update(ctx->GetUPIDs(), ctx->GetUPIDDeltaLog());
   CleanupSymbolizers(proc_tracker_.deleted_upids());
 }
 
-uint64_t PerfProfileConnector::SymbolicStackTraceID(
-    const SymbolicStackTrace& symbolic_stack_trace) {
-  const auto it = stack_trace_ids_.find(symbolic_stack_trace);
-
-  if (it != stack_trace_ids_.end()) {
-    const uint64_t stack_trace_id = it->second;
-    return stack_trace_id;
-  } else {
-    stack_trace_ids_[symbolic_stack_trace] = next_stack_trace_id_;
-    return next_stack_trace_id_++;
-  }
-}
-
 PerfProfileConnector::StackTraceHisto PerfProfileConnector::AggregateStackTraces(
     ConnectorContext* ctx, ebpf::BPFStackTable* stack_traces,
     ebpf::BPFHashTable<stack_trace_key_t, uint64_t>* histo) {
@@ -212,26 +204,29 @@ PerfProfileConnector::StackTraceHisto PerfProfileConnector::AggregateStackTraces
   // after the table has been read.
   constexpr bool kClearTable = true;
 
+  // Clear the stack-traces map as we go along here; this has lower overhead
+  // compared to first reading the stack-traces map, then using clear_table_non_atomic().
+  constexpr bool kClearStackId = true;
+
   for (const auto& [stack_trace_key, count] : histo->get_table_offline(kClearTable)) {
     cum_sum_count += count;
 
     const md::UPID upid(asid, stack_trace_key.upid.pid, stack_trace_key.upid.start_time_ticks);
 
-    const bool symbolize = upids_for_symbolization.contains(upid);
-    std::string stack_trace_str = FoldedStackTraceString(symbolize, stack_traces, stack_trace_key);
-    SymbolicStackTrace symbolic_stack_trace = {upid, std::move(stack_trace_str)};
-    symbolic_histogram[symbolic_stack_trace] += count;
-
-    // TODO(jps): If we see a perf. issue with having two maps keyed by symbolic-stack-trace,
-    // refactor such that creating/finding symoblic-stack-trace-id and count aggregation
-    // are both done here, in AggregateStackTraces().
-    // One possible implementation:
-    // make the histogram a map from "symbolic-track-trace" => "count & stack-trace-id"
-    // e.g.:
-    // ... auto& count_and_id = symbolic_histogram[symbolic_stack_trace];
-    // ... count_and_id.id = id;
-    // ... count_and_id.count += count;
-    // alternate impl. is a map from "stack-trace-id" => "count & symbolic-stack-trace"
+    StackTraceInterner::RawStackTrace raw_stack_trace = {
+        upid, upids_for_symbolization.contains(upid),
+        stack_traces->get_stack_addr(stack_trace_key.user_stack_id, kClearStackId),
+        stack_traces->get_stack_addr(stack_trace_key.kernel_stack_id, kClearStackId)};
+
+    // Symbolizing and folding is only done the first time a stack trace is seen. Without the
+    // symbol cache, symbols may change between lookups, so the folded string is rebuilt.
+    const uint64_t stack_trace_id = stack_trace_interner_.Intern(
+        std::move(raw_stack_trace),
+        [&](const StackTraceInterner::RawStackTrace& raw) {
+          return FoldedStackTraceString(stack_traces, stack_trace_key.upid, raw);
+        },
+        FLAGS_stirling_profiler_symcache);
+    symbolic_histogram[stack_trace_id] += count;
   }
   VLOG(1) << "PerfProfileConnector::AggregateStackTraces(): cum_sum_count: " << cum_sum_count;
   return symbolic_histogram;
@@ -253,15 +248,15 @@ void PerfProfileConnector::CreateRecords(const uint64_t timestamp_ns,
 
   StackTraceHisto stack_trace_histogram = AggregateStackTraces(ctx, stack_traces, histo);
 
-  for (const auto& [key, count] : stack_trace_histogram) {
+  for (const auto& [stack_trace_id, count] : stack_trace_histogram) {
     DataTable::RecordBuilder<&kStackTraceTable> r(data_table, timestamp_ns);
 
-    const uint64_t stack_trace_id = SymbolicStackTraceID(key);
+    const auto& stack_trace = stack_trace_interner_.Get(stack_trace_id);
 
     r.Append<r.ColIndex("time_")>(timestamp_ns);
-    r.Append<r.ColIndex("upid")>(key.upid.value());
+    r.Append<r.ColIndex("upid")>(stack_trace.upid.value());
     r.Append<r.ColIndex("stack_trace_id")>(stack_trace_id);
-    r.Append<r.ColIndex("stack_trace"), kMaxStackTraceSize>(key.stack_trace_str);
+    r.Append<r.ColIndex("stack_trace"), kMaxStackTraceSize>(stack_trace.folded);
     r.Append<r.ColIndex("count")>(count);
   }
 }
@@ -29,9 +29,12 @@
 #include "src/stirling/core/source_connector.h"
 #include "src/stirling/core/types.h"
 #include "src/stirling/source_connectors/perf_profiler/bcc_bpf_intf/stack_event.h"
+#include "src/stirling/source_connectors/perf_profiler/stack_trace_interner.h"
 #include "src/stirling/source_connectors/perf_profiler/stack_traces_table.h"
 #include "src/stirling/source_connectors/perf_profiler/symbolizer.h"
 
+DECLARE_uint32(stirling_profiler_max_raw_stack_traces);
+
 namespace px {
 namespace stirling {
 
@@ -51,39 +54,14 @@ class PerfProfileConnector : public SourceConnector, public bpf_tools::BCCWrappe
   static constexpr uint64_t BPFSamplingPeriodMillis() { return kSamplingPeriodMillis; }
 
  private:
-  // SymbolicStackTrace identifies a particular stack trace by:
-  // * upid
-  // * "folded" stack trace string
-  // The stack traces (in kernel & in BPF) are ordered lists of instruction pointers (addresses).
-  // Stirling uses BPF to recover the symbols associated with each address, and then
-  // uses the "symbolic stack trace" as the histogram key. Some of the stack traces that are
-  // distinct in the kernel and in BPF will collapse into the same symoblic stack trace in Stirling.
-  // For example, consider the following two stack traces from BPF:
+  // StackTraceHisto: stack-trace-id => observation-count
+  // Stack traces are interned by stack_trace_interner_, which maps them to their ids. The stack
+  // traces (in kernel & in BPF) are ordered lists of instruction pointers (addresses). Some of
+  // the stack traces that are distinct in BPF collapse into the same symbolic stack trace in
+  // Stirling, and thus into the same stack-trace-id. For example:
   // p0, p1, p2 => main;qux;baz   # both p2 & p3 point into baz.
   // p0, p1, p3 => main;qux;baz
-  //
-  // SymbolicStackTrace will serve as a key to the unique stack-trace-id (an integer) in Stirling.
-  struct SymbolicStackTrace {
-    const md::UPID upid;
-    const std::string stack_trace_str;
-
-    template <typename H>
-    friend H AbslHashValue(H h, const SymbolicStackTrace& s) {
-      return H::combine(std::move(h), s.upid, s.stack_trace_str);
-    }
-
-    friend bool operator==(const SymbolicStackTrace& lhs, const SymbolicStackTrace& rhs) {
-      if (lhs.upid != rhs.upid) {
-        return false;
-      }
-      return lhs.stack_trace_str == rhs.stack_trace_str;
-    }
-  };
-
-  // StackTraceHisto: SymbolicStackTrace => observation-count
-  // StackTraceIDMap: SymbolicStackTrace => stack-trace-id
-  using StackTraceHisto = absl::flat_hash_map<SymbolicStackTrace, uint64_t>;
-  using StackTraceIDMap = absl::flat_hash_map<SymbolicStackTrace, uint64_t>;
+  using StackTraceHisto = absl::flat_hash_map<uint64_t, uint64_t>;
 
   explicit PerfProfileConnector(std::string_view source_name);
 
@@ -94,13 +72,11 @@ class PerfProfileConnector : public SourceConnector, public bpf_tools::BCCWrappe
                      ebpf::BPFHashTable<stack_trace_key_t, uint64_t>* histo, ConnectorContext* ctx,
                      DataTable* data_table);
 
-  uint64_t SymbolicStackTraceID(const SymbolicStackTrace& symbolic_stack_trace);
-
   StackTraceHisto AggregateStackTraces(ConnectorContext* ctx, ebpf::BPFStackTable* stack_traces,
                                        ebpf::BPFHashTable<stack_trace_key_t, uint64_t>* histo);
 
-  std::string FoldedStackTraceString(const bool symbolize, ebpf::BPFStackTable* stack_traces,
-                                     const stack_trace_key_t& key);
+  std::string FoldedStackTraceString(ebpf::BPFStackTable* stack_traces, const struct upid_t& upid,
+                                     const StackTraceInterner::RawStackTrace& raw_stack_trace);
 
   void CleanupSymbolizers(const absl::flat_hash_set<md::UPID>& deleted_upids);
 
@@ -114,12 +90,9 @@ class PerfProfileConnector : public SourceConnector, public bpf_tools::BCCWrappe
   // Number of read & clear ops completed:
   uint64_t read_and_clear_count_ = 0;
 
-  // Tracks the next stack-trace-id to be assigned;
-  // incremented by 1 for each such assignment.
-  uint64_t next_stack_trace_id_ = 0;
-
-  // Tracks unique stack trace ids, for the lifetime of Stirling:
-  StackTraceIDMap stack_trace_ids_;
+  // Assigns stack-trace-ids and holds the folded stack trace strings, for the lifetime of the
+  // traced processes:
+  StackTraceInterner stack_trace_interner_;
 
   // At the discretion of its policy, a symbolizer will either:
   // ... return the symbol given an address,
@@ -129,6 +102,10 @@ class PerfProfileConnector : public SourceConnector, public bpf_tools::BCCWrappe
   // Symbolizers are created with a specific policy on a per upid basis.
   absl::flat_hash_map<struct upid_t, Symbolizer> symbolizers_;
 
+  // Loads the symbol tables of user-space binaries once, and shares them across the
+  // per upid symbolizers. Only used if --stirling_profiler_elf_symbolizer is set.
+  ElfSymbolizer elf_symbolizer_;
+
   // Some special case symbolizers:
   // ... 1. A symbolizer that has the policy of "do not symbolize," and
   // ... 2. a dedicated symbolizer for kernel syms.
@@ -0,0 +1,73 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include "src/stirling/source_connectors/perf_profiler/stack_trace_interner.h"
+
+#include "src/common/base/base.h"
+
+namespace px {
+namespace stirling {
+
+uint64_t StackTraceInterner::InternFolded(const md::UPID& upid, std::string folded) {
+  auto it = ids_by_symbolic_stack_trace_.find(std::make_pair(upid, std::string_view(folded)));
+  if (it != ids_by_symbolic_stack_trace_.end()) {
+    return it->second;
+  }
+
+  const uint64_t id = next_id_++;
+  const auto& stack_trace =
+      stack_traces_.try_emplace(id, SymbolicStackTrace{upid, std::move(folded)}).first->second;
+  ids_by_symbolic_stack_trace_.emplace(
+      std::make_pair(upid, std::string_view(stack_trace.folded)), id);
+  ids_by_upid_[upid].push_back(id);
+  return id;
+}
+
+const StackTraceInterner::SymbolicStackTrace& StackTraceInterner::Get(uint64_t id) const {
+  auto it = stack_traces_.find(id);
+  DCHECK(it != stack_traces_.end()) << absl::Substitute("Unknown stack-trace-id $0", id);
+  return it->second;
+}
+
+void StackTraceInterner::RemoveUPIDs(const absl::flat_hash_set<md::UPID>& upids) {
+  if (upids.empty()) {
+    return;
+  }
+  for (const auto& upid : upids) {
+    auto it = ids_by_upid_.find(upid);
+    if (it == ids_by_upid_.end()) {
+      continue;
+    }
+    for (const uint64_t id : it->second) {
+      auto stack_trace_it = stack_traces_.find(id);
+      ids_by_symbolic_stack_trace_.erase(
+          std::make_pair(upid, std::string_view(stack_trace_it->second.folded)));
+      stack_traces_.erase(stack_trace_it);
+    }
+    ids_by_upid_.erase(it);
+  }
+  for (auto it = ids_by_raw_stack_trace_.begin(); it != ids_by_raw_stack_trace_.end();) {
+    if (upids.contains(it->first.upid)) {
+      ids_by_raw_stack_trace_.erase(it++);
+    } else {
+      ++it;
+    }
+  }
+}
+
+}  // namespace stirling
+}  // namespace px
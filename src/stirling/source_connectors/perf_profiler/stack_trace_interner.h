@@ -0,0 +1,136 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#pragma once
+
+#include <limits>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <absl/container/flat_hash_map.h>
+#include <absl/container/flat_hash_set.h>
+#include <absl/container/node_hash_map.h>
+
+#include "src/shared/upid/upid.h"
+
+namespace px {
+namespace stirling {
+
+/**
+ * StackTraceInterner assigns stack-trace-ids to stack traces and keeps a single copy of the
+ * "folded" string of each one.
+ *
+ * Stack traces are interned at two levels:
+ * ... by their raw addresses (as read from BPF), so that a stack trace that was already seen
+ *     is neither re-symbolized nor re-folded on later push events, and,
+ * ... by their folded symbolic string, because distinct address lists can collapse into the same
+ *     symbolic stack trace (e.g. two addresses within the same function). Both share one id.
+ *
+ * Ids are never reused. Entries are dropped when their process goes away (see RemoveUPIDs).
+ * The raw stack traces are only a cache of the symbolic ones, which is bounded: when it is full,
+ * it is cleared, and stack traces seen again are folded again, and get the same ids as before.
+ */
+class StackTraceInterner {
+ public:
+  explicit StackTraceInterner(size_t max_raw_stack_traces = std::numeric_limits<size_t>::max())
+      : max_raw_stack_traces_(max_raw_stack_traces) {}
+
+  // A stack trace as read from BPF. The symbolize flag is part of the key, since the folded
+  // string differs depending on whether the process' addresses are symbolized.
+  struct RawStackTrace {
+    md::UPID upid;
+    bool symbolize = false;
+    std::vector<uintptr_t> user_addrs;
+    std::vector<uintptr_t> kernel_addrs;
+
+    template <typename H>
+    friend H AbslHashValue(H h, const RawStackTrace& s) {
+      return H::combine(std::move(h), s.upid, s.symbolize, s.user_addrs, s.kernel_addrs);
+    }
+
+    friend bool operator==(const RawStackTrace& lhs, const RawStackTrace& rhs) {
+      return lhs.upid == rhs.upid && lhs.symbolize == rhs.symbolize &&
+             lhs.user_addrs == rhs.user_addrs && lhs.kernel_addrs == rhs.kernel_addrs;
+    }
+  };
+
+  struct SymbolicStackTrace {
+    md::UPID upid;
+    std::string folded;
+  };
+
+  /**
+   * Returns the stack-trace-id of the given raw stack trace. fold_fn is only invoked (to create
+   * the folded string) if this raw stack trace is not in the cache of raw stack traces, or if
+   * cache_raw_stack_traces is false.
+   */
+  template <typename TFoldFn>
+  uint64_t Intern(RawStackTrace raw_stack_trace, TFoldFn fold_fn,
+                  bool cache_raw_stack_traces = true) {
+    if (cache_raw_stack_traces) {
+      auto it = ids_by_raw_stack_trace_.find(raw_stack_trace);
+      if (it != ids_by_raw_stack_trace_.end()) {
+        return it->second;
+      }
+    }
+    const uint64_t id = InternFolded(raw_stack_trace.upid, fold_fn(raw_stack_trace));
+    if (cache_raw_stack_traces && max_raw_stack_traces_ > 0) {
+      if (ids_by_raw_stack_trace_.size() >= max_raw_stack_traces_) {
+        ids_by_raw_stack_trace_.clear();
+      }
+      ids_by_raw_stack_trace_.emplace(std::move(raw_stack_trace), id);
+    }
+    return id;
+  }
+
+  /**
+   * Returns the stack-trace-id of a symbolic stack trace, assigning a new one if needed.
+   */
+  uint64_t InternFolded(const md::UPID& upid, std::string folded);
+
+  /**
+   * Returns the stack trace with the given id. The id must have been returned by Intern or
+   * InternFolded, and its process must not have been removed since.
+   */
+  const SymbolicStackTrace& Get(uint64_t id) const;
+
+  /**
+   * Drops all stack traces of the given processes.
+   */
+  void RemoveUPIDs(const absl::flat_hash_set<md::UPID>& upids);
+
+  size_t num_stack_traces() const { return stack_traces_.size(); }
+  size_t num_raw_stack_traces() const { return ids_by_raw_stack_trace_.size(); }
+
+ private:
+  // Owns the folded strings; node_hash_map keeps them at stable addresses, so that
+  // ids_by_symbolic_stack_trace_ can refer to them without a copy.
+  absl::node_hash_map<uint64_t, SymbolicStackTrace> stack_traces_;
+  absl::flat_hash_map<std::pair<md::UPID, std::string_view>, uint64_t>
+      ids_by_symbolic_stack_trace_;
+  absl::flat_hash_map<RawStackTrace, uint64_t> ids_by_raw_stack_trace_;
+  size_t max_raw_stack_traces_;
+  absl::flat_hash_map<md::UPID, std::vector<uint64_t>> ids_by_upid_;
+
+  // Tracks the next stack-trace-id to be assigned; incremented by 1 for each such assignment.
+  uint64_t next_id_ = 0;
+};
+
+}  // namespace stirling
+}  // namespace px
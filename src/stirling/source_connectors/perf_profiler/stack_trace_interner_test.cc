@@ -0,0 +1,99 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include "src/common/testing/testing.h"
+#include "src/stirling/source_connectors/perf_profiler/stack_trace_interner.h"
+
+namespace px {
+namespace stirling {
+
+class StackTraceInternerTest : public ::testing::Test {
+ protected:
+  uint64_t Intern(const md::UPID& upid, std::vector<uintptr_t> user_addrs,
+                  const std::string& folded) {
+    return interner_.Intern({upid, /*symbolize*/ true, std::move(user_addrs), {}},
+                            [this, &folded](const StackTraceInterner::RawStackTrace&) {
+                              ++num_folds_;
+                              return folded;
+                            });
+  }
+
+  StackTraceInterner interner_;
+  int num_folds_ = 0;
+  const md::UPID upid_a_{1, 100, 12345};
+  const md::UPID upid_b_{1, 200, 12345};
+};
+
+TEST_F(StackTraceInternerTest, FoldsEachRawStackTraceOnce) {
+  const uint64_t id = Intern(upid_a_, {0x10, 0x20}, "main;foo");
+  EXPECT_EQ(Intern(upid_a_, {0x10, 0x20}, "main;foo"), id);
+  EXPECT_EQ(num_folds_, 1);
+  EXPECT_EQ(interner_.Get(id).folded, "main;foo");
+  EXPECT_EQ(interner_.Get(id).upid, upid_a_);
+}
+
+TEST_F(StackTraceInternerTest, CollapsesToSymbolicStackTrace) {
+  // Distinct addresses within the same functions share the symbolic stack trace and its id.
+  const uint64_t id = Intern(upid_a_, {0x10, 0x20}, "main;foo");
+  EXPECT_EQ(Intern(upid_a_, {0x10, 0x24}, "main;foo"), id);
+  EXPECT_EQ(num_folds_, 2);
+  EXPECT_EQ(interner_.num_stack_traces(), 1);
+  EXPECT_EQ(interner_.num_raw_stack_traces(), 2);
+
+  // The same symbolic stack trace in another process has its own id.
+  EXPECT_NE(Intern(upid_b_, {0x10, 0x20}, "main;foo"), id);
+  EXPECT_NE(Intern(upid_a_, {0x10, 0x30}, "main;bar"), id);
+}
+
+TEST_F(StackTraceInternerTest, RemoveUPIDs) {
+  const uint64_t id_a = Intern(upid_a_, {0x10, 0x20}, "main;foo");
+  const uint64_t id_b = Intern(upid_b_, {0x10, 0x20}, "main;foo");
+
+  interner_.RemoveUPIDs({upid_a_});
+  EXPECT_EQ(interner_.num_stack_traces(), 1);
+  EXPECT_EQ(interner_.num_raw_stack_traces(), 1);
+  EXPECT_EQ(interner_.Get(id_b).folded, "main;foo");
+
+  // Ids are not reused.
+  const uint64_t new_id_a = Intern(upid_a_, {0x10, 0x20}, "main;foo");
+  EXPECT_NE(new_id_a, id_a);
+  EXPECT_NE(new_id_a, id_b);
+}
+
+TEST_F(StackTraceInternerTest, MaxRawStackTraces) {
+  interner_ = StackTraceInterner(/*max_raw_stack_traces*/ 2);
+  const uint64_t id = Intern(upid_a_, {0x10, 0x20}, "main;foo");
+  Intern(upid_a_, {0x10, 0x24}, "main;foo");
+  EXPECT_EQ(interner_.num_raw_stack_traces(), 2);
+
+  // The full cache of raw stack traces is cleared, but the symbolic stack traces are kept.
+  Intern(upid_a_, {0x10, 0x30}, "main;bar");
+  EXPECT_EQ(interner_.num_raw_stack_traces(), 1);
+  EXPECT_EQ(interner_.num_stack_traces(), 2);
+
+  // A raw stack trace that is no longer cached is folded again, into the same id.
+  EXPECT_EQ(Intern(upid_a_, {0x10, 0x20}, "main;foo"), id);
+  EXPECT_EQ(num_folds_, 4);
+  EXPECT_EQ(interner_.num_raw_stack_traces(), 2);
+}
+
+}  // namespace stirling
+}  // namespace px
@@ -19,6 +19,9 @@
 #include "src/stirling/source_connectors/perf_profiler/symbolizer.h"
 
 DEFINE_bool(stirling_profiler_symcache, true, "Enable the Stirling managed symbol cache.");
+DEFINE_bool(stirling_profiler_elf_symbolizer, false,
+            "Resolve user-space symbols from the ELF symbol tables of the mapped binaries, "
+            "shared across processes, before falling back to BCC.");
 
 namespace px {
 namespace stirling {
@@ -37,6 +40,18 @@ const std::string& SymbolOrAddr(ebpf::BPFStackTable* stack_traces, const uintptr
 }
 }  // namespace
 
+const std::string& Symbolizer::Resolve(ebpf::BPFStackTable* stack_traces, const uintptr_t addr) {
+  if (elf_symbolizer_ != nullptr) {
+    std::string_view sym = elf_symbolizer_->Lookup(pid_, addr);
+    if (!sym.empty()) {
+      static std::string elf_sym;
+      elf_sym = sym;
+      return elf_sym;
+    }
+  }
+  return SymbolOrAddr(stack_traces, addr, pid_);
+}
+
 const std::string& Symbolizer::LookupSym(ebpf::BPFStackTable* stack_traces, const uintptr_t addr) {
   if (!enable_symbolization_) {
     static std::string just_addr;
@@ -44,14 +59,14 @@ const std::string& Symbolizer::LookupSym(ebpf::BPFStackTable* stack_traces, cons
     return just_addr;
   }
   if (!FLAGS_stirling_profiler_symcache) {
-    return SymbolOrAddr(stack_traces, addr, pid_);
+    return Resolve(stack_traces, addr);
   }
 
   ++stat_accesses_;
 
   auto sym_iter = sym_cache_.find(addr);
   if (sym_iter == sym_cache_.end()) {
-    sym_iter = sym_cache_.try_emplace(addr, SymbolOrAddr(stack_traces, addr, pid_)).first;
+    sym_iter = sym_cache_.try_emplace(addr, Resolve(stack_traces, addr)).first;
   } else {
     ++stat_hits_;
   }
@@ -21,8 +21,10 @@
 #include <string>
 
 #include "src/stirling/bpf_tools/bcc_wrapper.h"
+#include "src/stirling/source_connectors/perf_profiler/elf_symbolizer.h"
 
 DECLARE_bool(stirling_profiler_symcache);
+DECLARE_bool(stirling_profiler_elf_symbolizer);
 
 namespace px {
 namespace stirling {
@@ -39,11 +41,14 @@ namespace stirling {
  * keeps its own symbol cache to reduce the cost of symbol lookup.
  * While BCC has its own symbol cache, the bcc cache is expensive to use.
  *
+ * If an ElfSymbolizer is provided, it is tried before BCC. The ElfSymbolizer is shared by
+ * all Symbolizers, so binaries common to many processes are only loaded once.
  */
 class Symbolizer {
  public:
-  explicit Symbolizer(const int pid, const bool enable_symbolization)
-      : pid_(pid), enable_symbolization_(enable_symbolization) {}
+  explicit Symbolizer(const int pid, const bool enable_symbolization,
+                      ElfSymbolizer* elf_symbolizer = nullptr)
+      : pid_(pid), enable_symbolization_(enable_symbolization), elf_symbolizer_(elf_symbolizer) {}
 
   const std::string& LookupSym(ebpf::BPFStackTable* stack_traces, const uintptr_t addr);
 
@@ -56,8 +61,11 @@ class Symbolizer {
   static constexpr int kKernelPID = -1;
 
  private:
+  const std::string& Resolve(ebpf::BPFStackTable* stack_traces, const uintptr_t addr);
+
   const int pid_;
   const bool enable_symbolization_;
+  ElfSymbolizer* elf_symbolizer_;
 
   absl::flat_hash_map<uintptr_t, std::string> sym_cache_;
 
@@ -0,0 +1,116 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <benchmark/benchmark.h>
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <bcc/bcc_syms.h>
+
+#include <vector>
+
+#include "src/common/base/base.h"
+#include "src/stirling/bpf_tools/macros.h"
+#include "src/stirling/source_connectors/perf_profiler/elf_symbolizer.h"
+
+using px::stirling::ElfSymbolizer;
+
+// Symbols to look up. Declared with C linkage so that both symbolizers return the same names.
+extern "C" {
+NO_OPT_ATTR int SymbolizerBenchmarkFn0(int x) { return x + 0; }
+NO_OPT_ATTR int SymbolizerBenchmarkFn1(int x) { return x + 1; }
+NO_OPT_ATTR int SymbolizerBenchmarkFn2(int x) { return x + 2; }
+NO_OPT_ATTR int SymbolizerBenchmarkFn3(int x) { return x + 3; }
+}
+
+std::vector<uintptr_t> LookupAddrs() {
+  return {reinterpret_cast<uintptr_t>(&SymbolizerBenchmarkFn0),
+          reinterpret_cast<uintptr_t>(&SymbolizerBenchmarkFn1),
+          reinterpret_cast<uintptr_t>(&SymbolizerBenchmarkFn2),
+          reinterpret_cast<uintptr_t>(&SymbolizerBenchmarkFn3)};
+}
+
+// Each iteration models the symbolization of one process: the symbolizer starts cold,
+// then resolves state.range(0) addresses.
+
+// NOLINTNEXTLINE : runtime/references.
+static void BM_bcc_symcache(benchmark::State& state) {
+  size_t num_lookup_iterations = state.range(0);
+  const std::vector<uintptr_t> addrs = LookupAddrs();
+  const int pid = getpid();
+
+  for (auto _ : state) {
+    void* symcache = bcc_symcache_new(pid, nullptr);
+    for (size_t i = 0; i < num_lookup_iterations; ++i) {
+      struct bcc_symbol sym;
+      bcc_symcache_resolve(symcache, addrs[i % addrs.size()], &sym);
+      benchmark::DoNotOptimize(sym.demangle_name);
+      bcc_symbol_free_demangle_name(&sym);
+    }
+    bcc_free_symcache(symcache, pid);
+  }
+}
+
+// NOLINTNEXTLINE : runtime/references.
+static void BM_elf_symbolizer(benchmark::State& state) {
+  size_t num_lookup_iterations = state.range(0);
+  const std::vector<uintptr_t> addrs = LookupAddrs();
+  const int pid = getpid();
+
+  for (auto _ : state) {
+    ElfSymbolizer symbolizer;
+    for (size_t i = 0; i < num_lookup_iterations; ++i) {
+      std::string_view sym = symbolizer.Lookup(pid, addrs[i % addrs.size()]);
+      benchmark::DoNotOptimize(sym);
+    }
+  }
+}
+
+// Models many replicas of the same binary: a forked child (with identical mappings) keeps the
+// binary loaded, so each process only pays for reading its /proc/<pid>/maps.
+// NOLINTNEXTLINE : runtime/references.
+static void BM_elf_symbolizer_shared(benchmark::State& state) {
+  size_t num_lookup_iterations = state.range(0);
+  const std::vector<uintptr_t> addrs = LookupAddrs();
+  const int pid = getpid();
+
+  const int sibling_pid = fork();
+  if (sibling_pid == 0) {
+    pause();
+    _exit(0);
+  }
+
+  ElfSymbolizer symbolizer;
+  benchmark::DoNotOptimize(symbolizer.Lookup(sibling_pid, addrs[0]));
+
+  for (auto _ : state) {
+    for (size_t i = 0; i < num_lookup_iterations; ++i) {
+      std::string_view sym = symbolizer.Lookup(pid, addrs[i % addrs.size()]);
+      benchmark::DoNotOptimize(sym);
+    }
+    symbolizer.RemovePID(pid);
+  }
+
+  kill(sibling_pid, SIGKILL);
+  waitpid(sibling_pid, nullptr, 0);
+}
+
+BENCHMARK(BM_bcc_symcache)->RangeMultiplier(4)->Range(1, 1024);
+BENCHMARK(BM_elf_symbolizer)->RangeMultiplier(4)->Range(1, 1024);
+BENCHMARK(BM_elf_symbolizer_shared)->RangeMultiplier(4)->Range(1, 1024);
@@ -26,12 +26,17 @@
 
 #include "src/common/base/base.h"
 #include "src/common/system/proc_parser.h"
+#include "src/common/system/proc_pid_sampler.h"
 #include "src/shared/metadata/metadata.h"
 
+DEFINE_int32(stirling_process_stats_sampler_threads, 2,
+             "Maximum number of threads used to sample the /proc files of processes.");
+
 namespace px {
 namespace stirling {
 
 using system::ProcParser;
+using system::ProcPIDSampler;
 
 Status ProcessStatsConnector::InitImpl() {
   sample_push_freq_mgr_.set_sampling_period(kSamplingPeriod);
@@ -43,34 +48,35 @@ Status ProcessStatsConnector::StopImpl() { return Status::OK(); }
 
 void ProcessStatsConnector::TransferProcessStatsTable(ConnectorContext* ctx,
                                                       DataTable* data_table) {
-  const absl::flat_hash_map<md::UPID, md::PIDInfoUPtr>& pid_info_by_upid = ctx->GetPIDInfoMap();
+  const md::PIDInfoMap& pid_info_by_upid = ctx->GetPIDInfoMap();
 
   int64_t timestamp = AdjustedSteadyClockNowNS();
 
+  upids_.clear();
+  pids_.clear();
   for (const auto& [upid, pid_info] : pid_info_by_upid) {
     // TODO(zasgar): Fix condition for dead pids after helper function is added.
     if (pid_info == nullptr || pid_info->stop_time_ns() > 0) {
       // PID has been stopped.
       continue;
     }
+    upids_.push_back(upid);
+    pids_.push_back(upid.pid());
+  }
 
-    ProcParser::ProcessStats stats;
-    int32_t pid = upid.pid();
-    // TODO(zasgar): We should double check the process start time to make sure it still the same
-    // PID.
-    auto s1 = proc_parser_->ParseProcPIDStat(pid, &stats);
-    if (!s1.ok()) {
-      VLOG(1) << absl::Substitute(
-          "Failed to fetch cpu stat info for PID ($0). Error=\"$1\" skipping.", pid, s1.msg());
-      continue;
-    }
+  // TODO(zasgar): We should double check the process start time to make sure it still the same
+  // PID.
+  proc_sampler_->SampleProcessStats(pids_, &samples_);
 
-    auto s2 = proc_parser_->ParseProcPIDStatIO(pid, &stats);
-    if (!s2.ok()) {
-      VLOG(1) << absl::Substitute(
-          "Failed to fetch IO stat info for PID ($0). Error=\"$1\" skipping.", pid, s2.msg());
+  for (size_t i = 0; i < samples_.size(); ++i) {
+    const md::UPID& upid = upids_[i];
+    const ProcPIDSampler::ProcessStatsSample& sample = samples_[i];
+    if (!sample.status.ok()) {
+      VLOG(1) << absl::Substitute("Failed to fetch stats for PID ($0). Error=\"$1\" skipping.",
+                                  sample.pid, sample.status.msg());
       continue;
     }
+    const ProcParser::ProcessStats& stats = sample.stats;
 
     DataTable::RecordBuilder<&kProcessStatsTable> r(data_table, timestamp);
     // TODO(oazizi): Enable version below, once rest of the agent supports tabletization.
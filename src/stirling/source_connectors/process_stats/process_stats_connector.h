@@ -25,12 +25,15 @@
 #include <vector>
 
 #include "src/common/base/base.h"
+#include "src/common/system/proc_pid_sampler.h"
 #include "src/common/system/system.h"
 #include "src/shared/metadata/metadata.h"
 #include "src/stirling/core/canonical_types.h"
 #include "src/stirling/core/source_connector.h"
 #include "src/stirling/source_connectors/process_stats/process_stats_table.h"
 
+DECLARE_int32(stirling_process_stats_sampler_threads);
+
 namespace px {
 namespace stirling {
 
@@ -62,13 +65,19 @@ class ProcessStatsConnector : public SourceConnector {
  protected:
   explicit ProcessStatsConnector(std::string_view source_name)
       : SourceConnector(source_name, kTables) {
-    proc_parser_ = std::make_unique<system::ProcParser>(sysconfig_);
+    proc_sampler_ = std::make_unique<system::ProcPIDSampler>(
+        sysconfig_, FLAGS_stirling_process_stats_sampler_threads);
   }
 
  private:
   void TransferProcessStatsTable(ConnectorContext* ctx, DataTable* data_table);
 
-  std::unique_ptr<system::ProcParser> proc_parser_;
+  std::unique_ptr<system::ProcPIDSampler> proc_sampler_;
+
+  // Reused across iterations, to avoid re-allocations.
+  std::vector<md::UPID> upids_;
+  std::vector<int32_t> pids_;
+  std::vector<system::ProcPIDSampler::ProcessStatsSample> samples_;
 };
 
 }  // namespace stirling
@@ -176,6 +176,7 @@ Status SocketTraceConnector::InitImpl() {
 
   PL_RETURN_IF_ERROR(OpenPerfBuffers(kPerfBufferSpecs, this));
   LOG(INFO) << absl::Substitute("Number of perf buffers opened = $0", kPerfBufferSpecs.size());
+  set_event_driven();
 
   // Set trace role to BPF probes.
   for (const auto& p : TrafficProtocolEnumValues()) {
@@ -440,7 +441,8 @@ std::string ProbeLossMessage(std::string_view perf_buffer_name, uint64_t lost) {
 
 }  // namespace
 
-void SocketTraceConnector::HandleDataEventLoss(void* /*cb_cookie*/, uint64_t lost) {
+void SocketTraceConnector::HandleDataEventLoss(void* cb_cookie, uint64_t lost) {
+  static_cast<SocketTraceConnector*>(cb_cookie)->RecordLostEvents(lost);
   VLOG(1) << ProbeLossMessage("socket_data_events", lost);
 }
 
@@ -450,7 +452,8 @@ void SocketTraceConnector::HandleControlEvent(void* cb_cookie, void* data, int /
   connector->AcceptControlEvent(*static_cast<const socket_control_event_t*>(data));
 }
 
-void SocketTraceConnector::HandleControlEventLoss(void* /*cb_cookie*/, uint64_t lost) {
+void SocketTraceConnector::HandleControlEventLoss(void* cb_cookie, uint64_t lost) {
+  static_cast<SocketTraceConnector*>(cb_cookie)->RecordLostEvents(lost);
   VLOG(1) << ProbeLossMessage("socket_control_events", lost);
 }
 
@@ -460,7 +463,8 @@ void SocketTraceConnector::HandleMMapEvent(void* cb_cookie, void* data, int /*da
   connector->uprobe_mgr_.NotifyMMapEvent(*static_cast<upid_t*>(data));
 }
 
-void SocketTraceConnector::HandleMMapEventLoss(void* /*cb_cookie*/, uint64_t lost) {
+void SocketTraceConnector::HandleMMapEventLoss(void* cb_cookie, uint64_t lost) {
+  static_cast<SocketTraceConnector*>(cb_cookie)->RecordLostEvents(lost);
   VLOG(1) << ProbeLossMessage("mmap_events", lost);
 }
 
@@ -479,7 +483,8 @@ void SocketTraceConnector::HandleHTTP2HeaderEvent(void* cb_cookie, void* data, i
   connector->AcceptHTTP2Header(std::move(event));
 }
 
-void SocketTraceConnector::HandleHTTP2HeaderEventLoss(void* /*cb_cookie*/, uint64_t lost) {
+void SocketTraceConnector::HandleHTTP2HeaderEventLoss(void* cb_cookie, uint64_t lost) {
+  static_cast<SocketTraceConnector*>(cb_cookie)->RecordLostEvents(lost);
   VLOG(1) << ProbeLossMessage("go_grpc_header_events", lost);
 }
 
@@ -499,7 +504,8 @@ void SocketTraceConnector::HandleHTTP2Data(void* cb_cookie, void* data, int /*da
   connector->AcceptHTTP2Data(std::move(event));
 }
 
-void SocketTraceConnector::HandleHTTP2DataLoss(void* /*cb_cookie*/, uint64_t lost) {
+void SocketTraceConnector::HandleHTTP2DataLoss(void* cb_cookie, uint64_t lost) {
+  static_cast<SocketTraceConnector*>(cb_cookie)->RecordLostEvents(lost);
   VLOG(1) << ProbeLossMessage("go_grpc_data_events", lost);
 }
 
@@ -22,12 +22,15 @@
 #include <unistd.h>
 
 #include <algorithm>
+#include <atomic>
 #include <filesystem>
 #include <map>
+#include <thread>
 
 #include "src/common/base/base.h"
 #include "src/common/base/utils.h"
 #include "src/common/fs/fs_wrapper.h"
+#include "src/common/system/boot_clock.h"
 #include "src/stirling/bpf_tools/macros.h"
 #include "src/stirling/obj_tools/dwarf_tools.h"
 #include "src/stirling/source_connectors/socket_tracer/bcc_bpf_intf/symaddrs.h"
@@ -40,6 +43,10 @@ DEFINE_bool(stirling_rescan_for_dlopen, false,
 DEFINE_double(stirling_rescan_exp_backoff_factor, 2.0,
               "Exponential backoff factor used in decided how often to rescan binaries for "
               "dynamically loaded libraries");
+DEFINE_int32(stirling_uprobe_analysis_threads, 4,
+             "Number of threads used to analyze new binaries for uprobe deployment");
+DEFINE_int32(stirling_uprobe_binary_cache_size, 1024,
+             "Maximum number of binaries for which uprobe analysis results are cached");
 
 namespace px {
 namespace stirling {
@@ -47,7 +54,10 @@ namespace stirling {
 using ::px::stirling::obj_tools::DwarfReader;
 using ::px::stirling::obj_tools::ElfReader;
 
-UProbeManager::UProbeManager(bpf_tools::BCCWrapper* bcc) : bcc_(bcc) {
+UProbeManager::UProbeManager(bpf_tools::BCCWrapper* bcc)
+    : bcc_(bcc),
+      go_binary_cache_(FLAGS_stirling_uprobe_binary_cache_size),
+      openssl_symaddrs_cache_(FLAGS_stirling_uprobe_binary_cache_size) {
   proc_parser_ = std::make_unique<system::ProcParser>(system::Config::GetInstance());
 }
 
@@ -67,14 +77,13 @@ void UProbeManager::Init(bool enable_http2_tracing, bool disable_self_probing) {
 
 void UProbeManager::NotifyMMapEvent(upid_t upid) { upids_with_mmap_.insert(upid); }
 
-StatusOr<int> UProbeManager::AttachUProbeTmpl(const ArrayView<UProbeTmpl>& probe_tmpls,
-                                              const std::string& binary,
-                                              obj_tools::ElfReader* elf_reader) {
+StatusOr<std::vector<bpf_tools::UProbeSpec>> UProbeManager::ResolveUProbeTmpls(
+    const ArrayView<UProbeTmpl>& probe_tmpls, obj_tools::ElfReader* elf_reader) {
   using bpf_tools::BPFProbeAttachType;
 
-  int uprobe_count = 0;
+  std::vector<bpf_tools::UProbeSpec> specs;
   for (const auto& tmpl : probe_tmpls) {
-    bpf_tools::UProbeSpec spec = {binary,
+    bpf_tools::UProbeSpec spec = {{},
                                   {},
                                   0,
                                   bpf_tools::UProbeSpec::kDefaultPID,
@@ -95,8 +104,7 @@ StatusOr<int> UProbeManager::AttachUProbeTmpl(const ArrayView<UProbeTmpl>& probe
         case BPFProbeAttachType::kEntry:
         case BPFProbeAttachType::kReturn: {
           spec.symbol = symbol_info.name;
-          PL_RETURN_IF_ERROR(bcc_->AttachUProbe(spec));
-          ++uprobe_count;
+          specs.push_back(spec);
           break;
         }
         case BPFProbeAttachType::kReturnInsts: {
@@ -111,10 +119,10 @@ StatusOr<int> UProbeManager::AttachUProbeTmpl(const ArrayView<UProbeTmpl>& probe
           PL_ASSIGN_OR_RETURN(std::vector<uint64_t> ret_inst_addrs,
                               elf_reader->FuncRetInstAddrs(symbol_info));
           for (const uint64_t& addr : ret_inst_addrs) {
-            spec.attach_type = BPFProbeAttachType::kEntry;
-            spec.address = addr;
-            PL_RETURN_IF_ERROR(bcc_->AttachUProbe(spec));
-            ++uprobe_count;
+            bpf_tools::UProbeSpec ret_spec = spec;
+            ret_spec.attach_type = BPFProbeAttachType::kEntry;
+            ret_spec.address = addr;
+            specs.push_back(std::move(ret_spec));
           }
           break;
         }
@@ -123,48 +131,30 @@ StatusOr<int> UProbeManager::AttachUProbeTmpl(const ArrayView<UProbeTmpl>& probe
       }
     }
   }
-  return uprobe_count;
+  return specs;
 }
 
-Status UProbeManager::UpdateOpenSSLSymAddrs(std::filesystem::path libcrypto_path, uint32_t pid) {
-  PL_ASSIGN_OR_RETURN(struct openssl_symaddrs_t symaddrs, OpenSSLSymAddrs(libcrypto_path));
-
-  openssl_symaddrs_map_->UpdateValue(pid, symaddrs);
-
-  return Status::OK();
-}
-
-Status UProbeManager::UpdateGoCommonSymAddrs(ElfReader* elf_reader, DwarfReader* dwarf_reader,
-                                             const std::vector<int32_t>& pids) {
-  PL_ASSIGN_OR_RETURN(struct go_common_symaddrs_t symaddrs,
-                      GoCommonSymAddrs(elf_reader, dwarf_reader));
-
-  for (auto& pid : pids) {
-    go_common_symaddrs_map_->UpdateValue(pid, symaddrs);
+StatusOr<int> UProbeManager::AttachUProbes(const std::vector<bpf_tools::UProbeSpec>& specs,
+                                           const std::string& binary) {
+  int uprobe_count = 0;
+  for (bpf_tools::UProbeSpec spec : specs) {
+    spec.binary_path = binary;
+    PL_RETURN_IF_ERROR(bcc_->AttachUProbe(spec));
+    ++uprobe_count;
   }
-
-  return Status::OK();
+  return uprobe_count;
 }
 
-Status UProbeManager::UpdateGoHTTP2SymAddrs(ElfReader* elf_reader, DwarfReader* dwarf_reader,
-                                            const std::vector<int32_t>& pids) {
-  PL_ASSIGN_OR_RETURN(struct go_http2_symaddrs_t symaddrs,
-                      GoHTTP2SymAddrs(elf_reader, dwarf_reader));
-
-  for (auto& pid : pids) {
-    go_http2_symaddrs_map_->UpdateValue(pid, symaddrs);
+Status UProbeManager::UpdateOpenSSLSymAddrs(std::filesystem::path libcrypto_path, uint32_t pid) {
+  // Detecting the OpenSSL version is expensive, so it is done once per library file.
+  PL_ASSIGN_OR_RETURN(obj_tools::BinaryKey key, obj_tools::GetBinaryKey(libcrypto_path));
+  std::shared_ptr<const struct openssl_symaddrs_t> symaddrs = openssl_symaddrs_cache_.Lookup(key);
+  if (symaddrs == nullptr) {
+    PL_ASSIGN_OR_RETURN(struct openssl_symaddrs_t new_symaddrs, OpenSSLSymAddrs(libcrypto_path));
+    symaddrs = openssl_symaddrs_cache_.Insert(key, "", new_symaddrs);
   }
 
-  return Status::OK();
-}
-
-Status UProbeManager::UpdateGoTLSSymAddrs(ElfReader* elf_reader, DwarfReader* dwarf_reader,
-                                          const std::vector<int32_t>& pids) {
-  PL_ASSIGN_OR_RETURN(struct go_tls_symaddrs_t symaddrs, GoTLSSymAddrs(elf_reader, dwarf_reader));
-
-  for (auto& pid : pids) {
-    go_tls_symaddrs_map_->UpdateValue(pid, symaddrs);
-  }
+  openssl_symaddrs_map_->UpdateValue(pid, *symaddrs);
 
   return Status::OK();
 }
@@ -273,25 +263,28 @@ StatusOr<int> UProbeManager::AttachOpenSSLUProbes(uint32_t pid) {
 }
 
 StatusOr<int> UProbeManager::AttachGoTLSUProbes(const std::string& binary,
-                                                obj_tools::ElfReader* elf_reader,
-                                                obj_tools::DwarfReader* dwarf_reader,
+                                                const GoBinaryAnalysis& analysis,
                                                 const std::vector<int32_t>& pids) {
-  // Step 1: Update BPF symbols_map on all new PIDs.
-  Status s = UpdateGoTLSSymAddrs(elf_reader, dwarf_reader, pids);
-  if (!s.ok()) {
+  if (!analysis.tls_symaddrs.has_value()) {
     // Doesn't appear to be a binary with the mandatory symbols.
     // Might not even be a golang binary.
     // Either way, not of interest to probe.
     return 0;
   }
 
+  // Step 1: Update BPF symbols_map on all new PIDs.
+  for (auto& pid : pids) {
+    go_tls_symaddrs_map_->UpdateValue(pid, analysis.tls_symaddrs.value());
+  }
+
   // Step 2: Deploy uprobes on all new binaries.
   auto result = go_tls_probed_binaries_.insert(binary);
   if (!result.second) {
     // This is not a new binary, so nothing more to do.
     return 0;
   }
-  return AttachUProbeTmpl(kGoTLSUProbeTmpls, binary, elf_reader);
+  PL_RETURN_IF_ERROR(analysis.tls_probes);
+  return AttachUProbes(analysis.tls_probes.ValueOrDie(), binary);
 }
 
 // TODO(oazizi/yzhao): Should HTTP uprobes use a different set of perf buffers than the kprobes?
@@ -299,22 +292,25 @@ StatusOr<int> UProbeManager::AttachGoTLSUProbes(const std::string& binary,
 // cleanly. For example, right now, enabling uprobe & kprobe simultaneously can crash Stirling,
 // because of the mixed & duplicate data events from these 2 sources.
 StatusOr<int> UProbeManager::AttachGoHTTP2Probes(const std::string& binary,
-                                                 obj_tools::ElfReader* elf_reader,
-                                                 obj_tools::DwarfReader* dwarf_reader,
+                                                 const GoBinaryAnalysis& analysis,
                                                  const std::vector<int32_t>& pids) {
-  // Step 1: Update BPF symaddrs for this binary.
-  Status s = UpdateGoHTTP2SymAddrs(elf_reader, dwarf_reader, pids);
-  if (!s.ok()) {
+  if (!analysis.http2_symaddrs.has_value()) {
     return 0;
   }
 
+  // Step 1: Update BPF symaddrs for this binary.
+  for (auto& pid : pids) {
+    go_http2_symaddrs_map_->UpdateValue(pid, analysis.http2_symaddrs.value());
+  }
+
   // Step 2: Deploy uprobes on all new binaries.
   auto result = go_http2_probed_binaries_.insert(binary);
   if (!result.second) {
     // This is not a new binary, so nothing more to do.
     return 0;
   }
-  return AttachUProbeTmpl(kHTTP2ProbeTmpls, binary, elf_reader);
+  PL_RETURN_IF_ERROR(analysis.http2_probes);
+  return AttachUProbes(analysis.http2_probes.ValueOrDie(), binary);
 }
 
 namespace {
@@ -364,6 +360,7 @@ std::thread UProbeManager::RunDeployUProbesThread(const absl::flat_hash_set<md::
 
 void UProbeManager::CleanupSymaddrMaps(const absl::flat_hash_set<md::UPID>& deleted_upids) {
   for (const auto& pid : deleted_upids) {
+    traced_upids_.erase(pid);
     openssl_symaddrs_map_->RemoveValue(pid.pid());
     go_common_symaddrs_map_->RemoveValue(pid.pid());
     go_tls_symaddrs_map_->RemoveValue(pid.pid());
@@ -393,17 +390,87 @@ int UProbeManager::DeployOpenSSLUProbes(const absl::flat_hash_set<md::UPID>& pid
   return uprobe_count;
 }
 
-int UProbeManager::DeployGoUProbes(const absl::flat_hash_set<md::UPID>& pids) {
-  int uprobe_count = 0;
+std::shared_ptr<const UProbeManager::GoBinaryAnalysis> UProbeManager::AnalyzeGoBinary(
+    const std::string& binary, const obj_tools::BinaryKey& key) {
+  GoBinaryAnalysis analysis;
+
+  // Read binary's symbols.
+  StatusOr<std::unique_ptr<ElfReader>> elf_reader_status = ElfReader::Create(binary);
+  if (!elf_reader_status.ok()) {
+    LOG(WARNING) << absl::Substitute(
+        "Cannot analyze binary $0 for uprobe deployment. "
+        "If file is under /var/lib, container may have terminated. "
+        "Message = $1",
+        binary, elf_reader_status.msg());
+    return go_binary_cache_.Insert(key, "", std::move(analysis));
+  }
+  std::unique_ptr<ElfReader> elf_reader = elf_reader_status.ConsumeValueOrDie();
+  const std::string& build_id = elf_reader->build_id();
+
+  // The same binary may have been analyzed already under a different file (e.g. a different
+  // image layer). If so, skip the expensive DWARF analysis below.
+  std::shared_ptr<const GoBinaryAnalysis> cached = go_binary_cache_.LookupBuildID(key, build_id);
+  if (cached != nullptr) {
+    return cached;
+  }
 
-  static int32_t kPID = getpid();
+  // Avoid going passed this point if not a golang program.
+  // The DwarfReader is memory intensive, and the remaining probes are Golang specific.
+  // TODO(oazizi): Consolidate with similar check in dynamic_tracing/autogen.cc.
+  bool is_golang_binary = elf_reader->SymbolAddress("runtime.buildVersion").has_value();
+  if (!is_golang_binary) {
+    return go_binary_cache_.Insert(key, build_id, std::move(analysis));
+  }
 
-  for (const auto& [binary, pid_vec] : ConvertPIDsListToMap(pids, &fp_resolver_)) {
-    // Don't bother rescanning binaries that have been scanned before to avoid unnecessary work.
-    if (!scanned_binaries_.insert(binary).second) {
-      continue;
+  // Only a handful of symbols are looked up, so index lazily rather than indexing all DIEs.
+  StatusOr<std::unique_ptr<DwarfReader>> dwarf_reader_status =
+      DwarfReader::Create(binary, obj_tools::DwarfIndexMode::kLazy);
+  if (!dwarf_reader_status.ok()) {
+    VLOG(1) << absl::Substitute(
+        "Failed to get binary $0 debug symbols. Cannot deploy uprobes. "
+        "Message = $1",
+        binary, dwarf_reader_status.msg());
+    return go_binary_cache_.Insert(key, build_id, std::move(analysis));
+  }
+  std::unique_ptr<DwarfReader> dwarf_reader = dwarf_reader_status.ConsumeValueOrDie();
+
+  StatusOr<struct go_common_symaddrs_t> common_symaddrs =
+      GoCommonSymAddrs(elf_reader.get(), dwarf_reader.get());
+  if (!common_symaddrs.ok()) {
+    VLOG(1) << absl::Substitute(
+        "Golang binary $0 does not have the mandatory symbols (e.g. TCPConn).", binary);
+    return go_binary_cache_.Insert(key, build_id, std::move(analysis));
+  }
+  analysis.common_symaddrs = common_symaddrs.ConsumeValueOrDie();
+
+  StatusOr<struct go_tls_symaddrs_t> tls_symaddrs =
+      GoTLSSymAddrs(elf_reader.get(), dwarf_reader.get());
+  if (tls_symaddrs.ok()) {
+    analysis.tls_symaddrs = tls_symaddrs.ConsumeValueOrDie();
+    analysis.tls_probes = ResolveUProbeTmpls(kGoTLSUProbeTmpls, elf_reader.get());
+  }
+
+  if (cfg_enable_http2_tracing_) {
+    StatusOr<struct go_http2_symaddrs_t> http2_symaddrs =
+        GoHTTP2SymAddrs(elf_reader.get(), dwarf_reader.get());
+    if (http2_symaddrs.ok()) {
+      analysis.http2_symaddrs = http2_symaddrs.ConsumeValueOrDie();
+      analysis.http2_probes = ResolveUProbeTmpls(kHTTP2ProbeTmpls, elf_reader.get());
     }
+  }
 
+  return go_binary_cache_.Insert(key, build_id, std::move(analysis));
+}
+
+std::vector<UProbeManager::GoBinaryInfo> UProbeManager::AnalyzeGoBinaries(
+    const std::map<std::string, std::vector<int32_t>>& binary_pids) {
+  static int32_t kPID = getpid();
+
+  // Step 1: Look up the analysis of each binary. Binaries that have not been seen before are
+  // queued for analysis, once per unique file.
+  std::vector<GoBinaryInfo> binaries;
+  absl::flat_hash_map<obj_tools::BinaryKey, size_t> to_analyze;
+  for (const auto& [binary, pid_vec] : binary_pids) {
     if (cfg_disable_self_probing_) {
       // Don't try to attach uprobes to self.
       // This speeds up stirling_wrapper initialization significantly.
@@ -412,50 +479,80 @@ int UProbeManager::DeployGoUProbes(const absl::flat_hash_set<md::UPID>& pids) {
       }
     }
 
-    // Read binary's symbols.
-    StatusOr<std::unique_ptr<ElfReader>> elf_reader_status = ElfReader::Create(binary);
-    if (!elf_reader_status.ok()) {
-      LOG(WARNING) << absl::Substitute(
-          "Cannot analyze binary $0 for uprobe deployment. "
-          "If file is under /var/lib, container may have terminated. "
-          "Message = $1",
-          binary, elf_reader_status.msg());
-      continue;
+    PL_ASSIGN_OR(obj_tools::BinaryKey key, obj_tools::GetBinaryKey(binary), continue);
+    std::shared_ptr<const GoBinaryAnalysis> analysis = go_binary_cache_.Lookup(key);
+    if (analysis == nullptr) {
+      to_analyze.try_emplace(key, binaries.size());
     }
-    std::unique_ptr<ElfReader> elf_reader = elf_reader_status.ConsumeValueOrDie();
+    binaries.push_back({binary, &pid_vec, key, std::move(analysis)});
+  }
 
-    // Avoid going passed this point if not a golang program.
-    // The DwarfReader is memory intensive, and the remaining probes are Golang specific.
-    // TODO(oazizi): Consolidate with similar check in dynamic_tracing/autogen.cc.
-    bool is_golang_binary = elf_reader->SymbolAddress("runtime.buildVersion").has_value();
-    if (!is_golang_binary) {
-      continue;
+  if (to_analyze.empty()) {
+    return binaries;
+  }
+
+  // Step 2: Analyze the new binaries in parallel. This is the expensive part of deployment,
+  // and is independent per binary.
+  std::vector<GoBinaryInfo*> work;
+  for (const auto& [key, idx] : to_analyze) {
+    work.push_back(&binaries[idx]);
+  }
+
+  std::atomic<size_t> next = 0;
+  auto analyze_fn = [this, &work, &next]() {
+    for (size_t i = next++; i < work.size(); i = next++) {
+      work[i]->analysis = AnalyzeGoBinary(work[i]->binary, work[i]->key);
     }
+  };
 
-    StatusOr<std::unique_ptr<DwarfReader>> dwarf_reader_status = DwarfReader::Create(binary);
-    if (!dwarf_reader_status.ok()) {
-      VLOG(1) << absl::Substitute(
-          "Failed to get binary $0 debug symbols. Cannot deploy uprobes. "
-          "Message = $1",
-          binary, dwarf_reader_status.msg());
-      continue;
+  int num_threads = std::min<int>(FLAGS_stirling_uprobe_analysis_threads, work.size());
+  std::vector<std::thread> threads;
+  for (int i = 1; i < num_threads; ++i) {
+    threads.emplace_back(analyze_fn);
+  }
+  analyze_fn();
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  // Binaries sharing a file were only analyzed once.
+  for (GoBinaryInfo& info : binaries) {
+    if (info.analysis == nullptr) {
+      info.analysis = binaries[to_analyze[info.key]].analysis;
     }
-    std::unique_ptr<DwarfReader> dwarf_reader = dwarf_reader_status.ConsumeValueOrDie();
+  }
+  return binaries;
+}
 
-    Status s = UpdateGoCommonSymAddrs(elf_reader.get(), dwarf_reader.get(), pid_vec);
-    if (!s.ok()) {
-      VLOG(1) << absl::Substitute(
-          "Golang binary $0 does not have the mandatory symbols (e.g. TCPConn).", binary);
+int UProbeManager::DeployGoUProbes(const absl::flat_hash_set<md::UPID>& pids) {
+  int uprobe_count = 0;
+
+  std::map<std::string, std::vector<int32_t>> binary_pids =
+      ConvertPIDsListToMap(pids, &fp_resolver_);
+  std::vector<GoBinaryInfo> binaries = AnalyzeGoBinaries(binary_pids);
+
+  absl::flat_hash_map<int32_t, md::UPID> upids_by_pid;
+  for (const auto& upid : pids) {
+    upids_by_pid.emplace(upid.pid(), upid);
+  }
+
+  // Populate symbol addresses and attach uprobes. BPF operations are sequential.
+  for (const GoBinaryInfo& info : binaries) {
+    const GoBinaryAnalysis& analysis = *info.analysis;
+    if (!analysis.common_symaddrs.has_value()) {
       continue;
     }
 
+    for (auto& pid : *info.pids) {
+      go_common_symaddrs_map_->UpdateValue(pid, analysis.common_symaddrs.value());
+    }
+
     // GoTLS Probes.
     {
-      StatusOr<int> attach_status =
-          AttachGoTLSUProbes(binary, elf_reader.get(), dwarf_reader.get(), pid_vec);
+      StatusOr<int> attach_status = AttachGoTLSUProbes(info.binary, analysis, *info.pids);
       if (!attach_status.ok()) {
         LOG_FIRST_N(WARNING, 10) << absl::Substitute("Failed to attach GoTLS Uprobes to $0: $1",
-                                                     binary, attach_status.ToString());
+                                                     info.binary, attach_status.ToString());
       } else {
         uprobe_count += attach_status.ValueOrDie();
       }
@@ -463,20 +560,58 @@ int UProbeManager::DeployGoUProbes(const absl::flat_hash_set<md::UPID>& pids) {
 
     // Go HTTP2 Probes.
     if (cfg_enable_http2_tracing_) {
-      StatusOr<int> attach_status =
-          AttachGoHTTP2Probes(binary, elf_reader.get(), dwarf_reader.get(), pid_vec);
+      StatusOr<int> attach_status = AttachGoHTTP2Probes(info.binary, analysis, *info.pids);
       if (!attach_status.ok()) {
         LOG_FIRST_N(WARNING, 10) << absl::Substitute("Failed to attach HTTP2 Uprobes to $0: $1",
-                                                     binary, attach_status.ToString());
+                                                     info.binary, attach_status.ToString());
       } else {
         uprobe_count += attach_status.ValueOrDie();
       }
     }
+
+    for (auto& pid : *info.pids) {
+      auto iter = upids_by_pid.find(pid);
+      if (iter != upids_by_pid.end()) {
+        RecordTraced(iter->second);
+      }
+    }
   }
 
   return uprobe_count;
 }
 
+void UProbeManager::RecordTraced(const md::UPID& upid) {
+  // Processes are attached to again when they are rescanned, e.g. after a dlopen.
+  if (!traced_upids_.insert(upid).second) {
+    return;
+  }
+
+  const system::Config& sysconfig = system::Config::GetInstance();
+  const int64_t start_time_ns = static_cast<int64_t>(upid.start_ts()) * 1000 * 1000 * 1000 /
+                                sysconfig.KernelTicksPerSecond();
+  const int64_t now_ns = px::chrono::boot_clock::now().time_since_epoch().count();
+  const int64_t time_to_trace_ns = std::max<int64_t>(now_ns - start_time_ns, 0);
+
+  ++stats_.num_traced_upids;
+  stats_.time_to_trace_total_ns += time_to_trace_ns;
+  stats_.time_to_trace_max_ns = std::max(stats_.time_to_trace_max_ns, time_to_trace_ns);
+}
+
+UProbeManager::Stats UProbeManager::stats() {
+  const std::lock_guard<std::mutex> lock(deploy_uprobes_mutex_);
+  return stats_;
+}
+
+std::string UProbeManager::Stats::ToString() const {
+  return absl::Substitute(
+      "traced_upids=$0 avg_time_to_trace_ms=$1 max_time_to_trace_ms=$2 binary_cache_hits=$3 "
+      "binary_cache_build_id_hits=$4 binary_cache_misses=$5",
+      num_traced_upids,
+      num_traced_upids == 0 ? 0 : time_to_trace_total_ns / num_traced_upids / 1000 / 1000,
+      time_to_trace_max_ns / 1000 / 1000, binary_cache_hits, binary_cache_build_id_hits,
+      binary_cache_misses);
+}
+
 absl::flat_hash_set<md::UPID> UProbeManager::PIDsToRescanForUProbes() {
   // Count number of calls to this function.
   ++rescan_counter_;
@@ -545,6 +680,11 @@ void UProbeManager::DeployUProbes(const absl::flat_hash_set<md::UPID>& pids) {
   if (uprobe_count != 0) {
     LOG(INFO) << absl::Substitute("Number of uprobes deployed = $0", uprobe_count);
   }
+
+  stats_.binary_cache_hits = go_binary_cache_.hits() + openssl_symaddrs_cache_.hits();
+  stats_.binary_cache_build_id_hits = go_binary_cache_.build_id_hits();
+  stats_.binary_cache_misses = go_binary_cache_.misses() + openssl_symaddrs_cache_.misses();
+  VLOG(1) << absl::Substitute("UProbe deployment stats: $0", stats_.ToString());
 }
 
 }  // namespace stirling
@@ -18,7 +18,9 @@
 
 #pragma once
 
+#include <map>
 #include <memory>
+#include <optional>
 #include <string>
 #include <utility>
 #include <vector>
@@ -26,6 +28,7 @@
 #include <absl/synchronization/mutex.h>
 
 #include "src/stirling/bpf_tools/bcc_wrapper.h"
+#include "src/stirling/obj_tools/binary_analysis_cache.h"
 #include "src/stirling/obj_tools/dwarf_tools.h"
 #include "src/stirling/obj_tools/elf_tools.h"
 
@@ -37,6 +40,8 @@
 
 DECLARE_bool(stirling_rescan_for_dlopen);
 DECLARE_double(stirling_rescan_exp_backoff_factor);
+DECLARE_int32(stirling_uprobe_analysis_threads);
+DECLARE_int32(stirling_uprobe_binary_cache_size);
 
 namespace px {
 namespace stirling {
@@ -127,6 +132,28 @@ class UProbeManager {
    */
   bool ThreadsRunning() { return num_deploy_uprobes_threads_ != 0; }
 
+  /**
+   * Statistics on uprobe deployment, for monitoring how quickly new processes get traced.
+   */
+  struct Stats {
+    // Number of Go processes for which symbol addresses were populated (i.e. now traced).
+    int64_t num_traced_upids = 0;
+    // Time from process start until its symbol addresses were populated.
+    int64_t time_to_trace_total_ns = 0;
+    int64_t time_to_trace_max_ns = 0;
+    // Binary analysis cache effectiveness.
+    int64_t binary_cache_hits = 0;
+    int64_t binary_cache_build_id_hits = 0;
+    int64_t binary_cache_misses = 0;
+
+    std::string ToString() const;
+  };
+
+  /**
+   * Returns the stats as of the end of the last deployment round.
+   */
+  Stats stats();
+
  private:
   inline static constexpr auto kHTTP2ProbeTmpls = MakeArray<UProbeTmpl>({
       // Probes on Golang net/http2 library.
@@ -194,6 +221,32 @@ class UProbeManager {
       },
   });
 
+  /**
+   * The result of analyzing a binary for Go uprobe deployment, which is cached per binary so that
+   * new instances of the same binary don't need to be re-analyzed.
+   */
+  struct GoBinaryAnalysis {
+    // Only set if this is a Go binary with the mandatory symbols (e.g. TCPConn).
+    std::optional<struct go_common_symaddrs_t> common_symaddrs;
+
+    // Only set if the binary uses the corresponding library.
+    std::optional<struct go_tls_symaddrs_t> tls_symaddrs;
+    std::optional<struct go_http2_symaddrs_t> http2_symaddrs;
+
+    // The resolved uprobes for the libraries above, without the binary path, which is filled in
+    // at attach time since the same analysis may apply to several paths.
+    StatusOr<std::vector<bpf_tools::UProbeSpec>> tls_probes;
+    StatusOr<std::vector<bpf_tools::UProbeSpec>> http2_probes;
+  };
+
+  // A binary with the PIDs of its new instances, and its analysis.
+  struct GoBinaryInfo {
+    std::string binary;
+    const std::vector<int32_t>* pids;
+    obj_tools::BinaryKey key;
+    std::shared_ptr<const GoBinaryAnalysis> analysis;
+  };
+
   // Probes on Golang crypto/tls library.
   inline static const auto kGoTLSUProbeTmpls = MakeArray<UProbeTmpl>({
       UProbeTmpl{
@@ -258,21 +311,38 @@ class UProbeManager {
    */
   int DeployGoUProbes(const absl::flat_hash_set<md::UPID>& pids);
 
+  /**
+   * Returns the analysis of a Go binary, either from the cache or by analyzing the binary.
+   * This is thread-safe, so that several binaries can be analyzed in parallel.
+   *
+   * @param binary The path to the binary.
+   * @param key The key of the binary, used to look up and populate the cache.
+   */
+  std::shared_ptr<const GoBinaryAnalysis> AnalyzeGoBinary(const std::string& binary,
+                                                          const obj_tools::BinaryKey& key);
+
+  /**
+   * Returns the analysis of each of the binaries. Binaries that are not in the cache are analyzed
+   * in parallel, once per unique file.
+   *
+   * @param binary_pids The binaries, with the PIDs of their new instances.
+   */
+  std::vector<GoBinaryInfo> AnalyzeGoBinaries(
+      const std::map<std::string, std::vector<int32_t>>& binary_pids);
+
   /**
    * Attaches the required probes for Go HTTP2 tracing to the specified binary, if it is a
    * compatible Go binary.
    *
    * @param binary The path to the binary on which to deploy Go HTTP2 probes.
-   * @param elf_reader ELF reader for the binary.
-   * @param dwarf_reader DWARF reader for the binary.
+   * @param analysis The analysis of the binary.
    * @param pids The list of PIDs that are new instances of the binary. Used to populate symbol
    *             addresses.
    * @return The number of uprobes deployed, or error. It is not considered an error if the binary
    *         is not a Go binary or doesn't use a Go HTTP2 library; instead the return value will be
    *         zero.
    */
-  StatusOr<int> AttachGoHTTP2Probes(const std::string& binary, obj_tools::ElfReader* elf_reader,
-                                    obj_tools::DwarfReader* dwarf_reader,
+  StatusOr<int> AttachGoHTTP2Probes(const std::string& binary, const GoBinaryAnalysis& analysis,
                                     const std::vector<int32_t>& pids);
 
   /**
@@ -280,15 +350,13 @@ class UProbeManager {
    * Go binary.
    *
    * @param binary The path to the binary on which to deploy Go HTTP2 probes.
-   * @param elf_reader ELF reader for the binary.
-   * @param dwarf_reader DWARF reader for the binary.
+   * @param analysis The analysis of the binary.
    * @param pids The list of PIDs that are new instances of the binary. Used to populate symbol
    *             addresses.
    * @return The number of uprobes deployed, or error. It is not an error if the binary
    *         is not a Go binary or doesn't use Go TLS; instead the return value will be zero.
    */
-  StatusOr<int> AttachGoTLSUProbes(const std::string& binary, obj_tools::ElfReader* elf_reader,
-                                   obj_tools::DwarfReader* dwarf_reader,
+  StatusOr<int> AttachGoTLSUProbes(const std::string& binary, const GoBinaryAnalysis& analysis,
                                    const std::vector<int32_t>& new_pids);
 
   /**
@@ -305,31 +373,32 @@ class UProbeManager {
   StatusOr<int> AttachOpenSSLUProbes(uint32_t pid);
 
   /**
-   * Helper function that calls BCCWrapper.AttachUprobe() from a probe template.
+   * Helper function that resolves probe templates into uprobe specs.
    * Among other things, it finds all symbol matches as specified in the template,
-   * and attaches a probe per matching symbol.
+   * and creates a probe spec per matching symbol.
    *
    * @param probe_tmpls Array of probe templates to process.
-   * @param binary The binary to uprobe.
    * @param elf_reader Pointer to an elf reader for the binary. Used to find symbol matches.
-   * @return Number of uprobes deployed, or error if uprobes failed to deploy. Zero uprobes
-   *         deploying because there are no symbol matches is not considered an error.
+   * @return The uprobe specs, without binary path, or error if they could not be resolved.
+   *         No symbol matches is not considered an error.
+   */
+  static StatusOr<std::vector<bpf_tools::UProbeSpec>> ResolveUProbeTmpls(
+      const ArrayView<UProbeTmpl>& probe_tmpls, obj_tools::ElfReader* elf_reader);
+
+  /**
+   * Attaches previously resolved uprobe specs to the binary.
+   * @return Number of uprobes deployed, or error if uprobes failed to deploy.
    */
-  StatusOr<int> AttachUProbeTmpl(const ArrayView<UProbeTmpl>& probe_tmpls,
-                                 const std::string& binary, obj_tools::ElfReader* elf_reader);
+  StatusOr<int> AttachUProbes(const std::vector<bpf_tools::UProbeSpec>& specs,
+                              const std::string& binary);
+
+  // Records the time-to-trace of a newly traced process. Only the first call per UPID counts.
+  void RecordTraced(const md::UPID& upid);
 
   // Returns set of PIDs that have had mmap called on them since the last call.
   absl::flat_hash_set<md::UPID> PIDsToRescanForUProbes();
 
   Status UpdateOpenSSLSymAddrs(std::filesystem::path container_lib, uint32_t pid);
-  Status UpdateGoCommonSymAddrs(obj_tools::ElfReader* elf_reader,
-                                obj_tools::DwarfReader* dwarf_reader,
-                                const std::vector<int32_t>& pids);
-  Status UpdateGoHTTP2SymAddrs(obj_tools::ElfReader* elf_reader,
-                               obj_tools::DwarfReader* dwarf_reader,
-                               const std::vector<int32_t>& pids);
-  Status UpdateGoTLSSymAddrs(obj_tools::ElfReader* elf_reader, obj_tools::DwarfReader* dwarf_reader,
-                             const std::vector<int32_t>& pids);
 
   // Clean-up various BPF maps used to communicate symbol addresses per PID.
   // Once the PID has terminated, the information is not required anymore.
@@ -344,7 +413,8 @@ class UProbeManager {
   // Whether we want to enable HTTP2 tracing. When false, we don't deploy HTTP2 uprobes.
   bool cfg_enable_http2_tracing_;
 
-  // Ensures DeployUProbes threads run sequentially.
+  // Ensures DeployUProbes threads run sequentially. Within a DeployUProbes call, binaries are
+  // analyzed in parallel, while attaching uprobes and updating BPF maps remains sequential.
   std::mutex deploy_uprobes_mutex_;
   std::atomic<int> num_deploy_uprobes_threads_ = 0;
 
@@ -366,10 +436,19 @@ class UProbeManager {
   // TODO(oazizi): How should these sets be cleaned up of old binaries, once they are deleted?
   //               Without clean-up, these could consume more-and-more memory.
   absl::flat_hash_set<std::string> openssl_probed_binaries_;
-  absl::flat_hash_set<std::string> scanned_binaries_;
   absl::flat_hash_set<std::string> go_http2_probed_binaries_;
   absl::flat_hash_set<std::string> go_tls_probed_binaries_;
 
+  // Analysis results of previously seen binaries, so that new instances of the same binary
+  // (possibly under a different path, e.g. in another container) are cheap to trace.
+  obj_tools::BinaryAnalysisCache<GoBinaryAnalysis> go_binary_cache_;
+  obj_tools::BinaryAnalysisCache<struct openssl_symaddrs_t> openssl_symaddrs_cache_;
+
+  Stats stats_;
+
+  // The processes whose time-to-trace was recorded.
+  absl::flat_hash_set<md::UPID> traced_upids_;
+
   // BPF maps through which the addresses of symbols for a given pid are communicated to uprobes.
   std::unique_ptr<UserSpaceManagedBPFMap<uint32_t, struct openssl_symaddrs_t> >
       openssl_symaddrs_map_;
@@ -378,6 +457,8 @@ class UProbeManager {
   std::unique_ptr<UserSpaceManagedBPFMap<uint32_t, struct go_http2_symaddrs_t> >
       go_http2_symaddrs_map_;
   std::unique_ptr<UserSpaceManagedBPFMap<uint32_t, struct go_tls_symaddrs_t> > go_tls_symaddrs_map_;
+
+  friend class UProbeManagerTest;
 };
 
 }  // namespace stirling
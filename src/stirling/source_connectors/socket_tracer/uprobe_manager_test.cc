@@ -0,0 +1,120 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/stirling/source_connectors/socket_tracer/uprobe_manager.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "src/common/testing/temp_dir.h"
+#include "src/common/testing/testing.h"
+
+namespace px {
+namespace stirling {
+
+class UProbeManagerTest : public ::testing::Test {
+ protected:
+  UProbeManagerTest() : uprobe_manager_(/* bcc */ nullptr) {
+    // Init() also creates the BPF maps, which the analysis doesn't need.
+    uprobe_manager_.cfg_enable_http2_tracing_ = true;
+    uprobe_manager_.cfg_disable_self_probing_ = true;
+  }
+
+  std::vector<UProbeManager::GoBinaryInfo> AnalyzeGoBinaries(
+      const std::map<std::string, std::vector<int32_t>>& binary_pids) {
+    return uprobe_manager_.AnalyzeGoBinaries(binary_pids);
+  }
+
+  void RecordTraced(const md::UPID& upid) { uprobe_manager_.RecordTraced(upid); }
+
+  const obj_tools::BinaryAnalysisCache<UProbeManager::GoBinaryAnalysis>& go_binary_cache() {
+    return uprobe_manager_.go_binary_cache_;
+  }
+
+  static constexpr std::string_view kGoGRPCServer =
+      "src/stirling/testing/demo_apps/go_grpc_tls_pl/server/server_/server";
+
+  UProbeManager uprobe_manager_;
+};
+
+TEST_F(UProbeManagerTest, AnalyzeGoBinariesInParallelAndFromCache) {
+  const std::filesystem::path server = px::testing::BazelBinTestFilePath(kGoGRPCServer);
+
+  // A symlink is the same file as the server, so it shares its analysis. A copy is a different
+  // file with the same build-id.
+  px::testing::TempDir tmp_dir;
+  const std::filesystem::path link = tmp_dir.path() / "link";
+  const std::filesystem::path copy = tmp_dir.path() / "copy";
+  std::filesystem::create_symlink(server, link);
+  std::filesystem::copy_file(server, copy);
+
+  const std::map<std::string, std::vector<int32_t>> binary_pids = {
+      {server.string(), {1}},
+      {link.string(), {2}},
+      {copy.string(), {3}},
+  };
+
+  const int orig_threads = FLAGS_stirling_uprobe_analysis_threads;
+  FLAGS_stirling_uprobe_analysis_threads = 4;
+  std::vector<UProbeManager::GoBinaryInfo> binaries = AnalyzeGoBinaries(binary_pids);
+  FLAGS_stirling_uprobe_analysis_threads = orig_threads;
+
+  ASSERT_EQ(binaries.size(), 3);
+  std::map<std::string, UProbeManager::GoBinaryInfo> by_binary;
+  for (const auto& info : binaries) {
+    ASSERT_NE(info.analysis, nullptr) << info.binary;
+    EXPECT_TRUE(info.analysis->common_symaddrs.has_value()) << info.binary;
+    EXPECT_TRUE(info.analysis->tls_symaddrs.has_value()) << info.binary;
+    EXPECT_OK(info.analysis->tls_probes) << info.binary;
+    EXPECT_EQ(info.pids, &binary_pids.at(info.binary));
+    by_binary[info.binary] = info;
+  }
+  EXPECT_EQ(by_binary[link.string()].analysis, by_binary[server.string()].analysis);
+  EXPECT_EQ(by_binary[copy.string()].analysis->common_symaddrs->tls_Conn,
+            by_binary[server.string()].analysis->common_symaddrs->tls_Conn);
+  EXPECT_EQ(go_binary_cache().misses(), 3);
+  EXPECT_EQ(go_binary_cache().hits(), 0);
+
+  // New instances of the binaries are served from the cache.
+  std::vector<UProbeManager::GoBinaryInfo> cached_binaries = AnalyzeGoBinaries(binary_pids);
+  ASSERT_EQ(cached_binaries.size(), 3);
+  for (const auto& info : cached_binaries) {
+    EXPECT_EQ(info.analysis, by_binary[info.binary].analysis) << info.binary;
+  }
+  EXPECT_EQ(go_binary_cache().misses(), 3);
+  EXPECT_EQ(go_binary_cache().hits(), 3);
+}
+
+TEST_F(UProbeManagerTest, RecordTracedOncePerUPID) {
+  const md::UPID upid(/* asid */ 1, /* pid */ 123, /* start_ts */ 0);
+  RecordTraced(upid);
+  RecordTraced(upid);
+  EXPECT_EQ(uprobe_manager_.stats().num_traced_upids, 1);
+
+  RecordTraced(md::UPID(/* asid */ 1, /* pid */ 456, /* start_ts */ 0));
+  EXPECT_EQ(uprobe_manager_.stats().num_traced_upids, 2);
+}
+
+}  // namespace stirling
+}  // namespace px
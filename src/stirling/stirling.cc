@@ -36,6 +36,7 @@
 
 #include "src/stirling/bpf_tools/probe_cleaner.h"
 #include "src/stirling/core/data_table.h"
+#include "src/stirling/core/host_upid_tracker.h"
 #include "src/stirling/core/pub_sub_manager.h"
 #include "src/stirling/core/source_connector.h"
 #include "src/stirling/core/source_registry.h"
@@ -192,6 +193,11 @@ class StirlingImpl final : public Stirling {
   // Destroys a dynamic tracing source created by DeployDynamicTraceConnector.
   void DestroyDynamicTraceConnector(sole::uuid trace_id);
 
+  // Returns the context for an iteration of the main loop. Unlike GetContext(), it also updates
+  // the UPID tracking used to give the source connectors incremental process updates,
+  // so it must only be called from RunCore().
+  std::unique_ptr<ConnectorContext> GetLoopContext();
+
   // Main run implementation.
   void RunCore();
 
@@ -240,6 +246,13 @@ class StirlingImpl final : public Stirling {
   absl::flat_hash_map<sole::uuid, StatusOr<stirlingpb::Publish>> dynamic_trace_status_map_
       ABSL_GUARDED_BY(dynamic_trace_status_map_lock_);
 
+  // Tracks the host processes when running without the agent's metadata. Only used by RunCore().
+  HostUPIDTracker host_upid_tracker_{system::Config::GetInstance().proc_path()};
+
+  // Log of the UPID changes between the metadata snapshots seen by RunCore().
+  UPIDDeltaLog agent_upid_delta_log_;
+  std::shared_ptr<const md::AgentMetadataState> last_agent_metadata_state_;
+
   int debug_level_ = 0;
 };
 
@@ -330,6 +343,23 @@ std::unique_ptr<ConnectorContext> StirlingImpl::GetContext() {
   return std::unique_ptr<ConnectorContext>(new StandaloneContext());
 }
 
+std::unique_ptr<ConnectorContext> StirlingImpl::GetLoopContext() {
+  if (agent_metadata_callback_ != nullptr) {
+    std::shared_ptr<const md::AgentMetadataState> agent_metadata_state = agent_metadata_callback_();
+    // The same snapshot is returned until the metadata changes, so the UPID changes are only
+    // computed once per snapshot.
+    if (agent_metadata_state != last_agent_metadata_state_) {
+      agent_upid_delta_log_.Reset(agent_metadata_state->upids());
+      last_agent_metadata_state_ = agent_metadata_state;
+    }
+    return std::unique_ptr<ConnectorContext>(
+        new AgentContext(std::move(agent_metadata_state), &agent_upid_delta_log_));
+  }
+  host_upid_tracker_.Update();
+  return std::unique_ptr<ConnectorContext>(
+      new StandaloneContext(&host_upid_tracker_.upid_delta_log()));
+}
+
 Status StirlingImpl::AddSource(std::unique_ptr<SourceConnector> source, bool dynamic) {
   // Step 1: Init the source.
   PL_RETURN_IF_ERROR(source->Init());
@@ -733,7 +763,7 @@ void StirlingImpl::RunCore() {
   // First initialize each info class manager with context.
   {
     absl::base_internal::SpinLockHolder lock(&info_class_mgrs_lock_);
-    std::unique_ptr<ConnectorContext> initial_context = GetContext();
+    std::unique_ptr<ConnectorContext> initial_context = GetLoopContext();
     for (const auto& s : sources_) {
       s->InitContext(initial_context.get());
     }
@@ -745,10 +775,9 @@ void StirlingImpl::RunCore() {
 
     // Update the context/state on each iteration.
     // Note that if no changes are present, the same pointer will be returned back.
-    // TODO(oazizi): If context constructor does a lot of work (e.g. ListUPIDs()),
-    //               then there might be an inefficiency here, since we don't know if
-    //               mgr->SamplingRequired() will be true for any manager.
-    std::unique_ptr<ConnectorContext> ctx = GetContext();
+    // Process changes are tracked incrementally, so this is cheap when no processes
+    // started or exited since the last iteration.
+    std::unique_ptr<ConnectorContext> ctx = GetLoopContext();
 
     {
       // Acquire spin lock to go through one iteration of sampling and pushing data.
@@ -763,7 +792,7 @@ void StirlingImpl::RunCore() {
             source->TransferData(ctx.get(), output.data_tables);
           }
         } else {
-          // TODO(yzhao): Reduce sampling periods if we are dropping data.
+          // Sampling periods adapt to the load on each push (see InfoClassManager::PushData()).
           for (const auto& mgr : output.info_class_mgrs) {
             if (mgr->subscribed() && mgr->SamplingRequired()) {
               mgr->SampleData(ctx.get());
@@ -827,6 +856,21 @@ void StirlingImpl::ToggleDebug() {
   for (auto& s : sources_) {
     s->SetDebugLevel(debug_level_);
   }
+
+  if (debug_level_ > 0) {
+    for (const auto& mgr : info_class_mgrs_) {
+      const DataTable* data_table = mgr->data_table();
+      if (data_table == nullptr) {
+        continue;
+      }
+      const DataTable::Stats& stats = data_table->stats();
+      LOG(INFO) << absl::Substitute(
+          "Data table $0: tablets=$1 tablets_created=$2 tablets_expired=$3 "
+          "buffers_allocated=$4 buffers_reused=$5",
+          mgr->name(), data_table->num_tablets(), stats.tablets_created, stats.tablets_expired,
+          stats.buffers_allocated, stats.buffers_reused);
+    }
+  }
 }
 
 void StirlingImpl::EnablePIDTrace(int pid) {
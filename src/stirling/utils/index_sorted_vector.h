@@ -18,29 +18,94 @@
 
 #pragma once
 
+#include <algorithm>
+#include <array>
+#include <iterator>
+#include <queue>
+#include <utility>
 #include <vector>
 
 namespace px {
 namespace stirling {
 namespace utils {
 
+// Returns the start positions of the maximal non-decreasing runs of v.
+template <typename T>
+std::vector<size_t> SortedRunStarts(const std::vector<T>& v) {
+  std::vector<size_t> run_starts;
+  if (v.empty()) {
+    return run_starts;
+  }
+  run_starts.push_back(0);
+  for (size_t i = 1; i < v.size(); ++i) {
+    if (v[i] < v[i - 1]) {
+      run_starts.push_back(i);
+    }
+  }
+  return run_starts;
+}
+
 // Computes a reorder vector that specifies the sorted order.
 // Note 1: ColumnWrapper itself is not modified.
 // Note 2: There are different ways to define the reorder indexes.
 // Here we use the form where the result, idx, is used to sort x according to:
 //    { x[idx[0]], x[idx[1]], x[idx[2]], ... }
+// Note 3: The sort is stable.
+//
+// Data is usually appended in mostly increasing order, so v is first split into its sorted runs,
+// which are then k-way merged. If there are too many runs, a regular sort is used instead.
 template <typename T>
 std::vector<size_t> SortedIndexes(const std::vector<T>& v) {
+  constexpr size_t kMaxMergedRuns = 64;
+
   // Create indices corresponding to v.
   std::vector<size_t> idx(v.size());
-  // Initialize idx = {0, 1, 2, 3, ... }
-  for (size_t i = 0; i < idx.size(); ++i) {
-    idx[i] = i;
+
+  std::vector<size_t> run_starts = SortedRunStarts(v);
+  if (run_starts.size() > kMaxMergedRuns) {
+    // Initialize idx = {0, 1, 2, 3, ... }
+    for (size_t i = 0; i < idx.size(); ++i) {
+      idx[i] = i;
+    }
+
+    // Find the sorted indices by running a sort on idx, but using the values of v.
+    // Use std::stable_sort instead of std::sort to minimize churn in indices.
+    std::stable_sort(idx.begin(), idx.end(),
+                     [&v](size_t i1, size_t i2) { return v[i1] < v[i2]; });
+    return idx;
   }
 
-  // Find the sorted indices by running a sort on idx, but using the values of v.
-  // Use std::stable_sort instead of std::sort to minimize churn in indices.
-  std::stable_sort(idx.begin(), idx.end(), [&v](size_t i1, size_t i2) { return v[i1] < v[i2]; });
+  // Each heap entry is the {next position, end position} of a run.
+  // Ties are broken by position, which keeps the merge stable, since the runs are disjoint and
+  // in order.
+  using Cursor = std::pair<size_t, size_t>;
+  auto greater = [&v](const Cursor& a, const Cursor& b) {
+    return v[b.first] < v[a.first] || (!(v[a.first] < v[b.first]) && a.first > b.first);
+  };
+  std::vector<Cursor> cursors;
+  cursors.reserve(run_starts.size());
+  for (size_t i = 0; i < run_starts.size(); ++i) {
+    size_t end = (i + 1 < run_starts.size()) ? run_starts[i + 1] : v.size();
+    cursors.emplace_back(run_starts[i], end);
+  }
+  std::priority_queue<Cursor, std::vector<Cursor>, decltype(greater)> heap(
+      greater, std::move(cursors));
+
+  size_t out = 0;
+  while (heap.size() > 1) {
+    Cursor c = heap.top();
+    heap.pop();
+    idx[out++] = c.first++;
+    if (c.first < c.second) {
+      heap.push(c);
+    }
+  }
+  // The last run needs no more comparisons.
+  if (!heap.empty()) {
+    for (size_t i = heap.top().first; i < heap.top().second; ++i) {
+      idx[out++] = i;
+    }
+  }
 
   return idx;
 }
@@ -97,7 +162,7 @@ class IndexedVectorIterator {
 // Uses std::lower_bound, which is a binary search for efficiency.
 template <size_t N, typename T>
 std::array<size_t, N> SplitSortedVector(const std::vector<T>& vec,
-                                        const std::vector<size_t> sort_indexes,
+                                        const std::vector<size_t>& sort_indexes,
                                         std::array<T, N> split_vals) {
   std::array<size_t, N> out;
 
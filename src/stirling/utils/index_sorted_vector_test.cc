@@ -33,6 +33,34 @@ TEST(SortedIndexes, Basic) {
   EXPECT_EQ(sort_indexes, (std::vector<size_t>{1, 0, 2, 5, 4, 3}));
 }
 
+TEST(SortedIndexes, SortedRuns) {
+  std::vector<int> data = {1, 3, 5, 2, 3, 6, 0, 3};
+  EXPECT_EQ(SortedRunStarts(data), (std::vector<size_t>{0, 3, 6}));
+
+  // Equal values keep their original order.
+  EXPECT_EQ(SortedIndexes(data), (std::vector<size_t>{6, 0, 3, 1, 4, 7, 2, 5}));
+
+  EXPECT_EQ(SortedIndexes(std::vector<int>{}), (std::vector<size_t>{}));
+  EXPECT_EQ(SortedIndexes(std::vector<int>{4, 5, 6}), (std::vector<size_t>{0, 1, 2}));
+}
+
+TEST(SortedIndexes, ManyRuns) {
+  // A strictly decreasing sequence, where every element is its own run.
+  std::vector<int> data;
+  for (int i = 200; i > 0; --i) {
+    data.push_back(i / 2);
+  }
+  std::vector<size_t> sort_indexes = SortedIndexes(data);
+
+  ASSERT_EQ(sort_indexes.size(), data.size());
+  for (size_t i = 1; i < sort_indexes.size(); ++i) {
+    EXPECT_LE(data[sort_indexes[i - 1]], data[sort_indexes[i]]);
+    if (data[sort_indexes[i - 1]] == data[sort_indexes[i]]) {
+      EXPECT_LT(sort_indexes[i - 1], sort_indexes[i]);
+    }
+  }
+}
+
 TEST(SplitSortedVector, Basic) {
   // Corresponds to {0, 2, 4, 6, 8, 10} after applying sort_indexes
   std::vector<int> data = {2, 0, 4, 10, 8, 6};
@@ -39,5 +39,35 @@ void ProcTracker::Update(absl::flat_hash_set<md::UPID> upids) {
   upids_ = std::move(upids);
 }
 
+void ProcTracker::Update(const absl::flat_hash_set<md::UPID>& upids,
+                         const UPIDDeltaLog* upid_delta_log) {
+  new_upids_.clear();
+  deleted_upids_.clear();
+
+  // A UPID that is both added and removed since the last update nets out to no change.
+  auto apply_delta = [this](const md::UPID& upid, bool added) {
+    if (added) {
+      if (upids_.insert(upid).second && deleted_upids_.erase(upid) == 0) {
+        new_upids_.insert(upid);
+      }
+    } else {
+      if (upids_.erase(upid) > 0 && new_upids_.erase(upid) == 0) {
+        deleted_upids_.insert(upid);
+      }
+    }
+  };
+
+  const bool applied = upid_delta_log != nullptr && upid_delta_log == upid_delta_log_ &&
+                       upid_delta_log->ForEachDeltaSince(upid_delta_log_seq_, apply_delta);
+
+  upid_delta_log_ = upid_delta_log;
+  upid_delta_log_seq_ = upid_delta_log != nullptr ? upid_delta_log->seq() : 0;
+
+  if (!applied) {
+    // Fall back to diffing the full set.
+    Update(upids);
+  }
+}
+
 }  // namespace stirling
 }  // namespace px
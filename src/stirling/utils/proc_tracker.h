@@ -22,6 +22,7 @@
 
 #include "src/common/system/proc_parser.h"
 #include "src/shared/upid/upid.h"
+#include "src/stirling/utils/upid_delta_log.h"
 
 namespace px {
 namespace stirling {
@@ -38,6 +39,15 @@ class ProcTracker : NotCopyMoveable {
    */
   void Update(absl::flat_hash_set<md::UPID> upids);
 
+  /**
+   * Same as Update() above, but if upid_delta_log is provided and still retains the changes
+   * since the previous call, only these changes are applied; the cost is then linear in the
+   * number of changes rather than in the number of processes.
+   * @param upids Current set of UPIDs. Must be the same as upid_delta_log->upids(), if provided.
+   * @param upid_delta_log The log of changes to the UPIDs. May be null.
+   */
+  void Update(const absl::flat_hash_set<md::UPID>& upids, const UPIDDeltaLog* upid_delta_log);
+
   /**
    * Returns all current upids, as set by last call to Update().
    */
@@ -57,6 +67,10 @@ class ProcTracker : NotCopyMoveable {
   absl::flat_hash_set<md::UPID> upids_;
   absl::flat_hash_set<md::UPID> new_upids_;
   absl::flat_hash_set<md::UPID> deleted_upids_;
+
+  // The log and its sequence number as of the last incremental update.
+  const UPIDDeltaLog* upid_delta_log_ = nullptr;
+  uint64_t upid_delta_log_seq_ = 0;
 };
 
 }  // namespace stirling
@@ -61,5 +61,62 @@ TEST_F(ProcTrackerTest, Basic) {
   EXPECT_THAT(proc_tracker_.deleted_upids(), UnorderedElementsAre(kUPID3));
 }
 
+TEST_F(ProcTrackerTest, UPIDDeltaLog) {
+  using UPIDSet = absl::flat_hash_set<md::UPID>;
+
+  const md::UPID kUPID1 = md::UPID(0, 1, 111);
+  const md::UPID kUPID2 = md::UPID(0, 2, 222);
+  const md::UPID kUPID3 = md::UPID(0, 3, 333);
+  const md::UPID kUPID4 = md::UPID(0, 4, 444);
+
+  UPIDDeltaLog log;
+
+  // The first update diffs the full set.
+  log.Reset(UPIDSet{kUPID1, kUPID2});
+  proc_tracker_.Update(log.upids(), &log);
+  EXPECT_THAT(proc_tracker_.upids(), UnorderedElementsAre(kUPID1, kUPID2));
+  EXPECT_THAT(proc_tracker_.new_upids(), UnorderedElementsAre(kUPID1, kUPID2));
+  EXPECT_THAT(proc_tracker_.deleted_upids(), IsEmpty());
+
+  log.Apply({kUPID3}, {kUPID2});
+  proc_tracker_.Update(log.upids(), &log);
+  EXPECT_THAT(proc_tracker_.upids(), UnorderedElementsAre(kUPID1, kUPID3));
+  EXPECT_THAT(proc_tracker_.new_upids(), UnorderedElementsAre(kUPID3));
+  EXPECT_THAT(proc_tracker_.deleted_upids(), UnorderedElementsAre(kUPID2));
+
+  // A process that starts and exits in between updates is never reported.
+  log.Apply({kUPID4}, {});
+  log.Apply({}, {kUPID4, kUPID1});
+  proc_tracker_.Update(log.upids(), &log);
+  EXPECT_THAT(proc_tracker_.upids(), UnorderedElementsAre(kUPID3));
+  EXPECT_THAT(proc_tracker_.new_upids(), IsEmpty());
+  EXPECT_THAT(proc_tracker_.deleted_upids(), UnorderedElementsAre(kUPID1));
+
+  proc_tracker_.Update(log.upids(), &log);
+  EXPECT_THAT(proc_tracker_.upids(), UnorderedElementsAre(kUPID3));
+  EXPECT_THAT(proc_tracker_.new_upids(), IsEmpty());
+  EXPECT_THAT(proc_tracker_.deleted_upids(), IsEmpty());
+}
+
+TEST_F(ProcTrackerTest, UPIDDeltaLogNoLongerRetained) {
+  using UPIDSet = absl::flat_hash_set<md::UPID>;
+
+  const md::UPID kUPID1 = md::UPID(0, 1, 111);
+  const md::UPID kUPID2 = md::UPID(0, 2, 222);
+  const md::UPID kUPID3 = md::UPID(0, 3, 333);
+
+  UPIDDeltaLog log(/* max_retained_deltas */ 1);
+
+  log.Reset(UPIDSet{kUPID1});
+  proc_tracker_.Update(log.upids(), &log);
+
+  // Falls back to diffing the full set.
+  log.Apply({kUPID2, kUPID3}, {kUPID1});
+  proc_tracker_.Update(log.upids(), &log);
+  EXPECT_THAT(proc_tracker_.upids(), UnorderedElementsAre(kUPID2, kUPID3));
+  EXPECT_THAT(proc_tracker_.new_upids(), UnorderedElementsAre(kUPID2, kUPID3));
+  EXPECT_THAT(proc_tracker_.deleted_upids(), UnorderedElementsAre(kUPID1));
+}
+
 }  // namespace stirling
 }  // namespace px
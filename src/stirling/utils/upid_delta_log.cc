@@ -0,0 +1,63 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/stirling/utils/upid_delta_log.h"
+
+#include <utility>
+
+namespace px {
+namespace stirling {
+
+void UPIDDeltaLog::Log(const md::UPID& upid, bool added) {
+  ++seq_;
+  deltas_.push_back({upid, added});
+  if (deltas_.size() > max_retained_deltas_) {
+    deltas_.pop_front();
+  }
+}
+
+void UPIDDeltaLog::Reset(absl::flat_hash_set<md::UPID> upids) {
+  for (const auto& upid : upids_) {
+    if (!upids.contains(upid)) {
+      Log(upid, /*added*/ false);
+    }
+  }
+  for (const auto& upid : upids) {
+    if (!upids_.contains(upid)) {
+      Log(upid, /*added*/ true);
+    }
+  }
+  upids_ = std::move(upids);
+}
+
+void UPIDDeltaLog::Apply(const std::vector<md::UPID>& added,
+                         const std::vector<md::UPID>& removed) {
+  for (const auto& upid : removed) {
+    if (upids_.erase(upid) > 0) {
+      Log(upid, /*added*/ false);
+    }
+  }
+  for (const auto& upid : added) {
+    if (upids_.insert(upid).second) {
+      Log(upid, /*added*/ true);
+    }
+  }
+}
+
+}  // namespace stirling
+}  // namespace px
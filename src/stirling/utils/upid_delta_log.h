@@ -0,0 +1,98 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <deque>
+#include <vector>
+
+#include <absl/container/flat_hash_set.h>
+
+#include "src/common/base/base.h"
+#include "src/shared/upid/upid.h"
+
+namespace px {
+namespace stirling {
+
+/**
+ * UPIDDeltaLog holds the current set of UPIDs, along with a bounded log of the changes to it.
+ *
+ * Consumers that remember the sequence number of the last change they saw can catch up by only
+ * visiting the changes since, instead of diffing the full set of UPIDs (see ProcTracker).
+ */
+class UPIDDeltaLog : NotCopyMoveable {
+ public:
+  static constexpr size_t kDefaultMaxRetainedDeltas = 64 * 1024;
+
+  explicit UPIDDeltaLog(size_t max_retained_deltas = kDefaultMaxRetainedDeltas)
+      : max_retained_deltas_(max_retained_deltas) {}
+
+  /**
+   * Replaces the current set of UPIDs, logging the differences with the previous set.
+   * Cost is linear in the number of UPIDs.
+   */
+  void Reset(absl::flat_hash_set<md::UPID> upids);
+
+  /**
+   * Adds and removes UPIDs. Cost is linear in the number of changes.
+   */
+  void Apply(const std::vector<md::UPID>& added, const std::vector<md::UPID>& removed);
+
+  const absl::flat_hash_set<md::UPID>& upids() const { return upids_; }
+
+  /**
+   * Sequence number of the last change. Starts at 0, before any change.
+   */
+  uint64_t seq() const { return seq_; }
+
+  /**
+   * Calls fn(upid, added) for each change after the change with sequence number seq, in order.
+   *
+   * @return false, without calling fn, if some of these changes are no longer retained.
+   */
+  template <typename TFn>
+  bool ForEachDeltaSince(uint64_t seq, TFn fn) const {
+    const uint64_t first_retained_seq = seq_ - deltas_.size() + 1;
+    if (seq + 1 < first_retained_seq) {
+      return false;
+    }
+    for (size_t i = seq + 1 - first_retained_seq; i < deltas_.size(); ++i) {
+      fn(deltas_[i].upid, deltas_[i].added);
+    }
+    return true;
+  }
+
+ private:
+  struct Delta {
+    md::UPID upid;
+    bool added;
+  };
+
+  void Log(const md::UPID& upid, bool added);
+
+  const size_t max_retained_deltas_;
+
+  absl::flat_hash_set<md::UPID> upids_;
+
+  // deltas_.back() has sequence number seq_.
+  std::deque<Delta> deltas_;
+  uint64_t seq_ = 0;
+};
+
+}  // namespace stirling
+}  // namespace px
@@ -0,0 +1,84 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/stirling/utils/upid_delta_log.h"
+
+#include <utility>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+namespace px {
+namespace stirling {
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+using ::testing::Pair;
+using ::testing::UnorderedElementsAre;
+
+using UPIDSet = absl::flat_hash_set<md::UPID>;
+
+const md::UPID kUPID1 = md::UPID(0, 1, 111);
+const md::UPID kUPID2 = md::UPID(0, 2, 222);
+const md::UPID kUPID3 = md::UPID(0, 3, 333);
+
+std::vector<std::pair<md::UPID, bool>> DeltasSince(const UPIDDeltaLog& log, uint64_t seq) {
+  std::vector<std::pair<md::UPID, bool>> deltas;
+  EXPECT_TRUE(log.ForEachDeltaSince(
+      seq, [&](const md::UPID& upid, bool added) { deltas.emplace_back(upid, added); }));
+  return deltas;
+}
+
+TEST(UPIDDeltaLogTest, ResetAndApply) {
+  UPIDDeltaLog log;
+  EXPECT_EQ(log.seq(), 0);
+  EXPECT_THAT(DeltasSince(log, 0), IsEmpty());
+
+  log.Reset(UPIDSet{kUPID1, kUPID2});
+  EXPECT_THAT(log.upids(), UnorderedElementsAre(kUPID1, kUPID2));
+  EXPECT_EQ(log.seq(), 2);
+
+  log.Reset(UPIDSet{kUPID1, kUPID3});
+  EXPECT_THAT(log.upids(), UnorderedElementsAre(kUPID1, kUPID3));
+  EXPECT_EQ(log.seq(), 4);
+  EXPECT_THAT(DeltasSince(log, 2), UnorderedElementsAre(Pair(kUPID2, false), Pair(kUPID3, true)));
+
+  log.Apply({kUPID2}, {kUPID3});
+  EXPECT_THAT(log.upids(), UnorderedElementsAre(kUPID1, kUPID2));
+  EXPECT_THAT(DeltasSince(log, 4), ElementsAre(Pair(kUPID3, false), Pair(kUPID2, true)));
+  EXPECT_THAT(DeltasSince(log, log.seq()), IsEmpty());
+
+  // Changes that don't modify the set are not logged.
+  const uint64_t seq = log.seq();
+  log.Apply({kUPID1}, {kUPID3});
+  EXPECT_EQ(log.seq(), seq);
+}
+
+TEST(UPIDDeltaLogTest, BoundedRetention) {
+  UPIDDeltaLog log(/* max_retained_deltas */ 2);
+
+  log.Reset(UPIDSet{kUPID1, kUPID2});
+  log.Apply({kUPID3}, {});
+
+  EXPECT_FALSE(log.ForEachDeltaSince(0, [](const md::UPID&, bool) {}));
+  EXPECT_THAT(DeltasSince(log, 1), ElementsAre(Pair(::testing::_, true), Pair(kUPID3, true)));
+}
+
+}  // namespace stirling
+}  // namespace px
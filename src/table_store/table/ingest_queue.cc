@@ -0,0 +1,102 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/table_store/table/ingest_queue.h"
+
+#include <chrono>
+#include <utility>
+
+DEFINE_int32(table_store_ingest_queue_max_depth, 4096,
+             "The maximum number of record batches waiting to be appended to the table store, "
+             "beyond which the producer waits for the ingest thread to catch up.");
+
+namespace px {
+namespace table_store {
+
+namespace {
+constexpr std::chrono::milliseconds kDequeueTimeout{100};
+constexpr std::chrono::microseconds kFullQueueBackoff{100};
+}  // namespace
+
+IngestQueue::IngestQueue(TableStore* table_store, int64_t max_depth)
+    : table_store_(table_store), max_depth_(max_depth) {
+  DCHECK(table_store_ != nullptr);
+}
+
+IngestQueue::~IngestQueue() { Stop(); }
+
+void IngestQueue::Start() {
+  DCHECK(!ingest_thread_.joinable());
+  running_ = true;
+  ingest_thread_ = std::thread(&IngestQueue::Run, this);
+}
+
+void IngestQueue::Stop() {
+  running_ = false;
+  if (ingest_thread_.joinable()) {
+    ingest_thread_.join();
+  }
+
+  // Append whatever the ingest thread did not get to.
+  Batch batch;
+  while (queue_.try_dequeue(batch)) {
+    --depth_;
+    Apply(std::move(batch));
+  }
+}
+
+Status IngestQueue::AppendData(uint64_t table_id, types::TabletID tablet_id,
+                               std::unique_ptr<types::ColumnWrapperRecordBatch> record_batch) {
+  if (!running_) {
+    return table_store_->AppendData(table_id, std::move(tablet_id), std::move(record_batch));
+  }
+
+  if (depth_ >= max_depth_) {
+    ++num_full_waits_;
+    while (depth_ >= max_depth_ && running_) {
+      std::this_thread::sleep_for(kFullQueueBackoff);
+    }
+  }
+
+  ++depth_;
+  if (!queue_.enqueue(Batch{table_id, std::move(tablet_id), std::move(record_batch)})) {
+    --depth_;
+    return error::ResourceUnavailable("Failed to queue record batch for table $0.", table_id);
+  }
+  return Status::OK();
+}
+
+void IngestQueue::Run() {
+  Batch batch;
+  while (running_) {
+    if (queue_.wait_dequeue_timed(batch, kDequeueTimeout)) {
+      --depth_;
+      Apply(std::move(batch));
+    }
+  }
+}
+
+void IngestQueue::Apply(Batch batch) {
+  Status s = table_store_->AppendData(batch.table_id, std::move(batch.tablet_id),
+                                      std::move(batch.record_batch));
+  LOG_IF(DFATAL, !s.ok()) << absl::Substitute("Failed to append data to table $0. Message = $1",
+                                              batch.table_id, s.msg());
+}
+
+}  // namespace table_store
+}  // namespace px
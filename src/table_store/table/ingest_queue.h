@@ -0,0 +1,103 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <thread>
+
+#include "blockingconcurrentqueue.h"
+
+#include "src/common/base/base.h"
+#include "src/shared/types/column_wrapper.h"
+#include "src/table_store/table/table_store.h"
+
+DECLARE_int32(table_store_ingest_queue_max_depth);
+
+namespace px {
+namespace table_store {
+
+/**
+ * IngestQueue decouples a data producer (e.g. Stirling) from the TableStore.
+ *
+ * Record batches passed to AppendData() are put on a lock-free queue, and appended to the
+ * TableStore by a dedicated ingest thread. The producer therefore never contends on the table
+ * locks that queries hold while reading. Batches are applied in the order they were appended.
+ *
+ * The queue is bounded: if the ingest thread falls behind by more than max_depth batches,
+ * AppendData() waits for it to catch up. depth() can be observed as a backpressure signal.
+ */
+class IngestQueue : public NotCopyable {
+ public:
+  explicit IngestQueue(TableStore* table_store,
+                       int64_t max_depth = FLAGS_table_store_ingest_queue_max_depth);
+  ~IngestQueue();
+
+  /**
+   * Starts the ingest thread.
+   */
+  void Start();
+
+  /**
+   * Stops the ingest thread, after appending all the queued batches.
+   * The producer must have stopped calling AppendData() by then.
+   */
+  void Stop();
+
+  /**
+   * Queues a record batch to be appended to the TableStore.
+   * Has the same signature as TableStore::AppendData(), so it can be used as a push callback.
+   * If the ingest thread is not running, the batch is appended synchronously.
+   */
+  Status AppendData(uint64_t table_id, types::TabletID tablet_id,
+                    std::unique_ptr<types::ColumnWrapperRecordBatch> record_batch);
+
+  /**
+   * Number of batches waiting to be appended.
+   */
+  int64_t depth() const { return depth_; }
+
+  /**
+   * Number of times AppendData() had to wait because the queue was full.
+   */
+  int64_t num_full_waits() const { return num_full_waits_; }
+
+ private:
+  struct Batch {
+    uint64_t table_id;
+    types::TabletID tablet_id;
+    std::unique_ptr<types::ColumnWrapperRecordBatch> record_batch;
+  };
+
+  void Run();
+  void Apply(Batch batch);
+
+  TableStore* table_store_;
+  const int64_t max_depth_;
+
+  moodycamel::BlockingConcurrentQueue<Batch> queue_;
+  std::atomic<int64_t> depth_ = 0;
+  std::atomic<int64_t> num_full_waits_ = 0;
+
+  std::thread ingest_thread_;
+  std::atomic<bool> running_ = false;
+};
+
+}  // namespace table_store
+}  // namespace px
@@ -0,0 +1,87 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <vector>
+
+#include "src/common/testing/testing.h"
+#include "src/table_store/schema/relation.h"
+#include "src/table_store/table/ingest_queue.h"
+
+namespace px {
+namespace table_store {
+
+class IngestQueueTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    schema::Relation rel({types::DataType::INT64}, {"col1"});
+    table_store_.AddTable(Table::Create(rel), "a", kTableID);
+  }
+
+  static std::unique_ptr<types::ColumnWrapperRecordBatch> MakeBatch(int64_t val) {
+    auto col = std::make_shared<types::Int64ValueColumnWrapper>(0);
+    col->Append(val);
+    auto batch = std::make_unique<types::ColumnWrapperRecordBatch>();
+    batch->push_back(col);
+    return batch;
+  }
+
+  static constexpr uint64_t kTableID = 1;
+  TableStore table_store_;
+};
+
+TEST_F(IngestQueueTest, AppendsInBackground) {
+  IngestQueue ingest_queue(&table_store_);
+  ingest_queue.Start();
+
+  constexpr int kNumBatches = 100;
+  for (int i = 0; i < kNumBatches; ++i) {
+    EXPECT_OK(ingest_queue.AppendData(kTableID, "", MakeBatch(i)));
+  }
+  ingest_queue.Stop();
+
+  EXPECT_EQ(ingest_queue.depth(), 0);
+  EXPECT_EQ(table_store_.GetTable(kTableID)->NumBatches(), kNumBatches);
+}
+
+TEST_F(IngestQueueTest, AppendsSynchronouslyWhenNotRunning) {
+  IngestQueue ingest_queue(&table_store_);
+
+  EXPECT_OK(ingest_queue.AppendData(kTableID, "", MakeBatch(1)));
+  EXPECT_EQ(table_store_.GetTable(kTableID)->NumBatches(), 1);
+}
+
+TEST_F(IngestQueueTest, BoundedDepth) {
+  IngestQueue ingest_queue(&table_store_, /*max_depth*/ 2);
+  ingest_queue.Start();
+
+  constexpr int kNumBatches = 100;
+  for (int i = 0; i < kNumBatches; ++i) {
+    EXPECT_OK(ingest_queue.AppendData(kTableID, "", MakeBatch(i)));
+    EXPECT_LE(ingest_queue.depth(), 2);
+  }
+  ingest_queue.Stop();
+
+  EXPECT_EQ(table_store_.GetTable(kTableID)->NumBatches(), kNumBatches);
+}
+
+}  // namespace table_store
+}  // namespace px
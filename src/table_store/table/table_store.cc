@@ -34,6 +34,15 @@ std::unique_ptr<std::unordered_map<std::string, schema::Relation>> TableStore::G
   return map;
 }
 
+TableStore::TableSizeMap TableStore::GetTableSizes() const {
+  TableSizeMap sizes;
+  sizes.reserve(name_to_relation_map_.size());
+  for (const auto& [name_tablet, table] : name_to_table_map_) {
+    sizes[name_tablet.name_] += table->NumBytes();
+  }
+  return sizes;
+}
+
 StatusOr<Table*> TableStore::CreateNewTablet(uint64_t table_id, const types::TabletID& tablet_id) {
   auto id_to_table_info_map_iter = id_to_table_info_map_.find(table_id);
   if (id_to_table_info_map_iter == id_to_table_info_map_.end()) {
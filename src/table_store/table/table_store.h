@@ -79,6 +79,7 @@ struct TableInfo {
 class TableStore {
  public:
   using RelationMap = std::unordered_map<std::string, schema::Relation>;
+  using TableSizeMap = std::unordered_map<std::string, int64_t>;
 
   TableStore() = default;
 
@@ -139,6 +140,11 @@ class TableStore {
    */
   std::unique_ptr<RelationMap> GetRelationMap();
 
+  /**
+   * @return A map of table name to the number of bytes held by the table, summed over its tablets.
+   */
+  TableSizeMap GetTableSizes() const;
+
   /**
    * @brief Appends the record_batch to the sepcified table and tablet_id. If the table exists but
    * the tablet does not, then the method creates a new container for the tablet.
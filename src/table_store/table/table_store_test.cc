@@ -277,6 +277,25 @@ TEST_F(TableStoreTabletsTest, add_tablet_on_append_data) {
   EXPECT_EQ(tablet2->NumBatches(), 0);
 }
 
+TEST_F(TableStoreTabletsTest, table_sizes_sum_tablets) {
+  auto table_store = TableStore();
+  uint64_t table_id = 123;
+  types::TabletID tablet1_id = "456";
+  types::TabletID tablet2_id = "789";
+
+  table_store.AddTable(tablet1_1, "a", table_id, tablet1_id);
+  table_store.AddTable(tablet1_2, "a", table_id, tablet2_id);
+  table_store.AddTable(tablet2_1, "b");
+
+  EXPECT_OK(table_store.AppendData(table_id, tablet1_id, MakeRel1ColumnWrapperBatch()));
+  EXPECT_OK(table_store.AppendData(table_id, tablet2_id, MakeRel1ColumnWrapperBatch()));
+
+  auto sizes = table_store.GetTableSizes();
+  EXPECT_EQ(sizes.size(), 2);
+  EXPECT_EQ(sizes["a"], 54);
+  EXPECT_EQ(sizes["b"], 0);
+}
+
 using TableStoreTabletsDeathTest = TableStoreTabletsTest;
 TEST_F(TableStoreTabletsDeathTest, tablet_test) {
   auto table_store = TableStore();
@@ -28,9 +28,13 @@ namespace agent {
 Status PEMManager::InitImpl() { return Status::OK(); }
 
 Status PEMManager::PostRegisterHookImpl() {
-  stirling_->RegisterDataPushCallback(std::bind(&table_store::TableStore::AppendData, table_store(),
-                                                std::placeholders::_1, std::placeholders::_2,
-                                                std::placeholders::_3));
+  // Stirling pushes into the ingest queue, so that its loop never waits on the table locks held
+  // by queries.
+  ingest_queue_ = std::make_unique<table_store::IngestQueue>(table_store());
+  ingest_queue_->Start();
+  stirling_->RegisterDataPushCallback(std::bind(&table_store::IngestQueue::AppendData,
+                                                ingest_queue_.get(), std::placeholders::_1,
+                                                std::placeholders::_2, std::placeholders::_3));
 
   // Enable use of USR1/USR2 for controlling Stirling debug.
   stirling_->RegisterUserDebugSignalHandlers();
@@ -57,6 +61,9 @@ Status PEMManager::PostRegisterHookImpl() {
 
 Status PEMManager::StopImpl(std::chrono::milliseconds) {
   stirling_->Stop();
+  if (ingest_queue_ != nullptr) {
+    ingest_queue_->Stop();
+  }
   return Status::OK();
 }
 
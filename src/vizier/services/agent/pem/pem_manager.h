@@ -23,6 +23,7 @@
 #include <utility>
 
 #include "src/stirling/stirling.h"
+#include "src/table_store/table/ingest_queue.h"
 #include "src/vizier/services/agent/manager/manager.h"
 #include "src/vizier/services/agent/pem/tracepoint_manager.h"
 
@@ -69,6 +70,8 @@ class PEMManager : public Manager {
     return capabilities;
   }
 
+  // Declared before stirling_, so that it outlives Stirling's pushes on destruction.
+  std::unique_ptr<table_store::IngestQueue> ingest_queue_;
   std::unique_ptr<stirling::Stirling> stirling_;
   std::shared_ptr<TracepointManager> tracepoint_manager_;
 };